@@ -26,6 +26,9 @@ import Shading;                      // Shading functions, etc
 // A separate file with some simple utility functions: getPerpendicularVector(), initRand(), nextRand()
 #include "aoCommonUtils.hlsli"
 
+// Optional counters of the rays we trace: countRay()
+#include "rayCounters.hlsli"
+
 // Payload for our primary rays.  We really don't use this for this g-buffer pass
 struct AORayPayload
 {
@@ -109,6 +112,7 @@ void AoRayGen()
 			AORayPayload rayPayload = { gAORadius + 1.0f };
 
 			// Trace our ray
+			countRay(RAY_COUNT_AO);
 			TraceRay(gRtScene, RAY_FLAG_ACCEPT_FIRST_HIT_AND_END_SEARCH, 0xFF, 0, hitProgramCount, 0, rayAO, rayPayload);
 
 			// If our hit is what we initialized it to, above, we hit no geometry (else we did hit a surface)
@@ -28,6 +28,9 @@ import Lights;                       // Light structures for our current scene
 // A separate file with some simple utility functions: getPerpendicularVector(), initRand(), nextRand()
 #include "lambertianPlusShadowsUtils.hlsli"
 
+// Optional counters of the rays we trace: countRay()
+#include "rayCounters.hlsli"
+
 // Payload for our primary rays.  We really don't use this for this g-buffer pass
 struct ShadowRayPayload
 {
@@ -59,6 +62,7 @@ float shadowRayVisibility( float3 origin, float3 direction, float minT, float ma
 
 	// Query if anything is between the current point and the light (i.e., at maxT) 
 	ShadowRayPayload rayPayload = { maxT + 1.0f }; 
+	countRay(RAY_COUNT_SHADOW);
 	TraceRay(gRtScene, RAY_FLAG_ACCEPT_FIRST_HIT_AND_END_SEARCH, 0xFF, 0, hitProgramCount, 0, ray, rayPayload);
 
 	// Check if anyone was closer than our maxT distance (in which case we're occluded)
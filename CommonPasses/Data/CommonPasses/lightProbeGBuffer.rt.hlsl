@@ -26,6 +26,9 @@ import Shading;                      // Shading functions, etc
 // Include utility functions for sampling random numbers
 #include "lightProbeGBufferUtils.hlsli"
 
+// Optional counters of the rays we trace: countRay()
+#include "rayCounters.hlsli"
+
 // Payload for our primary rays.  We really don't use this for this g-buffer pass
 struct SimpleRayPayload
 {
@@ -148,6 +151,7 @@ void GBufferRayGen()
 	SimpleRayPayload rayData = { false };
 
 	// Trace our ray
+	countRay(RAY_COUNT_PRIMARY);
 	TraceRay(gRtScene,                        // Acceleration structure
 		RAY_FLAG_CULL_BACK_FACING_TRIANGLES,  // Ray flags
 		0xFF,                                 // Instance inclusion mask
@@ -0,0 +1,57 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+// Optional ray counters, used to measure how many rays each pass traces (and so its throughput in Mrays/s).
+//    Call countRay() next to each TraceRay().  Unless the C++ code enables counting (see
+//    RayLaunch::setRayCountingEnabled()), RAY_COUNTERS is not defined and countRay() compiles to nothing.
+
+// Counter slots, one per ray type.  Keep these in sync with RayLaunch::RayCountSlot
+#define RAY_COUNT_PRIMARY     0
+#define RAY_COUNT_SHADOW      1
+#define RAY_COUNT_AO          2
+#define RAY_COUNT_INDIRECT    3    // Indirect rays use one slot per depth: RAY_COUNT_INDIRECT + depth
+#define RAY_COUNT_MAX_DEPTH   8    // Deeper indirect rays are counted in the last depth slot
+
+#ifdef RAY_COUNTERS
+// One 32-bit counter per slot.  Cleared before each launch, and read back a few frames later.
+shared RWByteAddressBuffer gRayCounters;
+#endif
+
+void countRay(uint slot)
+{
+#ifdef RAY_COUNTERS
+	// Lanes in a wave may count different slots (e.g., rays at different depths).  Handle one slot per
+	//    iteration, with a single atomic for all the lanes counting it, instead of one atomic per ray.
+	for (;;)
+	{
+		uint waveSlot = WaveReadLaneFirst(slot);
+		if (waveSlot == slot)
+		{
+			uint rayCount = WaveActiveCountBits(true);
+			if (WaveIsFirstLane())
+				gRayCounters.InterlockedAdd(slot * 4, rayCount);
+			break;
+		}
+	}
+#endif
+}
+
+void countIndirectRay(uint depth)
+{
+	countRay(RAY_COUNT_INDIRECT + min(depth, RAY_COUNT_MAX_DEPTH - 1));
+}
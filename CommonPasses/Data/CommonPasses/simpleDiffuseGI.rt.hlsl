@@ -29,6 +29,9 @@ import Lights;                       // Light structures for our current scene
 // A separate file with some simple utility functions: getPerpendicularVector(), initRand(), nextRand()
 #include "simpleDiffuseGIUtils.hlsli"
 
+// Optional counters of the rays we trace: countRay()
+#include "rayCounters.hlsli"
+
 // Include shader entries, data structures, and utility function to spawn shadow rays
 #include "standardShadowRay.hlsli"
 
@@ -124,6 +127,7 @@ float3 shootIndirectRay(float3 rayOrigin, float3 rayDir, float minT, uint seed)
 	payload.rndSeed = seed;
 
 	// Trace our ray to get a color in the indirect direction.  Use hit group #1 and miss shader #1
+	countIndirectRay(0);
 	TraceRay(gRtScene, 0, 0xFF, 1, hitProgramCount, 1, rayColor, payload);
 
 	// Return the color we got from our ray
@@ -26,6 +26,9 @@ import Shading;                      // Shading functions, etc
 // Include utility functions for sampling random numbers
 #include "thinLensUtils.hlsli"
 
+// Optional counters of the rays we trace: countRay()
+#include "rayCounters.hlsli"
+
 // Define pi
 #define M_PI  3.14159265358979323846264338327950288
 
@@ -146,6 +149,7 @@ void GBufferRayGen()
 	SimpleRayPayload rayData = { false };
 
 	// Trace our ray
+	countRay(RAY_COUNT_PRIMARY);
 	TraceRay(gRtScene,                        // Acceleration structure
 		RAY_FLAG_CULL_BACK_FACING_TRIANGLES,  // Ray flags
 		0xFF,                                 // Instance inclusion mask
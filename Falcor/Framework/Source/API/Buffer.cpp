@@ -48,6 +48,7 @@ namespace Falcor
 
     Buffer::~Buffer()
     {
+        MemoryTracker::releaseAllocation(static_cast<const Resource*>(this));
         if (mDynamicData.pResourceHandle)
         {
             gpDevice->getResourceAllocator()->release(mDynamicData);
@@ -85,6 +85,12 @@ namespace Falcor
         */
         virtual void uavBarrier(const Resource* pResource);
 
+        /** Insert an aliasing barrier. Must be recorded before using a placed resource which shares memory with a resource used earlier.
+            \param[in] pBefore The resource that was using the memory, or nullptr if any placed resource might have
+            \param[in] pAfter The resource about to use the memory
+        */
+        void aliasingBarrier(const Resource* pBefore, const Resource* pAfter);
+
         /** Copy an entire resource
         */
         void copyResource(const Resource* pDst, const Resource* pSrc);
@@ -98,12 +98,15 @@ namespace Falcor
         {
             mState.global = Resource::State::CopyDest;
             mApiHandle = createBuffer(mState.global, mSize, kReadbackHeapProps, mBindFlags);
+            MemoryTracker::trackAllocation(static_cast<const Resource*>(this), MemoryTracker::Category::Readback, mSize);
         }
         else
         {
             mState.global = Resource::State::Common;
             if (is_set(mBindFlags, BindFlags::AccelerationStructure)) mState.global = Resource::State::AccelerationStructure;
             mApiHandle = createBuffer(mState.global, mSize, kDefaultHeapProps, mBindFlags);
+            bool isAccelerationStructure = is_set(mBindFlags, BindFlags::AccelerationStructure);
+            MemoryTracker::trackAllocation(static_cast<const Resource*>(this), isAccelerationStructure ? MemoryTracker::Category::AccelerationStructure : MemoryTracker::Category::Buffer, mSize);
         }
 
         return true;
@@ -274,6 +274,17 @@ namespace Falcor
         mCommandsPending = true;
     }
 
+    void CopyContext::aliasingBarrier(const Resource* pBefore, const Resource* pAfter)
+    {
+        D3D12_RESOURCE_BARRIER barrier;
+        barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_ALIASING;
+        barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+        barrier.Aliasing.pResourceBefore = pBefore ? pBefore->getApiHandle().GetInterfacePtr() : nullptr;
+        barrier.Aliasing.pResourceAfter = pAfter ? pAfter->getApiHandle().GetInterfacePtr() : nullptr;
+        mpLowLevelData->getCommandList()->ResourceBarrier(1, &barrier);
+        mCommandsPending = true;
+    }
+
     void CopyContext::copyResource(const Resource* pDst, const Resource* pSrc)
     {
         resourceBarrier(pDst, Resource::State::CopyDest);
@@ -0,0 +1,73 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "API/ResourceHeap.h"
+#include "API/Device.h"
+#include "Utils/MemoryTracker.h"
+
+namespace Falcor
+{
+    bool ResourceHeap::isSupported()
+    {
+        // Tier 1 heaps can only contain one category of resource: buffers, render-targets/depth-stencils, or other textures
+        D3D12_FEATURE_DATA_D3D12_OPTIONS options = {};
+        if (FAILED(gpDevice->getApiHandle()->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS, &options, sizeof(options)))) return false;
+        return options.ResourceHeapTier >= D3D12_RESOURCE_HEAP_TIER_2;
+    }
+
+    ResourceHeap::SharedPtr ResourceHeap::create(uint64_t size, uint64_t alignment)
+    {
+        if (isSupported() == false)
+        {
+            logError("ResourceHeap::create() - the device doesn't support placing all texture types in one heap");
+            return nullptr;
+        }
+
+        D3D12_HEAP_DESC desc = {};
+        desc.SizeInBytes = align_to(alignment, size);
+        desc.Properties.Type = D3D12_HEAP_TYPE_DEFAULT;
+        desc.Properties.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+        desc.Properties.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+        desc.Alignment = alignment;
+        desc.Flags = D3D12_HEAP_FLAG_ALLOW_ALL_BUFFERS_AND_TEXTURES;
+
+        SharedPtr pHeap = SharedPtr(new ResourceHeap(desc.SizeInBytes));
+        if (FAILED(gpDevice->getApiHandle()->CreateHeap(&desc, IID_PPV_ARGS(&pHeap->mApiHandle))))
+        {
+            logError("ResourceHeap::create() - failed to create a heap of " + std::to_string(desc.SizeInBytes) + " bytes");
+            return nullptr;
+        }
+        MemoryTracker::trackAllocation(pHeap.get(), MemoryTracker::Category::TextureHeap, desc.SizeInBytes);
+        return pHeap;
+    }
+
+    ResourceHeap::~ResourceHeap()
+    {
+        MemoryTracker::releaseAllocation(this);
+    }
+}
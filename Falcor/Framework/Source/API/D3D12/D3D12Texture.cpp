@@ -35,6 +35,7 @@
 #include "Graphics/FullScreenPass.h"
 #include "Graphics/GraphicsState.h"
 #include "D3D12Resource.h"
+#include "API/ResourceHeap.h"
 
 namespace Falcor
 {
@@ -97,63 +98,107 @@ namespace Falcor
         }
     }
 
-    void Texture::apinit(const void* pData, bool autoGenMips)
+    static D3D12_RESOURCE_DESC getResourceDesc(Texture::Type type, uint32_t width, uint32_t height, uint32_t depth, uint32_t arraySize, uint32_t mipLevels, uint32_t sampleCount, ResourceFormat format, Texture::BindFlags bindFlags)
     {
         D3D12_RESOURCE_DESC desc = {};
 
-        desc.MipLevels = mMipLevels;
-        desc.Format = getDxgiFormat(mFormat);
-        desc.Width = align_to(getFormatWidthCompressionRatio(mFormat), mWidth);
-        desc.Height = align_to(getFormatHeightCompressionRatio(mFormat), mHeight);
-        desc.Flags = getD3D12ResourceFlags(mBindFlags);
-        desc.SampleDesc.Count = mSampleCount;
+        desc.MipLevels = mipLevels;
+        desc.Format = getDxgiFormat(format);
+        desc.Width = align_to(getFormatWidthCompressionRatio(format), width);
+        desc.Height = align_to(getFormatHeightCompressionRatio(format), height);
+        desc.Flags = getD3D12ResourceFlags(bindFlags);
+        desc.SampleDesc.Count = sampleCount;
         desc.SampleDesc.Quality = 0;
-        desc.Dimension = getResourceDimension(mType);
+        desc.Dimension = getResourceDimension(type);
         desc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
         desc.Alignment = 0;
 
-        if (mType == Texture::Type::TextureCube)
+        if (type == Texture::Type::TextureCube)
         {
-            desc.DepthOrArraySize = mArraySize * 6;
+            desc.DepthOrArraySize = arraySize * 6;
         }
-        else if (mType == Texture::Type::Texture3D)
+        else if (type == Texture::Type::Texture3D)
         {
-            desc.DepthOrArraySize = mDepth;
+            desc.DepthOrArraySize = depth;
         }
         else
         {
-            desc.DepthOrArraySize = mArraySize;
+            desc.DepthOrArraySize = arraySize;
         }
 
-        D3D12_CLEAR_VALUE clearValue = {};
-        D3D12_CLEAR_VALUE* pClearVal = nullptr;
-        if ((mBindFlags & (Texture::BindFlags::RenderTarget | Texture::BindFlags::DepthStencil)) != Texture::BindFlags::None)
+        //If depth and either ua or sr, set to typeless
+        if (isDepthFormat(format) && is_set(bindFlags, Texture::BindFlags::ShaderResource | Texture::BindFlags::UnorderedAccess))
         {
-            clearValue.Format = desc.Format;
-            if ((mBindFlags & Texture::BindFlags::DepthStencil) != Texture::BindFlags::None)
-            {
-                clearValue.DepthStencil.Depth = 1.0f;
-            }
-            pClearVal = &clearValue;
+            desc.Format = getTypelessFormatFromDepthFormat(format);
         }
+        return desc;
+    }
 
-        //If depth and either ua or sr, set to typeless
-        if (isDepthFormat(mFormat) && is_set(mBindFlags, Texture::BindFlags::ShaderResource | Texture::BindFlags::UnorderedAccess))
+    // Returns the optimized clear value for render-targets and depth-stencils, or nullptr if the texture doesn't have one
+    static D3D12_CLEAR_VALUE* getClearValue(ResourceFormat format, Texture::BindFlags bindFlags, D3D12_CLEAR_VALUE& clearValue)
+    {
+        if ((bindFlags & (Texture::BindFlags::RenderTarget | Texture::BindFlags::DepthStencil)) == Texture::BindFlags::None) return nullptr;
+        if (isDepthFormat(format) && is_set(bindFlags, Texture::BindFlags::ShaderResource | Texture::BindFlags::UnorderedAccess)) return nullptr;
+
+        clearValue = {};
+        clearValue.Format = getDxgiFormat(format);
+        if ((bindFlags & Texture::BindFlags::DepthStencil) != Texture::BindFlags::None)
         {
-            desc.Format = getTypelessFormatFromDepthFormat(mFormat);
-            pClearVal = nullptr;
+            clearValue.DepthStencil.Depth = 1.0f;
         }
+        return &clearValue;
+    }
+
+    void Texture::apinit(const void* pData, bool autoGenMips)
+    {
+        D3D12_RESOURCE_DESC desc = getResourceDesc(mType, mWidth, mHeight, mDepth, mArraySize, mMipLevels, mSampleCount, mFormat, mBindFlags);
+        D3D12_CLEAR_VALUE clearValue;
+        D3D12_CLEAR_VALUE* pClearVal = getClearValue(mFormat, mBindFlags, clearValue);
 
         d3d_call(gpDevice->getApiHandle()->CreateCommittedResource(&kDefaultHeapProps, D3D12_HEAP_FLAG_NONE, &desc, D3D12_RESOURCE_STATE_COMMON, pClearVal, IID_PPV_ARGS(&mApiHandle)));
 
+        // Count the size the driver allocates, which includes padding and alignment. Placed textures use their heap's memory, which is counted instead.
+        D3D12_RESOURCE_ALLOCATION_INFO info = gpDevice->getApiHandle()->GetResourceAllocationInfo(0, 1, &desc);
+        bool isTarget = !pData && (is_set(mBindFlags, BindFlags::RenderTarget) || is_set(mBindFlags, BindFlags::DepthStencil));
+        MemoryTracker::trackAllocation(static_cast<const Resource*>(this), isTarget ? MemoryTracker::Category::RenderTarget : MemoryTracker::Category::Texture, info.SizeInBytes, mSourceFilename);
+
         if (pData)
         {
             uploadInitData(pData, autoGenMips);
         }
     }
 
+    bool Texture::getPlacementInfo(Type type, uint32_t width, uint32_t height, uint32_t depth, ResourceFormat format, uint32_t sampleCount, BindFlags bindFlags, uint64_t& size, uint64_t& alignment)
+    {
+        if (type == Type::TextureCube || type == Type::Buffer || ResourceHeap::isSupported() == false) return false;
+
+        D3D12_RESOURCE_DESC desc = getResourceDesc(type, width, height, depth, 1, 1, sampleCount, format, bindFlags);
+        D3D12_RESOURCE_ALLOCATION_INFO info = gpDevice->getApiHandle()->GetResourceAllocationInfo(0, 1, &desc);
+        if (info.SizeInBytes == UINT64_MAX) return false;
+
+        size = info.SizeInBytes;
+        alignment = info.Alignment;
+        return true;
+    }
+
+    void Texture::apinitPlaced(const std::shared_ptr<ResourceHeap>& pHeap, uint64_t heapOffset)
+    {
+        D3D12_RESOURCE_DESC desc = getResourceDesc(mType, mWidth, mHeight, mDepth, mArraySize, mMipLevels, mSampleCount, mFormat, mBindFlags);
+        D3D12_CLEAR_VALUE clearValue;
+        D3D12_CLEAR_VALUE* pClearVal = getClearValue(mFormat, mBindFlags, clearValue);
+
+        if (FAILED(gpDevice->getApiHandle()->CreatePlacedResource(pHeap->getApiHandle(), heapOffset, &desc, D3D12_RESOURCE_STATE_COMMON, pClearVal, IID_PPV_ARGS(&mApiHandle))))
+        {
+            logError("Texture::createPlaced() - failed to place a texture at offset " + std::to_string(heapOffset) + " of a heap");
+            mApiHandle = nullptr;
+            return;
+        }
+        mpHeap = pHeap;
+    }
+
     Texture::~Texture()
     {
+        MemoryTracker::releaseAllocation(static_cast<const Resource*>(this));
         gpDevice->releaseResource(mApiHandle);
     }
 }
@@ -133,6 +133,7 @@ namespace Falcor
     MAKE_SMART_COM_PTR(ID3D12PipelineState);
     MAKE_SMART_COM_PTR(ID3D12RootSignature);
     MAKE_SMART_COM_PTR(ID3D12QueryHeap);
+    MAKE_SMART_COM_PTR(ID3D12Heap);
     MAKE_SMART_COM_PTR(ID3D12CommandSignature);
     MAKE_SMART_COM_PTR(IUnknown);
     
@@ -161,6 +162,7 @@ namespace Falcor
     using FboHandle = void*;
     using GpuAddress = D3D12_GPU_VIRTUAL_ADDRESS;
     using QueryHeapHandle = ID3D12QueryHeapPtr;
+    using ResourceHeapHandle = ID3D12HeapPtr;
 
     using GraphicsStateHandle = ID3D12PipelineStatePtr;
     using ComputeStateHandle = ID3D12PipelineStatePtr;
@@ -136,6 +136,10 @@ namespace Falcor
         */
         void flushAndSync();
 
+        /** Get the fence signaled at the end of every frame. Work recorded during a frame is done once the GPU value reaches the CPU value the fence had while recording it.
+        */
+        const GpuFence::SharedPtr& getFrameFence() const { return mpFrameFence; }
+
         /** Check if vertical sync is enabled
         */
         bool isVsyncEnabled() const { return mVsyncOn; }
@@ -100,6 +100,7 @@ namespace Falcor
             double end = (double)result[1];
             double range = end - start;
             mElapsedTime = range * gpDevice->getGpuTimestampFrequency();
+            mStartTime = start * gpDevice->getGpuTimestampFrequency();
             mStatus = Status::Idle;
         }
         assert(mStatus == Status::Idle);
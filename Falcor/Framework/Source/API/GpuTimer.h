@@ -65,6 +65,11 @@ namespace Falcor
         */
         double getElapsedTime();
 
+        /** Get the timestamp of the last begin() call, in miliseconds. \n
+            Only valid after getElapsedTime() fetched the data. The value is in the GPU's clock domain, so it is only meaningful relative to other GpuTimer timestamps.
+        */
+        double getStartTime() const { return mStartTime; }
+
     private:
         GpuTimer();
         enum Status
@@ -79,6 +84,7 @@ namespace Falcor
         uint32_t mStart;
         uint32_t mEnd;
         double mElapsedTime;
+        double mStartTime = 0;
         void apiBegin();
         void apiEnd();
         void apiResolve(uint64_t result[2]);
@@ -27,13 +27,26 @@
 ***************************************************************************/
 #include "Framework.h"
 #include "API/LowLevel/ResourceAllocator.h"
+#include "Utils/MemoryTracker.h"
 #include "API/Buffer.h"
 
 namespace Falcor
 {
     ResourceAllocator::~ResourceAllocator()
     {
-        mDeferredReleases = decltype(mDeferredReleases)();
+        while (mDeferredReleases.size())
+        {
+            if (mDeferredReleases.top().pageID == AllocationData::kMegaPageId) MemoryTracker::releaseAllocation(mDeferredReleases.top().pData);
+            mDeferredReleases.pop();
+        }
+
+        if (mpActivePage) MemoryTracker::releaseAllocation(mpActivePage.get());
+        for (const auto& page : mUsedPages) MemoryTracker::releaseAllocation(page.second.get());
+        while (mAvailablePages.size())
+        {
+            MemoryTracker::releaseAllocation(mAvailablePages.front().get());
+            mAvailablePages.pop();
+        }
     }
 
     ResourceAllocator::SharedPtr ResourceAllocator::create(size_t pageSize, GpuFence::SharedPtr pFence)
@@ -61,6 +74,7 @@ namespace Falcor
         {
             mpActivePage = std::make_unique<PageData>();
             initBasePageData((*mpActivePage), mPageSize);
+            MemoryTracker::trackAllocation(mpActivePage.get(), MemoryTracker::Category::UploadHeap, mPageSize, "Upload pages");
         }
 
         mpActivePage->currentOffset = 0;
@@ -74,6 +88,7 @@ namespace Falcor
         {
             data.pageID = ResourceAllocator::AllocationData::kMegaPageId;
             initBasePageData(data, size);
+            MemoryTracker::trackAllocation(data.pData, MemoryTracker::Category::UploadHeap, size, "Upload pages (large allocations)");
         }
         else
         {
@@ -129,7 +144,11 @@ namespace Falcor
                         mUsedPages.erase(data.pageID);
                     }
                 }
-                // else it's a mega-page. Popping it will release the resource
+                else
+                {
+                    // It's a mega-page. Popping it will release the resource
+                    MemoryTracker::releaseAllocation(data.pData);
+                }
             }
             mDeferredReleases.pop();
         }
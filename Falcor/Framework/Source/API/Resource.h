@@ -27,6 +27,7 @@
 ***************************************************************************/
 #pragma once
 #include "ResourceViews.h"
+#include "Utils/MemoryTracker.h"
 #include <unordered_map>
 
 namespace Falcor
@@ -172,9 +173,9 @@ namespace Falcor
         */
         void invalidateViews() const;
 
-        /** Set the resource name
+        /** Set the resource name. The name is also used as the owner of the resource's memory, see MemoryTracker.
         */
-        void setName(const std::string& name) { mName = name; apiSetName(); }
+        void setName(const std::string& name) { mName = name; apiSetName(); MemoryTracker::setOwner(this, name); }
 
         /** Get the resource name
         */
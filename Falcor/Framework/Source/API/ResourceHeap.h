@@ -0,0 +1,63 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+
+namespace Falcor
+{
+    /** A block of GPU memory that textures can be placed in. Textures placed at overlapping ranges of a heap alias each other,
+        which lets resources that are never used at the same time share memory.
+    */
+    class ResourceHeap : public std::enable_shared_from_this<ResourceHeap>
+    {
+    public:
+        using SharedPtr = std::shared_ptr<ResourceHeap>;
+        using ApiHandle = ResourceHeapHandle;
+
+        /** Check if the device can place textures of any kind (render-target, depth-stencil and others) in a single heap.
+            When this returns false, create() will fail.
+        */
+        static bool isSupported();
+
+        /** Create a heap
+            \param[in] size Size of the heap in bytes
+            \param[in] alignment Alignment of the heap. Must be large enough for every texture placed in it
+            \return A new object, or nullptr if the heap couldn't be created
+        */
+        static SharedPtr create(uint64_t size, uint64_t alignment);
+
+        ~ResourceHeap();
+
+        const ApiHandle& getApiHandle() const { return mApiHandle; }
+        uint64_t getSize() const { return mSize; }
+
+    private:
+        ResourceHeap(uint64_t size) : mSize(size) {}
+        ApiHandle mApiHandle;
+        uint64_t mSize = 0;
+    };
+}
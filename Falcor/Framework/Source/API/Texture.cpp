@@ -113,6 +113,18 @@ namespace Falcor
         return pTexture->mApiHandle ? pTexture : nullptr;
     }
 
+    Texture::SharedPtr Texture::createPlaced(const std::shared_ptr<ResourceHeap>& pHeap, uint64_t heapOffset, Type type, uint32_t width, uint32_t height, uint32_t depth, ResourceFormat format, uint32_t sampleCount, BindFlags bindFlags)
+    {
+        if (type == Type::TextureCube || type == Type::Buffer)
+        {
+            logError("Texture::createPlaced() - only 1D, 2D, 2D multisample and 3D textures can be placed");
+            return nullptr;
+        }
+        Texture::SharedPtr pTexture = SharedPtr(new Texture(width, height, depth, 1, 1, sampleCount, format, type, bindFlags));
+        pTexture->apinitPlaced(pHeap, heapOffset);
+        return pTexture->mApiHandle ? pTexture : nullptr;
+    }
+
     Texture::Texture(uint32_t width, uint32_t height, uint32_t depth, uint32_t arraySize, uint32_t mipLevels, uint32_t sampleCount, ResourceFormat format, Type type, BindFlags bindFlags)
         : Resource(type, bindFlags), mWidth(width), mHeight(height), mDepth(depth), mMipLevels(mipLevels), mSampleCount(sampleCount), mArraySize(arraySize), mFormat(format)
     {
@@ -36,6 +36,7 @@ namespace Falcor
     class Sampler;
     class Device;
     class RenderContext;
+    class ResourceHeap;
 
     /** Abstracts the API texture objects
     */
@@ -153,7 +154,25 @@ namespace Falcor
         */
 
         static SharedPtr create2DMS(uint32_t width, uint32_t height, ResourceFormat format, uint32_t sampleCount, uint32_t arraySize = 1, BindFlags bindFlags = BindFlags::ShaderResource);
-        
+
+        /** Get the size and alignment of the heap memory a texture created with createPlaced() needs.
+            \return false if the texture can't be placed in a heap (see ResourceHeap::isSupported())
+        */
+        static bool getPlacementInfo(Type type, uint32_t width, uint32_t height, uint32_t depth, ResourceFormat format, uint32_t sampleCount, BindFlags bindFlags, uint64_t& size, uint64_t& alignment);
+
+        /** Create a single-mip 1D, 2D, 2D multisample or 3D texture in existing heap memory.
+            Textures placed at overlapping heap ranges alias each other, and only one of them may be used at a time. Before using another one,
+            call CopyContext::aliasingBarrier() and initialize it with a clear.
+            \param[in] pHeap The heap. The texture keeps a reference to it.
+            \param[in] heapOffset Offset of the texture in the heap. Must be a multiple of the alignment returned by getPlacementInfo().
+            \return A pointer to a new texture, or nullptr if creation failed
+        */
+        static SharedPtr createPlaced(const std::shared_ptr<ResourceHeap>& pHeap, uint64_t heapOffset, Type type, uint32_t width, uint32_t height, uint32_t depth, ResourceFormat format, uint32_t sampleCount, BindFlags bindFlags);
+
+        /** Get the heap the texture was placed in, or nullptr if it has dedicated memory
+        */
+        const std::shared_ptr<ResourceHeap>& getHeap() const { return mpHeap; }
+
         /** Capture the texture to an image file.
             \param[in] mipLevel Requested mip-level
             \param[in] arraySlice Requested array-slice
@@ -169,7 +188,7 @@ namespace Falcor
 
         /** In case the texture was loaded from a file, use this to set the filename
         */
-        void setSourceFilename(const std::string& filename) { mSourceFilename = filename; }
+        void setSourceFilename(const std::string& filename) { mSourceFilename = filename; MemoryTracker::setOwner(static_cast<const Resource*>(this), filename); }
 
         /** In case the texture was loaded from a file, get the source filename
         */
@@ -178,6 +197,7 @@ namespace Falcor
     protected:
         friend class Device;
         void apinit(const void* pData, bool autoGenMips);
+        void apinitPlaced(const std::shared_ptr<ResourceHeap>& pHeap, uint64_t heapOffset);
         void uploadInitData(const void* pData, bool autoGenMips);
 		bool mReleaseRtvsAfterGenMips = true;
         static RtvHandle spNullRTV;
@@ -197,6 +217,7 @@ namespace Falcor
         uint32_t mArraySize = 0;
         ResourceFormat mFormat = ResourceFormat::Unknown;
         bool mIsSparse = false;
+        std::shared_ptr<ResourceHeap> mpHeap;
         glm::i32vec3 mSparsePageRes = glm::i32vec3(0);
     };
 }
@@ -84,6 +84,7 @@ namespace Falcor
        mName(name), mpReflector(pReflectionType), Buffer(elementSize * elementCount, bindFlags, cpuAccess), mElementCount(elementCount), mElementSize(elementSize)
     {
         Buffer::apiInit(false);
+        MemoryTracker::setOwner(static_cast<const Resource*>(this), name);
         mData.assign(mSize, 0);
     }
 
@@ -101,6 +101,7 @@ namespace Falcor
     using GpuAddress = size_t;
     using DescriptorSetApiHandle = VkDescriptorSet;
     using QueryHeapHandle = VkHandle<VkQueryPool>::SharedPtr;
+    using ResourceHeapHandle = void*;
 
     using GraphicsStateHandle = VkHandle<VkPipeline>::SharedPtr;
     using ComputeStateHandle = VkHandle<VkPipeline>::SharedPtr;
@@ -255,6 +255,11 @@ namespace Falcor
         UNSUPPORTED_IN_VULKAN("uavBarrier");
     }
 
+    void CopyContext::aliasingBarrier(const Resource* pBefore, const Resource* pAfter)
+    {
+        UNSUPPORTED_IN_VULKAN("aliasingBarrier");
+    }
+
     void CopyContext::apiSubresourceBarrier(const Texture* pTexture, Resource::State newState, Resource::State oldState, uint32_t arraySlice, uint32_t mipLevel)
     {
         VkImageMemoryBarrier barrier = {};
@@ -45,6 +45,16 @@ namespace Falcor
         if(gpDevice )gpDevice->releaseResource(std::static_pointer_cast<VkBaseApiHandle>(mApiHandle));
     }
 
+    bool Texture::getPlacementInfo(Type type, uint32_t width, uint32_t height, uint32_t depth, ResourceFormat format, uint32_t sampleCount, BindFlags bindFlags, uint64_t& size, uint64_t& alignment)
+    {
+        return false;
+    }
+
+    void Texture::apinitPlaced(const std::shared_ptr<ResourceHeap>& pHeap, uint64_t heapOffset)
+    {
+        UNSUPPORTED_IN_VULKAN("Texture::createPlaced()");
+    }
+
     // Like getD3D12ResourceFlags but for Images specifically
     VkImageUsageFlags getVkImageUsageFlags(Resource::BindFlags bindFlags)
     {
@@ -61,6 +61,7 @@
 #include "API/CopyContext.h"
 #include "API/ComputeContext.h"
 #include "API/QueryHeap.h"
+#include "API/ResourceHeap.h"
 
 #if defined FALCOR_D3D12 || defined FALCOR_VK
 #include "API/DescriptorSet.h"
@@ -76,6 +77,9 @@
 #include "Graphics/GraphicsState.h"
 #include "Graphics/FullScreenPass.h"
 #include "Graphics/TextureHelper.h"
+#include "Graphics/TextureStreamer.h"
+#include "Graphics/AssetRegistry.h"
+#include "Graphics/GeometryStreamer.h"
 #include "Graphics/Light.h"
 #include "Graphics/LightProbe.h"
 #include "Graphics/FboHelper.h"
@@ -86,6 +90,8 @@
 #include "Graphics/Program/ProgramVars.h"
 #include "Graphics/Program/ProgramVersion.h"
 #include "Graphics/Program/Program.h"
+#include "Graphics/Program/ShaderCache.h"
+#include "Graphics/Program/ProgramCompiler.h"
 #include "Graphics/Program/GraphicsProgram.h"
 #include "Graphics/Program/ComputeProgram.h"
 #include "Graphics/Program/ParameterBlock.h"
@@ -95,12 +101,15 @@
 
 // Model
 #include "Graphics/Model/Mesh.h"
+#include "Graphics/Model/MeshSimplifier.h"
+#include "Graphics/Model/TangentGenerator.h"
 #include "Graphics/Model/Model.h"
 #include "Graphics/Model/ModelRenderer.h"
 
 // Scene
 #include "Graphics/Scene/Scene.h"
 #include "Graphics/Scene/SceneRenderer.h"
+#include "Graphics/Scene/SyntheticSceneGenerator.h"
 #include "Graphics/Scene/Editor/SceneEditor.h"
 
 // Math
@@ -132,6 +141,8 @@
 #include "Utils/CpuTimer.h"
 #include "Utils/UserInput.h"
 #include "Utils/Profiler.h"
+#include "Utils/MemoryTracker.h"
+#include "Utils/ImageCompare.h"
 #include "Utils/StringUtils.h"
 #include "Utils/BinaryFileStream.h"
 #include "Utils/Video/VideoEncoder.h"
@@ -0,0 +1,176 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "AssetRegistry.h"
+#include "API/ConstantBuffer.h"
+#include "Utils/Platform/OS.h"
+#include "Utils/StringUtils.h"
+#include <fstream>
+
+namespace Falcor
+{
+    static AssetRegistry::SharedPtr spActiveRegistry;
+
+    static uint64_t hashFileContents(std::ifstream& stream)
+    {
+        uint64_t hash = kFnv1aOffsetBasis;
+        std::vector<char> buffer(1 << 16);
+        while (stream)
+        {
+            stream.read(buffer.data(), buffer.size());
+            hash = hashBytes(hash, buffer.data(), (size_t)stream.gcount());
+        }
+        return hash;
+    }
+
+    static uint64_t getTextureSize(const Texture* pTexture)
+    {
+        ResourceFormat format = pTexture->getFormat();
+        uint32_t blockWidth = isCompressedFormat(format) ? getFormatWidthCompressionRatio(format) : 1;
+        uint32_t blockHeight = isCompressedFormat(format) ? getFormatHeightCompressionRatio(format) : 1;
+
+        uint64_t size = 0;
+        for (uint32_t mip = 0; mip < pTexture->getMipCount(); mip++)
+        {
+            uint64_t blocksX = (pTexture->getWidth(mip) + blockWidth - 1) / blockWidth;
+            uint64_t blocksY = (pTexture->getHeight(mip) + blockHeight - 1) / blockHeight;
+            size += blocksX * blocksY * getFormatBytesPerBlock(format);
+        }
+        return size * pTexture->getArraySize() * pTexture->getDepth();
+    }
+
+    static uint64_t getMaterialSize(const Material* pMaterial)
+    {
+        // The CPU copy of the material data and the constant buffer of the material's parameter block. The textures are shared with the equivalent material, and are counted by the texture stats if they were deduplicated.
+        uint64_t size = sizeof(MaterialData);
+        ConstantBuffer::SharedPtr pCB = pMaterial->getParameterBlock()->getDefaultConstantBuffer();
+        if (pCB) size += pCB->getSize();
+        return size;
+    }
+
+    AssetRegistry::SharedPtr AssetRegistry::create()
+    {
+        return SharedPtr(new AssetRegistry());
+    }
+
+    const AssetRegistry::SharedPtr& AssetRegistry::getActive()
+    {
+        return spActiveRegistry;
+    }
+
+    void AssetRegistry::setActive(const SharedPtr& pRegistry)
+    {
+        spActiveRegistry = pRegistry;
+    }
+
+    bool AssetRegistry::getContentKey(const std::string& filename, bool loadAsSrgb, uint64_t& key)
+    {
+        std::string fullpath;
+        if (findFileInDataDirectories(filename, fullpath) == false) return false;
+
+        auto it = mFileToHash.find(fullpath);
+        if (it == mFileToHash.end())
+        {
+            std::ifstream stream(fullpath, std::ios::binary);
+            if (stream.is_open() == false) return false;
+            it = mFileToHash.insert({ fullpath, hashFileContents(stream) }).first;
+        }
+
+        // The same image loaded as sRGB and as linear results in different textures
+        key = (it->second << 1) | (loadAsSrgb ? 1 : 0);
+        return true;
+    }
+
+    Texture::SharedPtr AssetRegistry::findTexture(const std::string& filename, bool loadAsSrgb)
+    {
+        uint64_t key;
+        if (getContentKey(filename, loadAsSrgb, key) == false) return nullptr;
+
+        auto it = mTextures.find(key);
+        if (it == mTextures.end()) return nullptr;
+
+        mStats.textureDuplicates++;
+        mStats.textureBytesSaved += getTextureSize(it->second.get());
+        return it->second;
+    }
+
+    void AssetRegistry::addTexture(const std::string& filename, bool loadAsSrgb, const Texture::SharedPtr& pTexture)
+    {
+        uint64_t key;
+        if (pTexture == nullptr || getContentKey(filename, loadAsSrgb, key) == false) return;
+
+        if (mTextures.insert({ key, pTexture }).second)
+        {
+            mStats.textureCount++;
+        }
+    }
+
+    Material::SharedPtr AssetRegistry::findOrAddMaterial(const Material::SharedPtr& pMaterial)
+    {
+        size_t hash = pMaterial->getHash();
+        auto range = mMaterials.equal_range(hash);
+        for (auto it = range.first; it != range.second; it++)
+        {
+            if (it->second == pMaterial) return pMaterial;
+            if (*it->second == *pMaterial)
+            {
+                mStats.materialDuplicates++;
+                mStats.materialBytesSaved += getMaterialSize(pMaterial.get());
+                return it->second;
+            }
+        }
+
+        mMaterials.insert({ hash, pMaterial });
+        mStats.materialCount++;
+        return pMaterial;
+    }
+
+    AssetRegistry::ScopedActivation::ScopedActivation()
+    {
+        if (spActiveRegistry == nullptr)
+        {
+            mpRegistry = create();
+            setActive(mpRegistry);
+        }
+    }
+
+    AssetRegistry::ScopedActivation::~ScopedActivation()
+    {
+        if (mpRegistry == nullptr) return;
+        mpRegistry->logStats();
+        if (spActiveRegistry == mpRegistry) setActive(nullptr);
+    }
+
+    void AssetRegistry::logStats() const
+    {
+        std::string msg = "Asset registry: " + std::to_string(mStats.textureCount) + " unique textures, " + std::to_string(mStats.textureDuplicates) + " duplicates shared (";
+        msg += std::to_string(mStats.textureBytesSaved / 1024) + " KB saved). ";
+        msg += std::to_string(mStats.materialCount) + " unique materials, " + std::to_string(mStats.materialDuplicates) + " duplicates shared (" + std::to_string(mStats.materialBytesSaved) + " bytes saved).";
+        logInfo(msg);
+    }
+}
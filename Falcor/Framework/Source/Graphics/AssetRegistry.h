@@ -0,0 +1,114 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <string>
+#include <unordered_map>
+#include "API/Texture.h"
+#include "Graphics/Material/Material.h"
+
+namespace Falcor
+{
+    /** Shares identical textures and materials between the models of a scene.
+        Textures are identified by a hash of their file contents, so copies of the same image stored under different paths are loaded once.
+        Materials are identified by their parameters and textures, the same way Material::operator==() compares them.
+        SceneImporter activates a registry for the duration of a scene load. The model importers use the active registry, if there is one.
+    */
+    class AssetRegistry
+    {
+    public:
+        using SharedPtr = std::shared_ptr<AssetRegistry>;
+        using SharedConstPtr = std::shared_ptr<const AssetRegistry>;
+
+        struct Stats
+        {
+            uint32_t textureCount = 0;          ///< Number of unique textures
+            uint32_t textureDuplicates = 0;     ///< Number of texture loads which were resolved to an existing texture with the same content
+            uint64_t textureBytesSaved = 0;     ///< GPU memory which would have been used by the duplicate textures
+            uint32_t materialCount = 0;         ///< Number of unique materials
+            uint32_t materialDuplicates = 0;    ///< Number of materials which were replaced with an existing equivalent material
+            uint64_t materialBytesSaved = 0;    ///< Material data and parameter block constant buffers which would have been used by the duplicate materials. Their textures are counted by textureBytesSaved.
+        };
+
+        /** Create a new registry
+        */
+        static SharedPtr create();
+
+        /** Get the active registry. Can be nullptr.
+        */
+        static const SharedPtr& getActive();
+
+        /** Set the active registry. Pass nullptr to deactivate.
+        */
+        static void setActive(const SharedPtr& pRegistry);
+
+        /** Activates a new registry while the object is alive, unless a registry is already active. Scopes can be nested; only the outermost one creates a registry.
+            When it ends, the registry it created logs its statistics and is deactivated.
+        */
+        class ScopedActivation
+        {
+        public:
+            ScopedActivation();
+            ~ScopedActivation();
+        private:
+            SharedPtr mpRegistry;
+        };
+
+        /** Find a texture with the same content as a file
+            \param[in] filename The texture's file
+            \param[in] loadAsSrgb Whether the texture is loaded using an sRGB format
+            \return A texture created from a file with identical content, or nullptr if there is none
+        */
+        Texture::SharedPtr findTexture(const std::string& filename, bool loadAsSrgb);
+
+        /** Add a texture which was loaded from a file
+        */
+        void addTexture(const std::string& filename, bool loadAsSrgb, const Texture::SharedPtr& pTexture);
+
+        /** Find an equivalent material, or add the material if there is none
+            \return The existing equivalent material, or pMaterial if it was added
+        */
+        Material::SharedPtr findOrAddMaterial(const Material::SharedPtr& pMaterial);
+
+        /** Get the deduplication statistics
+        */
+        const Stats& getStats() const { return mStats; }
+
+        /** Log the deduplication statistics
+        */
+        void logStats() const;
+
+    private:
+        AssetRegistry() = default;
+        bool getContentKey(const std::string& filename, bool loadAsSrgb, uint64_t& key);
+
+        Stats mStats;
+        std::unordered_map<std::string, uint64_t> mFileToHash;              ///< Content hash of each file that was hashed
+        std::unordered_map<uint64_t, Texture::SharedPtr> mTextures;         ///< Keyed by content hash and sRGB flag
+        std::unordered_multimap<size_t, Material::SharedPtr> mMaterials;    ///< Keyed by Material::getHash()
+    };
+}
@@ -0,0 +1,505 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "GeometryStreamer.h"
+#include "Graphics/Model/Mesh.h"
+#include "Graphics/Model/MeshSimplifier.h"
+#include "Graphics/Material/Material.h"
+#include "Graphics/Scene/Scene.h"
+#include "Graphics/Camera/Camera.h"
+#include "Data/VertexAttrib.h"
+#include "Utils/Gui.h"
+#include "Utils/Platform/OS.h"
+#include "Utils/StringUtils.h"
+#include "Utils/Math/FalcorMath.h"
+#include <fstream>
+#include <algorithm>
+#include <cstdio>
+
+namespace Falcor
+{
+    static const uint32_t kPageMagic = 0x4F454746;      // 'FGEO'
+    static const uint32_t kPageVersion = 1;
+
+    struct PageHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t vertexCount;
+        uint32_t indexCount;
+        uint32_t vertexBufferCount;
+    };
+
+    static GeometryStreamer::SharedPtr spGlobalStreamer;
+
+    static Buffer::SharedPtr createBuffer(const void* pData, size_t size, Buffer::BindFlags bindFlags, bool shaderResource)
+    {
+        if (shaderResource) bindFlags |= Buffer::BindFlags::ShaderResource;
+        return Buffer::create(size, bindFlags, Buffer::CpuAccess::None, pData);
+    }
+
+    GeometryStreamer::SharedPtr GeometryStreamer::create(const Desc& desc)
+    {
+        return SharedPtr(new GeometryStreamer(desc));
+    }
+
+    const GeometryStreamer::SharedPtr& GeometryStreamer::getGlobalStreamer(bool createIfMissing)
+    {
+        if (spGlobalStreamer == nullptr && createIfMissing)
+        {
+            spGlobalStreamer = create();
+        }
+        return spGlobalStreamer;
+    }
+
+    void GeometryStreamer::setGlobalStreamer(const SharedPtr& pStreamer)
+    {
+        spGlobalStreamer = pStreamer;
+    }
+
+    GeometryStreamer::GeometryStreamer(const Desc& desc) : mDesc(desc)
+    {
+        if (mDesc.cacheDirectory.empty())
+        {
+            mDesc.cacheDirectory = getExecutableDirectory() + "/GeometryCache";
+        }
+        if (isDirectoryExists(mDesc.cacheDirectory) == false && createDirectory(mDesc.cacheDirectory) == false)
+        {
+            logWarning("GeometryStreamer: can't create cache directory '" + mDesc.cacheDirectory + "'.");
+        }
+        mDesc.clusterTriangleCount = std::max(mDesc.clusterTriangleCount, 2 * mDesc.proxyTriangleCount);
+        mDesc.maxRequestsInFlight = std::max(1u, mDesc.maxRequestsInFlight);
+        mIoThread = std::thread(&GeometryStreamer::ioThreadFunc, this);
+    }
+
+    GeometryStreamer::~GeometryStreamer()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mIoMutex);
+            mTerminate = true;
+        }
+        mIoCondition.notify_all();
+        mIoThread.join();
+    }
+
+    uint64_t GeometryStreamer::getPageSize(const StreamedMesh& mesh)
+    {
+        uint64_t size = uint64_t(mesh.indexCount) * sizeof(uint32_t);
+        for (uint64_t vbSize : mesh.vbSizes) size += vbSize;
+        return size;
+    }
+
+    bool GeometryStreamer::cookPage(const std::string& pageFile, const std::vector<std::vector<uint8_t>>& vertexData, uint32_t vertexCount, const std::vector<uint32_t>& indices)
+    {
+        // Write through a temporary file, so that a partially written file is never picked up
+        bool written = writeFileAtomic(pageFile, [&](std::ostream& stream)
+        {
+            PageHeader header = { kPageMagic, kPageVersion, vertexCount, uint32_t(indices.size()), uint32_t(vertexData.size()) };
+            stream.write((const char*)&header, sizeof(header));
+            for (const auto& vb : vertexData)
+            {
+                uint64_t size = vb.size();
+                stream.write((const char*)&size, sizeof(size));
+            }
+            for (const auto& vb : vertexData)
+            {
+                stream.write((const char*)vb.data(), vb.size());
+            }
+            stream.write((const char*)indices.data(), indices.size() * sizeof(uint32_t));
+            return true;
+        });
+        if (written == false) logWarning("GeometryStreamer: can't write page file '" + pageFile + "'.");
+        return written;
+    }
+
+    Mesh::SharedPtr GeometryStreamer::createMesh(const VertexLayout::SharedPtr& pLayout, const std::vector<std::vector<uint8_t>>& vertexData, uint32_t vertexCount, const std::vector<uint32_t>& indices,
+        bool shaderResource, const Material::SharedPtr& pMaterial, const BoundingBox& boundingBox)
+    {
+        // Streaming small meshes isn't worth it
+        if (indices.size() % 3 != 0 || indices.size() / 3 <= 2 * mDesc.proxyTriangleCount) return nullptr;
+        assert(vertexData.size() == pLayout->getBufferCount());
+
+        // Gather the positions, which the proxy is built from
+        std::vector<glm::vec3> positions;
+        for (uint32_t b = 0; b < pLayout->getBufferCount() && positions.empty(); b++)
+        {
+            const VertexBufferLayout* pVbLayout = pLayout->getBufferLayout(b).get();
+            for (uint32_t e = 0; e < pVbLayout->getElementCount(); e++)
+            {
+                if (pVbLayout->getElementShaderLocation(e) != VERTEX_POSITION_LOC) continue;
+                if (pVbLayout->getElementFormat(e) != ResourceFormat::RGB32Float) return nullptr;
+
+                positions.resize(vertexCount);
+                for (uint32_t v = 0; v < vertexCount; v++)
+                {
+                    memcpy(&positions[v], vertexData[b].data() + v * pVbLayout->getStride() + pVbLayout->getElementOffset(e), sizeof(glm::vec3));
+                }
+                break;
+            }
+        }
+        if (positions.empty()) return nullptr;
+
+        // Simplify the cluster down to the proxy size. The LOD chain is cached, so this only happens the first time the cluster is seen.
+        MeshSimplifier::Desc simplifierDesc;
+        simplifierDesc.maxLodCount = 32;
+        simplifierDesc.minTriangleCount = mDesc.proxyTriangleCount;
+        std::vector<MeshSimplifier::Lod> lods = MeshSimplifier::generateLodChain(positions.data(), vertexCount, indices, simplifierDesc);
+        if (lods.empty()) return nullptr;
+
+        // Cook the full-resolution page
+        uint64_t hash = kFnv1aOffsetBasis;
+        hash = hashBytes(hash, &kPageVersion, sizeof(kPageVersion));
+        hash = hashBytes(hash, &vertexCount, sizeof(vertexCount));
+        for (const auto& vb : vertexData) hash = hashBytes(hash, vb.data(), vb.size());
+        hash = hashBytes(hash, indices.data(), indices.size() * sizeof(uint32_t));
+        std::string pageFile = mDesc.cacheDirectory + "/" + std::to_string(hash) + ".fgeo";
+        if (doesFileExist(pageFile) == false && cookPage(pageFile, vertexData, vertexCount, indices) == false) return nullptr;
+
+        // The proxy only keeps the vertices referenced by the coarsest LOD
+        const std::vector<uint32_t>& lodIndices = lods.back().indices;
+        std::vector<uint32_t> remap(vertexCount, uint32_t(-1));
+        std::vector<uint32_t> proxyVertices;
+        std::vector<uint32_t> proxyIndices(lodIndices.size());
+        for (size_t i = 0; i < lodIndices.size(); i++)
+        {
+            uint32_t& newIndex = remap[lodIndices[i]];
+            if (newIndex == uint32_t(-1))
+            {
+                newIndex = uint32_t(proxyVertices.size());
+                proxyVertices.push_back(lodIndices[i]);
+            }
+            proxyIndices[i] = newIndex;
+        }
+
+        StreamedMesh mesh;
+        mesh.proxyBytes = proxyIndices.size() * sizeof(uint32_t);
+        Vao::BufferVec proxyVbs(pLayout->getBufferCount());
+        for (uint32_t b = 0; b < pLayout->getBufferCount(); b++)
+        {
+            uint32_t stride = pLayout->getBufferLayout(b)->getStride();
+            std::vector<uint8_t> data(stride * proxyVertices.size());
+            for (size_t v = 0; v < proxyVertices.size(); v++)
+            {
+                memcpy(data.data() + v * stride, vertexData[b].data() + proxyVertices[v] * stride, stride);
+            }
+            proxyVbs[b] = createBuffer(data.data(), data.size(), Buffer::BindFlags::Vertex, shaderResource);
+            mesh.proxyBytes += data.size();
+            mesh.vbSizes.push_back(vertexData[b].size());
+        }
+        Buffer::SharedPtr pProxyIb = createBuffer(proxyIndices.data(), proxyIndices.size() * sizeof(uint32_t), Buffer::BindFlags::Index, shaderResource);
+
+        Mesh::SharedPtr pMesh = Mesh::create(proxyVbs, uint32_t(proxyVertices.size()), pProxyIb, uint32_t(proxyIndices.size()), pLayout, Vao::Topology::TriangleList, pMaterial, boundingBox, false);
+
+        mesh.pMesh = pMesh;
+        mesh.pKey = pMesh.get();
+        mesh.pageFile = pageFile;
+        mesh.pLayout = pLayout;
+        mesh.shaderResource = shaderResource;
+        mesh.vertexCount = vertexCount;
+        mesh.indexCount = uint32_t(indices.size());
+        mesh.pProxyVao = pMesh->getVao();
+        mesh.proxyVertexCount = uint32_t(proxyVertices.size());
+        mesh.proxyIndexCount = uint32_t(proxyIndices.size());
+
+        mMeshToId[pMesh.get()] = uint32_t(mMeshes.size());
+        mStats.clusterCount++;
+        mStats.proxyBytes += mesh.proxyBytes;
+        mMeshes.push_back(std::move(mesh));
+        return pMesh;
+    }
+
+    void GeometryStreamer::touchMesh(const Mesh* pMesh, float priority)
+    {
+        auto it = mMeshToId.find(pMesh);
+        if (it == mMeshToId.end()) return;
+
+        StreamedMesh& mesh = mMeshes[it->second];
+        mesh.priority = std::max(mesh.priority, std::max(priority, 0.0f));
+        mesh.lastUsedFrame = mFrameCount;
+    }
+
+    void GeometryStreamer::updateResidency(Scene* pScene, const Camera* pCamera, uint32_t viewportHeight)
+    {
+        if (pScene == nullptr || pCamera == nullptr || mMeshToId.empty()) return;
+        float tanHalfFovY = tanf(0.5f * focalLengthToFovY(pCamera->getFocalLength(), pCamera->getFrameHeight()));
+        float nearbyDistance = pScene->getRadius() * mDesc.nearbyRadiusScale;
+        const glm::vec3& camPos = pCamera->getPosition();
+
+        for (uint32_t modelId = 0; modelId < pScene->getModelCount(); modelId++)
+        {
+            const Model* pModel = pScene->getModel(modelId).get();
+            for (uint32_t modelInstanceId = 0; modelInstanceId < pScene->getModelInstanceCount(modelId); modelInstanceId++)
+            {
+                const auto& pModelInstance = pScene->getModelInstance(modelId, modelInstanceId);
+                if (pModelInstance->isVisible() == false) continue;
+
+                for (uint32_t meshId = 0; meshId < pModel->getMeshCount(); meshId++)
+                {
+                    const Mesh* pMesh = pModel->getMesh(meshId).get();
+                    if (mMeshToId.find(pMesh) == mMeshToId.end()) continue;
+
+                    for (uint32_t meshInstanceId = 0; meshInstanceId < pModel->getMeshInstanceCount(meshId); meshInstanceId++)
+                    {
+                        const auto& pMeshInstance = pModel->getMeshInstance(meshId, meshInstanceId);
+                        if (pMeshInstance->isVisible() == false) continue;
+
+                        BoundingBox box = pMeshInstance->getBoundingBox().transform(pModelInstance->getTransformMatrix());
+                        float radius = glm::length(box.extent);
+                        float distance = std::max(glm::length(box.center - camPos) - radius, 0.0f);
+
+                        if (pCamera->isObjectCulled(box) == false)
+                        {
+                            // Visible clusters come first, largest on screen first
+                            float projectedPixels = float(viewportHeight) * radius / (std::max(distance, pCamera->getNearPlane()) * tanHalfFovY);
+                            touchMesh(pMesh, 1 + projectedPixels);
+                        }
+                        else if (distance <= nearbyDistance)
+                        {
+                            // Not visible, but reflection and shadow rays are likely to hit it
+                            touchMesh(pMesh, 0);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    void GeometryStreamer::makeResident(uint32_t meshId, const IoResult& result)
+    {
+        StreamedMesh& mesh = mMeshes[meshId];
+        Mesh::SharedPtr pMesh = mesh.pMesh.lock();
+        if (pMesh == nullptr) return;
+
+        Vao::BufferVec vbs(result.vbData.size());
+        for (size_t b = 0; b < vbs.size(); b++)
+        {
+            vbs[b] = createBuffer(result.vbData[b].data(), result.vbData[b].size(), Buffer::BindFlags::Vertex, mesh.shaderResource);
+        }
+        Buffer::SharedPtr pIb = createBuffer(result.ibData.data(), result.ibData.size(), Buffer::BindFlags::Index, mesh.shaderResource);
+        pMesh->setGeometry(Vao::create(Vao::Topology::TriangleList, mesh.pLayout, vbs, pIb, ResourceFormat::R32Uint), mesh.vertexCount, mesh.indexCount);
+
+        mesh.resident = true;
+        mStats.residentClusters++;
+        mStats.residentBytes += getPageSize(mesh);
+        mStats.peakResidentBytes = std::max(mStats.peakResidentBytes, mStats.residentBytes);
+        mStats.pagesIn++;
+        mChangedMeshes.push_back(mesh.pKey);
+    }
+
+    void GeometryStreamer::makeProxy(uint32_t meshId)
+    {
+        StreamedMesh& mesh = mMeshes[meshId];
+        assert(mesh.resident);
+        Mesh::SharedPtr pMesh = mesh.pMesh.lock();
+        if (pMesh)
+        {
+            // The full-resolution buffers are released with the VAO
+            pMesh->setGeometry(mesh.pProxyVao, mesh.proxyVertexCount, mesh.proxyIndexCount);
+            mChangedMeshes.push_back(mesh.pKey);
+        }
+
+        mesh.resident = false;
+        mStats.residentClusters--;
+        mStats.residentBytes -= getPageSize(mesh);
+    }
+
+    bool GeometryStreamer::evict(uint64_t requiredBytes)
+    {
+        // Candidates are clusters which weren't used this frame, least-recently-used first
+        std::vector<uint32_t> candidates;
+        for (uint32_t i = 0; i < (uint32_t)mMeshes.size(); i++)
+        {
+            if (mMeshes[i].resident && mMeshes[i].lastUsedFrame < mFrameCount) candidates.push_back(i);
+        }
+        std::sort(candidates.begin(), candidates.end(), [this](uint32_t a, uint32_t b) { return mMeshes[a].lastUsedFrame < mMeshes[b].lastUsedFrame; });
+
+        for (uint32_t id : candidates)
+        {
+            if (mStats.residentBytes + requiredBytes <= mDesc.memoryBudget) break;
+            makeProxy(id);
+            mStats.pagesEvicted++;
+        }
+        return mStats.residentBytes + requiredBytes <= mDesc.memoryBudget;
+    }
+
+    bool GeometryStreamer::update()
+    {
+        mChangedMeshes.clear();
+
+        // Forget the clusters of models which were released
+        for (auto& mesh : mMeshes)
+        {
+            if (mesh.pKey == nullptr || mesh.pMesh.expired() == false) continue;
+            if (mesh.resident)
+            {
+                mStats.residentClusters--;
+                mStats.residentBytes -= getPageSize(mesh);
+            }
+            mStats.clusterCount--;
+            mStats.proxyBytes -= mesh.proxyBytes;
+            mMeshToId.erase(mesh.pKey);
+            mesh = StreamedMesh();
+        }
+
+        // Swap completed pages into their meshes
+        std::vector<IoResult> completed;
+        {
+            std::lock_guard<std::mutex> lock(mIoMutex);
+            completed.swap(mCompletedRequests);
+        }
+
+        for (const auto& result : completed)
+        {
+            uint32_t id = result.request.meshId;
+            StreamedMesh& mesh = mMeshes[id];
+            mesh.inFlight = false;
+            if (mesh.pKey == nullptr || mesh.resident) continue;
+            if (result.success == false)
+            {
+                logWarning("GeometryStreamer: failed to read page file '" + mesh.pageFile + "'.");
+                continue;
+            }
+
+            uint64_t requiredBytes = getPageSize(mesh);
+            if (mStats.residentBytes + requiredBytes > mDesc.memoryBudget && evict(requiredBytes) == false) continue;
+
+            makeResident(id, result);
+            double latency = CpuTimer::calcDuration(result.request.issueTime, CpuTimer::getCurrentTimePoint());
+            mTotalLatencyMs += latency;
+            mStats.maxLatencyMs = std::max(mStats.maxLatencyMs, latency);
+            mStats.avgLatencyMs = mTotalLatencyMs / mStats.pagesIn;
+        }
+
+        // The budget may have been lowered
+        if (mStats.residentBytes > mDesc.memoryBudget) evict(0);
+
+        // Issue new requests, highest priority first
+        std::vector<std::pair<float, uint32_t>> candidates;
+        uint32_t inFlight = 0;
+        for (uint32_t i = 0; i < (uint32_t)mMeshes.size(); i++)
+        {
+            StreamedMesh& mesh = mMeshes[i];
+            if (mesh.inFlight) inFlight++;
+            else if (mesh.pKey && mesh.resident == false && mesh.priority >= 0) candidates.push_back({ mesh.priority, i });
+            mesh.priority = -1;
+        }
+        std::sort(candidates.begin(), candidates.end(), [](const std::pair<float, uint32_t>& a, const std::pair<float, uint32_t>& b) { return a.first > b.first; });
+
+        std::vector<IoRequest> requests;
+        for (const auto& c : candidates)
+        {
+            if (inFlight >= mDesc.maxRequestsInFlight) break;
+            StreamedMesh& mesh = mMeshes[c.second];
+
+            IoRequest request;
+            request.meshId = c.second;
+            request.pageFile = mesh.pageFile;
+            request.vbSizes = mesh.vbSizes;
+            request.ibSize = uint64_t(mesh.indexCount) * sizeof(uint32_t);
+            request.issueTime = CpuTimer::getCurrentTimePoint();
+            requests.push_back(std::move(request));
+            mesh.inFlight = true;
+            inFlight++;
+        }
+        mStats.pendingRequests = inFlight;
+
+        if (requests.size())
+        {
+            {
+                std::lock_guard<std::mutex> lock(mIoMutex);
+                for (auto& r : requests) mPendingRequests.push_back(std::move(r));
+            }
+            mIoCondition.notify_one();
+        }
+
+        mFrameCount++;
+        return mChangedMeshes.size() > 0;
+    }
+
+    void GeometryStreamer::ioThreadFunc()
+    {
+        while (true)
+        {
+            IoRequest request;
+            {
+                std::unique_lock<std::mutex> lock(mIoMutex);
+                mIoCondition.wait(lock, [this] { return mTerminate || mPendingRequests.size(); });
+                if (mTerminate) return;
+                request = std::move(mPendingRequests.front());
+                mPendingRequests.pop_front();
+            }
+
+            IoResult result;
+            std::ifstream stream(request.pageFile, std::ios::binary);
+            PageHeader header = {};
+            result.success = stream.is_open() && stream.read((char*)&header, sizeof(header)).good();
+            result.success = result.success && header.magic == kPageMagic && header.version == kPageVersion && header.vertexBufferCount == request.vbSizes.size();
+            result.success = result.success && stream.seekg(sizeof(header) + request.vbSizes.size() * sizeof(uint64_t)).good();
+
+            result.vbData.resize(request.vbSizes.size());
+            for (size_t i = 0; i < request.vbSizes.size() && result.success; i++)
+            {
+                result.vbData[i].resize(request.vbSizes[i]);
+                result.success = stream.read((char*)result.vbData[i].data(), request.vbSizes[i]).good();
+            }
+            if (result.success)
+            {
+                result.ibData.resize(request.ibSize);
+                result.success = stream.read((char*)result.ibData.data(), request.ibSize).good();
+            }
+            result.request = std::move(request);
+
+            std::lock_guard<std::mutex> lock(mIoMutex);
+            mCompletedRequests.push_back(std::move(result));
+        }
+    }
+
+    void GeometryStreamer::renderUI(Gui* pGui, const char* uiGroup)
+    {
+        if (uiGroup == nullptr || pGui->beginGroup(uiGroup))
+        {
+            const double MB = 1024.0 * 1024.0;
+            std::string s = "Clusters resident: " + std::to_string(mStats.residentClusters) + "/" + std::to_string(mStats.clusterCount) + "\n";
+            s += "Resident: " + std::to_string(mStats.residentBytes / MB) + " MB / " + std::to_string(mDesc.memoryBudget / MB) + " MB\n";
+            s += "Peak resident: " + std::to_string(mStats.peakResidentBytes / MB) + " MB\n";
+            s += "Proxies: " + std::to_string(mStats.proxyBytes / MB) + " MB\n";
+            s += "Pending requests: " + std::to_string(mStats.pendingRequests) + "\n";
+            s += "Pages in/evicted: " + std::to_string(mStats.pagesIn) + "/" + std::to_string(mStats.pagesEvicted) + "\n";
+            s += "Latency avg/max: " + std::to_string(mStats.avgLatencyMs) + "/" + std::to_string(mStats.maxLatencyMs) + " ms";
+            pGui->addText(s.c_str());
+
+            int32_t budgetMB = int32_t(mDesc.memoryBudget / (1024 * 1024));
+            if (pGui->addIntVar("Budget (MB)", budgetMB, 16))
+            {
+                mDesc.memoryBudget = uint64_t(budgetMB) * 1024 * 1024;
+            }
+
+            if (uiGroup) pGui->endGroup();
+        }
+    }
+}
@@ -0,0 +1,210 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "API/VAO.h"
+#include "API/VertexLayout.h"
+#include "Utils/AABB.h"
+#include "Utils/CpuTimer.h"
+
+namespace Falcor
+{
+    class Mesh;
+    class Material;
+    class Scene;
+    class Camera;
+    class Gui;
+
+    /** Pages mesh geometry in and out of GPU memory.
+        When a model is loaded with Model::LoadFlags::StreamGeometry, its meshes are split into clusters of at most Desc::clusterTriangleCount triangles.
+        The full-resolution geometry of each cluster is cooked once into a page file, and the cluster's mesh is created with a small proxy built by simplifying the cluster.
+        updateResidency() requests the pages of clusters which are visible or close to the camera, where secondary rays are likely to hit. Pages are read on a background I/O thread and swapped into their mesh in update().
+        Resident geometry is kept under Desc::memoryBudget by reverting the least-recently-used clusters to their proxies.
+    */
+    class GeometryStreamer
+    {
+    public:
+        using SharedPtr = std::shared_ptr<GeometryStreamer>;
+        using SharedConstPtr = std::shared_ptr<const GeometryStreamer>;
+
+        struct Desc
+        {
+            uint64_t memoryBudget = 512ull * 1024ull * 1024ull;     ///< Maximum number of bytes of resident full-resolution geometry
+            uint32_t clusterTriangleCount = 32768;                  ///< Meshes are split into clusters of at most this many triangles. A cluster is paged in and out as a unit.
+            uint32_t proxyTriangleCount = 256;                      ///< Target triangle count of the proxy used while a cluster isn't resident
+            float nearbyRadiusScale = 0.1f;                         ///< Clusters closer to the camera than this fraction of the scene radius are requested even when they are outside the view frustum
+            uint32_t maxRequestsInFlight = 8;                       ///< Maximum number of pages being read at the same time
+            std::string cacheDirectory;                             ///< Where page files are stored. If empty, uses '<executable directory>/GeometryCache'
+        };
+
+        struct Stats
+        {
+            uint32_t clusterCount = 0;          ///< Number of streamed clusters
+            uint32_t residentClusters = 0;      ///< Number of clusters with their full-resolution geometry resident
+            uint64_t residentBytes = 0;         ///< Bytes of full-resolution geometry currently resident
+            uint64_t peakResidentBytes = 0;     ///< Largest value residentBytes reached
+            uint64_t proxyBytes = 0;            ///< Bytes used by the always-resident proxies
+            uint32_t pendingRequests = 0;       ///< Number of pages being read
+            uint32_t pagesIn = 0;               ///< Total number of pages made resident
+            uint32_t pagesEvicted = 0;          ///< Total number of pages evicted
+            double avgLatencyMs = 0;            ///< Average time between issuing a request and the page being resident
+            double maxLatencyMs = 0;            ///< Longest request latency
+        };
+
+        /** Create a new streamer
+        */
+        static SharedPtr create(const Desc& desc = Desc());
+
+        /** Get the streamer used by the model importers when Model::LoadFlags::StreamGeometry is set
+            \param[in] createIfMissing Create a streamer with the default settings if none exists
+        */
+        static const SharedPtr& getGlobalStreamer(bool createIfMissing = true);
+
+        /** Set the streamer used by the model importers. Pass nullptr to release it.
+        */
+        static void setGlobalStreamer(const SharedPtr& pStreamer);
+
+        ~GeometryStreamer();
+
+        /** Get the streamer's settings
+        */
+        const Desc& getDesc() const { return mDesc; }
+
+        /** Create a streamed mesh. The geometry is cooked into a page file, and the mesh is created with the cluster's proxy.
+            \param[in] pLayout The vertex layout. Positions must be stored as RGB32Float.
+            \param[in] vertexData The contents of each of the layout's vertex buffers
+            \param[in] vertexCount Number of vertices
+            \param[in] indices Triangle-list indices
+            \param[in] shaderResource Create the buffers with the shader-resource bind flag
+            \param[in] pMaterial The mesh's material
+            \param[in] boundingBox The mesh's bounding-box
+            \return The mesh, or nullptr if the geometry can't be streamed, for example because it's already smaller than its proxy would be. In that case, create a regular mesh.
+        */
+        std::shared_ptr<Mesh> createMesh(const VertexLayout::SharedPtr& pLayout, const std::vector<std::vector<uint8_t>>& vertexData, uint32_t vertexCount, const std::vector<uint32_t>& indices,
+            bool shaderResource, const std::shared_ptr<Material>& pMaterial, const BoundingBox& boundingBox);
+
+        /** Mark a mesh as used in the current frame, for example because rays hit it. Requests for meshes which are not streamed are ignored.
+            \param[in] pMesh The mesh
+            \param[in] priority Requests with a higher priority are issued first
+        */
+        void touchMesh(const Mesh* pMesh, float priority = 0);
+
+        /** Request the clusters which are visible from the camera or close to it. The priority of visible clusters is their projected size.
+            \param[in] pScene The scene
+            \param[in] pCamera The camera used for rendering
+            \param[in] viewportHeight Height of the render target in pixels
+        */
+        void updateResidency(Scene* pScene, const Camera* pCamera, uint32_t viewportHeight);
+
+        /** Issue I/O requests for this frame's requests, swap completed pages into their meshes and evict pages if over budget. Call once per frame.
+            \return Whether the geometry of any mesh changed. Acceleration structures built for those meshes must be rebuilt, see getChangedMeshes().
+        */
+        bool update();
+
+        /** Get the meshes whose geometry changed in the last call to update()
+        */
+        const std::vector<const Mesh*>& getChangedMeshes() const { return mChangedMeshes; }
+
+        /** Get streaming statistics
+        */
+        const Stats& getStats() const { return mStats; }
+
+        /** Render the streamer's UI
+        */
+        void renderUI(Gui* pGui, const char* uiGroup = nullptr);
+
+    private:
+        GeometryStreamer(const Desc& desc);
+
+        struct StreamedMesh
+        {
+            std::weak_ptr<Mesh> pMesh;                      ///< Meshes are owned by their models
+            const Mesh* pKey = nullptr;
+            std::string pageFile;
+            VertexLayout::SharedPtr pLayout;
+            bool shaderResource = false;
+            uint32_t vertexCount = 0;
+            uint32_t indexCount = 0;
+            std::vector<uint64_t> vbSizes;
+            Vao::SharedPtr pProxyVao;
+            uint32_t proxyVertexCount = 0;
+            uint32_t proxyIndexCount = 0;
+            uint64_t proxyBytes = 0;
+            bool resident = false;
+            bool inFlight = false;
+            float priority = -1;                            ///< Highest priority requested since the last update(). Negative if not requested.
+            uint64_t lastUsedFrame = 0;
+        };
+
+        struct IoRequest
+        {
+            uint32_t meshId;
+            std::string pageFile;
+            std::vector<uint64_t> vbSizes;
+            uint64_t ibSize;
+            CpuTimer::TimePoint issueTime;
+        };
+
+        struct IoResult
+        {
+            IoRequest request;
+            std::vector<std::vector<uint8_t>> vbData;
+            std::vector<uint8_t> ibData;
+            bool success = false;
+        };
+
+        static uint64_t getPageSize(const StreamedMesh& mesh);
+        bool cookPage(const std::string& pageFile, const std::vector<std::vector<uint8_t>>& vertexData, uint32_t vertexCount, const std::vector<uint32_t>& indices);
+        void makeResident(uint32_t meshId, const IoResult& result);
+        void makeProxy(uint32_t meshId);
+        bool evict(uint64_t requiredBytes);
+        void ioThreadFunc();
+
+        Desc mDesc;
+        Stats mStats;
+        uint64_t mFrameCount = 0;
+        double mTotalLatencyMs = 0;
+
+        std::vector<StreamedMesh> mMeshes;
+        std::unordered_map<const Mesh*, uint32_t> mMeshToId;
+        std::vector<const Mesh*> mChangedMeshes;
+
+        std::thread mIoThread;
+        std::mutex mIoMutex;
+        std::condition_variable mIoCondition;
+        std::deque<IoRequest> mPendingRequests;
+        std::vector<IoResult> mCompletedRequests;
+        bool mTerminate = false;
+    };
+}
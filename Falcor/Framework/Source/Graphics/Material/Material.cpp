@@ -273,6 +273,41 @@ namespace Falcor
         if (mData.resources.samplerState != other.mData.resources.samplerState) return false;
         return true;
     }
+
+    size_t Material::getHash() const
+    {
+        size_t hash = 0;
+        auto combine = [&hash](const void* pData, size_t size)
+        {
+            const uint8_t* pBytes = (const uint8_t*)pData;
+            for (size_t i = 0; i < size; i++)
+            {
+                hash ^= std::hash<uint8_t>()(pBytes[i]) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+            }
+        };
+
+#define hash_field(_a) combine(&mData._a, sizeof(mData._a))
+        hash_field(baseColor);
+        hash_field(specular);
+        hash_field(emissive);
+        hash_field(alphaThreshold);
+        hash_field(IoR);
+        hash_field(flags);
+        hash_field(heightScaleOffset);
+#undef hash_field
+
+#define hash_resource(_a) { const void* p = mData.resources._a.get(); combine(&p, sizeof(p)); }
+        hash_resource(baseColor);
+        hash_resource(specular);
+        hash_resource(emissive);
+        hash_resource(normalMap);
+        hash_resource(occlusionMap);
+        hash_resource(lightMap);
+        hash_resource(heightMap);
+        hash_resource(samplerState);
+#undef hash_resource
+        return hash;
+    }
     
     #if _LOG_ENABLED
 #define check_offset(_a) assert(pCB->getVariableOffset(std::string(varName) + #_a) == (offsetof(MaterialData, _a) + offset))
@@ -246,6 +246,10 @@ namespace Falcor
         */
         bool operator==(const Material& other) const;
 
+        /** Get a hash of the fields compared by operator==. Equal materials have equal hashes.
+        */
+        size_t getHash() const;
+
         /** Bind a sampler to the material
         */
         void setSampler(Sampler::SharedPtr pSampler);
@@ -30,6 +30,8 @@
 #include "AnimationController.h"
 #include "glm/gtc/matrix_transform.hpp"
 #include "glm/gtx/transform.hpp"
+#include "glm/gtc/constants.hpp"
+#include <algorithm>
 
 namespace Falcor
 {
@@ -55,70 +57,102 @@ namespace Falcor
 
     Animation::~Animation() = default;
 
-    template<typename T>
-    uint32_t findCurrentFrame(T channel, float ticks)
+    /** Find the last key at or before a time, or the first key if the time is before it.
+        During playback, the time usually stays within the same key or moves to the next one, so those are checked before doing a binary search.
+    */
+    static uint32_t findKey(const std::vector<float>& times, float ticks, uint32_t hint)
     {
-        uint32_t curKeyID = channel.lastKeyUsed;
-        while(curKeyID < channel.keys.size() - 1)
+        uint32_t count = (uint32_t)times.size();
+        if (hint < count && times[hint] <= ticks)
         {
-            if(channel.keys[curKeyID + 1].time > ticks)
-            {
-                break;
-            }
-            curKeyID++;
+            if (hint + 1 == count || times[hint + 1] > ticks) return hint;
+            if (hint + 2 == count || times[hint + 2] > ticks) return hint + 1;
         }
-        return curKeyID;
+
+        auto it = std::upper_bound(times.begin(), times.end(), ticks);
+        return (it == times.begin()) ? 0 : uint32_t(it - times.begin() - 1);
     }
 
-    glm::vec3 interpolate(const glm::vec3& start, const glm::vec3& end, float ratio)
+    void Animation::slerpBatch(RotationBatch& batch, uint32_t count)
     {
-        return start + ((end - start) * ratio);
+        float* pX0 = batch.startX.data();
+        float* pY0 = batch.startY.data();
+        float* pZ0 = batch.startZ.data();
+        float* pW0 = batch.startW.data();
+        const float* pX1 = batch.endX.data();
+        const float* pY1 = batch.endY.data();
+        const float* pZ1 = batch.endZ.data();
+        const float* pW1 = batch.endW.data();
+        const float* pRatio = batch.ratio.data();
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            float cosTheta = pX0[i] * pX1[i] + pY0[i] * pY1[i] + pZ0[i] * pZ1[i] + pW0[i] * pW1[i];
+
+            // Take the shortest path
+            float sign = (cosTheta < 0) ? -1.0f : 1.0f;
+            cosTheta *= sign;
+
+            // When the rotations are close, sin(theta) is too small to divide by and we interpolate linearly, like glm::slerp()
+            float theta = std::acos(std::min(cosTheta, 1.0f));
+            float sinTheta = std::max(std::sin(theta), 1e-6f);
+            bool useLerp = cosTheta > 1.0f - glm::epsilon<float>();
+            float t = pRatio[i];
+            float slerpStart = std::sin((1.0f - t) * theta) / sinTheta;
+            float slerpEnd = std::sin(t * theta) / sinTheta;
+            float startWeight = useLerp ? (1.0f - t) : slerpStart;
+            float endWeight = (useLerp ? t : slerpEnd) * sign;
+
+            pX0[i] = pX0[i] * startWeight + pX1[i] * endWeight;
+            pY0[i] = pY0[i] * startWeight + pY1[i] * endWeight;
+            pZ0[i] = pZ0[i] * startWeight + pZ1[i] * endWeight;
+            pW0[i] = pW0[i] * startWeight + pW1[i] * endWeight;
+        }
     }
 
-    glm::quat interpolate(const glm::quat& start, const glm::quat& end, float ratio)
+    void Animation::RotationBatch::resize(size_t size)
     {
-        return glm::slerp(start, end, ratio);
+        for (auto pArray : { &startX, &startY, &startZ, &startW, &endX, &endY, &endZ, &endW, &ratio })
+        {
+            pArray->resize(size);
+        }
     }
 
     template<typename KeyType>
-    KeyType Animation::calcCurrentKey(AnimationChannel<KeyType>& channel, float ticks, float lastUpdateTime)
+    Animation::KeyInterval Animation::findKeys(AnimationChannel<KeyType>& channel, float ticks) const
     {
-        KeyType curValue;
-        if(channel.keys.size() > 0)
-        {
-            if(ticks < lastUpdateTime)
-            {
-                channel.lastKeyUsed = 0;
-            }
+        const std::vector<float>& times = channel.times;
+        assert(times.size() > 0 && times.size() == channel.values.size());
 
-            // search for the next keyframe
-            uint32_t curKeyIndex = findCurrentFrame(channel, ticks);
-            uint32_t nextKeyIndex = (curKeyIndex + 1) % channel.keys.size();
-            const AnimationKey<KeyType>& curKey = channel.keys[curKeyIndex];
-            const AnimationKey<KeyType>& nextKey = channel.keys[nextKeyIndex];
+        KeyInterval interval;
+        interval.first = findKey(times, ticks, channel.lastKeyUsed);
+        interval.second = (interval.first + 1) % times.size();
+        interval.ratio = 0;
+        channel.lastKeyUsed = interval.first;
 
-            assert(ticks >= curKey.time);
-            // Interpolate between them
-            float diff = nextKey.time - curKey.time;
-
-            if (diff == 0)
+        float diff = times[interval.second] - times[interval.first];
+        if (diff != 0)
+        {
+            // Interpolating from the last key back to the first one
+            if (diff < 0)
             {
-                curValue = curKey.value;
+                diff += mDuration;
             }
-            else
-            {
-                if (diff < 0)
-                {
-                    diff += mDuration;
-                }
 
-                float ratio = (ticks - curKey.time) / diff;
-                curValue = interpolate(curKey.value, nextKey.value, ratio);
-            }
-            
-            channel.lastKeyUsed = curKeyIndex;
+            // Times before the first key use its value
+            interval.ratio = glm::clamp((ticks - times[interval.first]) / diff, 0.0f, 1.0f);
         }
-        return curValue;
+        return interval;
+    }
+
+    glm::vec3 Animation::calcCurrentKey(AnimationChannel<glm::vec3>& channel, float ticks) const
+    {
+        if (channel.getKeyCount() == 0) return glm::vec3(0);
+
+        KeyInterval interval = findKeys(channel, ticks);
+        const glm::vec3& start = channel.values[interval.first];
+        const glm::vec3& end = channel.values[interval.second];
+        return start + ((end - start) * interval.ratio);
     }
 
     void Animation::animate(double totalTime, AnimationController* pAnimationController)
@@ -126,24 +160,53 @@ namespace Falcor
         // Calculate the relative time
         float ticks = (float)fmod(totalTime * mTicksPerSecond, mDuration);
 
-        for(auto& Key : mAnimationSets)
+        // Gather the rotation keys of all the bones and interpolate them together
+        uint32_t setCount = (uint32_t)mAnimationSets.size();
+        RotationBatch& batch = mRotationBatch;
+        batch.resize(setCount);
+        for (uint32_t i = 0; i < setCount; i++)
+        {
+            auto& channel = mAnimationSets[i].rotation;
+            glm::quat start(1, 0, 0, 0);
+            glm::quat end(1, 0, 0, 0);
+            float ratio = 0;
+            if (channel.getKeyCount() > 0)
+            {
+                KeyInterval interval = findKeys(channel, ticks);
+                start = channel.values[interval.first];
+                end = channel.values[interval.second];
+                ratio = interval.ratio;
+            }
+
+            batch.startX[i] = start.x;
+            batch.startY[i] = start.y;
+            batch.startZ[i] = start.z;
+            batch.startW[i] = start.w;
+            batch.endX[i] = end.x;
+            batch.endY[i] = end.y;
+            batch.endZ[i] = end.z;
+            batch.endW[i] = end.w;
+            batch.ratio[i] = ratio;
+        }
+        slerpBatch(batch, setCount);
+
+        for (uint32_t i = 0; i < setCount; i++)
         {
+            auto& Key = mAnimationSets[i];
             glm::mat4 translation;
-            translation[3] = glm::vec4(calcCurrentKey(Key.translation, ticks, Key.lastUpdateTime), 1);
+            translation[3] = glm::vec4(calcCurrentKey(Key.translation, ticks), 1);
 
             glm::mat4 scaling;
-            if (Key.scaling.keys.size() > 0)
+            if (Key.scaling.getKeyCount() > 0)
             {
-                scaling = glm::scale(calcCurrentKey(Key.scaling, ticks, Key.lastUpdateTime));
+                scaling = glm::scale(calcCurrentKey(Key.scaling, ticks));
             }
 
-            glm::quat q = calcCurrentKey(Key.rotation, ticks, Key.lastUpdateTime);
+            glm::quat q(batch.startW[i], batch.startX[i], batch.startY[i], batch.startZ[i]);
             glm::mat4 rotation = glm::mat4_cast(q);
 
-            Key.lastUpdateTime = ticks;
-
             glm::mat4 T = translation * rotation * scaling;
             pAnimationController->setBoneLocalTransform(Key.boneID, T);
         }
     }
-}
+}
\ No newline at end of file
@@ -40,18 +40,17 @@ namespace Falcor
         using UniquePtr = std::unique_ptr<Animation>;
         using UniqueConstPtr = std::unique_ptr<const Animation>;
 
-        template<typename T>
-        struct AnimationKey
-        {
-            T value;
-            float time;
-        };
-
+        /** The keys of a channel. Times and values are stored in separate arrays, so that searching for a key only touches the times.
+        */
         template<typename T>
         struct AnimationChannel
         {
-            std::vector<AnimationKey<T>> keys;
-            uint32_t lastKeyUsed = 0;
+            std::vector<float> times;   ///< Key times, in ticks, in increasing order
+            std::vector<T> values;
+            uint32_t lastKeyUsed = 0;   ///< The key found by the previous search, checked before searching again
+
+            void addKey(const T& value, float time) { values.push_back(value); times.push_back(time); }
+            size_t getKeyCount() const { return times.size(); }
         };
 
         struct AnimationSet
@@ -60,7 +59,6 @@ namespace Falcor
             AnimationChannel<glm::vec3> translation;
             AnimationChannel<glm::vec3> scaling;
             AnimationChannel<glm::quat> rotation;
-            float lastUpdateTime = 0;
         };
 
         static UniquePtr create(const std::string& name, const std::vector<AnimationSet>& animationSets, float duration, float ticksPerSecond);
@@ -79,7 +77,33 @@ namespace Falcor
 
         std::vector<AnimationSet> mAnimationSets;
 
+        /** The two keys to interpolate between at some time
+        */
+        struct KeyInterval
+        {
+            uint32_t first;
+            uint32_t second;
+            float ratio;
+        };
+
+        /** The rotation keys of all the animation sets, one component per array, so that they can be interpolated together
+        */
+        struct RotationBatch
+        {
+            std::vector<float> startX, startY, startZ, startW;
+            std::vector<float> endX, endY, endZ, endW;
+            std::vector<float> ratio;
+            void resize(size_t size);
+        };
+        RotationBatch mRotationBatch;
+
+        /** Interpolate the rotations of a batch, writing the results to the start arrays.
+            Both weights are always computed and then selected, so the loop body has no branches. Whether the compiler vectorizes it depends on it having vector versions of acos() and sin(); if it doesn't, the loop still reads contiguous arrays.
+        */
+        static void slerpBatch(RotationBatch& batch, uint32_t count);
+
         template<typename _KeyType>
-        _KeyType calcCurrentKey(AnimationChannel<_KeyType>& channel, float ticks, float lastUpdateTime);
+        KeyInterval findKeys(AnimationChannel<_KeyType>& channel, float ticks) const;
+        glm::vec3 calcCurrentKey(AnimationChannel<glm::vec3>& channel, float ticks) const;
     };
 }
\ No newline at end of file
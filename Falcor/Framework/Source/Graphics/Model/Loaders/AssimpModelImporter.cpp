@@ -28,6 +28,7 @@
 #include "assimp/Importer.hpp"
 #include "assimp/postprocess.h"
 #include "assimp/scene.h"
+#include "assimp/cexport.h"
 
 #include "Framework.h"
 #include "AssimpModelImporter.h"
@@ -35,14 +36,22 @@
 #include "Graphics/Model/Animation.h"
 #include "Graphics/Model/Mesh.h"
 #include "Graphics/Model/AnimationController.h"
+#include "Graphics/Model/MeshSimplifier.h"
+#include "Graphics/Model/TangentGenerator.h"
 #include "API/Texture.h"
 #include "API/Buffer.h"
 #include "Utils/Platform/OS.h"
+#include "Graphics/TextureStreamer.h"
+#include "Graphics/GeometryStreamer.h"
+#include "Graphics/AssetRegistry.h"
 #include "Graphics/TextureHelper.h"
 #include "API/VertexLayout.h"
 #include "Data/VertexAttrib.h"
 #include "Utils/StringUtils.h"
 #include "API/Device.h"
+#include <condition_variable>
+#include <mutex>
+#include <unordered_map>
 
 namespace Falcor
 {
@@ -56,17 +65,6 @@ namespace Falcor
 
     using VertexIdsVec = std::vector<uvec8_4>;
 
-    template<typename posType>
-    void generateSubmeshTangentData(
-        const std::vector<uint32_t>& indices,
-        uint32_t vertexCount,
-        const posType* vertexPosData,
-        const glm::vec3* vertexNormalData,
-        const glm::vec2* texCrdData,
-        uint32_t texCrdCount,
-        glm::vec3* bitangentData);
-
-
     void loadBones(const aiMesh* pAiMesh, VertexWeightsVec& weights, VertexIdsVec& ids, uint32_t vertexCount, const std::map<std::string, uint32_t>& boneNameToIdMap)
     {
         if (pAiMesh->mNumBones > 0xff)
@@ -171,7 +169,14 @@ namespace Falcor
                 }
             }
 
-            generateSubmeshTangentData<glm::vec3>(indices, pAiMesh->mNumVertices, pPos, pNormals, (texCrdCount > 0 ? texCrd.data() : nullptr), texCrdCount, pBi);
+            TangentGenerator::MeshData meshData;
+            meshData.pIndices = indices.data();
+            meshData.indexCount = indices.size();
+            meshData.vertexCount = pAiMesh->mNumVertices;
+            meshData.pPositions = &pPos->x;
+            meshData.pNormals = pNormals;
+            meshData.pTexCrd = (texCrdCount > 0 ? texCrd.data() : nullptr);
+            TangentGenerator::generateBitangents(meshData, pBi);
         }
     }
 
@@ -307,7 +312,31 @@ namespace Falcor
                     // create a new texture
                     std::string fullpath = folder + '/' + s;
                     fullpath = replaceSubstring(fullpath, "\\", "/");
-                    pTex = createTextureFromFile(fullpath, true, isSrgbRequired(aiType, useSrgb, pMaterial->getShadingModel()));
+                    bool loadAsSrgb = isSrgbRequired(aiType, useSrgb, pMaterial->getShadingModel());
+
+                    // Other models in the scene might have loaded a file with the same content
+                    const AssetRegistry::SharedPtr& pRegistry = AssetRegistry::getActive();
+                    if (pRegistry)
+                    {
+                        pTex = pRegistry->findTexture(fullpath, loadAsSrgb);
+                    }
+
+                    if (pTex == nullptr)
+                    {
+                        if (is_set(mFlags, Model::LoadFlags::StreamTextures))
+                        {
+                            pTex = TextureStreamer::getGlobalStreamer()->loadTexture(fullpath, loadAsSrgb);
+                        }
+                        else
+                        {
+                            pTex = createTextureFromFile(fullpath, true, loadAsSrgb);
+                        }
+
+                        if (pRegistry)
+                        {
+                            pRegistry->addTexture(fullpath, loadAsSrgb, pTex);
+                        }
+                    }
                     if (pTex)
                     {
                         mTextureCache[s] = pTex;
@@ -450,12 +479,149 @@ namespace Falcor
                 // Material already exists
                 pMaterial = pAdded;
             }
+            else
+            {
+                // Share equivalent materials with the other models in the scene
+                const AssetRegistry::SharedPtr& pRegistry = AssetRegistry::getActive();
+                Material::SharedPtr pShared = pRegistry ? pRegistry->findOrAddMaterial(pMaterial) : pMaterial;
+                if (pShared != pMaterial)
+                {
+                    mLoadedMaterials.back() = pShared;
+                    pMaterial = pShared;
+                }
+                else if (is_set(mFlags, Model::LoadFlags::StreamTextures))
+                {
+                    TextureStreamer::getGlobalStreamer()->registerMaterial(pMaterial);
+                }
+            }
             mAiMaterialToFalcor[i] = pMaterial;
         }
 
         return true;
     }
 
+    static vec3 aiVecToGLM(const aiVector3D& v)
+    {
+        return vec3(v.x, v.y, v.z);
+    }
+
+    /** Hash the parts of a mesh which don't change under a rigid transform - topology, texture coordinates, material and the spread of the vertices around their centroid
+    */
+    static uint64_t getRigidInvariantHash(const aiMesh* pAiMesh)
+    {
+        uint64_t hash = kFnv1aOffsetBasis;
+        hash = hashBytes(hash, &pAiMesh->mNumVertices, sizeof(pAiMesh->mNumVertices));
+        hash = hashBytes(hash, &pAiMesh->mNumFaces, sizeof(pAiMesh->mNumFaces));
+        hash = hashBytes(hash, &pAiMesh->mMaterialIndex, sizeof(pAiMesh->mMaterialIndex));
+        for (uint32_t i = 0; i < pAiMesh->mNumFaces; i++)
+        {
+            hash = hashBytes(hash, pAiMesh->mFaces[i].mIndices, pAiMesh->mFaces[i].mNumIndices * sizeof(uint32_t));
+        }
+        for (uint32_t c = 0; c < AI_MAX_NUMBER_OF_TEXTURECOORDS && pAiMesh->HasTextureCoords(c); c++)
+        {
+            hash = hashBytes(hash, pAiMesh->mTextureCoords[c], pAiMesh->mNumVertices * sizeof(aiVector3D));
+        }
+
+        // A mesh without vertices has no centroid. The vertex count is already hashed, so it only matches other empty meshes
+        if (pAiMesh->mNumVertices == 0) return hash;
+
+        vec3 centroid(0);
+        for (uint32_t i = 0; i < pAiMesh->mNumVertices; i++) centroid += aiVecToGLM(pAiMesh->mVertices[i]);
+        centroid /= float(pAiMesh->mNumVertices);
+        double sum = 0;
+        for (uint32_t i = 0; i < pAiMesh->mNumVertices; i++)
+        {
+            vec3 d = aiVecToGLM(pAiMesh->mVertices[i]) - centroid;
+            sum += glm::dot(d, d);
+        }
+        int32_t spread = (sum > 0) ? int32_t(std::floor(std::log2(sum / pAiMesh->mNumVertices) * 256.0 + 0.5)) : INT32_MIN;
+        return hashBytes(hash, &spread, sizeof(spread));
+    }
+
+    /** Find the rigid transform which maps the vertices of pSrc onto the vertices of pDst. Both meshes must have the same vertex count.
+        \return Whether such a transform exists
+    */
+    static bool findRigidTransform(const aiMesh* pSrc, const aiMesh* pDst, glm::mat4& transform)
+    {
+        const uint32_t count = pSrc->mNumVertices;
+        if (count == 0) return false;
+
+        vec3 srcCenter(0), dstCenter(0);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            srcCenter += aiVecToGLM(pSrc->mVertices[i]);
+            dstCenter += aiVecToGLM(pDst->mVertices[i]);
+        }
+        srcCenter /= float(count);
+        dstCenter /= float(count);
+
+        // Pick two reference vertices which span a plane - the one farthest from the centroid, and the one farthest from the line through it
+        uint32_t i0 = 0, i1 = 0;
+        float maxDist = 0, maxArea = 0;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            vec3 v = aiVecToGLM(pSrc->mVertices[i]) - srcCenter;
+            float d = glm::dot(v, v);
+            if (d > maxDist) { maxDist = d; i0 = i; }
+        }
+        vec3 a0 = aiVecToGLM(pSrc->mVertices[i0]) - srcCenter;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            vec3 c = glm::cross(a0, aiVecToGLM(pSrc->mVertices[i]) - srcCenter);
+            float area = glm::dot(c, c);
+            if (area > maxArea) { maxArea = area; i1 = i; }
+        }
+        if (maxDist == 0 || maxArea <= 1e-12f * maxDist * maxDist) return false;
+
+        auto createFrame = [](const vec3& u, const vec3& v)
+        {
+            vec3 x = glm::normalize(u);
+            vec3 z = glm::normalize(glm::cross(u, v));
+            return mat3(x, glm::cross(z, x), z);
+        };
+        mat3 srcFrame = createFrame(a0, aiVecToGLM(pSrc->mVertices[i1]) - srcCenter);
+        mat3 dstFrame = createFrame(aiVecToGLM(pDst->mVertices[i0]) - dstCenter, aiVecToGLM(pDst->mVertices[i1]) - dstCenter);
+        mat3 rotation = dstFrame * glm::transpose(srcFrame);
+        vec3 translation = dstCenter - rotation * srcCenter;
+
+        // Validate all the vertices. This also rejects mirrored and scaled copies
+        float tolerance = 1e-4f * std::sqrt(maxDist);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            vec3 p = rotation * aiVecToGLM(pSrc->mVertices[i]) + translation;
+            if (glm::length(p - aiVecToGLM(pDst->mVertices[i])) > tolerance) return false;
+        }
+
+        if (pSrc->HasNormals() != pDst->HasNormals()) return false;
+        for (uint32_t i = 0; pSrc->HasNormals() && i < count; i++)
+        {
+            if (glm::dot(rotation * aiVecToGLM(pSrc->mNormals[i]), aiVecToGLM(pDst->mNormals[i])) < 0.999f) return false;
+        }
+
+        for (uint32_t c = 0; c < AI_MAX_NUMBER_OF_VERTEX_COLORS; c++)
+        {
+            if (pSrc->HasVertexColors(c) != pDst->HasVertexColors(c)) return false;
+            if (pSrc->HasVertexColors(c) && memcmp(pSrc->mColors[c], pDst->mColors[c], count * sizeof(aiColor4D)) != 0) return false;
+        }
+
+        transform = mat4(rotation);
+        transform[3] = vec4(translation, 1);
+        return true;
+    }
+
+    Mesh::SharedPtr AssimpModelImporter::findInstancedMesh(const aiMesh* pAiMesh, glm::mat4& meshToInstance)
+    {
+        uint64_t hash = getRigidInvariantHash(pAiMesh);
+        auto range = mGeometryCandidates.equal_range(hash);
+        for (auto it = range.first; it != range.second; it++)
+        {
+            const aiMesh* pCandidate = it->second.first;
+            if (pCandidate->mNumVertices != pAiMesh->mNumVertices || pCandidate->mNumFaces != pAiMesh->mNumFaces || pCandidate->mMaterialIndex != pAiMesh->mMaterialIndex) continue;
+            if (findRigidTransform(pCandidate, pAiMesh, meshToInstance)) return it->second.second;
+        }
+        return nullptr;
+    }
+
     bool AssimpModelImporter::parseAiSceneNode(const aiNode* pCurrent, const aiScene* pScene, IdToMesh& aiToFalcorMesh)
     {
         if (pCurrent->mNumMeshes)
@@ -469,19 +635,48 @@ namespace Falcor
                 pParent = pParent->mParent;
             }
 
-            // Initialize the meshes
+            // Meshes which were split into clusters are replaced with their clusters
+            std::vector<uint32_t> aiIds;
             for (uint32_t i = 0; i < pCurrent->mNumMeshes; i++)
             {
-                uint32_t aiId = pCurrent->mMeshes[i];
+                auto clusters = mMeshToClusters.find(pCurrent->mMeshes[i]);
+                if (clusters == mMeshToClusters.end()) aiIds.push_back(pCurrent->mMeshes[i]);
+                else aiIds.insert(aiIds.end(), clusters->second.begin(), clusters->second.end());
+            }
+
+            // Initialize the meshes
+            for (uint32_t aiId : aiIds)
+            {
+                const aiMesh* pAiMesh = (aiId < pScene->mNumMeshes) ? pScene->mMeshes[aiId] : mClusterMeshes[aiId - pScene->mNumMeshes].get();
+                const bool detectInstancing = is_set(mFlags, Model::LoadFlags::DetectInstancing) && (pAiMesh->HasBones() == false);
 
                 // New mesh
                 if (aiToFalcorMesh.find(aiId) == aiToFalcorMesh.end())
                 {
+                    // Check if it's a copy of a mesh we already created
+                    glm::mat4 meshToInstance;
+                    Mesh::SharedPtr pMesh = detectInstancing ? findInstancedMesh(pAiMesh, meshToInstance) : nullptr;
+                    if (pMesh)
+                    {
+                        mAiMeshToInstanceTransform[aiId] = meshToInstance;
+                    }
+                    else
+                    {
+                        pMesh = createMesh(pAiMesh);
+                        if (detectInstancing) mGeometryCandidates.insert({ getRigidInvariantHash(pAiMesh), { pAiMesh, pMesh } });
+                    }
+
                     // Cache mesh
-                    aiToFalcorMesh[aiId] = createMesh(pScene->mMeshes[aiId]);
+                    aiToFalcorMesh[aiId] = pMesh;
                 }
 
-                mModel.addMeshInstance(aiToFalcorMesh[aiId], aiMatToGLM(transform));
+                glm::mat4 instanceTransform = aiMatToGLM(transform);
+                const auto& it = mAiMeshToInstanceTransform.find(aiId);
+                if (it != mAiMeshToInstanceTransform.end())
+                {
+                    instanceTransform = instanceTransform * it->second;
+                }
+                mModel.addMeshInstance(aiToFalcorMesh[aiId], instanceTransform);
             }
         }
 
@@ -502,38 +697,283 @@ namespace Falcor
         return parseAiSceneNode(pRoot, pScene, aiToFalcorMeshId);
     }
 
-    bool AssimpModelImporter::initModel(const std::string& filename)
+    // Recursively splits a range of faces at the median of their centroids along the longest axis, until each part has at most maxFaces faces
+    static void partitionFaces(const std::vector<vec3>& centroids, std::vector<uint32_t>& faces, size_t first, size_t last, uint32_t maxFaces, std::vector<std::pair<size_t, size_t>>& clusters)
     {
-        std::string fullpath;
-        if (findFileInDataDirectories(filename, fullpath) == false)
+        if (last - first <= maxFaces)
         {
-            logError(std::string("Can't find model file ") + filename, true);
-            return false;
+            clusters.push_back({ first, last });
+            return;
+        }
+
+        vec3 boxMin(FLT_MAX);
+        vec3 boxMax(-FLT_MAX);
+        for (size_t i = first; i < last; i++)
+        {
+            boxMin = glm::min(boxMin, centroids[faces[i]]);
+            boxMax = glm::max(boxMax, centroids[faces[i]]);
+        }
+        vec3 extent = boxMax - boxMin;
+        int axis = (extent.x >= extent.y && extent.x >= extent.z) ? 0 : ((extent.y >= extent.z) ? 1 : 2);
+
+        size_t mid = first + (last - first) / 2;
+        std::nth_element(faces.begin() + first, faces.begin() + mid, faces.begin() + last, [&centroids, axis](uint32_t a, uint32_t b) { return centroids[a][axis] < centroids[b][axis]; });
+        partitionFaces(centroids, faces, first, mid, maxFaces, clusters);
+        partitionFaces(centroids, faces, mid, last, maxFaces, clusters);
+    }
+
+    template<typename T>
+    static T* copyVertexAttribute(const T* pSrc, const std::vector<uint32_t>& vertices)
+    {
+        if (pSrc == nullptr) return nullptr;
+        T* pDst = new T[vertices.size()];
+        for (size_t i = 0; i < vertices.size(); i++)
+        {
+            pDst[i] = pSrc[vertices[i]];
+        }
+        return pDst;
+    }
+
+    static aiMesh* createClusterMesh(const aiMesh* pSrc, const uint32_t* pFaces, size_t faceCount, size_t clusterId)
+    {
+        aiMesh* pMesh = new aiMesh;
+        pMesh->mName = aiString(std::string(pSrc->mName.C_Str()) + "_cluster" + std::to_string(clusterId));
+        pMesh->mMaterialIndex = pSrc->mMaterialIndex;
+        pMesh->mPrimitiveTypes = pSrc->mPrimitiveTypes;
+
+        // Copy the faces and remap their indices to the vertices used by the cluster
+        std::unordered_map<uint32_t, uint32_t> remap;
+        std::vector<uint32_t> vertices;
+        pMesh->mNumFaces = (uint32_t)faceCount;
+        pMesh->mFaces = new aiFace[faceCount];
+        for (size_t f = 0; f < faceCount; f++)
+        {
+            const aiFace& srcFace = pSrc->mFaces[pFaces[f]];
+            aiFace& dstFace = pMesh->mFaces[f];
+            dstFace.mNumIndices = srcFace.mNumIndices;
+            dstFace.mIndices = new unsigned int[srcFace.mNumIndices];
+            for (uint32_t j = 0; j < srcFace.mNumIndices; j++)
+            {
+                auto it = remap.insert({ srcFace.mIndices[j], (uint32_t)vertices.size() });
+                if (it.second) vertices.push_back(srcFace.mIndices[j]);
+                dstFace.mIndices[j] = it.first->second;
+            }
+        }
+
+        pMesh->mNumVertices = (uint32_t)vertices.size();
+        pMesh->mVertices = copyVertexAttribute(pSrc->mVertices, vertices);
+        pMesh->mNormals = copyVertexAttribute(pSrc->mNormals, vertices);
+        pMesh->mTangents = copyVertexAttribute(pSrc->mTangents, vertices);
+        pMesh->mBitangents = copyVertexAttribute(pSrc->mBitangents, vertices);
+        for (uint32_t c = 0; c < AI_MAX_NUMBER_OF_COLOR_SETS; c++)
+        {
+            pMesh->mColors[c] = copyVertexAttribute(pSrc->mColors[c], vertices);
+        }
+        for (uint32_t t = 0; t < AI_MAX_NUMBER_OF_TEXTURECOORDS; t++)
+        {
+            pMesh->mTextureCoords[t] = copyVertexAttribute(pSrc->mTextureCoords[t], vertices);
+            pMesh->mNumUVComponents[t] = pSrc->mNumUVComponents[t];
+        }
+        return pMesh;
+    }
+
+    /** Split the static triangle meshes of a scene into spatially coherent clusters of at most maxTriangles triangles, which can be paged in and out individually.
+        The scene isn't modified, since it may be shared with other imports of the same file. The clusters are stored in mClusterMeshes, and parseAiSceneNode() uses them in place of the mesh they were split from.
+        \return The number of meshes which were split
+    */
+    uint32_t AssimpModelImporter::splitMeshesIntoClusters(const aiScene* pScene, uint32_t maxTriangles)
+    {
+        uint32_t splitCount = 0;
+        for (uint32_t m = 0; m < pScene->mNumMeshes; m++)
+        {
+            const aiMesh* pAiMesh = pScene->mMeshes[m];
+            if (pAiMesh->mNumFaces <= maxTriangles || pAiMesh->HasBones() || pAiMesh->mPrimitiveTypes != aiPrimitiveType_TRIANGLE) continue;
+
+            std::vector<vec3> centroids(pAiMesh->mNumFaces);
+            std::vector<uint32_t> faces(pAiMesh->mNumFaces);
+            for (uint32_t f = 0; f < pAiMesh->mNumFaces; f++)
+            {
+                const aiFace& face = pAiMesh->mFaces[f];
+                centroids[f] = (aiVecToGLM(pAiMesh->mVertices[face.mIndices[0]]) + aiVecToGLM(pAiMesh->mVertices[face.mIndices[1]]) + aiVecToGLM(pAiMesh->mVertices[face.mIndices[2]])) / 3.0f;
+                faces[f] = f;
+            }
+
+            std::vector<std::pair<size_t, size_t>> clusters;
+            partitionFaces(centroids, faces, 0, faces.size(), maxTriangles, clusters);
+            std::vector<uint32_t>& clusterIds = mMeshToClusters[m];
+            for (size_t c = 0; c < clusters.size(); c++)
+            {
+                clusterIds.push_back(pScene->mNumMeshes + (uint32_t)mClusterMeshes.size());
+                mClusterMeshes.emplace_back(createClusterMesh(pAiMesh, faces.data() + clusters[c].first, clusters[c].second - clusters[c].first, c));
+            }
+            splitCount++;
         }
+        return splitCount;
+    }
 
+    struct PrefetchedFile
+    {
+        std::unique_ptr<Assimp::Importer> pImporter;    ///< nullptr if parsing threw
+        const aiScene* pScene = nullptr;
+        uint32_t remainingUses = 1;
+        bool parsing = true;                            ///< Set until the parse finished, successfully or not
+        bool valid = false;                             ///< Whether the file was parsed and passed verifyScene()
+    };
+
+    // Guards sPrefetchedFiles and the fields of its entries. sPrefetchCondition is signaled whenever an entry finishes parsing.
+    static std::mutex sPrefetchMutex;
+    static std::condition_variable sPrefetchCondition;
+    static std::unordered_map<std::string, std::shared_ptr<PrefetchedFile>> sPrefetchedFiles;
+
+    static uint32_t getAssimpFlags(Model::LoadFlags flags)
+    {
         uint32_t assimpFlags = aiProcessPreset_TargetRealtime_MaxQuality |
             aiProcess_OptimizeGraph |
             aiProcess_FlipUVs |
             0;
 
-        if(is_set(mFlags, Model::LoadFlags::FindDegeneratePrimitives) == false) assimpFlags &= ~aiProcess_FindDegenerates;
-        if(is_set(mFlags, Model::LoadFlags::DontMergeMeshes))                   assimpFlags &= ~aiProcess_OptimizeMeshes; // Avoid merging original meshes
-        if(is_set(mFlags, Model::LoadFlags::RemoveInstancing))                  assimpFlags |= aiProcess_PreTransformVertices;
+        if(is_set(flags, Model::LoadFlags::FindDegeneratePrimitives) == false) assimpFlags &= ~aiProcess_FindDegenerates;
+        if(is_set(flags, Model::LoadFlags::DontMergeMeshes))                   assimpFlags &= ~aiProcess_OptimizeMeshes; // Avoid merging original meshes
+        if(is_set(flags, Model::LoadFlags::RemoveInstancing) && is_set(flags, Model::LoadFlags::DetectInstancing) == false) assimpFlags |= aiProcess_PreTransformVertices;
 
         // Never use Assimp's tangent gen code
         assimpFlags &= ~(aiProcess_CalcTangentSpace);
+        return assimpFlags;
+    }
+
+    static std::string makePrefetchKey(const std::string& fullpath, Model::LoadFlags flags)
+    {
+        return fullpath + '|' + std::to_string(getAssimpFlags(flags));
+    }
+
+    std::string AssimpModelImporter::getPrefetchKey(const std::string& filename, Model::LoadFlags flags)
+    {
+        std::string fullpath;
+        if (findFileInDataDirectories(filename, fullpath) == false) return "";
+        return makePrefetchKey(fullpath, flags);
+    }
+
+    bool AssimpModelImporter::prefetch(const std::string& filename, Model::LoadFlags flags, uint32_t useCount)
+    {
+        std::string fullpath;
+        if (findFileInDataDirectories(filename, fullpath) == false)
+        {
+            return false;
+        }
+
+        // Reserve the entry before parsing, so that other threads wait for this parse instead of starting their own
+        std::string key = makePrefetchKey(fullpath, flags);
+        auto pFile = std::make_shared<PrefetchedFile>();
+        pFile->remainingUses = useCount;
+        {
+            std::lock_guard<std::mutex> lock(sPrefetchMutex);
+            auto it = sPrefetchedFiles.find(key);
+            if (it != sPrefetchedFiles.end())
+            {
+                it->second->remainingUses += useCount;
+                return true;
+            }
+            sPrefetchedFiles[key] = pFile;
+        }
+
+        // Parse outside the lock, then publish the result. A file which fails to parse or verify is kept too, so that import() reports the error on the main thread.
+        auto publish = [&pFile](std::unique_ptr<Assimp::Importer> pImporter, const aiScene* pScene, bool valid)
+        {
+            {
+                std::lock_guard<std::mutex> lock(sPrefetchMutex);
+                pFile->pImporter = std::move(pImporter);
+                pFile->pScene = pScene;
+                pFile->valid = valid;
+                pFile->parsing = false;
+            }
+            sPrefetchCondition.notify_all();
+        };
+
+        try
+        {
+            auto pImporter = std::make_unique<Assimp::Importer>();
+            const aiScene* pScene = pImporter->ReadFile(fullpath, getAssimpFlags(flags));
+            bool valid = (pScene != nullptr) && verifyScene(pScene);
+            publish(std::move(pImporter), pScene, valid);
+            return valid;
+        }
+        catch (...)
+        {
+            // import() parses the file again
+            publish(nullptr, nullptr, false);
+            throw;
+        }
+    }
 
-        Assimp::Importer importer;
-        const aiScene* pScene = importer.ReadFile(fullpath, assimpFlags);
+    void AssimpModelImporter::releasePrefetchedFiles()
+    {
+        std::lock_guard<std::mutex> lock(sPrefetchMutex);
+        sPrefetchedFiles.clear();
+    }
 
-        if((pScene == nullptr) || (verifyScene(pScene) == false))
+    bool AssimpModelImporter::initModel(const std::string& filename)
+    {
+        std::string fullpath;
+        if (findFileInDataDirectories(filename, fullpath) == false)
+        {
+            logError(std::string("Can't find model file ") + filename, true);
+            return false;
+        }
+
+        // Use the prefetched data if the file was already parsed, waiting for the parse if it's still running.
+        // Importing modifies the scene's meshes (bitangents), so only its last user imports it directly and the others import a copy.
+        std::shared_ptr<PrefetchedFile> pFile;
+        std::unique_ptr<aiScene, void(*)(const aiScene*)> pSceneCopy(nullptr, aiFreeScene);
+        bool copyScene = false;
+        {
+            std::unique_lock<std::mutex> lock(sPrefetchMutex);
+            std::string key = makePrefetchKey(fullpath, mFlags);
+            auto it = sPrefetchedFiles.find(key);
+            if (it != sPrefetchedFiles.end())
+            {
+                pFile = it->second;
+                sPrefetchCondition.wait(lock, [&pFile]() { return pFile->parsing == false; });
+                copyScene = pFile->valid && (pFile->remainingUses > 1);
+                if (copyScene)
+                {
+                    pFile->remainingUses--;
+                }
+                else
+                {
+                    // The map may have changed while waiting
+                    it = sPrefetchedFiles.find(key);
+                    if (it != sPrefetchedFiles.end() && it->second == pFile) sPrefetchedFiles.erase(it);
+                }
+            }
+        }
+
+        // If the prefetch threw, parse the file here
+        if (pFile && pFile->pImporter == nullptr) pFile = nullptr;
+
+        if (pFile == nullptr)
+        {
+            pFile = std::make_shared<PrefetchedFile>();
+            pFile->pImporter = std::make_unique<Assimp::Importer>();
+            pFile->pScene = pFile->pImporter->ReadFile(fullpath, getAssimpFlags(mFlags));
+            pFile->valid = (pFile->pScene != nullptr) && verifyScene(pFile->pScene);
+        }
+
+        if (pFile->valid == false)
         {
             std::string str("Can't open model file '");
-            str = str + std::string(filename) + "'\n" + importer.GetErrorString();
+            str = str + std::string(filename) + "'\n" + pFile->pImporter->GetErrorString();
             logError(str, true);
             return false;
         }
 
+        if (copyScene)
+        {
+            aiScene* pCopy = nullptr;
+            aiCopyScene(pFile->pScene, &pCopy);
+            pSceneCopy.reset(pCopy);
+        }
+        const aiScene* pScene = pSceneCopy ? pSceneCopy.get() : pFile->pScene;
+
         // Extract the folder name
         auto last = fullpath.find_last_of("/\\");
         std::string modelFolder = fullpath.substr(0, last);
@@ -547,17 +987,39 @@ namespace Falcor
             return false;
         }
 
+        // Split large meshes into clusters, so that only the visible parts of them need to be resident
+        if (is_set(mFlags, Model::LoadFlags::StreamGeometry))
+        {
+            uint32_t clusterTriangles = GeometryStreamer::getGlobalStreamer()->getDesc().clusterTriangleCount;
+            uint32_t splitCount = splitMeshesIntoClusters(pScene, clusterTriangles);
+            if (splitCount) logInfo("Model " + filename + ": split " + std::to_string(splitCount) + " meshes into clusters of at most " + std::to_string(clusterTriangles) + " triangles.");
+        }
+
         if (createDrawList(pScene) == false)
         {
             logError(std::string("Can't create draw lists for model ") + filename, true);
             return false;
         }
 
+        if (is_set(mFlags, Model::LoadFlags::DetectInstancing))
+        {
+            uint64_t uniqueTriangles = 0, instancedTriangles = 0;
+            for (uint32_t i = 0; i < mModel.getMeshCount(); i++)
+            {
+                uint32_t primitives = mModel.getMesh(i)->getPrimitiveCount();
+                uniqueTriangles += primitives;
+                instancedTriangles += uint64_t(primitives) * mModel.getMeshInstanceCount(i);
+            }
+            logInfo("Model " + filename + ": " + std::to_string(mAiMeshToInstanceTransform.size()) + " meshes turned into instances. " +
+                std::to_string(uniqueTriangles) + " unique triangles, " + std::to_string(instancedTriangles) + " instanced triangles.");
+        }
+
         return true;
     }
 
     bool AssimpModelImporter::import(Model& model, const std::string& filename, Model::LoadFlags flags)
     {
+        Logger::ScopedSubsystem logSubsystem("AssimpModelImporter");
         AssimpModelImporter loader(model, flags);
         return loader.initModel(filename);
     }
@@ -712,28 +1174,19 @@ namespace Falcor
             for (uint32_t j = 0; j < pAiNode->mNumPositionKeys; j++)
             {
                 const aiVectorKey& key = pAiNode->mPositionKeys[j];
-                Animation::AnimationKey<glm::vec3> position;
-                position.value = glm::vec3(key.mValue.x, key.mValue.y, key.mValue.z);
-                position.time = float(key.mTime);
-                animationSets[i].translation.keys.push_back(position);
+                animationSets[i].translation.addKey(glm::vec3(key.mValue.x, key.mValue.y, key.mValue.z), float(key.mTime));
             }
 
             for (uint32_t j = 0; j < pAiNode->mNumScalingKeys; j++)
             {
                 const aiVectorKey& key = pAiNode->mScalingKeys[j];
-                Animation::AnimationKey<glm::vec3> scale;
-                scale.value = glm::vec3(key.mValue.x, key.mValue.y, key.mValue.z);
-                scale.time = float(key.mTime);
-                animationSets[i].scaling.keys.push_back(scale);
+                animationSets[i].scaling.addKey(glm::vec3(key.mValue.x, key.mValue.y, key.mValue.z), float(key.mTime));
             }
 
             for (uint32_t j = 0; j < pAiNode->mNumRotationKeys; j++)
             {
                 const aiQuatKey& key = pAiNode->mRotationKeys[j];
-                Animation::AnimationKey<glm::quat> rotation;
-                rotation.value = glm::quat(key.mValue.w, key.mValue.x, key.mValue.y, key.mValue.z);
-                rotation.time = float(key.mTime);
-                animationSets[i].rotation.keys.push_back(rotation);
+                animationSets[i].rotation.addKey(glm::quat(key.mValue.w, key.mValue.x, key.mValue.y, key.mValue.z), float(key.mTime));
             }
         }
 
@@ -766,8 +1219,8 @@ namespace Falcor
     Mesh::SharedPtr AssimpModelImporter::createMesh(const aiMesh* pAiMesh)
     {
         uint32_t vertexCount = pAiMesh->mNumVertices;
-        uint32_t indexCount = pAiMesh->mNumFaces * pAiMesh->mFaces[0].mNumIndices;
-        auto pIB = createIndexBuffer(pAiMesh);
+        std::vector<uint32_t> indices = createIndexBufferData(pAiMesh);
+        uint32_t indexCount = (uint32_t)indices.size();
         BoundingBox boundingBox = createMeshBbox(pAiMesh);
 
         const bool generateTangentSpace = (pAiMesh->HasTangentsAndBitangents() == false) && (is_set(mFlags, Model::LoadFlags::DontGenerateTangentSpace) == false);
@@ -783,7 +1236,7 @@ namespace Falcor
             return nullptr;
         }
 
-        std::vector<Buffer::SharedPtr> pVBs(pLayout->getBufferCount());
+        std::vector<std::vector<uint8_t>> vertexData(pLayout->getBufferCount());
 
         // Initialize the bones data
         VertexWeightsVec weights;
@@ -793,11 +1246,11 @@ namespace Falcor
             loadBones(pAiMesh, weights, ids, vertexCount, mBoneNameToIdMap);
         }
 
-        // Create corresponding vertex buffers
+        // Fill the corresponding vertex buffers
         for (uint32_t i = 0; i < pLayout->getBufferCount(); i++)
         {
             const VertexBufferLayout* pVbLayout = pLayout->getBufferLayout(i).get();
-            pVBs[i] = createVertexBuffer(pAiMesh, pVbLayout, (uint8_t*)ids.data(), weights.data());
+            vertexData[i] = createVertexBufferData(pAiMesh, pVbLayout, (uint8_t*)ids.data(), weights.data());
         }
 
         Vao::Topology topology = Vao::Topology::TriangleList;
@@ -820,7 +1273,42 @@ namespace Falcor
         auto pMaterial = mAiMaterialToFalcor[pAiMesh->mMaterialIndex];
         assert(pMaterial);
 
-        Mesh::SharedPtr pMesh = Mesh::create(pVBs, vertexCount, pIB, indexCount, pLayout, topology, pMaterial, boundingBox, pAiMesh->HasBones());
+        // Static triangle meshes can be paged in and out. The streamer returns nullptr for meshes which are too small to be worth it.
+        Mesh::SharedPtr pMesh;
+        if (is_set(mFlags, Model::LoadFlags::StreamGeometry) && (topology == Vao::Topology::TriangleList) && (pAiMesh->HasBones() == false))
+        {
+            bool shaderResource = is_set(mFlags, Model::LoadFlags::BuffersAsShaderResource);
+            pMesh = GeometryStreamer::getGlobalStreamer()->createMesh(pLayout, vertexData, vertexCount, indices, shaderResource, pMaterial, boundingBox);
+        }
+
+        if (pMesh == nullptr)
+        {
+            std::vector<Buffer::SharedPtr> pVBs(pLayout->getBufferCount());
+            for (uint32_t i = 0; i < pLayout->getBufferCount(); i++)
+            {
+                pVBs[i] = createVertexBuffer(vertexData[i]);
+            }
+            pMesh = Mesh::create(pVBs, vertexCount, createIndexBuffer(indices), indexCount, pLayout, topology, pMaterial, boundingBox, pAiMesh->HasBones());
+
+            // Skinned meshes are deformed every frame, so a LOD computed from the bind pose isn't valid
+            if (is_set(mFlags, Model::LoadFlags::GenerateLods) && (topology == Vao::Topology::TriangleList) && (pAiMesh->HasBones() == false))
+            {
+                createMeshLods(pAiMesh, indices, pMesh.get());
+            }
+        }
+
+        // Keep the vertices of skinned meshes, so they can be skinned on the CPU without reading back the vertex buffers
+        if (pAiMesh->HasBones())
+        {
+            auto pSource = std::make_shared<Mesh::SkinningSource>();
+            pSource->positions.assign((const glm::vec3*)pAiMesh->mVertices, (const glm::vec3*)pAiMesh->mVertices + vertexCount);
+            if (pAiMesh->HasNormals()) pSource->normals.assign((const glm::vec3*)pAiMesh->mNormals, (const glm::vec3*)pAiMesh->mNormals + vertexCount);
+            if (pAiMesh->mBitangents) pSource->bitangents.assign((const glm::vec3*)pAiMesh->mBitangents, (const glm::vec3*)pAiMesh->mBitangents + vertexCount);
+            pSource->boneWeights.assign(weights.begin(), weights.end());
+            pSource->boneIds.resize(vertexCount);
+            memcpy(pSource->boneIds.data(), ids.data(), vertexCount * sizeof(uint32_t));
+            pMesh->setSkinningSource(pSource);
+        }
 
         if (generateTangentSpace)
         {
@@ -831,9 +1319,18 @@ namespace Falcor
         return pMesh;
     }
 
-    Buffer::SharedPtr AssimpModelImporter::createIndexBuffer(const aiMesh* pAiMesh)
+    void AssimpModelImporter::createMeshLods(const aiMesh* pAiMesh, const std::vector<uint32_t>& indices, Mesh* pMesh)
+    {
+        const glm::vec3* pPositions = (const glm::vec3*)pAiMesh->mVertices;
+        std::vector<MeshSimplifier::Lod> lods = MeshSimplifier::generateLodChain(pPositions, pAiMesh->mNumVertices, indices);
+        for (const auto& lod : lods)
+        {
+            pMesh->addLod(createIndexBuffer(lod.indices), (uint32_t)lod.indices.size(), lod.error);
+        }
+    }
+
+    Buffer::SharedPtr AssimpModelImporter::createIndexBuffer(const std::vector<uint32_t>& indices)
     {
-        std::vector<uint32_t> indices = createIndexBufferData(pAiMesh);
         const uint32_t size = (uint32_t)(sizeof(uint32_t) * indices.size());
         Buffer::BindFlags bindFlags = Buffer::BindFlags::Index;
         if (is_set(mFlags, Model::LoadFlags::BuffersAsShaderResource))
@@ -912,7 +1409,7 @@ namespace Falcor
         return pLayout;
     }
 
-    Buffer::SharedPtr AssimpModelImporter::createVertexBuffer(const aiMesh* pAiMesh, const VertexBufferLayout* pLayout, const uint8_t* pBoneIds, const vec4* pBoneWeights)
+    std::vector<uint8_t> AssimpModelImporter::createVertexBufferData(const aiMesh* pAiMesh, const VertexBufferLayout* pLayout, const uint8_t* pBoneIds, const vec4* pBoneWeights)
     {
         const uint32_t vertexStride = pLayout->getStride();
         std::vector<uint8_t> initData(vertexStride * pAiMesh->mNumVertices, 0);
@@ -979,12 +1476,17 @@ namespace Falcor
                 memcpy(pDst, pSrc, size);
             }
         }
+        return initData;
+    }
+
+    Buffer::SharedPtr AssimpModelImporter::createVertexBuffer(const std::vector<uint8_t>& data)
+    {
         Buffer::BindFlags bindFlags = Buffer::BindFlags::Vertex;
         if (is_set(mFlags, Model::LoadFlags::BuffersAsShaderResource))
         {
             bindFlags |= Buffer::BindFlags::ShaderResource;
         }
 
-        return Buffer::create(vertexStride * pAiMesh->mNumVertices, bindFlags, Buffer::CpuAccess::None, initData.data());;
+        return Buffer::create(data.size(), bindFlags, Buffer::CpuAccess::None, data.data());
     }
 }
\ No newline at end of file
@@ -28,6 +28,7 @@
 #pragma once
 #include <map>
 #include <unordered_set>
+#include <unordered_map>
 #include <vector>
 #include "Graphics/Model/Loaders/ModelImporter.h"
 #include "../AnimationController.h"
@@ -65,6 +66,26 @@ namespace Falcor
         */
         static bool import(Model& model, const std::string& filename, Model::LoadFlags flags);
 
+        /** Parse a model file ahead of import. The parsed data is kept until releasePrefetchedFiles() is called, and import() of the same file with the same flags will use it instead of parsing the file again.
+            Doesn't create any GPU resources and is thread-safe, so it can be called from worker threads. If another thread is parsing the same file, the uses are added to that parse; import() waits for a parse which is still running.
+            \param[in] filename Model's filename. Can include a full path or a relative path from a data directory
+            \param[in] flags Flags controlling model creation
+            \param[in] useCount Number of import() calls which will use the data. Importing modifies the parsed scene, so all of them but the last one import a copy.
+            \return Whether parsing succeeded
+        */
+        static bool prefetch(const std::string& filename, Model::LoadFlags flags, uint32_t useCount = 1);
+
+        /** Release the data kept by prefetch()
+        */
+        static void releasePrefetchedFiles();
+
+        /** Get the key identifying the parsed data of a file. Loads with the same key share one prefetch().
+            \param[in] filename Model's filename. Can include a full path or a relative path from a data directory
+            \param[in] flags Flags controlling model creation
+            \return The key, or an empty string if the file can't be found
+        */
+        static std::string getPrefetchKey(const std::string& filename, Model::LoadFlags flags);
+
     private:
 
         using IdToMesh = std::unordered_map<uint32_t, Mesh::SharedPtr>;
@@ -75,7 +96,9 @@ namespace Falcor
 
         bool initModel(const std::string& filename);
         bool createDrawList(const aiScene* pScene);
+        uint32_t splitMeshesIntoClusters(const aiScene* pScene, uint32_t maxTriangles);
         bool parseAiSceneNode(const aiNode* pCurrent, const aiScene* pScene, IdToMesh& aiToFalcorMesh);
+        Mesh::SharedPtr findInstancedMesh(const aiMesh* pAiMesh, glm::mat4& meshToInstance);
         bool createAllMaterials(const aiScene* pScene, const std::string& modelFolder, bool isObjFile, bool useSrgb);
 
         void createAnimationController(const aiScene* pScene);
@@ -87,8 +110,10 @@ namespace Falcor
 
         Mesh::SharedPtr createMesh(const aiMesh* pAiMesh);
         VertexLayout::SharedPtr createVertexLayout(const aiMesh* pAiMesh);
-        Buffer::SharedPtr createIndexBuffer(const aiMesh* pAiMesh);
-        Buffer::SharedPtr createVertexBuffer(const aiMesh* pAiMesh, const VertexBufferLayout* pLayout, const uint8_t* pBoneIds, const vec4* pBoneWeights);
+        Buffer::SharedPtr createIndexBuffer(const std::vector<uint32_t>& indices);
+        void createMeshLods(const aiMesh* pAiMesh, const std::vector<uint32_t>& indices, Mesh* pMesh);
+        std::vector<uint8_t> createVertexBufferData(const aiMesh* pAiMesh, const VertexBufferLayout* pLayout, const uint8_t* pBoneIds, const vec4* pBoneWeights);
+        Buffer::SharedPtr createVertexBuffer(const std::vector<uint8_t>& data);
         void loadTextures(const aiMaterial* pAiMaterial, const std::string& folder, Material* pMaterial, bool isObjFile, bool useSrgb);
         Material::SharedPtr createMaterial(const aiMaterial* pAiMaterial, const std::string& folder, bool isObjFile, bool useSrgb);
 
@@ -101,6 +126,14 @@ namespace Falcor
 
         std::map<uint32_t, Material::SharedPtr> mAiMaterialToFalcor;
 
+        // Used by DetectInstancing. Meshes created so far keyed by a hash of their rigid-invariant properties, and the transform from the shared mesh to each aiMesh which was replaced with an instance
+        std::unordered_multimap<uint64_t, std::pair<const aiMesh*, Mesh::SharedPtr>> mGeometryCandidates;
+        std::unordered_map<uint32_t, glm::mat4> mAiMeshToInstanceTransform;
+
+        // Used by StreamGeometry. The clusters created by splitMeshesIntoClusters(). Cluster i has the mesh ID aiScene::mNumMeshes + i, and mMeshToClusters maps the ID of each split aiScene mesh to the IDs of its clusters.
+        std::vector<std::unique_ptr<aiMesh>> mClusterMeshes;
+        std::unordered_map<uint32_t, std::vector<uint32_t>> mMeshToClusters;
+
         Model& mModel;
 
         std::vector<Bone> mBones;
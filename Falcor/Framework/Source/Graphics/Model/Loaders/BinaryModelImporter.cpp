@@ -30,6 +30,7 @@
 #include "BinaryModelSpec.h"
 #include "../Model.h"
 #include "../Mesh.h"
+#include "../TangentGenerator.h"
 #include "Utils/Platform/OS.h"
 #include "API/VertexLayout.h"
 #include "Data/VertexAttrib.h"
@@ -53,125 +54,6 @@ namespace Falcor
         std::string name;
     };
 
-    bool isSpecialFloat(float f)
-    {
-        uint32_t d = *(uint32_t*)&f;
-        // Check the exponent
-        d = (d >> 23) & 0xff;
-        return d == 0xff;
-    }
-
-    static vec3 projectNormalToBitangent(const vec3& normal)
-    {
-        vec3 bitangent;
-        if (abs(normal.x) > abs(normal.y))
-        {
-            bitangent = vec3(normal.z, 0.f, -normal.x) / length(vec2(normal.x, normal.z));
-        }
-        else
-        {
-            bitangent = vec3(0.f, normal.z, -normal.y) / length(vec2(normal.y, normal.z));
-        }
-        return normalize(bitangent);
-    }
-
-    static bool isInvalidVec(const vec3& v)
-    {
-        return isSpecialFloat(v.x) || isSpecialFloat(v.y) || isSpecialFloat(v.z);
-    }
-
-    template<typename posType>
-    void generateSubmeshTangentData(
-        const std::vector<uint32_t>& indices,
-        uint32_t vertexCount,
-        const posType* vertexPosData,
-        const glm::vec3* vertexNormalData,
-        const glm::vec2* texCrdData,
-        uint32_t texCrdCount,
-        glm::vec3* bitangentData)
-    {
-        std::memset(bitangentData, 0, vertexCount * sizeof(vec3));
-
-        // calculate the tangent and bitangent for every face
-        size_t primCount = indices.size() / 3;
-        for(size_t primID = 0; primID < primCount; primID++)
-        {
-            struct Data
-            {
-                posType position;
-                glm::vec3 normal;
-                glm::vec2 uv;
-            };
-            Data V[3];
-
-            // Get the data
-            for(uint32_t i = 0; i < 3; i++)
-            {
-                uint32_t index = indices[primID * 3 + i];
-                V[i].position = vertexPosData[index];
-                V[i].normal = vertexNormalData[index];
-                V[i].uv = texCrdData ? texCrdData[index * texCrdCount] : vec2(0);
-            }
-
-            // Position delta
-            posType posDelta[2];
-            posDelta[0] = V[1].position - V[0].position;
-            posDelta[1] = V[2].position - V[0].position;
-
-            // Texture offset
-            glm::vec2 s = V[1].uv - V[0].uv;
-            glm::vec2 t = V[2].uv - V[0].uv;
-
-            glm::vec3 tangent;
-            glm::vec3 bitangent;
-
-            // when t1, t2, t3 in same position in UV space, just use default UV direction.
-            if((s == glm::vec2(0, 0)) || (t == glm::vec2(0, 0)))
-            {
-                const glm::vec3 &normal = V[0].normal;
-                bitangent = projectNormalToBitangent(normal);
-                tangent = cross(bitangent, normal);
-            }
-            else
-            {
-                float dirCorrection = 1.0f / (s.x * t.y - s.y * t.x);
-
-                // tangent points in the direction where to positive X axis of the texture coord's would point in model space
-                // bitangent's points along the positive Y axis of the texture coord's, respectively
-                tangent   = (posDelta[0] * t.y - posDelta[1] * t.x) * dirCorrection;
-                bitangent = (posDelta[1] * s.x - posDelta[0] * s.y) * dirCorrection;
-            }
-
-            // store for every vertex of that face
-            for(uint32_t i = 0; i < 3; i++)
-            {
-                // project tangent and bitangent into the plane formed by the vertex' normal
-                glm::vec3 localTangent = tangent - V[i].normal * (glm::dot(tangent, V[i].normal));
-                localTangent = glm::normalize(localTangent);
-                glm::vec3 localBitangent = bitangent - V[i].normal * (glm::dot(bitangent, V[i].normal));
-                localBitangent = glm::normalize(localBitangent);
-                localBitangent = localBitangent - localTangent * (glm::dot(localBitangent, localTangent));
-                localBitangent = glm::normalize(localBitangent);
-
-                if (isInvalidVec(bitangent) == false)
-                {
-                    // and write it into the mesh
-                    uint32_t index = indices[primID * 3 + i];
-                    bitangentData[index] += normalize(localBitangent);
-                }
-            }
-        }
-
-        for (uint32_t v = 0; v < vertexCount; v++)
-        {
-            bitangentData[v] = normalize(bitangentData[v]);
-            if (isInvalidVec(bitangentData[v]))
-            {
-                bitangentData[v] = projectNormalToBitangent(vertexNormalData[v]);
-            }
-        }
-    }
-
     static void setTexture(Material* pMaterial, Texture::SharedPtr pTexture, TextureType texType, const std::string& modelName)
     {
         switch(texType)
@@ -496,6 +378,7 @@ namespace Falcor
 
     bool BinaryModelImporter::import(Model& model, const std::string& filename, Model::LoadFlags flags)
     {
+        Logger::ScopedSubsystem logSubsystem("BinaryModelImporter");
         std::string fullpath;
         if(findFileInDataDirectories(filename, fullpath) == false)
         {
@@ -908,13 +791,18 @@ namespace Falcor
 
                     ResourceFormat posFormat = pLayout->getBufferLayout(positionBufferIndex)->getElementFormat(0);
 
-                    if (posFormat == ResourceFormat::RGB32Float)
-                    {
-                        generateSubmeshTangentData<glm::vec3>(indices, numVertices, (glm::vec3*)buffers[positionBufferIndex].vec.data(), (glm::vec3*)buffers[normalBufferIndex].vec.data(), texCrd, texCrdCount, (glm::vec3*)buffers[bitangentBufferIndex].vec.data());
-                    }
-                    else if (posFormat == ResourceFormat::RGBA32Float)
+                    if ((posFormat == ResourceFormat::RGB32Float) || (posFormat == ResourceFormat::RGBA32Float))
                     {
-                        generateSubmeshTangentData<glm::vec4>(indices, numVertices, (glm::vec4*)buffers[positionBufferIndex].vec.data(), (glm::vec3*)buffers[normalBufferIndex].vec.data(), texCrd, texCrdCount, (glm::vec3*)buffers[bitangentBufferIndex].vec.data());
+                        TangentGenerator::MeshData meshData;
+                        meshData.pIndices = indices.data();
+                        meshData.indexCount = indices.size();
+                        meshData.vertexCount = numVertices;
+                        meshData.pPositions = (float*)buffers[positionBufferIndex].vec.data();
+                        meshData.positionStride = (posFormat == ResourceFormat::RGBA32Float) ? 4 : 3;
+                        meshData.pNormals = (glm::vec3*)buffers[normalBufferIndex].vec.data();
+                        meshData.pTexCrd = texCrd;
+                        meshData.texCrdStride = texCrdCount;
+                        TangentGenerator::generateBitangents(meshData, (glm::vec3*)buffers[bitangentBufferIndex].vec.data());
                     }
 
                     pVBs[bitangentBufferIndex] = Buffer::create(buffers[bitangentBufferIndex].vec.size(), Buffer::BindFlags::Vertex, Buffer::CpuAccess::None, buffers[bitangentBufferIndex].vec.data());
@@ -90,6 +90,34 @@ namespace Falcor
         mpVao = Vao::create(topology, pLayout, vertexBuffers, pIndexBuffer, ResourceFormat::R32Uint);
     }
 
+    void Mesh::addLod(const Buffer::SharedPtr& pIndexBuffer, uint32_t indexCount, float error)
+    {
+        assert(mpVao->getPrimitiveTopology() == Vao::Topology::TriangleList && mHasBones == false);
+        assert(mLods.empty() || mLods.back().error <= error);
+
+        Vao::BufferVec vertexBuffers(mpVao->getVertexBuffersCount());
+        for (uint32_t i = 0; i < mpVao->getVertexBuffersCount(); i++)
+        {
+            vertexBuffers[i] = mpVao->getVertexBuffer(i);
+        }
+
+        Lod lod;
+        lod.pVao = Vao::create(Vao::Topology::TriangleList, mpVao->getVertexLayout(), vertexBuffers, pIndexBuffer, ResourceFormat::R32Uint);
+        lod.indexCount = indexCount;
+        lod.error = error;
+        mLods.push_back(lod);
+    }
+
+    void Mesh::setGeometry(const Vao::SharedPtr& pVao, uint32_t vertexCount, uint32_t indexCount)
+    {
+        assert(pVao->getVertexLayout() == mpVao->getVertexLayout() && pVao->getPrimitiveTopology() == Vao::Topology::TriangleList);
+        assert(mLods.empty());
+        mpVao = pVao;
+        mVertexCount = vertexCount;
+        mIndexCount = indexCount;
+        mPrimitiveCount = indexCount / 3;
+    }
+
     void Mesh::resetGlobalIdCounter()
     {
         sMeshCounter = 0;
@@ -29,6 +29,7 @@
 #include <map>
 #include <vector>
 #include "glm/vec3.hpp"
+#include "glm/vec4.hpp"
 #include "glm/mat4x4.hpp"
 #include "API/VAO.h"
 #include "API/RenderContext.h"
@@ -47,6 +48,7 @@ namespace Falcor
     class AssimpModelImporter;
     class BinaryModelImporter;
     class SimpleModelImporter;
+    class GeometryStreamer;
 
     /** Class representing a single mesh
     */
@@ -112,6 +114,43 @@ namespace Falcor
         */
         const Vao::SharedPtr& getVao() const { return mpVao; }
 
+        /** Get the number of levels-of-detail. LOD 0 is the full-resolution mesh, higher LODs are progressively coarser.
+        */
+        uint32_t getLodCount() const { return (uint32_t)mLods.size() + 1; }
+
+        /** Get the vertex array object of a LOD. All LODs share the mesh's vertex buffers and only differ in their index buffer.
+            LOD 0 returns the same object as getVao().
+        */
+        const Vao::SharedPtr& getLodVao(uint32_t lod) const { return (lod == 0) ? mpVao : mLods[lod - 1].pVao; }
+
+        /** Get the number of indices of a LOD. Use this value when drawing the LOD.
+        */
+        uint32_t getLodIndexCount(uint32_t lod) const { return (lod == 0) ? mIndexCount : mLods[lod - 1].indexCount; }
+
+        /** Get the number of primitives of a LOD.
+        */
+        uint32_t getLodPrimitiveCount(uint32_t lod) const { return (lod == 0) ? mPrimitiveCount : mLods[lod - 1].indexCount / 3; }
+
+        /** Get the geometric error of a LOD, an estimate of the object-space distance between the LOD and the full-resolution surface. LOD 0 has no error.
+        */
+        float getLodError(uint32_t lod) const { return (lod == 0) ? 0.0f : mLods[lod - 1].error; }
+
+        /** Bind-pose vertices of a skinned mesh in CPU memory. The importer keeps them so the mesh can be skinned on the CPU without reading back its vertex buffers (see SkinningCache::Mode::Cpu).
+            Normals and bitangents are empty if the mesh doesn't have them.
+        */
+        struct SkinningSource
+        {
+            std::vector<glm::vec3> positions;
+            std::vector<glm::vec3> normals;
+            std::vector<glm::vec3> bitangents;
+            std::vector<glm::vec4> boneWeights;
+            std::vector<uint32_t> boneIds;      ///< 4 8-bit bone IDs per vertex, as in the RGBA8Uint vertex buffer
+        };
+
+        /** Get the CPU copy of the mesh's vertices, or nullptr if the importer didn't keep one
+        */
+        const std::shared_ptr<const SkinningSource>& getSkinningSource() const { return mpSkinningSource; }
+
         /** Get global mesh ID
         */
         const uint32_t getId() const { return mId; }
@@ -129,6 +168,23 @@ namespace Falcor
         friend AssimpModelImporter;
         friend BinaryModelImporter;
         friend SimpleModelImporter;
+        friend GeometryStreamer;
+
+        /** Append a LOD to the chain. LODs must be added from finest to coarsest.
+            \param[in] pIndexBuffer Triangle-list indices into the mesh's vertex buffers
+            \param[in] indexCount Number of indices in the index buffer
+            \param[in] error The LOD's geometric error
+        */
+        void addLod(const Buffer::SharedPtr& pIndexBuffer, uint32_t indexCount, float error);
+
+        /** Replace the mesh's geometry. Used by the GeometryStreamer to swap between the full-resolution geometry and its proxy.
+            The vertex layout and the bounding-box must not change. Meshes with LODs can't be swapped.
+        */
+        void setGeometry(const Vao::SharedPtr& pVao, uint32_t vertexCount, uint32_t indexCount);
+
+        /** Keep a CPU copy of the vertices of a skinned mesh
+        */
+        void setSkinningSource(const std::shared_ptr<const SkinningSource>& pSource) { mpSkinningSource = pSource; }
 
     private:
         Mesh(const Vao::BufferVec& vertexBuffers,
@@ -152,5 +208,14 @@ namespace Falcor
         Material::SharedPtr mpMaterial;
         BoundingBox mBoundingBox;
         Vao::SharedPtr mpVao;
+        std::shared_ptr<const SkinningSource> mpSkinningSource;
+
+        struct Lod
+        {
+            Vao::SharedPtr pVao;
+            uint32_t indexCount = 0;
+            float error = 0;
+        };
+        std::vector<Lod> mLods;     ///< LOD 1 and up
     };
 }
\ No newline at end of file
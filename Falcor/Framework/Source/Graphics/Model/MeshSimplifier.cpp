@@ -0,0 +1,439 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "MeshSimplifier.h"
+#include "Utils/Platform/OS.h"
+#include "Utils/StringUtils.h"
+#include "glm/geometric.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <unordered_map>
+
+namespace Falcor
+{
+    static const uint32_t kCacheMagic = 0x444F4C46;    // 'FLOD'
+    static const uint32_t kCacheVersion = 1;
+    static const uint32_t kMaxCachedLods = 32;
+
+    /** Symmetric 4x4 matrix measuring the sum of squared distances of a point to a set of planes.
+        The number of planes is tracked as well, so that the error can be reported as an average distance rather than growing with every collapse.
+    */
+    struct Quadric
+    {
+        double a2 = 0, ab = 0, ac = 0, ad = 0;
+        double b2 = 0, bc = 0, bd = 0;
+        double c2 = 0, cd = 0;
+        double d2 = 0;
+        double planeCount = 0;
+
+        static Quadric fromPlane(const glm::dvec3& n, double d)
+        {
+            Quadric q;
+            q.a2 = n.x * n.x; q.ab = n.x * n.y; q.ac = n.x * n.z; q.ad = n.x * d;
+            q.b2 = n.y * n.y; q.bc = n.y * n.z; q.bd = n.y * d;
+            q.c2 = n.z * n.z; q.cd = n.z * d;
+            q.d2 = d * d;
+            q.planeCount = 1;
+            return q;
+        }
+
+        Quadric& operator+=(const Quadric& q)
+        {
+            a2 += q.a2; ab += q.ab; ac += q.ac; ad += q.ad;
+            b2 += q.b2; bc += q.bc; bd += q.bd;
+            c2 += q.c2; cd += q.cd;
+            d2 += q.d2;
+            planeCount += q.planeCount;
+            return *this;
+        }
+
+        double evaluate(const glm::dvec3& p) const
+        {
+            double e = a2 * p.x * p.x + 2 * ab * p.x * p.y + 2 * ac * p.x * p.z + 2 * ad * p.x
+                + b2 * p.y * p.y + 2 * bc * p.y * p.z + 2 * bd * p.y
+                + c2 * p.z * p.z + 2 * cd * p.z
+                + d2;
+            return std::max(e, 0.0) / std::max(planeCount, 1.0);
+        }
+    };
+
+    struct Collapse
+    {
+        uint32_t from;
+        uint32_t to;
+        double cost;
+    };
+
+    // Returns for each vertex the ID of the first vertex with the same position
+    static std::vector<uint32_t> weldPositions(const glm::vec3* pPositions, uint32_t vertexCount)
+    {
+        std::vector<uint32_t> order(vertexCount);
+        for (uint32_t i = 0; i < vertexCount; i++)
+        {
+            order[i] = i;
+        }
+
+        std::sort(order.begin(), order.end(), [pPositions](uint32_t a, uint32_t b)
+        {
+            const glm::vec3& pa = pPositions[a];
+            const glm::vec3& pb = pPositions[b];
+            if (pa.x != pb.x) return pa.x < pb.x;
+            if (pa.y != pb.y) return pa.y < pb.y;
+            if (pa.z != pb.z) return pa.z < pb.z;
+            return a < b;
+        });
+
+        std::vector<uint32_t> remap(vertexCount);
+        for (uint32_t i = 0; i < vertexCount; i++)
+        {
+            bool sameAsPrev = (i > 0) && (pPositions[order[i]] == pPositions[order[i - 1]]);
+            remap[order[i]] = sameAsPrev ? remap[order[i - 1]] : order[i];
+        }
+        return remap;
+    }
+
+    static glm::dvec3 getTriangleNormal(const glm::vec3* pPositions, uint32_t i0, uint32_t i1, uint32_t i2)
+    {
+        glm::dvec3 p0(pPositions[i0]);
+        return glm::cross(glm::dvec3(pPositions[i1]) - p0, glm::dvec3(pPositions[i2]) - p0);
+    }
+
+    // Checks if moving vertex 'from' onto 'to' flips or degenerates any of the triangles which survive the collapse
+    static bool collapseFlipsTriangle(const glm::vec3* pPositions, const std::vector<uint32_t>& indices, const uint32_t* pTriangles, uint32_t triangleCount, uint32_t from, uint32_t to)
+    {
+        for (uint32_t t = 0; t < triangleCount; t++)
+        {
+            uint32_t tri[3] = { indices[pTriangles[t] * 3 + 0], indices[pTriangles[t] * 3 + 1], indices[pTriangles[t] * 3 + 2] };
+            if (tri[0] == to || tri[1] == to || tri[2] == to) continue;  // Removed by the collapse
+
+            glm::dvec3 oldNormal = getTriangleNormal(pPositions, tri[0], tri[1], tri[2]);
+            for (uint32_t& i : tri)
+            {
+                if (i == from) i = to;
+            }
+            glm::dvec3 newNormal = getTriangleNormal(pPositions, tri[0], tri[1], tri[2]);
+            if (glm::dot(oldNormal, newNormal) <= 0) return true;
+        }
+        return false;
+    }
+
+    std::vector<uint32_t> MeshSimplifier::simplify(const glm::vec3* pPositions, uint32_t vertexCount, const std::vector<uint32_t>& indices, uint32_t targetTriangleCount, float& error)
+    {
+        error = 0;
+        std::vector<uint32_t> result = indices;
+        if (result.size() % 3 != 0)
+        {
+            logWarning("MeshSimplifier::simplify() - index count is not a multiple of 3. Only triangle lists can be simplified.");
+            return result;
+        }
+
+        // Vertices sharing a position are on an attribute seam. Moving them would tear the surface apart, so they are locked.
+        std::vector<uint32_t> remap = weldPositions(pPositions, vertexCount);
+        std::vector<uint32_t> copyCount(vertexCount, 0);
+        for (uint32_t v = 0; v < vertexCount; v++)
+        {
+            copyCount[remap[v]]++;
+        }
+
+        std::vector<bool> locked(vertexCount, false);
+        for (uint32_t v = 0; v < vertexCount; v++)
+        {
+            locked[v] = copyCount[remap[v]] > 1;
+        }
+
+        // Lock the vertices of edges used by a single triangle, so that open borders keep their shape
+        std::unordered_map<uint64_t, uint32_t> edgeUseCount;
+        auto getEdgeKey = [&remap](uint32_t a, uint32_t b)
+        {
+            uint64_t wa = remap[a], wb = remap[b];
+            return (std::min(wa, wb) << 32) | std::max(wa, wb);
+        };
+
+        for (size_t t = 0; t < result.size(); t += 3)
+        {
+            for (uint32_t e = 0; e < 3; e++)
+            {
+                edgeUseCount[getEdgeKey(result[t + e], result[t + (e + 1) % 3])]++;
+            }
+        }
+
+        for (size_t t = 0; t < result.size(); t += 3)
+        {
+            for (uint32_t e = 0; e < 3; e++)
+            {
+                uint32_t a = result[t + e];
+                uint32_t b = result[t + (e + 1) % 3];
+                if (edgeUseCount[getEdgeKey(a, b)] == 1)
+                {
+                    locked[a] = true;
+                    locked[b] = true;
+                }
+            }
+        }
+
+        // Initialize the quadrics with the planes of the adjacent triangles. Quadrics are stored per position.
+        std::vector<Quadric> quadrics(vertexCount);
+        for (size_t t = 0; t < result.size(); t += 3)
+        {
+            glm::dvec3 n = getTriangleNormal(pPositions, result[t], result[t + 1], result[t + 2]);
+            double length = glm::length(n);
+            if (length == 0) continue;
+            n /= length;
+
+            Quadric q = Quadric::fromPlane(n, -glm::dot(n, glm::dvec3(pPositions[result[t]])));
+            for (uint32_t i = 0; i < 3; i++)
+            {
+                quadrics[remap[result[t + i]]] += q;
+            }
+        }
+
+        auto getCollapseCost = [&](uint32_t from, uint32_t to)
+        {
+            Quadric q = quadrics[remap[from]];
+            q += quadrics[remap[to]];
+            return q.evaluate(glm::dvec3(pPositions[to]));
+        };
+
+        // Collapse edges in passes. Each pass sorts the candidates by cost and applies the cheapest independent collapses until the target is reached.
+        uint32_t triangleCount = uint32_t(result.size() / 3);
+        double maxCost = 0;
+        std::vector<uint32_t> triangleOffsets;
+        std::vector<uint32_t> vertexTriangles;
+        std::vector<uint32_t> collapseTo(vertexCount);
+        std::vector<bool> touched;
+        std::vector<Collapse> collapses;
+
+        while (triangleCount > targetTriangleCount)
+        {
+            // Build the vertex-to-triangle adjacency
+            triangleOffsets.assign(vertexCount + 1, 0);
+            for (uint32_t i : result)
+            {
+                triangleOffsets[i + 1]++;
+            }
+            for (uint32_t v = 0; v < vertexCount; v++)
+            {
+                triangleOffsets[v + 1] += triangleOffsets[v];
+            }
+            vertexTriangles.resize(result.size());
+            std::vector<uint32_t> fillOffsets(triangleOffsets.begin(), triangleOffsets.end() - 1);
+            for (size_t i = 0; i < result.size(); i++)
+            {
+                vertexTriangles[fillOffsets[result[i]]++] = uint32_t(i / 3);
+            }
+
+            // Each interior edge is shared by 2 triangles with opposite winding, so only the a < b half is used. Border edges are locked.
+            collapses.clear();
+            for (size_t t = 0; t < result.size(); t += 3)
+            {
+                for (uint32_t e = 0; e < 3; e++)
+                {
+                    uint32_t a = result[t + e];
+                    uint32_t b = result[t + (e + 1) % 3];
+                    if (a >= b) continue;
+                    if (locked[a] == false) collapses.push_back({ a, b, getCollapseCost(a, b) });
+                    if (locked[b] == false) collapses.push_back({ b, a, getCollapseCost(b, a) });
+                }
+            }
+            std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.cost < b.cost; });
+
+            for (uint32_t v = 0; v < vertexCount; v++)
+            {
+                collapseTo[v] = v;
+            }
+            touched.assign(vertexCount, false);
+
+            const uint32_t requiredRemovals = triangleCount - targetTriangleCount;
+            uint32_t removed = 0;
+            for (const auto& c : collapses)
+            {
+                if (removed >= requiredRemovals) break;
+                if (touched[c.from] || touched[c.to]) continue;
+
+                const uint32_t* pTriangles = vertexTriangles.data() + triangleOffsets[c.from];
+                uint32_t adjacentCount = triangleOffsets[c.from + 1] - triangleOffsets[c.from];
+                if (collapseFlipsTriangle(pPositions, result, pTriangles, adjacentCount, c.from, c.to)) continue;
+
+                // The neighborhood of 'from' changes, so don't touch it again in this pass
+                for (uint32_t t = 0; t < adjacentCount; t++)
+                {
+                    bool containsTo = false;
+                    for (uint32_t i = 0; i < 3; i++)
+                    {
+                        uint32_t v = result[pTriangles[t] * 3 + i];
+                        touched[v] = true;
+                        containsTo = containsTo || (v == c.to);
+                    }
+                    if (containsTo) removed++;
+                }
+
+                collapseTo[c.from] = c.to;
+                quadrics[remap[c.to]] += quadrics[remap[c.from]];
+                maxCost = std::max(maxCost, c.cost);
+            }
+
+            if (removed == 0) break;
+
+            // Apply the collapses and remove the degenerate triangles
+            size_t writeOffset = 0;
+            for (size_t t = 0; t < result.size(); t += 3)
+            {
+                uint32_t i0 = collapseTo[result[t]];
+                uint32_t i1 = collapseTo[result[t + 1]];
+                uint32_t i2 = collapseTo[result[t + 2]];
+                if (i0 == i1 || i1 == i2 || i0 == i2) continue;
+                result[writeOffset++] = i0;
+                result[writeOffset++] = i1;
+                result[writeOffset++] = i2;
+            }
+            result.resize(writeOffset);
+            triangleCount = uint32_t(result.size() / 3);
+        }
+
+        error = float(std::sqrt(maxCost));
+        return result;
+    }
+
+    std::vector<MeshSimplifier::Lod> MeshSimplifier::generateLodChain(const glm::vec3* pPositions, uint32_t vertexCount, const std::vector<uint32_t>& indices, const Desc& desc)
+    {
+        std::vector<Lod> lods;
+        if (indices.size() < 3 || indices.size() % 3 != 0) return lods;
+
+        std::string cacheFile;
+        if (desc.useCache)
+        {
+            cacheFile = getCacheFilename(pPositions, vertexCount, indices, desc);
+            if (loadFromCache(cacheFile, vertexCount, lods)) return lods;
+        }
+
+        for (uint32_t level = 0; level < desc.maxLodCount; level++)
+        {
+            const std::vector<uint32_t>& prevIndices = lods.empty() ? indices : lods.back().indices;
+            const float prevError = lods.empty() ? 0.0f : lods.back().error;
+            const uint32_t prevTriangleCount = uint32_t(prevIndices.size() / 3);
+            const uint32_t targetTriangleCount = uint32_t(prevTriangleCount * desc.reductionPerLod);
+            if (targetTriangleCount < desc.minTriangleCount) break;
+
+            Lod lod;
+            float error;
+            lod.indices = simplify(pPositions, vertexCount, prevIndices, targetTriangleCount, error);
+
+            // Stop once the simplifier can't make meaningful progress, usually because the remaining vertices are locked
+            if (lod.indices.size() / 3 > prevTriangleCount * 9 / 10) break;
+
+            // The errors of consecutive levels add up, since each level is simplified from the previous one
+            lod.error = prevError + error;
+            lods.push_back(std::move(lod));
+        }
+
+        if (cacheFile.size())
+        {
+            saveToCache(cacheFile, lods);
+        }
+        return lods;
+    }
+
+    std::string MeshSimplifier::getCacheFilename(const glm::vec3* pPositions, uint32_t vertexCount, const std::vector<uint32_t>& indices, const Desc& desc)
+    {
+        std::string directory = desc.cacheDirectory.empty() ? getExecutableDirectory() + "/MeshCache" : desc.cacheDirectory;
+        if (isDirectoryExists(directory) == false && createDirectory(directory) == false)
+        {
+            logWarning("MeshSimplifier: can't create cache directory '" + directory + "'. LODs will not be cached.");
+            return "";
+        }
+
+        uint64_t hash = kFnv1aOffsetBasis;
+        hash = hashBytes(hash, &kCacheVersion, sizeof(kCacheVersion));
+        hash = hashBytes(hash, &vertexCount, sizeof(vertexCount));
+        hash = hashBytes(hash, pPositions, sizeof(glm::vec3) * vertexCount);
+        hash = hashBytes(hash, indices.data(), sizeof(uint32_t) * indices.size());
+        hash = hashBytes(hash, &desc.maxLodCount, sizeof(desc.maxLodCount));
+        hash = hashBytes(hash, &desc.reductionPerLod, sizeof(desc.reductionPerLod));
+        hash = hashBytes(hash, &desc.minTriangleCount, sizeof(desc.minTriangleCount));
+        return directory + "/" + std::to_string(hash) + ".flod";
+    }
+
+    bool MeshSimplifier::loadFromCache(const std::string& filename, uint32_t vertexCount, std::vector<Lod>& lods)
+    {
+        if (filename.empty() || doesFileExist(filename) == false) return false;
+
+        std::ifstream stream(filename, std::ios::binary);
+        uint32_t header[3] = {};    // Magic, version, LOD count
+        stream.read((char*)header, sizeof(header));
+        if (stream.good() == false || header[0] != kCacheMagic || header[1] != kCacheVersion || header[2] > kMaxCachedLods)
+        {
+            logWarning("MeshSimplifier: ignoring invalid LOD cache file '" + filename + "'.");
+            return false;
+        }
+
+        bool valid = true;
+        lods.resize(header[2]);
+        for (auto& lod : lods)
+        {
+            uint32_t indexCount = 0;
+            stream.read((char*)&lod.error, sizeof(lod.error));
+            stream.read((char*)&indexCount, sizeof(indexCount));
+            valid = stream.good() && (indexCount % 3 == 0);
+            if (valid == false) break;
+
+            lod.indices.resize(indexCount);
+            stream.read((char*)lod.indices.data(), indexCount * sizeof(uint32_t));
+            valid = stream.good() && std::none_of(lod.indices.begin(), lod.indices.end(), [vertexCount](uint32_t i) { return i >= vertexCount; });
+            if (valid == false) break;
+        }
+
+        if (valid == false)
+        {
+            logWarning("MeshSimplifier: ignoring invalid LOD cache file '" + filename + "'.");
+            lods.clear();
+            return false;
+        }
+        return true;
+    }
+
+    void MeshSimplifier::saveToCache(const std::string& filename, const std::vector<Lod>& lods)
+    {
+        // Write through a temporary file, so that a partially written file is never picked up
+        bool written = writeFileAtomic(filename, [&](std::ostream& stream)
+        {
+            uint32_t header[3] = { kCacheMagic, kCacheVersion, uint32_t(lods.size()) };
+            stream.write((const char*)header, sizeof(header));
+            for (const auto& lod : lods)
+            {
+                uint32_t indexCount = uint32_t(lod.indices.size());
+                stream.write((const char*)&lod.error, sizeof(lod.error));
+                stream.write((const char*)&indexCount, sizeof(indexCount));
+                stream.write((const char*)lod.indices.data(), indexCount * sizeof(uint32_t));
+            }
+            return true;
+        });
+        if (written == false) logWarning("MeshSimplifier: can't write LOD cache file '" + filename + "'.");
+    }
+}
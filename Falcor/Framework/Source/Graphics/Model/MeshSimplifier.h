@@ -0,0 +1,81 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <string>
+#include <vector>
+#include "glm/vec3.hpp"
+
+namespace Falcor
+{
+    /** Builds levels-of-detail for triangle meshes using quadric error metrics.
+        Simplification is done by half-edge collapses, so every LOD references the vertices of the original mesh and only needs its own index buffer.
+        Vertices on open borders and on attribute seams (vertices sharing a position with another vertex) are never moved.
+    */
+    class MeshSimplifier
+    {
+    public:
+        struct Desc
+        {
+            uint32_t maxLodCount = 4;           ///< Maximum number of LODs to generate, not counting the original mesh
+            float reductionPerLod = 0.5f;       ///< Target triangle count of each LOD relative to the previous one
+            uint32_t minTriangleCount = 64;     ///< Don't generate LODs with less triangles than this
+            bool useCache = true;               ///< Load and store the generated LODs in the cache directory
+            std::string cacheDirectory;         ///< Where generated LODs are stored. If empty, uses '<executable directory>/MeshCache'
+        };
+
+        struct Lod
+        {
+            std::vector<uint32_t> indices;      ///< Triangle-list indices into the original vertex buffer
+            float error = 0;                    ///< Estimated object-space distance between this LOD and the original surface
+        };
+
+        /** Generate a LOD chain for a triangle mesh. Generation stops when Desc::maxLodCount is reached, the triangle count drops below Desc::minTriangleCount or a level can't be reduced any further.
+            \param[in] pPositions The vertex positions
+            \param[in] vertexCount Number of vertices
+            \param[in] indices Triangle-list indices of the original mesh
+            \param[in] desc Generation settings
+            \return The LODs, ordered from finest to coarsest. Doesn't include the original mesh.
+        */
+        static std::vector<Lod> generateLodChain(const glm::vec3* pPositions, uint32_t vertexCount, const std::vector<uint32_t>& indices, const Desc& desc = Desc());
+
+        /** Simplify a triangle mesh
+            \param[in] pPositions The vertex positions
+            \param[in] vertexCount Number of vertices
+            \param[in] indices Triangle-list indices of the mesh
+            \param[in] targetTriangleCount The requested number of triangles. The result may contain more triangles if the mesh can't be simplified further.
+            \param[out] error The geometric error introduced by this simplification
+            \return The indices of the simplified mesh
+        */
+        static std::vector<uint32_t> simplify(const glm::vec3* pPositions, uint32_t vertexCount, const std::vector<uint32_t>& indices, uint32_t targetTriangleCount, float& error);
+
+    private:
+        static std::string getCacheFilename(const glm::vec3* pPositions, uint32_t vertexCount, const std::vector<uint32_t>& indices, const Desc& desc);
+        static bool loadFromCache(const std::string& filename, uint32_t vertexCount, std::vector<Lod>& lods);
+        static void saveToCache(const std::string& filename, const std::vector<Lod>& lods);
+    };
+}
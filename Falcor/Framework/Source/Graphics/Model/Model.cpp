@@ -68,6 +68,7 @@ namespace Falcor
         mVertexCount = other.mVertexCount;
         mIndexCount = other.mIndexCount;
         mPrimitiveCount = other.mPrimitiveCount;
+        mUniquePrimitiveCount = other.mUniquePrimitiveCount;
         mMeshInstanceCount = other.mMeshInstanceCount;
         mBufferCount = other.mBufferCount;
         mMaterialCount = other.mMaterialCount;
@@ -137,6 +138,7 @@ namespace Falcor
         mVertexCount = 0;
         mIndexCount = 0;
         mPrimitiveCount = 0;
+        mUniquePrimitiveCount = 0;
         mMeshInstanceCount = 0;
         mBufferCount = 0;
         mMaterialCount = 0;
@@ -162,6 +164,7 @@ namespace Falcor
             mVertexCount += pMesh->getVertexCount() * instanceCount;
             mIndexCount += pMesh->getIndexCount() * instanceCount;
             mPrimitiveCount += pMesh->getPrimitiveCount() * instanceCount;
+            mUniquePrimitiveCount += pMesh->getPrimitiveCount();
             mMeshInstanceCount += instanceCount;
 
             const Material* pMaterial = pMesh->getMaterial().get();
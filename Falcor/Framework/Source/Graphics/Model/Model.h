@@ -67,6 +67,10 @@ namespace Falcor
             BuffersAsShaderResource     = 0x10,   ///< Generate the VBs and IB with the shader-resource-view bind flag
             RemoveInstancing            = 0x20,   ///< Flatten mesh instances
             UseSpecGlossMaterials       = 0x40,   ///< Set materials to use Spec-Gloss shading model. Otherwise default is Metal-Rough.
+            StreamTextures              = 0x80,   ///< Load textures through the global TextureStreamer. Only the mip-tail is loaded, higher resolution mips are streamed on demand.
+            DetectInstancing            = 0x100,  ///< Find meshes with identical geometry up to a rigid transform and turn them into instances of a single mesh. Overrides RemoveInstancing.
+            GenerateLods                = 0x200,  ///< Generate a chain of simplified LODs for each static triangle mesh. The LODs are stored in a cache directory, so they are only generated once.
+            StreamGeometry              = 0x400,  ///< Split static triangle meshes into clusters which are paged in and out by the global GeometryStreamer. Non-resident clusters are drawn with a proxy. Overrides GenerateLods for streamed meshes.
         };
 
         /** Create a new model from file
@@ -107,6 +111,10 @@ namespace Falcor
         */
         uint32_t getPrimitiveCount() const { return mPrimitiveCount; }
 
+        /** Get the number of primitives in the model, counting each instanced mesh once.
+        */
+        uint32_t getUniquePrimitiveCount() const { return mUniquePrimitiveCount; }
+
         /** Get the number of meshes in the model.
         */
         uint32_t getMeshCount() const { return uint32_t(mMeshes.size()); }
@@ -187,7 +195,7 @@ namespace Falcor
         void setAnimationController(AnimationController::UniquePtr pAnimController);
 
         /** Attach a skinning cache to the model, or nullptr to detach.
-            When a cache is attached, the model will use compute shader based skinning with caching of the resulting skinned vertex buffers.
+            When a cache is attached, the model will use compute shader (or CPU, see SkinningCache::Mode) based skinning with caching of the resulting skinned vertex buffers.
         */
         void attachSkinningCache(SkinningCache::SharedPtr pSkinningCache);
 
@@ -268,6 +276,7 @@ namespace Falcor
         uint32_t mVertexCount;
         uint32_t mIndexCount;
         uint32_t mPrimitiveCount;
+        uint32_t mUniquePrimitiveCount;
         uint32_t mMeshInstanceCount;
         uint32_t mBufferCount;
         uint32_t mMaterialCount;
@@ -303,6 +312,10 @@ namespace Falcor
             flag_str(BuffersAsShaderResource);
             flag_str(RemoveInstancing);            
             flag_str(UseSpecGlossMaterials);
+            flag_str(StreamTextures);
+            flag_str(DetectInstancing);
+            flag_str(GenerateLods);
+            flag_str(StreamGeometry);
         default:
             should_not_get_here();
             return "";
@@ -30,6 +30,11 @@
 #include "API/Device.h"
 #include "Data/VertexAttrib.h"
 #include "Graphics/Model/Model.h"
+#include <emmintrin.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
 
 namespace Falcor
 {
@@ -39,14 +44,32 @@ namespace Falcor
 
     static const uint32_t kGroupSize = 256;     // threads per group
 
-    SkinningCache::SharedPtr SkinningCache::create()
+    // CPU skinning splits the meshes into jobs of this many vertices, which are distributed between the threads
+    static const uint32_t kCpuVerticesPerJob = 16 * 1024;
+
+    SkinningCache::SharedPtr SkinningCache::create(Mode mode)
     {
-        SharedPtr ptr = SharedPtr(new SkinningCache());
+        SharedPtr ptr = SharedPtr(new SkinningCache(mode));
         return ptr->init() ? ptr : nullptr;
     }
 
+    SkinningCache::~SkinningCache()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mWorkerMutex);
+            mStopWorkers = true;
+        }
+        mWorkerCondition.notify_all();
+        for (auto& t : mWorkers) t.join();
+    }
+
     bool SkinningCache::update(const Model* pModel)
     {
+        if (mMode == Mode::Cpu)
+        {
+            return updateCpu(pModel);
+        }
+
         bool changed = false;
         if (pModel->hasBones())
         {
@@ -82,8 +105,20 @@ namespace Falcor
         return changed;
     }
 
-    Vao::SharedPtr SkinningCache::getVao(const Mesh* pMesh) const
+    Vao::SharedPtr SkinningCache::getVao(const Mesh* pMesh)
     {
+        // The CPU path uploads only when the vertex buffers are used
+        if (mMode == Mode::Cpu)
+        {
+            auto cpuIt = mCpuMeshes.find(pMesh);
+            if (cpuIt == mCpuMeshes.end() || cpuIt->second.valid == false) return nullptr;
+            if (cpuIt->second.uploaded == false)
+            {
+                uploadCpuVertices(pMesh, cpuIt->second.skinned);
+                cpuIt->second.uploaded = true;
+            }
+        }
+
         auto it = mSkinnedBuffers.find(pMesh);
         if (it != mSkinnedBuffers.end())
         {
@@ -92,8 +127,25 @@ namespace Falcor
         return nullptr;
     }
 
+    const SkinningCache::CpuVertices* SkinningCache::getCpuVertices(const Mesh* pMesh) const
+    {
+        auto it = mCpuMeshes.find(pMesh);
+        return (it != mCpuMeshes.end() && it->second.valid) ? &it->second.skinned : nullptr;
+    }
+
     bool SkinningCache::init()
     {
+        // The CPU path doesn't need the compute pass, but threads to share the work with the calling thread
+        if (mMode == Mode::Cpu)
+        {
+            uint32_t workerCount = std::max(1u, std::thread::hardware_concurrency()) - 1;
+            for (uint32_t i = 0; i < workerCount; i++)
+            {
+                mWorkers.emplace_back(&SkinningCache::workerThreadFunc, this);
+            }
+            return true;
+        }
+
         // Create shaders
         mSkinningPass.pProgram = ComputeProgram::createFromFile(kShaderFilenameSkinning, "main");
         assert(mSkinningPass.pProgram);
@@ -303,4 +355,349 @@ namespace Falcor
 
         it->second.valid = true;
     }
-}
\ No newline at end of file
+
+    namespace
+    {
+        /** Reads vertex attributes back from the GPU.
+            All the attributes are copied into one transient readback buffer, so there's a single wait for the GPU, and the vertex buffers don't get staging copies like with Buffer::map().
+        */
+        class VertexReadback
+        {
+        public:
+            VertexReadback(const Vao* pVao, uint32_t vertexCount) : mpVao(pVao), mVertexCount(vertexCount) {}
+
+            /** Add an attribute to read. data is resized to the vertex count, and filled by read().
+                \return false if the VAO doesn't have the attribute
+            */
+            template<typename T>
+            bool add(uint32_t vertexLoc, std::vector<T>& data)
+            {
+                const auto& elemDesc = mpVao->getElementIndexByLocation(vertexLoc);
+                if (elemDesc.elementIndex == Vao::ElementDesc::kInvalidIndex) return false;
+
+                // The vertex buffers hold a single attribute each, like the compute shader assumes
+                assert(elemDesc.elementIndex == 0);
+                const Buffer* pBuffer = mpVao->getVertexBuffer(elemDesc.vbIndex).get();
+                assert(pBuffer->getSize() >= mVertexCount * sizeof(T));
+
+                data.resize(mVertexCount);
+                mAttribs.push_back({ pBuffer, data.data(), mVertexCount * sizeof(T) });
+                return true;
+            }
+
+            /** Copy the attributes to the readback buffer, wait for the GPU and fill the vectors passed to add()
+            */
+            void read()
+            {
+                if (mAttribs.empty()) return;
+
+                std::vector<uint64_t> offsets;
+                uint64_t size = 0;
+                for (const Attrib& attrib : mAttribs)
+                {
+                    offsets.push_back(size);
+                    size += align_to(16, attrib.size);
+                }
+
+                Buffer::SharedPtr pReadback = Buffer::create(size, Resource::BindFlags::None, Buffer::CpuAccess::Read);
+                RenderContext* pRenderContext = gpDevice->getRenderContext().get();
+                for (size_t i = 0; i < mAttribs.size(); i++)
+                {
+                    pRenderContext->copyBufferRegion(pReadback.get(), offsets[i], mAttribs[i].pBuffer, 0, mAttribs[i].size);
+                }
+                pRenderContext->flush(true);
+
+                const uint8_t* pData = (const uint8_t*)pReadback->map(Buffer::MapType::Read);
+                for (size_t i = 0; i < mAttribs.size(); i++)
+                {
+                    std::memcpy(mAttribs[i].pDst, pData + offsets[i], mAttribs[i].size);
+                }
+                pReadback->unmap();
+                mAttribs.clear();
+            }
+
+        private:
+            struct Attrib
+            {
+                const Buffer* pBuffer;
+                void* pDst;
+                size_t size;
+            };
+            const Vao* mpVao;
+            uint32_t mVertexCount;
+            std::vector<Attrib> mAttribs;
+        };
+
+        void writeVertexBuffer(const Vao* pVao, uint32_t vertexLoc, const std::vector<glm::vec3>& data)
+        {
+            const auto& elemDesc = pVao->getElementIndexByLocation(vertexLoc);
+            if (elemDesc.elementIndex == Vao::ElementDesc::kInvalidIndex || data.empty()) return;
+            pVao->getVertexBuffer(elemDesc.vbIndex)->updateData(data.data(), 0, data.size() * sizeof(glm::vec3));
+        }
+
+        // Largest difference between GPU vertices and the CPU results, relative to the attribute's length when it's larger than 1
+        float compareVertices(const std::vector<glm::vec3>& gpuData, const std::vector<glm::vec3>& cpuData)
+        {
+            float maxError = 0;
+            for (size_t i = 0; i < cpuData.size(); i++)
+            {
+                float error = glm::length(cpuData[i] - gpuData[i]) / std::max(glm::length(gpuData[i]), 1.0f);
+                maxError = std::max(maxError, error);
+            }
+            return maxError;
+        }
+
+        inline __m128 loadColumn(const glm::mat4& m, uint32_t column)
+        {
+            return _mm_loadu_ps(&m[column][0]);
+        }
+
+        /** Blend the first columnCount columns of the 4 bone matrices of a vertex.
+            The order of operations is the same as in ComputeSkinning.cs.slang.
+        */
+        inline void blendBoneMatrices(const glm::mat4* pMats, const uint32_t boneIds[4], const __m128 weights[4], uint32_t columnCount, __m128* pColumns)
+        {
+            for (uint32_t c = 0; c < columnCount; c++)
+            {
+                __m128 column = _mm_mul_ps(loadColumn(pMats[boneIds[0]], c), weights[0]);
+                column = _mm_add_ps(column, _mm_mul_ps(loadColumn(pMats[boneIds[1]], c), weights[1]));
+                column = _mm_add_ps(column, _mm_mul_ps(loadColumn(pMats[boneIds[2]], c), weights[2]));
+                column = _mm_add_ps(column, _mm_mul_ps(loadColumn(pMats[boneIds[3]], c), weights[3]));
+                pColumns[c] = column;
+            }
+        }
+
+        // Multiply a vector by the upper 3x3 of a matrix given by its columns
+        inline __m128 transformVector(const __m128* pColumns, const glm::vec3& v)
+        {
+            __m128 result = _mm_mul_ps(pColumns[0], _mm_set1_ps(v.x));
+            result = _mm_add_ps(result, _mm_mul_ps(pColumns[1], _mm_set1_ps(v.y)));
+            return _mm_add_ps(result, _mm_mul_ps(pColumns[2], _mm_set1_ps(v.z)));
+        }
+
+        inline glm::vec3 toVec3(__m128 v)
+        {
+            float f[4];
+            _mm_storeu_ps(f, v);
+            return glm::vec3(f[0], f[1], f[2]);
+        }
+    }
+
+    void SkinningCache::skinVertices(CpuMesh& cpuMesh, const glm::mat4* pBoneMats, const glm::mat4* pInvTransposeBoneMats, uint32_t firstVertex, uint32_t endVertex)
+    {
+        const Mesh::SkinningSource& source = *cpuMesh.pSource;
+        bool hasNormal = source.normals.empty() == false;
+        bool hasBitangent = source.bitangents.empty() == false;
+        CpuVertices& skinned = cpuMesh.skinned;
+
+        for (uint32_t v = firstVertex; v < endVertex; v++)
+        {
+            uint32_t packedIds = source.boneIds[v];
+            const uint32_t boneIds[4] = { packedIds & 0xff, (packedIds >> 8) & 0xff, (packedIds >> 16) & 0xff, packedIds >> 24 };
+            const glm::vec4& w = source.boneWeights[v];
+            const __m128 weights[4] = { _mm_set1_ps(w.x), _mm_set1_ps(w.y), _mm_set1_ps(w.z), _mm_set1_ps(w.w) };
+
+            __m128 boneMat[4];
+            blendBoneMatrices(pBoneMats, boneIds, weights, 4, boneMat);
+            skinned.positions[v] = toVec3(_mm_add_ps(transformVector(boneMat, source.positions[v]), boneMat[3]));
+
+            if (hasNormal)
+            {
+                __m128 invTransposeBoneMat[3];
+                blendBoneMatrices(pInvTransposeBoneMats, boneIds, weights, 3, invTransposeBoneMat);
+                skinned.normals[v] = toVec3(transformVector(invTransposeBoneMat, source.normals[v]));
+            }
+
+            if (hasBitangent)
+            {
+                skinned.bitangents[v] = toVec3(transformVector(boneMat, source.bitangents[v]));
+            }
+        }
+    }
+
+    bool SkinningCache::readCpuMesh(const Mesh* pMesh, CpuMesh& cpuMesh)
+    {
+        // Use the vertices kept by the importer. Otherwise, read back the vertex buffers, which needs a device.
+        uint32_t vertexCount = pMesh->getVertexCount();
+        cpuMesh.pSource = pMesh->getSkinningSource();
+        if (cpuMesh.pSource == nullptr)
+        {
+            auto pSource = std::make_shared<Mesh::SkinningSource>();
+            VertexReadback readback(pMesh->getVao().get(), vertexCount);
+            bool hasPos = readback.add(VERTEX_POSITION_LOC, pSource->positions);
+            bool hasBoneWeight = readback.add(VERTEX_BONE_WEIGHT_LOC, pSource->boneWeights);
+            bool hasBoneId = readback.add(VERTEX_BONE_ID_LOC, pSource->boneIds);
+            if (hasPos && hasBoneWeight && hasBoneId)
+            {
+                readback.add(VERTEX_NORMAL_LOC, pSource->normals);
+                readback.add(VERTEX_BITANGENT_LOC, pSource->bitangents);
+                readback.read();
+            }
+            cpuMesh.pSource = pSource;
+        }
+
+        const Mesh::SkinningSource& source = *cpuMesh.pSource;
+        if (source.positions.size() != vertexCount || source.boneWeights.size() != vertexCount || source.boneIds.size() != vertexCount)
+        {
+            logError("SkinningCache: can't skin a mesh without positions, bone weights or bone IDs on the CPU");
+            return false;
+        }
+
+        cpuMesh.skinned.positions.resize(vertexCount);
+        cpuMesh.skinned.prevPositions.resize(vertexCount);
+        if (source.normals.empty() == false) cpuMesh.skinned.normals.resize(vertexCount);
+        if (source.bitangents.empty() == false) cpuMesh.skinned.bitangents.resize(vertexCount);
+        return true;
+    }
+
+    void SkinningCache::uploadCpuVertices(const Mesh* pMesh, const CpuVertices& vertices)
+    {
+        createVertexBuffers(pMesh);
+        const Vao* pVao = mSkinnedBuffers[pMesh].pVao.get();
+        writeVertexBuffer(pVao, VERTEX_POSITION_LOC, vertices.positions);
+        writeVertexBuffer(pVao, VERTEX_PREV_POSITION_LOC, vertices.prevPositions);
+        writeVertexBuffer(pVao, VERTEX_NORMAL_LOC, vertices.normals);
+        writeVertexBuffer(pVao, VERTEX_BITANGENT_LOC, vertices.bitangents);
+    }
+
+    bool SkinningCache::updateCpu(const Model* pModel)
+    {
+        if (pModel->hasBones() == false) return false;
+
+        struct Job
+        {
+            CpuMesh* pCpuMesh;
+            uint32_t firstVertex;
+            uint32_t endVertex;
+        };
+        std::vector<Job> jobs;
+        std::vector<std::pair<const Mesh*, CpuMesh*>> meshes;
+
+        for (uint32_t meshId = 0; meshId < pModel->getMeshCount(); meshId++)
+        {
+            const Mesh* pMesh = pModel->getMesh(meshId).get();
+            if (pMesh->hasBones() == false) continue;
+
+            // The mesh's source vertices are fetched the first time only
+            auto it = mCpuMeshes.find(pMesh);
+            if (it == mCpuMeshes.end())
+            {
+                CpuMesh cpuMesh;
+                if (readCpuMesh(pMesh, cpuMesh) == false) continue;
+                it = mCpuMeshes.emplace(pMesh, std::move(cpuMesh)).first;
+            }
+
+            // Like the compute shader, keep the previous positions, or use the current ones on the first frame
+            CpuMesh& cpuMesh = it->second;
+            std::swap(cpuMesh.skinned.positions, cpuMesh.skinned.prevPositions);
+            meshes.push_back({ pMesh, &cpuMesh });
+
+            for (uint32_t first = 0; first < pMesh->getVertexCount(); first += kCpuVerticesPerJob)
+            {
+                jobs.push_back({ &cpuMesh, first, std::min(first + kCpuVerticesPerJob, pMesh->getVertexCount()) });
+            }
+        }
+
+        const glm::mat4* pBoneMats = pModel->getBoneMatrices();
+        const glm::mat4* pInvTransposeBoneMats = pModel->getBoneInvTransposeMatrices();
+        std::atomic<uint32_t> nextJob(0);
+        runOnWorkers([&]()
+        {
+            for (uint32_t i = nextJob++; i < jobs.size(); i = nextJob++)
+            {
+                skinVertices(*jobs[i].pCpuMesh, pBoneMats, pInvTransposeBoneMats, jobs[i].firstVertex, jobs[i].endVertex);
+            }
+        });
+
+        for (auto& mesh : meshes)
+        {
+            CpuMesh& cpuMesh = *mesh.second;
+            if (cpuMesh.valid == false)
+            {
+                cpuMesh.skinned.prevPositions = cpuMesh.skinned.positions;
+                cpuMesh.valid = true;
+            }
+            cpuMesh.uploaded = false;
+        }
+        return meshes.empty() == false;
+    }
+
+    void SkinningCache::runOnWorkers(const std::function<void()>& func)
+    {
+        if (mWorkers.empty())
+        {
+            func();
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mWorkerMutex);
+            mpWorkerFunc = &func;
+            mWorkerGeneration++;
+            mBusyWorkerCount = (uint32_t)mWorkers.size();
+        }
+        mWorkerCondition.notify_all();
+        func();
+
+        // func references the caller's state, so wait until no worker runs it anymore
+        std::unique_lock<std::mutex> lock(mWorkerMutex);
+        mWorkerDoneCondition.wait(lock, [this] { return mBusyWorkerCount == 0; });
+        mpWorkerFunc = nullptr;
+    }
+
+    void SkinningCache::workerThreadFunc()
+    {
+        uint64_t generation = 0;
+        std::unique_lock<std::mutex> lock(mWorkerMutex);
+        while (true)
+        {
+            mWorkerCondition.wait(lock, [&] { return mStopWorkers || mWorkerGeneration != generation; });
+            if (mStopWorkers) return;
+            generation = mWorkerGeneration;
+            const std::function<void()>* pFunc = mpWorkerFunc;
+
+            lock.unlock();
+            (*pFunc)();
+            lock.lock();
+            if (--mBusyWorkerCount == 0) mWorkerDoneCondition.notify_one();
+        }
+    }
+
+    bool SkinningCache::validateCpuSkinning(const Model* pModel, float tolerance)
+    {
+        SharedPtr pGpuCache = create(Mode::Gpu);
+        SharedPtr pCpuCache = create(Mode::Cpu);
+        if (!pGpuCache || !pCpuCache || !pModel->hasBones()) return false;
+
+        pGpuCache->update(pModel);
+        pCpuCache->update(pModel);
+
+        float maxError = 0;
+        for (uint32_t meshId = 0; meshId < pModel->getMeshCount(); meshId++)
+        {
+            const Mesh* pMesh = pModel->getMesh(meshId).get();
+            if (pMesh->hasBones() == false) continue;
+
+            const CpuVertices* pCpuVertices = pCpuCache->getCpuVertices(pMesh);
+            const Vao* pGpuVao = pGpuCache->getVao(pMesh).get();
+            if (!pCpuVertices || !pGpuVao) return false;
+
+            CpuVertices gpuVertices;
+            VertexReadback readback(pGpuVao, pMesh->getVertexCount());
+            bool hasPos = readback.add(VERTEX_POSITION_LOC, gpuVertices.positions);
+            bool hasPrevPos = readback.add(VERTEX_PREV_POSITION_LOC, gpuVertices.prevPositions);
+            bool hasNormal = readback.add(VERTEX_NORMAL_LOC, gpuVertices.normals);
+            bool hasBitangent = readback.add(VERTEX_BITANGENT_LOC, gpuVertices.bitangents);
+            if (!hasPos || !hasPrevPos || hasNormal == pCpuVertices->normals.empty() || hasBitangent == pCpuVertices->bitangents.empty()) return false;
+            readback.read();
+
+            maxError = std::max(maxError, compareVertices(gpuVertices.positions, pCpuVertices->positions));
+            maxError = std::max(maxError, compareVertices(gpuVertices.prevPositions, pCpuVertices->prevPositions));
+            maxError = std::max(maxError, compareVertices(gpuVertices.normals, pCpuVertices->normals));
+            maxError = std::max(maxError, compareVertices(gpuVertices.bitangents, pCpuVertices->bitangents));
+        }
+
+        logInfo("SkinningCache: largest difference between CPU and GPU skinning is " + std::to_string(maxError));
+        return maxError <= tolerance;
+    }
+}
@@ -27,12 +27,17 @@
 ***************************************************************************/
 #pragma once
 #include <map>
+#include <vector>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include "API/RenderContext.h"
+#include "Graphics/Model/Mesh.h"
 
 namespace Falcor
 {
     class Model;
-    class Mesh;
 
     /** Cache for skinned vertex buffers for one or more models.
 
@@ -41,6 +46,10 @@ namespace Falcor
         It also allows updating skinning at a lower frequency than the frame rate,
         and it simplifies the scene renderer as it does not have to deal with skinning.
 
+        With Mode::Cpu, the skinning is done on the CPU instead, and the skinned vertices are kept in CPU memory for CPU-side consumers
+        (e.g., a CPU BVH refit). They are uploaded to the skinned vertex buffers when getVao() is called, so a cache whose users only need the CPU
+        vertices skins without a device when the importer kept the meshes' vertices. The results match the compute shader within floating-point precision.
+
         TODOs:
 
         1)  The class handles skinning of positions, normals, and bitangents.
@@ -61,20 +70,54 @@ namespace Falcor
     public:
         using SharedPtr = std::shared_ptr<SkinningCache>;
         using SharedConstPtr = std::shared_ptr<const SkinningCache>;
-        virtual ~SkinningCache() = default;
+        virtual ~SkinningCache();
 
-        static SharedPtr create();
+        /** Where the vertices are skinned
+        */
+        enum class Mode
+        {
+            Gpu,    ///< Compute shader
+            Cpu,    ///< Worker threads, using SSE. The mesh vertices come from Mesh::getSkinningSource(), or are read back once if the importer didn't keep them. Skinned vertices are written to CPU memory.
+        };
+
+        /** Skinned vertices kept in CPU memory with Mode::Cpu. Normals and bitangents are empty if the mesh doesn't have them.
+        */
+        struct CpuVertices
+        {
+            std::vector<glm::vec3> positions;
+            std::vector<glm::vec3> prevPositions;
+            std::vector<glm::vec3> normals;
+            std::vector<glm::vec3> bitangents;
+        };
+
+        static SharedPtr create(Mode mode = Mode::Gpu);
 
         /** Create/update skinned vertex buffers for model.
         */
         bool update(const Model* pModel);
 
         /** Returns the vertex array object for pMesh containing skinned vertex buffers if it exists.
+            With Mode::Cpu, this uploads the vertices skinned since the last call.
+        */
+        Vao::SharedPtr getVao(const Mesh* pMesh);
+
+        /** Returns the skinned vertices of pMesh in CPU memory, or nullptr if the mesh wasn't skinned on the CPU.
         */
-        Vao::SharedPtr getVao(const Mesh* pMesh) const;
+        const CpuVertices* getCpuVertices(const Mesh* pMesh) const;
+
+        /** Get the skinning mode
+        */
+        Mode getMode() const { return mMode; }
+
+        /** Skin a model on both the CPU and the GPU, and compare the results.
+            \param[in] pModel A model with bones
+            \param[in] tolerance Largest accepted difference, relative to the length of the skinned attribute when it's larger than 1
+            \return Whether all the skinned attributes match. The largest difference is logged.
+        */
+        static bool validateCpuSkinning(const Model* pModel, float tolerance = 1e-4f);
 
     protected:
-        SkinningCache() = default;
+        SkinningCache(Mode mode) : mMode(mode) {}
 
         bool init();
         void initVariableOffsets(const ParameterBlockReflection* pBlock);
@@ -83,6 +126,14 @@ namespace Falcor
         void setPerModelData(const Model* pModel);
         void setPerMeshData(const Mesh* pMesh);
 
+        struct CpuMesh;
+        bool updateCpu(const Model* pModel);
+        bool readCpuMesh(const Mesh* pMesh, CpuMesh& cpuMesh);
+        void uploadCpuVertices(const Mesh* pMesh, const CpuVertices& vertices);
+        static void skinVertices(CpuMesh& cpuMesh, const glm::mat4* pBoneMats, const glm::mat4* pInvTransposeBoneMats, uint32_t firstVertex, uint32_t endVertex);
+        void runOnWorkers(const std::function<void()>& func);
+        void workerThreadFunc();
+
         struct VertexBuffers
         {
             Vao::SharedPtr pVao;
@@ -115,6 +166,29 @@ namespace Falcor
 
         std::map<const Mesh*, VertexBuffers> mSkinnedBuffers;
 
+        /** Input and output vertices of a mesh skinned on the CPU
+        */
+        struct CpuMesh
+        {
+            std::shared_ptr<const Mesh::SkinningSource> pSource;
+            CpuVertices skinned;
+            bool valid = false;
+            bool uploaded = false;      ///< Whether the skinned vertex buffers hold the current skinned vertices
+        };
+
+        Mode mMode;
+        std::map<const Mesh*, CpuMesh> mCpuMeshes;
+
+        // CPU skinning threads. They are created with the cache and wait for work between updates.
+        std::vector<std::thread> mWorkers;
+        std::mutex mWorkerMutex;
+        std::condition_variable mWorkerCondition;           ///< Signaled when work is posted or the workers must exit
+        std::condition_variable mWorkerDoneCondition;       ///< Signaled when the last busy worker is done
+        const std::function<void()>* mpWorkerFunc = nullptr;
+        uint64_t mWorkerGeneration = 0;                     ///< Incremented every time work is posted
+        uint32_t mBusyWorkerCount = 0;
+        bool mStopWorkers = false;
+
         struct
         {
             ComputeState::SharedPtr pState;
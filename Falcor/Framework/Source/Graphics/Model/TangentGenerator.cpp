@@ -0,0 +1,471 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "TangentGenerator.h"
+#include "Utils/CpuTimer.h"
+#include <emmintrin.h>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <thread>
+
+namespace Falcor
+{
+    namespace
+    {
+        // Threads are only worth spawning for large meshes
+        const size_t kMinTrianglesPerThread = 16 * 1024;
+
+        using MeshData = TangentGenerator::MeshData;
+
+        bool isSpecialFloat(float f)
+        {
+            uint32_t d = *(uint32_t*)&f;
+            // Check the exponent
+            d = (d >> 23) & 0xff;
+            return d == 0xff;
+        }
+
+        bool isInvalidVec(const vec3& v)
+        {
+            return isSpecialFloat(v.x) || isSpecialFloat(v.y) || isSpecialFloat(v.z);
+        }
+
+        vec3 projectNormalToBitangent(const vec3& normal)
+        {
+            vec3 bitangent;
+            if (abs(normal.x) > abs(normal.y))
+            {
+                bitangent = vec3(normal.z, 0.f, -normal.x) / length(vec2(normal.x, normal.z));
+            }
+            else
+            {
+                bitangent = vec3(0.f, normal.z, -normal.y) / length(vec2(normal.y, normal.z));
+            }
+            return normalize(bitangent);
+        }
+
+        vec3 getPosition(const MeshData& mesh, uint32_t index)
+        {
+            const float* p = mesh.pPositions + size_t(index) * mesh.positionStride;
+            return vec3(p[0], p[1], p[2]);
+        }
+
+        vec2 getTexCrd(const MeshData& mesh, uint32_t index)
+        {
+            return mesh.pTexCrd ? mesh.pTexCrd[size_t(index) * mesh.texCrdStride] : vec2(0);
+        }
+
+        /** Compute the tangent and bitangent of a triangle
+            \return Whether the bitangent is valid
+        */
+        bool computeTriangleFrame(const MeshData& mesh, size_t primID, vec3& tangent, vec3& bitangent)
+        {
+            const uint32_t* pIndices = mesh.pIndices + primID * 3;
+            vec3 position[3];
+            vec2 uv[3];
+            for (uint32_t i = 0; i < 3; i++)
+            {
+                position[i] = getPosition(mesh, pIndices[i]);
+                uv[i] = getTexCrd(mesh, pIndices[i]);
+            }
+
+            // Position delta
+            vec3 posDelta[2];
+            posDelta[0] = position[1] - position[0];
+            posDelta[1] = position[2] - position[0];
+
+            // Texture offset
+            vec2 s = uv[1] - uv[0];
+            vec2 t = uv[2] - uv[0];
+
+            // when t1, t2, t3 in same position in UV space, just use default UV direction.
+            if ((s == vec2(0, 0)) || (t == vec2(0, 0)))
+            {
+                const vec3& normal = mesh.pNormals[pIndices[0]];
+                bitangent = projectNormalToBitangent(normal);
+                tangent = cross(bitangent, normal);
+            }
+            else
+            {
+                float dirCorrection = 1.0f / (s.x * t.y - s.y * t.x);
+
+                // tangent points in the direction where to positive X axis of the texture coord's would point in model space
+                // bitangent's points along the positive Y axis of the texture coord's, respectively
+                tangent = (posDelta[0] * t.y - posDelta[1] * t.x) * dirCorrection;
+                bitangent = (posDelta[1] * s.x - posDelta[0] * s.y) * dirCorrection;
+            }
+            return isInvalidVec(bitangent) == false;
+        }
+
+        // Project the triangle's tangent and bitangent into the plane formed by a vertex' normal
+        vec3 projectToVertex(const vec3& tangent, const vec3& bitangent, const vec3& normal)
+        {
+            vec3 localTangent = tangent - normal * (dot(tangent, normal));
+            localTangent = normalize(localTangent);
+            vec3 localBitangent = bitangent - normal * (dot(bitangent, normal));
+            localBitangent = normalize(localBitangent);
+            localBitangent = localBitangent - localTangent * (dot(localBitangent, localTangent));
+            localBitangent = normalize(localBitangent);
+            return normalize(localBitangent);
+        }
+
+        // Run func(threadIndex) on threadCount threads, including the calling thread
+        template<typename FuncType>
+        void parallelFor(uint32_t threadCount, const FuncType& func)
+        {
+            std::vector<std::thread> threads;
+            for (uint32_t i = 1; i < threadCount; i++)
+            {
+                threads.emplace_back(func, i);
+            }
+            func(0);
+            for (auto& t : threads) t.join();
+        }
+
+        // 4 vectors, one per SSE lane
+        struct Vec3x4
+        {
+            __m128 x, y, z;
+        };
+
+        inline Vec3x4 operator-(const Vec3x4& a, const Vec3x4& b) { return{ _mm_sub_ps(a.x, b.x), _mm_sub_ps(a.y, b.y), _mm_sub_ps(a.z, b.z) }; }
+        inline Vec3x4 operator*(const Vec3x4& a, __m128 s) { return{ _mm_mul_ps(a.x, s), _mm_mul_ps(a.y, s), _mm_mul_ps(a.z, s) }; }
+
+        // Same order of operations as glm, so that the results match the scalar code
+        inline __m128 dotX4(const Vec3x4& a, const Vec3x4& b)
+        {
+            return _mm_add_ps(_mm_add_ps(_mm_mul_ps(a.x, b.x), _mm_mul_ps(a.y, b.y)), _mm_mul_ps(a.z, b.z));
+        }
+
+        inline Vec3x4 normalizeX4(const Vec3x4& v)
+        {
+            __m128 invLength = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(dotX4(v, v)));
+            return v * invLength;
+        }
+
+        inline Vec3x4 crossX4(const Vec3x4& a, const Vec3x4& b)
+        {
+            return{
+                _mm_sub_ps(_mm_mul_ps(a.y, b.z), _mm_mul_ps(b.y, a.z)),
+                _mm_sub_ps(_mm_mul_ps(a.z, b.x), _mm_mul_ps(b.z, a.x)),
+                _mm_sub_ps(_mm_mul_ps(a.x, b.y), _mm_mul_ps(b.x, a.y)) };
+        }
+
+        inline Vec3x4 selectX4(__m128 mask, const Vec3x4& a, const Vec3x4& b)
+        {
+            return{
+                _mm_or_ps(_mm_and_ps(mask, a.x), _mm_andnot_ps(mask, b.x)),
+                _mm_or_ps(_mm_and_ps(mask, a.y), _mm_andnot_ps(mask, b.y)),
+                _mm_or_ps(_mm_and_ps(mask, a.z), _mm_andnot_ps(mask, b.z)) };
+        }
+
+        // All bits set in the lanes where the value is neither infinite nor NaN
+        inline __m128 isFinite(__m128 v)
+        {
+            const __m128i exponentMask = _mm_set1_epi32(0x7f800000);
+            __m128i exponent = _mm_and_si128(_mm_castps_si128(v), exponentMask);
+            return _mm_castsi128_ps(_mm_xor_si128(_mm_cmpeq_epi32(exponent, exponentMask), _mm_set1_epi32(-1)));
+        }
+
+        // SIMD version of projectNormalToBitangent()
+        inline Vec3x4 projectNormalToBitangentX4(const Vec3x4& n)
+        {
+            const __m128 zero = _mm_setzero_ps();
+            const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+            __m128 useX = _mm_cmpgt_ps(_mm_and_ps(n.x, absMask), _mm_and_ps(n.y, absMask));
+
+            __m128 lengthXZ = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(n.x, n.x), _mm_mul_ps(n.z, n.z)));
+            __m128 lengthYZ = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(n.y, n.y), _mm_mul_ps(n.z, n.z)));
+            Vec3x4 fromX = { _mm_div_ps(n.z, lengthXZ), _mm_div_ps(zero, lengthXZ), _mm_div_ps(_mm_sub_ps(zero, n.x), lengthXZ) };
+            Vec3x4 fromY = { _mm_div_ps(zero, lengthYZ), _mm_div_ps(n.z, lengthYZ), _mm_div_ps(_mm_sub_ps(zero, n.y), lengthYZ) };
+            return normalizeX4(selectX4(useX, fromX, fromY));
+        }
+    }
+
+    void TangentGenerator::computeCornerBitangents(const MeshData& mesh, size_t firstPrim, size_t endPrim, float* const* ppCorners)
+    {
+        // Stores the contribution of a triangle to one of its vertices. Contributions of invalid triangles are stored as 0.
+        auto storeScalar = [ppCorners](size_t primID, uint32_t corner, const vec3& v)
+        {
+            ppCorners[corner * 3 + 0][primID] = v.x;
+            ppCorners[corner * 3 + 1][primID] = v.y;
+            ppCorners[corner * 3 + 2][primID] = v.z;
+        };
+
+        const __m128 zero = _mm_setzero_ps();
+        size_t primID = firstPrim;
+        for (; primID + 4 <= endPrim; primID += 4)
+        {
+            // Gather the vertex data of 4 triangles into SoA form. Building the registers with _mm_setr_ps() rather than going through memory avoids store-forwarding stalls.
+            Vec3x4 p[3];
+            Vec3x4 n[3];
+            __m128 u[3];
+            __m128 v[3];
+            for (uint32_t i = 0; i < 3; i++)
+            {
+                uint32_t index[4];
+                const float* pPos[4];
+                vec2 uv[4];
+                for (uint32_t lane = 0; lane < 4; lane++)
+                {
+                    index[lane] = mesh.pIndices[(primID + lane) * 3 + i];
+                    pPos[lane] = mesh.pPositions + size_t(index[lane]) * mesh.positionStride;
+                    uv[lane] = getTexCrd(mesh, index[lane]);
+                }
+                const vec3* pN = mesh.pNormals;
+                p[i] = { _mm_setr_ps(pPos[0][0], pPos[1][0], pPos[2][0], pPos[3][0]), _mm_setr_ps(pPos[0][1], pPos[1][1], pPos[2][1], pPos[3][1]), _mm_setr_ps(pPos[0][2], pPos[1][2], pPos[2][2], pPos[3][2]) };
+                n[i] = { _mm_setr_ps(pN[index[0]].x, pN[index[1]].x, pN[index[2]].x, pN[index[3]].x), _mm_setr_ps(pN[index[0]].y, pN[index[1]].y, pN[index[2]].y, pN[index[3]].y), _mm_setr_ps(pN[index[0]].z, pN[index[1]].z, pN[index[2]].z, pN[index[3]].z) };
+                u[i] = _mm_setr_ps(uv[0].x, uv[1].x, uv[2].x, uv[3].x);
+                v[i] = _mm_setr_ps(uv[0].y, uv[1].y, uv[2].y, uv[3].y);
+            }
+
+            // Tangent frame from the UV gradients
+            Vec3x4 posDelta0 = p[1] - p[0];
+            Vec3x4 posDelta1 = p[2] - p[0];
+            __m128 sx = _mm_sub_ps(u[1], u[0]);
+            __m128 sy = _mm_sub_ps(v[1], v[0]);
+            __m128 tx = _mm_sub_ps(u[2], u[0]);
+            __m128 ty = _mm_sub_ps(v[2], v[0]);
+            __m128 dirCorrection = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sub_ps(_mm_mul_ps(sx, ty), _mm_mul_ps(sy, tx)));
+            Vec3x4 tangent = (posDelta0 * ty - posDelta1 * tx) * dirCorrection;
+            Vec3x4 bitangent = (posDelta1 * sx - posDelta0 * sy) * dirCorrection;
+
+            // Triangles without a UV gradient use a frame derived from the first vertex' normal
+            __m128 sIsZero = _mm_and_ps(_mm_cmpeq_ps(sx, zero), _mm_cmpeq_ps(sy, zero));
+            __m128 tIsZero = _mm_and_ps(_mm_cmpeq_ps(tx, zero), _mm_cmpeq_ps(ty, zero));
+            __m128 noGradient = _mm_or_ps(sIsZero, tIsZero);
+            if (_mm_movemask_ps(noGradient))
+            {
+                Vec3x4 defaultBitangent = projectNormalToBitangentX4(n[0]);
+                Vec3x4 defaultTangent = crossX4(defaultBitangent, n[0]);
+                bitangent = selectX4(noGradient, defaultBitangent, bitangent);
+                tangent = selectX4(noGradient, defaultTangent, tangent);
+            }
+
+            __m128 valid = _mm_and_ps(_mm_and_ps(isFinite(bitangent.x), isFinite(bitangent.y)), isFinite(bitangent.z));
+
+            // Project the frame onto each vertex' normal
+            for (uint32_t i = 0; i < 3; i++)
+            {
+                Vec3x4 localTangent = normalizeX4(tangent - n[i] * dotX4(tangent, n[i]));
+                Vec3x4 localBitangent = normalizeX4(bitangent - n[i] * dotX4(bitangent, n[i]));
+                localBitangent = normalizeX4(localBitangent - localTangent * dotX4(localBitangent, localTangent));
+                localBitangent = normalizeX4(localBitangent);
+
+                _mm_storeu_ps(&ppCorners[i * 3 + 0][primID], _mm_and_ps(localBitangent.x, valid));
+                _mm_storeu_ps(&ppCorners[i * 3 + 1][primID], _mm_and_ps(localBitangent.y, valid));
+                _mm_storeu_ps(&ppCorners[i * 3 + 2][primID], _mm_and_ps(localBitangent.z, valid));
+            }
+        }
+
+        // Remaining triangles
+        for (; primID < endPrim; primID++)
+        {
+            vec3 tangent, bitangent;
+            bool valid = computeTriangleFrame(mesh, primID, tangent, bitangent);
+            for (uint32_t i = 0; i < 3; i++)
+            {
+                const vec3& normal = mesh.pNormals[mesh.pIndices[primID * 3 + i]];
+                storeScalar(primID, i, valid ? projectToVertex(tangent, bitangent, normal) : vec3(0));
+            }
+        }
+    }
+
+    void TangentGenerator::generateBitangents(const MeshData& mesh, vec3* pBitangents, uint32_t threadCount)
+    {
+        size_t primCount = mesh.indexCount / 3;
+        if (threadCount == 0)
+        {
+            threadCount = (uint32_t)std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), primCount / kMinTrianglesPerThread);
+            threadCount = std::max(threadCount, 1u);
+        }
+
+        // Compute the contribution of each triangle to each of its vertices. Ranges are multiples of 4 triangles, so only the last thread has a scalar tail.
+        // Stored as 9 arrays, [corner * 3 + component][primID], so that the SIMD code can write 4 triangles at once. Every element is written, so the storage isn't initialized.
+        std::unique_ptr<float[]> pCornerStorage(new float[primCount * 9]);
+        float* corners[9];
+        for (uint32_t i = 0; i < 9; i++) corners[i] = pCornerStorage.get() + i * primCount;
+        size_t primsPerThread = ((primCount + threadCount - 1) / threadCount + 3) & ~size_t(3);
+        parallelFor(threadCount, [&](uint32_t threadIndex)
+        {
+            size_t first = std::min(primCount, threadIndex * primsPerThread);
+            size_t end = std::min(primCount, first + primsPerThread);
+            computeCornerBitangents(mesh, first, end, corners);
+        });
+
+        // Sum the contributions per vertex. Corners are added in triangle order, so the summation order is the same as the reference.
+        const size_t cornerCount = primCount * 3;
+        auto getCorner = [&](size_t corner)
+        {
+            size_t primID = corner / 3;
+            uint32_t i = uint32_t(corner % 3);
+            return vec3(corners[i * 3 + 0][primID], corners[i * 3 + 1][primID], corners[i * 3 + 2][primID]);
+        };
+        auto finalizeVertex = [&](uint32_t v)
+        {
+            pBitangents[v] = normalize(pBitangents[v]);
+            if (isInvalidVec(pBitangents[v]))
+            {
+                pBitangents[v] = projectNormalToBitangent(mesh.pNormals[v]);
+            }
+        };
+
+        if (threadCount == 1)
+        {
+            std::memset(pBitangents, 0, mesh.vertexCount * sizeof(vec3));
+            for (size_t corner = 0; corner < cornerCount; corner++) pBitangents[mesh.pIndices[corner]] += getCorner(corner);
+            for (uint32_t v = 0; v < mesh.vertexCount; v++) finalizeVertex(v);
+            return;
+        }
+
+        // Each thread owns a range of vertices. A vertex to corners table (compressed sparse rows), filled in corner order, lets every thread
+        // visit only the corners of its own vertices, so no synchronization is needed and the total work doesn't grow with the thread count.
+        std::vector<uint32_t> cornerOffsets(mesh.vertexCount + 1, 0);
+        for (size_t corner = 0; corner < cornerCount; corner++) cornerOffsets[mesh.pIndices[corner] + 1]++;
+        for (uint32_t v = 0; v < mesh.vertexCount; v++) cornerOffsets[v + 1] += cornerOffsets[v];
+
+        std::vector<uint32_t> vertexCorners(cornerCount);
+        std::vector<uint32_t> nextCorner(cornerOffsets.begin(), cornerOffsets.end() - 1);
+        for (size_t corner = 0; corner < cornerCount; corner++) vertexCorners[nextCorner[mesh.pIndices[corner]]++] = uint32_t(corner);
+
+        uint32_t verticesPerThread = (mesh.vertexCount + threadCount - 1) / threadCount;
+        parallelFor(threadCount, [&](uint32_t threadIndex)
+        {
+            uint32_t firstVertex = std::min(mesh.vertexCount, threadIndex * verticesPerThread);
+            uint32_t endVertex = std::min(mesh.vertexCount, firstVertex + verticesPerThread);
+            for (uint32_t v = firstVertex; v < endVertex; v++)
+            {
+                pBitangents[v] = vec3(0);
+                for (uint32_t c = cornerOffsets[v]; c < cornerOffsets[v + 1]; c++) pBitangents[v] += getCorner(vertexCorners[c]);
+                finalizeVertex(v);
+            }
+        });
+    }
+
+    void TangentGenerator::generateBitangentsReference(const MeshData& mesh, vec3* pBitangents)
+    {
+        std::memset(pBitangents, 0, mesh.vertexCount * sizeof(vec3));
+
+        // calculate the tangent and bitangent for every face
+        size_t primCount = mesh.indexCount / 3;
+        for (size_t primID = 0; primID < primCount; primID++)
+        {
+            vec3 tangent, bitangent;
+            if (computeTriangleFrame(mesh, primID, tangent, bitangent) == false) continue;
+
+            // store for every vertex of that face
+            for (uint32_t i = 0; i < 3; i++)
+            {
+                uint32_t index = mesh.pIndices[primID * 3 + i];
+                pBitangents[index] += projectToVertex(tangent, bitangent, mesh.pNormals[index]);
+            }
+        }
+
+        for (uint32_t v = 0; v < mesh.vertexCount; v++)
+        {
+            pBitangents[v] = normalize(pBitangents[v]);
+            if (isInvalidVec(pBitangents[v]))
+            {
+                pBitangents[v] = projectNormalToBitangent(mesh.pNormals[v]);
+            }
+        }
+    }
+
+    bool TangentGenerator::runSelfTest(uint32_t triangleCount)
+    {
+        // A wavy grid. Every 7th row has a UV seam and every 5th column collapses its UVs, to exercise the degenerate-frame path.
+        uint32_t quadsPerSide = std::max(2u, (uint32_t)std::sqrt(triangleCount / 2.0));
+        uint32_t vertsPerSide = quadsPerSide + 1;
+        std::vector<vec3> positions(vertsPerSide * vertsPerSide);
+        std::vector<vec3> normals(positions.size());
+        std::vector<vec2> texCrd(positions.size());
+        for (uint32_t z = 0; z < vertsPerSide; z++)
+        {
+            for (uint32_t x = 0; x < vertsPerSide; x++)
+            {
+                uint32_t v = z * vertsPerSide + x;
+                float fx = float(x) / quadsPerSide;
+                float fz = float(z) / quadsPerSide;
+                positions[v] = vec3(fx, 0.1f * sin(fx * 20) * cos(fz * 13), fz);
+                normals[v] = normalize(vec3(-2 * cos(fx * 20) * cos(fz * 13), 1, 1.3f * sin(fx * 20) * sin(fz * 13)));
+                texCrd[v] = vec2((x % 5 == 0) ? 0 : fx * 4, (z % 7 == 0) ? 1 - fz : fz * 4);
+            }
+        }
+
+        std::vector<uint32_t> indices;
+        indices.reserve(quadsPerSide * quadsPerSide * 6);
+        for (uint32_t z = 0; z < quadsPerSide; z++)
+        {
+            for (uint32_t x = 0; x < quadsPerSide; x++)
+            {
+                uint32_t i0 = z * vertsPerSide + x;
+                uint32_t i1 = i0 + 1;
+                uint32_t i2 = i0 + vertsPerSide;
+                uint32_t i3 = i2 + 1;
+                indices.insert(indices.end(), { i0, i2, i1, i1, i2, i3 });
+            }
+        }
+
+        MeshData mesh;
+        mesh.pIndices = indices.data();
+        mesh.indexCount = indices.size();
+        mesh.vertexCount = (uint32_t)positions.size();
+        mesh.pPositions = &positions[0].x;
+        mesh.positionStride = 3;
+        mesh.pNormals = normals.data();
+        mesh.pTexCrd = texCrd.data();
+
+        std::vector<vec3> reference(positions.size());
+        std::vector<vec3> result(positions.size());
+
+        auto start = CpuTimer::getCurrentTimePoint();
+        generateBitangentsReference(mesh, reference.data());
+        auto referenceEnd = CpuTimer::getCurrentTimePoint();
+        generateBitangents(mesh, result.data(), 1);
+        auto singleThreadEnd = CpuTimer::getCurrentTimePoint();
+        generateBitangents(mesh, result.data());
+        auto end = CpuTimer::getCurrentTimePoint();
+
+        float maxDiff = 0;
+        for (size_t v = 0; v < result.size(); v++)
+        {
+            vec3 d = abs(result[v] - reference[v]);
+            maxDiff = std::max(maxDiff, std::max(d.x, std::max(d.y, d.z)));
+        }
+
+        bool passed = maxDiff <= 1e-5f;
+        std::string msg = "TangentGenerator self-test " + std::string(passed ? "passed" : "FAILED") + " on " + std::to_string(indices.size() / 3) + " triangles. ";
+        msg += "Max difference " + std::to_string(maxDiff) + ". ";
+        msg += "Scalar " + std::to_string(CpuTimer::calcDuration(start, referenceEnd)) + "ms, ";
+        msg += "SIMD " + std::to_string(CpuTimer::calcDuration(referenceEnd, singleThreadEnd)) + "ms, ";
+        msg += "SIMD multi-threaded " + std::to_string(CpuTimer::calcDuration(singleThreadEnd, end)) + "ms.";
+        passed ? logInfo(msg) : logWarning(msg);
+        return passed;
+    }
+}
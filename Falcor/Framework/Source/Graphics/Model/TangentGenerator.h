@@ -0,0 +1,75 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <vector>
+#include "glm/vec2.hpp"
+#include "glm/vec3.hpp"
+
+namespace Falcor
+{
+    /** Generates per-vertex bitangents for triangle meshes, used by the model importers when a mesh has normals but no tangent frame.
+        Each triangle's tangent frame is computed from its positions and texture coordinates, projected onto the normal of each of its vertices and summed per vertex.
+        generateBitangents() processes 4 triangles at a time using SSE and splits the mesh across threads. The per-vertex sums are computed by partitioning the vertices
+        between the threads and looking up each vertex' triangles in a vertex to corners table, so no atomics are needed, and contributions are summed in triangle order, so the result matches generateBitangentsReference().
+    */
+    class TangentGenerator
+    {
+    public:
+        struct MeshData
+        {
+            const uint32_t* pIndices = nullptr;     ///< Triangle-list indices
+            size_t indexCount = 0;
+            uint32_t vertexCount = 0;
+            const float* pPositions = nullptr;      ///< The first 3 floats of each element are the position
+            uint32_t positionStride = 3;            ///< Distance between positions, in floats
+            const glm::vec3* pNormals = nullptr;
+            const glm::vec2* pTexCrd = nullptr;     ///< Optional. If nullptr, a tangent frame is derived from the normal.
+            uint32_t texCrdStride = 1;              ///< Distance between texture coordinates, in vec2 elements
+        };
+
+        /** Generate the bitangents
+            \param[in] mesh The mesh
+            \param[out] pBitangents Array of mesh.vertexCount elements receiving the normalized bitangents
+            \param[in] threadCount Number of threads to use. 0 picks a count based on the mesh size and the number of cores.
+        */
+        static void generateBitangents(const MeshData& mesh, glm::vec3* pBitangents, uint32_t threadCount = 0);
+
+        /** Generate the bitangents using a single-threaded scalar loop. Kept as the reference for validating generateBitangents().
+        */
+        static void generateBitangentsReference(const MeshData& mesh, glm::vec3* pBitangents);
+
+        /** Validate generateBitangents() against the reference on a generated mesh, and time both.
+            \param[in] triangleCount Approximate number of triangles in the test mesh
+            \return Whether the results match. The timings and the largest difference are logged.
+        */
+        static bool runSelfTest(uint32_t triangleCount = 1 << 20);
+
+    private:
+        static void computeCornerBitangents(const MeshData& mesh, size_t firstPrim, size_t endPrim, float* const* ppCorners);
+    };
+}
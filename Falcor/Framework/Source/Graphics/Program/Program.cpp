@@ -38,6 +38,8 @@
 #include "API/RenderContext.h"
 #include "Utils/StringUtils.h"
 #include "ShaderLibrary.h"
+#include "ShaderCache.h"
+#include "Utils/CpuTimer.h"
 
 namespace Falcor
 {
@@ -371,8 +373,9 @@ namespace Falcor
     SlangSession* getSlangSession()
     {
         // TODO: figure out a strategy for finalizing the Slang session, if desired
+        // Sessions aren't thread-safe. Programs can be linked on ProgramCompiler's worker threads, so each thread gets its own.
 
-        static SlangSession* slangSession = spCreateSession(NULL);
+        static thread_local SlangSession* slangSession = spCreateSession(NULL);
         return slangSession;
     }
 
@@ -417,16 +420,8 @@ namespace Falcor
 #endif
     }
 
-    Program::VersionData Program::preprocessAndCreateProgramVersion(std::string& log) const
+    SlangCompileRequest* Program::createSlangCompileRequest(bool reflectionOnly) const
     {
-        mFileTimeMap.clear();
-
-        // Run all of the shaders through Slang, so that we can get final code,
-        // reflection data, etc.
-        //
-        // Note that we provide all the shaders at once, so that automatically
-        // generated bindings can be made consistent across the stages.
-
         SlangSession* slangSession = getSlangSession();
 
         // Start building a request for compilation
@@ -482,6 +477,9 @@ namespace Falcor
 
         // Don't actually perform semantic checking: just pass through functions bodies to downstream compiler
         slangFlags |= SLANG_COMPILE_FLAG_NO_CHECKING | SLANG_COMPILE_FLAG_SPLIT_MIXED_TYPES;
+
+        // When we only need reflection and dependencies, skip code generation, which includes running the downstream compiler
+        if (reflectionOnly) slangFlags |= SLANG_COMPILE_FLAG_NO_CODEGEN;
         spSetCompileFlags(slangRequest, slangFlags);
 
         // Now lets add all our input shader code, one-by-one
@@ -498,7 +496,7 @@ namespace Falcor
             if (src.type == Desc::Source::Type::File)
             {
                 // If this is not an HLSL or a SLANG file, display a warning
-                if (!hasSuffix(src.pLibrary->getFilename(), ".hlsl", false) && !hasSuffix(src.pLibrary->getFilename(), ".slang", false))
+                if (!reflectionOnly && !hasSuffix(src.pLibrary->getFilename(), ".hlsl", false) && !hasSuffix(src.pLibrary->getFilename(), ".slang", false))
                 {
                     logWarning("Compiling a shader file which is not a SLANG file or an HLSL file. This is not an error, but make sure that the file contains valid shaders");
                 }
@@ -532,6 +530,110 @@ namespace Falcor
                 getSlangStage(ShaderType(i)));
         }
 
+        return slangRequest;
+    }
+
+    void Program::extractReflectionAndDependencies(SlangCompileRequest* slangRequest, ProgramReflectors& reflectors, std::string& log) const
+    {
+        // Extract the reflection data
+        reflectors.pReflector = ProgramReflection::create(slang::ShaderReflection::get(slangRequest), ProgramReflection::ResourceScope::All, log);
+        reflectors.pLocalReflector = ProgramReflection::create(slang::ShaderReflection::get(slangRequest), ProgramReflection::ResourceScope::Local, log);
+        reflectors.pGlobalReflector = ProgramReflection::create(slang::ShaderReflection::get(slangRequest), ProgramReflection::ResourceScope::Global, log);
+
+        // Extract list of files referenced, for dependency-tracking purposes
+        int depFileCount = spGetDependencyFileCount(slangRequest);
+        for(int ii = 0; ii < depFileCount; ++ii)
+        {
+            std::string depFilePath = spGetDependencyFilePath(slangRequest, ii);
+            mFileTimeMap[depFilePath] = getFileModifiedTime(depFilePath);
+        }
+    }
+
+    bool Program::getShaderCacheKey(SlangCompileRequest* slangRequest, uint64_t& key) const
+    {
+        ShaderCache::Key cacheKey;
+        cacheKey.add(mDesc.mShaderModel);
+        cacheKey.add((uint32_t)mDesc.getCompilerFlags());
+
+        for (const auto& shaderDefine : mDefineList)
+        {
+            cacheKey.add(shaderDefine.first);
+            cacheKey.add(shaderDefine.second);
+        }
+
+        // File sources are covered by the dependency list below, which includes everything they #include
+        for (const auto& src : mDesc.mSources)
+        {
+            cacheKey.add((uint32_t)src.type);
+            if (src.type == Desc::Source::Type::String) cacheKey.add(src.str);
+        }
+
+        for (uint32_t i = 0; i < kShaderCount; i++)
+        {
+            const auto& entryPoint = mDesc.mEntryPoints[i];
+            cacheKey.add((uint32_t)entryPoint.index);
+            if (entryPoint.index >= 0) cacheKey.add(entryPoint.name);
+        }
+
+        int depFileCount = spGetDependencyFileCount(slangRequest);
+        for (int ii = 0; ii < depFileCount; ++ii)
+        {
+            if (cacheKey.addFile(spGetDependencyFilePath(slangRequest, ii)) == false) return false;
+        }
+
+        key = cacheKey.get();
+        return true;
+    }
+
+    Program::VersionData Program::preprocessAndCreateProgramVersion(std::string& log) const
+    {
+        mFileTimeMap.clear();
+
+        // Run all of the shaders through Slang, so that we can get final code,
+        // reflection data, etc.
+        //
+        // Note that we provide all the shaders at once, so that automatically
+        // generated bindings can be made consistent across the stages.
+
+        // Dumping intermediates requires actually compiling, so bypass the cache in that case
+        bool useCache = ShaderCache::isEnabled() && !is_set(mDesc.getCompilerFlags(), Shader::CompilerFlags::DumpIntermediates);
+        uint64_t cacheKey = 0;
+        CpuTimer::TimePoint start = CpuTimer::getCurrentTimePoint();
+
+        if (useCache)
+        {
+            // Run only Slang's front end. That's enough for the reflection data and the full list of files the program includes, which goes into the cache key.
+            SlangCompileRequest* slangRequest = createSlangCompileRequest(true);
+            useCache = (spCompile(slangRequest) == 0) && getShaderCacheKey(slangRequest, cacheKey);
+
+            Shader::Blob shaderBlob[kShaderCount];
+            double originalCompileTime = 0;
+            if (useCache && ShaderCache::load(cacheKey, shaderBlob, kShaderCount, originalCompileTime))
+            {
+                VersionData programVersion;
+                extractReflectionAndDependencies(slangRequest, programVersion.reflectors, log);
+                spDestroyCompileRequest(slangRequest);
+
+                programVersion.pVersion = createProgramVersion(log, shaderBlob, programVersion.reflectors);
+                if (programVersion.pVersion)
+                {
+                    ShaderCache::reportHit(originalCompileTime - CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint()));
+                    return programVersion;
+                }
+
+                // The cached code is unusable. Compile from scratch, which overwrites the entry.
+                logWarning("Ignoring unusable shader cache entry for " + getProgramDescString());
+                mFileTimeMap.clear();
+            }
+            else
+            {
+                // If the front end failed, the full compilation below reports the errors
+                spDestroyCompileRequest(slangRequest);
+                mFileTimeMap.clear();
+            }
+        }
+
+        SlangCompileRequest* slangRequest = createSlangCompileRequest(false);
         int anySlangErrors = spCompile(slangRequest);
         log += spGetDiagnosticOutput(slangRequest);
         if(anySlangErrors)
@@ -558,22 +660,17 @@ namespace Falcor
         }
 
         VersionData programVersion;
+        extractReflectionAndDependencies(slangRequest, programVersion.reflectors, log);
 
-        // Extract the reflection data
-        programVersion.reflectors.pReflector = ProgramReflection::create(slang::ShaderReflection::get(slangRequest), ProgramReflection::ResourceScope::All, log);
-        programVersion.reflectors.pLocalReflector = ProgramReflection::create(slang::ShaderReflection::get(slangRequest), ProgramReflection::ResourceScope::Local, log);
-        programVersion.reflectors.pGlobalReflector = ProgramReflection::create(slang::ShaderReflection::get(slangRequest), ProgramReflection::ResourceScope::Global, log);
+        spDestroyCompileRequest(slangRequest);
 
-        // Extract list of files referenced, for dependency-tracking purposes
-        int depFileCount = spGetDependencyFileCount(slangRequest);
-        for(int ii = 0; ii < depFileCount; ++ii)
+        if (useCache)
         {
-            std::string depFilePath = spGetDependencyFilePath(slangRequest, ii);
-            mFileTimeMap[depFilePath] = getFileModifiedTime(depFilePath);
+            double compileTime = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+            ShaderCache::store(cacheKey, shaderBlob, kShaderCount, compileTime);
+            ShaderCache::reportMiss(compileTime);
         }
 
-        spDestroyCompileRequest(slangRequest);
-
         // Now that we've preprocessed things, dispatch to the actual program creation logic,
         // which may vary in subclasses of `Program`
         programVersion.pVersion = createProgramVersion(log, shaderBlob, programVersion.reflectors);
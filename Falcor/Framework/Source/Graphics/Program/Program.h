@@ -300,6 +300,9 @@ namespace Falcor
 
         bool link() const;
         VersionData preprocessAndCreateProgramVersion(std::string& log) const;
+        SlangCompileRequest* createSlangCompileRequest(bool reflectionOnly) const;
+        void extractReflectionAndDependencies(SlangCompileRequest* slangRequest, ProgramReflectors& reflectors, std::string& log) const;
+        bool getShaderCacheKey(SlangCompileRequest* slangRequest, uint64_t& key) const;
         virtual ProgramVersion::SharedPtr createProgramVersion(std::string& log, const Shader::Blob shaderBlob[kShaderCount], const ProgramReflectors& reflectors) const;
 
         // The description used to create this program
@@ -0,0 +1,182 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "ProgramCompiler.h"
+#include "Utils/CpuTimer.h"
+#include <deque>
+#include <thread>
+
+namespace Falcor
+{
+    namespace
+    {
+        struct Task
+        {
+            Program::SharedPtr pProgram;
+            ProgramCompiler::Job::SharedPtr pJob;
+        };
+
+        struct WorkerPool
+        {
+            std::vector<std::thread> threads;
+            std::deque<Task> queue;
+            std::mutex mutex;
+            std::condition_variable workCond;
+            std::condition_variable idleCond;
+            uint32_t pendingCount = 0;
+            bool terminate = false;
+            ProgramCompiler::Stats stats;
+        };
+
+        WorkerPool& getPool()
+        {
+            static WorkerPool pool;
+            return pool;
+        }
+    }
+
+    void ProgramCompiler::workerMain()
+    {
+        WorkerPool& pool = getPool();
+        while (true)
+        {
+            Task task;
+            {
+                std::unique_lock<std::mutex> lock(pool.mutex);
+                pool.workCond.wait(lock, [&pool]() { return pool.terminate || pool.queue.empty() == false; });
+                if (pool.queue.empty()) return;
+                task = std::move(pool.queue.front());
+                pool.queue.pop_front();
+            }
+
+            // Requesting the active version links the program, which is where the compilation happens
+            auto start = CpuTimer::getCurrentTimePoint();
+            bool success = task.pProgram->getActiveVersion() != nullptr;
+            double duration = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+            task.pProgram = nullptr;
+
+            auto& pJob = task.pJob;
+            {
+                std::lock_guard<std::mutex> lock(pJob->mMutex);
+                pJob->mCompileTime += duration;
+                if (success == false) pJob->mFailed++;
+                pJob->mPending--;
+            }
+            pJob->mDoneCond.notify_all();
+
+            {
+                std::lock_guard<std::mutex> lock(pool.mutex);
+                pool.stats.programCount++;
+                pool.stats.compileTime += duration;
+                pool.pendingCount--;
+            }
+            pool.idleCond.notify_all();
+        }
+    }
+
+    void ProgramCompiler::Job::wait() const
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mDoneCond.wait(lock, [this]() { return isDone(); });
+    }
+
+    double ProgramCompiler::Job::getCompileTime() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mCompileTime;
+    }
+
+    uint32_t ProgramCompiler::getWorkerCount()
+    {
+        // Leave a core for the main thread, which keeps rendering while the workers compile
+        uint32_t coreCount = std::thread::hardware_concurrency();
+        return coreCount > 2 ? coreCount - 1 : 1;
+    }
+
+    ProgramCompiler::Job::SharedPtr ProgramCompiler::submit(const std::vector<Program::SharedPtr>& programs)
+    {
+        Job::SharedPtr pJob = std::make_shared<Job>();
+        uint32_t count = 0;
+        for (const auto& pProgram : programs) count += pProgram ? 1 : 0;
+        pJob->mPending = count;
+        pJob->mFailed = 0;
+        if (count == 0) return pJob;
+
+        WorkerPool& pool = getPool();
+        {
+            std::lock_guard<std::mutex> lock(pool.mutex);
+            if (pool.threads.empty())
+            {
+                pool.terminate = false;
+                uint32_t workerCount = getWorkerCount();
+                for (uint32_t i = 0; i < workerCount; i++)
+                {
+                    pool.threads.push_back(std::thread(workerMain));
+                }
+            }
+
+            for (const auto& pProgram : programs)
+            {
+                if (pProgram) pool.queue.push_back({ pProgram, pJob });
+            }
+            pool.pendingCount += count;
+        }
+        pool.workCond.notify_all();
+        return pJob;
+    }
+
+    void ProgramCompiler::waitForAll()
+    {
+        WorkerPool& pool = getPool();
+        std::unique_lock<std::mutex> lock(pool.mutex);
+        pool.idleCond.wait(lock, [&pool]() { return pool.pendingCount == 0; });
+    }
+
+    ProgramCompiler::Stats ProgramCompiler::getStats()
+    {
+        WorkerPool& pool = getPool();
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        Stats stats = pool.stats;
+        stats.pendingCount = pool.pendingCount;
+        return stats;
+    }
+
+    void ProgramCompiler::shutdown()
+    {
+        WorkerPool& pool = getPool();
+        {
+            std::lock_guard<std::mutex> lock(pool.mutex);
+            pool.terminate = true;
+        }
+        pool.workCond.notify_all();
+
+        // The workers drain the queue before exiting
+        for (auto& t : pool.threads) t.join();
+        pool.threads.clear();
+    }
+}
@@ -0,0 +1,105 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include "Graphics/Program/Program.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+namespace Falcor
+{
+    /** Links programs on a pool of worker threads.
+        Programs are compiled lazily the first time their active version is requested. Submitting them here does that work in the background, so several programs (and the shaders inside each of them) compile in parallel.
+        A program must not be used by the application until the job it was submitted with is done.
+    */
+    class ProgramCompiler
+    {
+    public:
+        /** A group of programs submitted together
+        */
+        class Job
+        {
+        public:
+            using SharedPtr = std::shared_ptr<Job>;
+
+            /** Check if all the programs in the job finished compiling. Doesn't block.
+            */
+            bool isDone() const { return mPending.load() == 0; }
+
+            /** Block until all the programs in the job finished compiling
+            */
+            void wait() const;
+
+            /** Check if all the programs linked successfully. Only valid once the job is done.
+            */
+            bool succeeded() const { return mFailed.load() == 0; }
+
+            /** Get the sum of the compilation times of the job's programs, in milliseconds. Only valid once the job is done.
+            */
+            double getCompileTime() const;
+
+        private:
+            friend class ProgramCompiler;
+            std::atomic<uint32_t> mPending;
+            std::atomic<uint32_t> mFailed;
+            mutable std::mutex mMutex;
+            mutable std::condition_variable mDoneCond;
+            double mCompileTime = 0;
+        };
+
+        struct Stats
+        {
+            uint32_t programCount = 0;      ///< Number of programs compiled on the workers
+            uint32_t pendingCount = 0;      ///< Number of programs waiting for or in compilation
+            double compileTime = 0;         ///< Sum of the compilation times, in milliseconds. With more than one worker this is larger than the wall time spent compiling
+        };
+
+        /** Submit programs for compilation. Null programs are ignored.
+            \param[in] programs The programs to link
+            \return A job tracking the programs
+        */
+        static Job::SharedPtr submit(const std::vector<Program::SharedPtr>& programs);
+
+        /** Block until all the submitted programs finished compiling
+        */
+        static void waitForAll();
+
+        /** Get the number of worker threads
+        */
+        static uint32_t getWorkerCount();
+
+        static Stats getStats();
+
+        /** Finish the pending work and stop the worker threads. Called when the application shuts down.
+        */
+        static void shutdown();
+
+    private:
+        static void workerMain();
+    };
+}
@@ -0,0 +1,256 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "ShaderCache.h"
+#include "Utils/Platform/OS.h"
+#include "Utils/StringUtils.h"
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+
+namespace Falcor
+{
+    namespace
+    {
+        // Bump this whenever the key or the file layout changes
+        const uint32_t kCacheFormatVersion = 1;
+        const uint32_t kEntryMagic = 0x31435346; // 'FSC1'
+
+        // Compiler binaries whose identity goes into every key, so updating the compiler invalidates the cache
+        const char* kCompilerBinaries[] = { "slang.dll", "dxcompiler.dll", "dxil.dll" };
+
+        struct CacheState
+        {
+            std::mutex mutex;
+            bool enabled = true;
+            ShaderCache::Stats stats;
+        };
+
+        CacheState& getState()
+        {
+            static CacheState state;
+            return state;
+        }
+
+        const std::string& getCacheDirectory()
+        {
+            static const std::string dir = getExecutableDirectory() + "/ShaderCache";
+            return dir;
+        }
+
+        std::string getEntryPath(uint64_t key)
+        {
+            char name[32];
+            snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+            return getCacheDirectory() + "/" + name;
+        }
+
+        // A Slang blob holding code read from the cache. ISlangBlob shares its interface ID with ID3DBlob, so the D3D code can query it exactly like the blobs Slang returns.
+        class CachedShaderBlob : public ISlangBlob
+        {
+        public:
+            CachedShaderBlob(std::vector<uint8_t>&& data) : mData(std::move(data)) {}
+
+            SLANG_NO_THROW SlangResult SLANG_MCALL QueryInterface(SlangUUID const& uuid, void** outObject) override
+            {
+                static const SlangUUID kUnknownGuid = { 0x00000000, 0x0000, 0x0000, { 0xC0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x46 } };
+                static const SlangUUID kBlobGuid = { 0x8BA5FB08, 0x5195, 0x40e2, { 0xAC, 0x58, 0x0D, 0x98, 0x9C, 0x3A, 0x01, 0x02 } };
+                if (memcmp(&uuid, &kUnknownGuid, sizeof(SlangUUID)) == 0 || memcmp(&uuid, &kBlobGuid, sizeof(SlangUUID)) == 0)
+                {
+                    AddRef();
+                    *outObject = static_cast<ISlangBlob*>(this);
+                    return SLANG_OK;
+                }
+                *outObject = nullptr;
+                return SLANG_E_NO_INTERFACE;
+            }
+
+            SLANG_NO_THROW uint32_t SLANG_MCALL AddRef() override { return ++mRefCount; }
+
+            SLANG_NO_THROW uint32_t SLANG_MCALL Release() override
+            {
+                uint32_t count = --mRefCount;
+                if (count == 0) delete this;
+                return count;
+            }
+
+            SLANG_NO_THROW void const* SLANG_MCALL getBufferPointer() override { return mData.data(); }
+            SLANG_NO_THROW size_t SLANG_MCALL getBufferSize() override { return mData.size(); }
+
+        private:
+            std::vector<uint8_t> mData;
+            std::atomic<uint32_t> mRefCount{ 0 };
+        };
+    }
+
+    ShaderCache::Key::Key() : mHash(kFnv1aOffsetBasis)
+    {
+        add(kCacheFormatVersion);
+#ifdef FALCOR_VK
+        add(std::string("FALCOR_VK"));
+#elif defined FALCOR_D3D12
+        add(std::string("FALCOR_D3D12"));
+#endif
+        for (const char* binary : kCompilerBinaries)
+        {
+            std::string path = getExecutableDirectory() + "/" + binary;
+            if (doesFileExist(path) == false) continue;
+            add(std::string(binary));
+            time_t modified = getFileModifiedTime(path);
+            add(&modified, sizeof(modified));
+        }
+    }
+
+    void ShaderCache::Key::add(const void* pData, size_t size)
+    {
+        mHash = hashBytes(mHash, pData, size);
+    }
+
+    void ShaderCache::Key::add(const std::string& str)
+    {
+        // Add the length too, so that adjacent strings can't run into each other
+        uint64_t length = str.size();
+        add(&length, sizeof(length));
+        add(str.data(), str.size());
+    }
+
+    bool ShaderCache::Key::addFile(const std::string& path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (file.good() == false) return false;
+        std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        add(path);
+        add(content);
+        return true;
+    }
+
+    void ShaderCache::setEnabled(bool enabled)
+    {
+        CacheState& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.enabled = enabled;
+    }
+
+    bool ShaderCache::isEnabled()
+    {
+        CacheState& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        return state.enabled;
+    }
+
+    bool ShaderCache::load(uint64_t key, Shader::Blob* pBlobs, uint32_t count, double& compileTime)
+    {
+        std::ifstream file(getEntryPath(key), std::ios::binary);
+        if (file.good() == false) return false;
+
+        uint32_t magic = 0, blobCount = 0;
+        file.read((char*)&magic, sizeof(magic));
+        file.read((char*)&blobCount, sizeof(blobCount));
+        file.read((char*)&compileTime, sizeof(compileTime));
+        if (!file || magic != kEntryMagic || blobCount != count) return false;
+
+        std::vector<Shader::Blob> blobs(count);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            uint64_t size = 0;
+            file.read((char*)&size, sizeof(size));
+            if (!file) return false;
+            if (size == 0) continue;
+
+            std::vector<uint8_t> data((size_t)size);
+            file.read((char*)data.data(), size);
+            if (!file) return false;
+            blobs[i] = new CachedShaderBlob(std::move(data));
+        }
+
+        // Only hand out the code once the whole entry was read successfully
+        for (uint32_t i = 0; i < count; i++) pBlobs[i] = blobs[i];
+        return true;
+    }
+
+    void ShaderCache::store(uint64_t key, const Shader::Blob* pBlobs, uint32_t count, double compileTime)
+    {
+        const std::string& dir = getCacheDirectory();
+        if (isDirectoryExists(dir) == false && createDirectory(dir) == false)
+        {
+            logWarning("ShaderCache: can't create the cache directory " + dir);
+            return;
+        }
+
+        // Several processes (or threads) may compile the same program at the same time. Each writes its own temporary file, and the last one replaces the entry,
+        // which also replaces a stale entry that failed to load.
+        writeFileAtomic(getEntryPath(key), [&](std::ostream& file)
+        {
+            file.write((const char*)&kEntryMagic, sizeof(kEntryMagic));
+            file.write((const char*)&count, sizeof(count));
+            file.write((const char*)&compileTime, sizeof(compileTime));
+            for (uint32_t i = 0; i < count; i++)
+            {
+                uint64_t size = pBlobs[i] ? pBlobs[i]->getBufferSize() : 0;
+                file.write((const char*)&size, sizeof(size));
+                if (size) file.write((const char*)pBlobs[i]->getBufferPointer(), size);
+            }
+            return true;
+        });
+    }
+
+    void ShaderCache::reportHit(double timeSaved)
+    {
+        CacheState& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.stats.hits++;
+        state.stats.timeSaved += timeSaved;
+    }
+
+    void ShaderCache::reportMiss(double compileTime)
+    {
+        CacheState& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.stats.misses++;
+        state.stats.compileTime += compileTime;
+    }
+
+    ShaderCache::Stats ShaderCache::getStats()
+    {
+        CacheState& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        return state.stats;
+    }
+
+    void ShaderCache::logStats()
+    {
+        Stats stats = getStats();
+        uint32_t lookups = stats.hits + stats.misses;
+        if (lookups == 0) return;
+
+        double hitRate = 100.0 * stats.hits / lookups;
+        logInfo("Shader cache: " + std::to_string(stats.hits) + "/" + std::to_string(lookups) + " programs loaded from the cache (" + std::to_string(hitRate) + "%), " +
+            std::to_string(stats.timeSaved) + " ms of compilation saved, " + std::to_string(stats.compileTime) + " ms spent compiling");
+    }
+}
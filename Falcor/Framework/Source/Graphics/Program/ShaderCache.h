@@ -0,0 +1,104 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include "API/Shader.h"
+
+namespace Falcor
+{
+    /** Persistent on-disk cache of compiled shader code.
+        Entries are keyed by a hash of everything that affects the generated code - the program's source files and everything they include, defines, entry points, shader model, compiler flags and the compiler binaries.
+        Only the output of the downstream compiler (fxc/dxc/glslang), which is where nearly all the compilation time goes, is cached. Reflection data still comes from Slang, which regenerates it quickly without running code generation.
+    */
+    class ShaderCache
+    {
+    public:
+        /** Builds a cache key out of the inputs to a compilation
+        */
+        class Key
+        {
+        public:
+            /** Create a key seeded with the cache format version and the identity of the compiler binaries
+            */
+            Key();
+
+            void add(const void* pData, size_t size);
+            void add(const std::string& str);
+            void add(uint32_t value) { add(&value, sizeof(value)); }
+
+            /** Add a file's path and content.
+                \return false if the file can't be read. The key shouldn't be used in that case.
+            */
+            bool addFile(const std::string& path);
+
+            uint64_t get() const { return mHash; }
+        private:
+            uint64_t mHash;
+        };
+
+        struct Stats
+        {
+            uint32_t hits = 0;
+            uint32_t misses = 0;
+            double compileTime = 0;         ///< Milliseconds spent compiling programs that weren't in the cache
+            double timeSaved = 0;           ///< Milliseconds saved by cache hits. For each hit, the time it took to compile the entry originally minus the time it took to load it.
+        };
+
+        /** Enable/disable the cache. It's enabled by default.
+        */
+        static void setEnabled(bool enabled);
+        static bool isEnabled();
+
+        /** Look up compiled code.
+            \param[in] key The cache key
+            \param[out] pBlobs Array of blobs to fill, one per shader stage. Stages without code are left empty.
+            \param[in] count Number of elements in pBlobs
+            \param[out] compileTime The time in milliseconds it originally took to compile the entry
+            \return true if the key was found
+        */
+        static bool load(uint64_t key, Shader::Blob* pBlobs, uint32_t count, double& compileTime);
+
+        /** Store compiled code. The entry is written to a temporary file which is then renamed, so a partially written entry is never visible to other processes.
+            \param[in] key The cache key
+            \param[in] pBlobs The code for each shader stage. Stages without code can be empty.
+            \param[in] count Number of elements in pBlobs
+            \param[in] compileTime The time in milliseconds it took to compile the program
+        */
+        static void store(uint64_t key, const Shader::Blob* pBlobs, uint32_t count, double compileTime);
+
+        /** Record the outcome of a lookup in the statistics
+        */
+        static void reportHit(double timeSaved);
+        static void reportMiss(double compileTime);
+
+        static Stats getStats();
+
+        /** Log the hit rate and the compilation time saved so far
+        */
+        static void logStats();
+    };
+}
@@ -91,11 +91,11 @@ namespace Falcor
             mNameToIndex[passName] = passIndex;
         }
 
-        auto passChangedCB = [this]() {mRecompile = true; };
+        auto passChangedCB = [this]() {invalidate(); };
         pPass->setPassChangedCB(passChangedCB);
         pPass->setScene(mpScene);
         mNodeData[passIndex] = { passName, pPass };
-        mRecompile = true;
+        invalidate();
         return passIndex;
     }
 
@@ -132,7 +132,7 @@ namespace Falcor
         const auto& removedEdges = mpGraph->removeNode(index);
         for (const auto& e : removedEdges) mEdgeData.erase(e);
 
-        mRecompile = true;
+        invalidate();
     }
 
     void RenderGraph::updatePass(const std::string& passName, const Dictionary& dict)
@@ -151,11 +151,11 @@ namespace Falcor
         auto pPass = RenderPassLibrary::instance().createPass(passTypeName.c_str(), dict);
         pPassIt->second.pPass = pPass;
 
-        auto passChangedCB = [this]() {mRecompile = true; };
+        auto passChangedCB = [this]() {invalidate(); };
         pPass->setPassChangedCB(passChangedCB);
 
         pPass->setScene(mpScene);
-        mRecompile = true;
+        invalidate();
     }
 
     const RenderPass::SharedPtr& RenderGraph::getPass(const std::string& name) const
@@ -267,7 +267,7 @@ namespace Falcor
 
         uint32_t e = mpGraph->addEdge(srcIndex, dstIndex);
         mEdgeData[e] = newEdge;
-        mRecompile = true;
+        invalidate();
         return e;
     }
 
@@ -305,7 +305,7 @@ namespace Falcor
     {
         mEdgeData.erase(edgeID);
         mpGraph->removeEdge(edgeID);
-        mRecompile = true;
+        invalidate();
     }
 
     uint32_t RenderGraph::getEdge(const std::string& src, const std::string& dst)
@@ -587,8 +587,9 @@ namespace Falcor
                 auto srcReflection = pSrcPass->reflect();
                 const RenderPassReflection::Field& srcField = srcReflection.getField(edgeData.srcField);
 
+                // The resource is alive until its consumer runs, not only while its producer does. Transient resources are aliased based on this range.
                 assert(passToIndex.count(pSrcPass.get()) > 0);
-                mpResourcesCache->registerField(dstFieldName, srcField, passToIndex[pSrcPass.get()], srcFieldName);
+                mpResourcesCache->registerField(dstFieldName, srcField, uint32_t(i), srcFieldName);
             }
         }
 
@@ -596,21 +597,37 @@ namespace Falcor
         return true;
     }
 
+    bool RenderGraph::compileGraph(std::string& log)
+    {
+        mpResourcesCache->reset();
+        restoreCompilationChanges();
+
+        if (resolveExecutionOrder() == false) return false;
+        // If passes were added, resolve execution order again
+        if (insertAutoPasses()) if (resolveExecutionOrder() == false) return false;
+        if (resolveResourceTypes() == false) return false;
+        if (isValid(log) == false) return false;
+        return true;
+    }
+
     bool RenderGraph::compile(std::string& log)
     {
-        if (mRecompile)
+        if (mCompiledVersion != mVersion)
         {
-            mpResourcesCache->reset();
-            restoreCompilationChanges();
+            mCompileLog.clear();
+            mCompileResult = compileGraph(mCompileLog);
+            mCompileCount.frame++;
+            mCompileCount.total++;
 
-            if (resolveExecutionOrder() == false) return false;
-            // If passes were added, resolve execution order again
-            if (insertAutoPasses()) if (resolveExecutionOrder() == false) return false;
-            if (resolveResourceTypes() == false) return false;
-            if (isValid(log) == false) return false;
+            // Compilation adds and removes auto-generated passes and edges, which bumps the version. Those changes are part of the compiled result.
+            mCompiledVersion = mVersion;
+            if (mCompileResult == false)
+            {
+                log = mCompileLog;
+                logWarning("Failed to compile RenderGraph\n" + log + "Ignoring RenderGraph::execute() calls until the graph changes");
+            }
         }
-        mRecompile = false;
-        return true;
+        return mCompileResult;
     }
 
     void RenderGraph::execute(RenderContext* pContext)
@@ -619,16 +636,19 @@ namespace Falcor
 
         if (profile) Profiler::startEvent("RenderGraph::execute()");
 
+        mCompileCount.frame = 0;
         std::string log;
         if (!compile(log))
         {
-            logWarning("Failed to compile RenderGraph\n" + log + "Ignoring RenderGraph::execute() call");
+            if (profile) Profiler::endEvent("RenderGraph::execute()");
             return;
         }
 
-        for (const auto& node : mExecutionList)
+        for (size_t i = 0; i < mExecutionList.size(); i++)
         {
+            uint32_t node = mExecutionList[i];
             if (profile) Profiler::startEvent(mNodeData[node].nodeName);
+            mpResourcesCache->beginTimePoint(pContext, uint32_t(i));
             RenderData renderData(mNodeData[node].nodeName, mpResourcesCache, mpPassDictionary);
             mNodeData[node].pPass->execute(pContext, &renderData);
             if (profile) Profiler::endEvent(mNodeData[node].nodeName);
@@ -721,7 +741,7 @@ namespace Falcor
         }
 
         mOutputs.push_back(newOut);
-        mRecompile = true;
+        invalidate();
     }
 
     void RenderGraph::unmarkOutput(const std::string& name)
@@ -739,7 +759,7 @@ namespace Falcor
             if (mOutputs[i].nodeId == removeMe.nodeId && mOutputs[i].field == removeMe.field)
             {
                 mOutputs.erase(mOutputs.begin() + i);
-                mRecompile = true;
+                invalidate();
                 return;
             }
         }
@@ -771,11 +791,6 @@ namespace Falcor
         const Texture* pDepth = pTargetFbo->getDepthStencilTexture().get();
         assert(pColor && pDepth);
 
-        // If the back-buffer values changed, recompile
-        mRecompile = mRecompile || (mSwapChainData.format != pColor->getFormat());
-        mRecompile = mRecompile || (mSwapChainData.width != pTargetFbo->getWidth());
-        mRecompile = mRecompile || (mSwapChainData.height != pTargetFbo->getHeight());
-
         // Store the values
         mSwapChainData.format = pColor->getFormat();
         mSwapChainData.width = pTargetFbo->getWidth();
@@ -788,7 +803,7 @@ namespace Falcor
         }
 
         // Invalidate the graph. Render-passes might change their reflection based on the resize information
-        mRecompile = true;
+        invalidate();
     }
 
     bool canFieldsConnect(const RenderPassReflection::Field& src, const RenderPassReflection::Field& dst)
@@ -826,7 +841,7 @@ namespace Falcor
 
                     uint32_t e = mpGraph->addEdge(srcIndex, dstIndex);
                     mEdgeData[e] = { true, srcField.getName(), dstFieldIt->getName() };
-                    mRecompile = true;
+                    invalidate();
 
                     // If connection was found, continue to next unsatisfied input
                     inputSatisfied = true;
@@ -938,6 +953,24 @@ namespace Falcor
             pGui->addCheckBox("Profile Passes", mProfileGraph);
             pGui->addTooltip("Profile the render-passes. The results will be shown in the profiler window. If you can't see it, click 'P'");
 
+            bool aliasResources = mpResourcesCache->isAliasingEnabled();
+            if (pGui->addCheckBox("Alias Transient Resources", aliasResources))
+            {
+                mpResourcesCache->setAliasingEnabled(aliasResources);
+                invalidate();
+            }
+            pGui->addTooltip("Place resources that are only used between passes in shared memory when their lifetimes don't overlap");
+
+            const auto& stats = mpResourcesCache->getMemoryStats();
+            const double MB = 1024.0 * 1024.0;
+            std::string memoryText = "Transient resources: " + std::to_string(stats.transientCount) + " in " + std::to_string(stats.memoryRangeCount) + " memory ranges\n";
+            memoryText += "Transient memory: " + std::to_string(stats.aliasedBytes / MB) + " MB (" + std::to_string(stats.transientBytes / MB) + " MB without aliasing)\n";
+            memoryText += "Persistent memory: " + std::to_string(stats.persistentBytes / MB) + " MB";
+            pGui->addText(memoryText.c_str());
+
+            std::string compileText = "Graph version " + std::to_string(mVersion) + ", compiled " + std::to_string(mCompileCount.total) + " times (" + std::to_string(mCompileCount.frame) + " this frame)";
+            pGui->addText(compileText.c_str());
+
             for (const auto& passId : mExecutionList)
             {
                 const auto& pass = mNodeData[passId];
@@ -89,10 +89,19 @@ namespace Falcor
         */
         bool isValid(std::string& log) const;
 
-        /** Execute the graph
+        /** Execute the graph. The graph is compiled first if it changed since the last call.
         */
         void execute(RenderContext* pContext);
 
+        /** Get the graph version. It is bumped by every change that requires the graph to be compiled again.
+        */
+        uint64_t getVersion() const { return mVersion; }
+
+        /** Get the number of times the graph was compiled during the last execute() call, and since the graph was created
+        */
+        uint32_t getFrameCompileCount() const { return mCompileCount.frame; }
+        uint64_t getTotalCompileCount() const { return mCompileCount.total; }
+
         /** Update graph based on another graph's topology
         */
         void update(const SharedPtr& pGraph);
@@ -188,6 +197,8 @@ namespace Falcor
         std::string mName;
 
         bool compile(std::string& log);
+        bool compileGraph(std::string& log);
+        void invalidate() { mVersion++; }
         bool resolveExecutionOrder();
         bool insertAutoPasses();
         bool resolveResourceTypes();
@@ -211,7 +222,16 @@ namespace Falcor
         bool canAutoResolve(const RenderPassReflection::Field& src, const RenderPassReflection::Field& dst);
         void restoreCompilationChanges();
 
-        bool mRecompile = true;
+        // The graph is compiled again only when its version differs from the one it was last compiled at
+        uint64_t mVersion = 1;
+        uint64_t mCompiledVersion = 0;
+        bool mCompileResult = false;
+        std::string mCompileLog;
+        struct
+        {
+            uint32_t frame = 0;
+            uint64_t total = 0;
+        } mCompileCount;
         std::shared_ptr<Scene> mpScene;
 
         std::unordered_map<std::string, uint32_t> mNameToIndex;
@@ -230,7 +230,7 @@ namespace Falcor
         for (auto& r : passesToReplace)
         {
             r.pGraph->mNodeData[r.nodeId].pPass = createPass(r.className.c_str());
-            r.pGraph->mRecompile = true;
+            r.pGraph->invalidate();
         }
     }
 
@@ -27,6 +27,9 @@
 ***************************************************************************/
 #include "Framework.h"
 #include "ResourceCache.h"
+#include "API/RenderContext.h"
+#include "API/ResourceHeap.h"
+#include <algorithm>
 
 namespace Falcor
 {
@@ -39,6 +42,8 @@ namespace Falcor
     {
         mNameToIndex.clear();
         mResourceData.clear();
+        mActivations.clear();
+        mpTransientHeap = nullptr;
     }
 
     const std::shared_ptr<Resource>& ResourceCache::getResource(const std::string& name) const
@@ -210,47 +215,263 @@ namespace Falcor
         }
     }
 
+    struct TextureDesc
+    {
+        Resource::Type type;
+        uint32_t width;
+        uint32_t height;
+        uint32_t depth;
+        uint32_t sampleCount;
+        ResourceFormat format;
+        Resource::BindFlags bindFlags;
+    };
+
+    TextureDesc getTextureDesc(const ResourceCache::DefaultProperties& params, const RenderPassReflection::Field& field)
+    {
+        TextureDesc desc;
+        desc.width = field.getWidth() ? field.getWidth() : params.width;
+        desc.height = field.getHeight() ? field.getHeight() : params.height;
+        desc.depth = field.getDepth() ? field.getDepth() : 1;
+        desc.sampleCount = field.getSampleCount() ? field.getSampleCount() : 1;
+        desc.format = field.getFormat() == ResourceFormat::Unknown ? params.format : field.getFormat();
+        desc.bindFlags = field.getBindFlags() | Resource::BindFlags::ShaderResource;
+
+        if (desc.depth > 1)
+        {
+            assert(desc.sampleCount == 1);
+            desc.type = Resource::Type::Texture3D;
+        }
+        else if (desc.height > 1 || desc.sampleCount > 1)
+        {
+            desc.type = (desc.sampleCount > 1) ? Resource::Type::Texture2DMultisample : Resource::Type::Texture2D;
+        }
+        else
+        {
+            desc.type = Resource::Type::Texture1D;
+        }
+        return desc;
+    }
+
     Texture::SharedPtr createTextureForPass(const ResourceCache::DefaultProperties& params, const RenderPassReflection::Field& field)
     {
-        uint32_t width = field.getWidth() ? field.getWidth() : params.width;
-        uint32_t height = field.getHeight() ? field.getHeight() : params.height;
-        uint32_t depth = field.getDepth() ? field.getDepth() : 1;
-        uint32_t sampleCount = field.getSampleCount() ? field.getSampleCount() : 1;
-        ResourceFormat format = field.getFormat() == ResourceFormat::Unknown ? params.format : field.getFormat();
-
-        Texture::SharedPtr pTexture;
-        if (depth > 1)
+        TextureDesc desc = getTextureDesc(params, field);
+        switch (desc.type)
         {
-            assert(sampleCount == 1);
-            pTexture = Texture::create3D(width, height, depth, format, 1, nullptr, field.getBindFlags() | Resource::BindFlags::ShaderResource);
+        case Resource::Type::Texture3D:
+            return Texture::create3D(desc.width, desc.height, desc.depth, desc.format, 1, nullptr, desc.bindFlags);
+        case Resource::Type::Texture2DMultisample:
+            return Texture::create2DMS(desc.width, desc.height, desc.format, desc.sampleCount, 1, desc.bindFlags);
+        case Resource::Type::Texture2D:
+            return Texture::create2D(desc.width, desc.height, desc.format, 1, 1, nullptr, desc.bindFlags);
+        default:
+            return Texture::create1D(desc.width, desc.format, 1, 1, nullptr, desc.bindFlags);
         }
-        else if (height > 1 || sampleCount > 1)
+    }
+
+    void ResourceCache::allocateResources(const DefaultProperties& params)
+    {
+        // Aliasing ties the placement of every transient resource to all the others, so they're all placed again if anything changed
+        bool changed = false;
+        for (const auto& data : mResourceData)
+        {
+            if ((data.pResource == nullptr || data.dirty) && data.field.isValid()) changed = true;
+        }
+        if (changed == false) return;
+
+        mMemoryStats = MemoryStats();
+        mActivations.clear();
+        mpTransientHeap = nullptr;
+
+        // Graph outputs are used after the graph executes, and internal resources usually carry data from one frame to the next, so only the rest is transient
+        std::vector<uint32_t> transients;
+        for (uint32_t i = 0; i < (uint32_t)mResourceData.size(); i++)
         {
-            if (sampleCount > 1)
+            auto& data = mResourceData[i];
+            if (data.field.isValid() == false) continue;
+
+            bool isPersistent = (data.lastUsed == uint32_t(-1)) || is_set(data.field.getType(), RenderPassReflection::Field::Type::Internal);
+            if (isPersistent == false)
             {
-                pTexture = Texture::create2DMS(width, height, format, sampleCount, 1, field.getBindFlags() | Resource::BindFlags::ShaderResource);
+                transients.push_back(i);
+                continue;
+            }
+
+            if (data.pResource == nullptr || data.dirty)
+            {
+                data.pResource = createTextureForPass(params, data.field);
+                data.dirty = false;
             }
-            else
+
+            TextureDesc desc = getTextureDesc(params, data.field);
+            uint64_t size, alignment;
+            if (Texture::getPlacementInfo(desc.type, desc.width, desc.height, desc.depth, desc.format, desc.sampleCount, desc.bindFlags, size, alignment))
             {
-                pTexture = Texture::create2D(width, height, format, 1, 1, nullptr, field.getBindFlags() | Resource::BindFlags::ShaderResource);
+                mMemoryStats.persistentBytes += size;
             }
         }
-        else
+
+        mMemoryStats.transientCount = (uint32_t)transients.size();
+        if (mAliasingEnabled && placeTransientResources(params, transients))
         {
-            pTexture = Texture::create1D(width, format, 1, 1, nullptr, field.getBindFlags() | Resource::BindFlags::ShaderResource);
+            const double MB = 1024.0 * 1024.0;
+            logInfo("ResourceCache: " + std::to_string(transients.size()) + " transient resources need " + std::to_string(mMemoryStats.transientBytes / MB) + " MB with dedicated memory, " +
+                std::to_string(mMemoryStats.aliasedBytes / MB) + " MB aliased in " + std::to_string(mMemoryStats.memoryRangeCount) + " memory ranges");
+            return;
         }
 
-        return pTexture;
+        // No aliasing. Every transient resource gets its own memory.
+        mMemoryStats.transientBytes = 0;
+        for (uint32_t index : transients)
+        {
+            auto& data = mResourceData[index];
+            data.pResource = createTextureForPass(params, data.field);
+            data.dirty = false;
+
+            TextureDesc desc = getTextureDesc(params, data.field);
+            uint64_t size, alignment;
+            if (Texture::getPlacementInfo(desc.type, desc.width, desc.height, desc.depth, desc.format, desc.sampleCount, desc.bindFlags, size, alignment))
+            {
+                mMemoryStats.transientBytes += size;
+            }
+        }
+        mMemoryStats.aliasedBytes = mMemoryStats.transientBytes;
+        mMemoryStats.memoryRangeCount = mMemoryStats.transientCount;
     }
 
-    void ResourceCache::allocateResources(const DefaultProperties& params)
+    bool ResourceCache::placeTransientResources(const DefaultProperties& params, const std::vector<uint32_t>& transients)
+    {
+        struct Transient
+        {
+            uint32_t index;
+            TextureDesc desc;
+            uint64_t size;
+            uint64_t alignment;
+            uint32_t range;
+        };
+        std::vector<Transient> resources;
+        for (uint32_t index : transients)
+        {
+            Transient t = { index, getTextureDesc(params, mResourceData[index].field), 0, 0, 0 };
+            if (Texture::getPlacementInfo(t.desc.type, t.desc.width, t.desc.height, t.desc.depth, t.desc.format, t.desc.sampleCount, t.desc.bindFlags, t.size, t.alignment) == false) return false;
+            mMemoryStats.transientBytes += t.size;
+            resources.push_back(t);
+        }
+        if (resources.empty()) return true;
+
+        // The lifetimes form an interval graph. Coloring it greedily in order of first use is optimal, so we get the fewest memory ranges such that resources sharing a range are never alive at the same time.
+        // Among the ranges free at a resource's first use, we pick the smallest that fits it, or grow the largest one if none does.
+        std::sort(resources.begin(), resources.end(), [this](const Transient& a, const Transient& b)
+        {
+            const auto& dataA = mResourceData[a.index];
+            const auto& dataB = mResourceData[b.index];
+            return (dataA.firstUsed != dataB.firstUsed) ? (dataA.firstUsed < dataB.firstUsed) : (a.size > b.size);
+        });
+
+        struct MemoryRange
+        {
+            uint64_t size = 0;
+            uint64_t alignment = 1;
+            uint32_t freeAfter = 0;         // Last time point of the resource currently occupying the range
+            uint32_t residentCount = 0;
+            uint64_t offset = 0;
+        };
+        std::vector<MemoryRange> ranges;
+        for (auto& t : resources)
+        {
+            const auto& data = mResourceData[t.index];
+            int32_t best = -1;
+            for (uint32_t r = 0; r < (uint32_t)ranges.size(); r++)
+            {
+                const MemoryRange& range = ranges[r];
+                if (range.freeAfter >= data.firstUsed) continue;
+                if (best < 0)
+                {
+                    best = r;
+                    continue;
+                }
+                const MemoryRange& current = ranges[best];
+                bool fits = range.size >= t.size;
+                bool currentFits = current.size >= t.size;
+                if ((fits && (!currentFits || range.size < current.size)) || (!fits && !currentFits && range.size > current.size)) best = r;
+            }
+
+            if (best < 0)
+            {
+                best = (int32_t)ranges.size();
+                ranges.push_back(MemoryRange());
+            }
+
+            MemoryRange& range = ranges[best];
+            range.size = std::max(range.size, t.size);
+            range.alignment = std::max(range.alignment, t.alignment);
+            range.freeAfter = data.lastUsed;
+            range.residentCount++;
+            t.range = (uint32_t)best;
+        }
+
+        // Lay the ranges out in a single heap
+        uint64_t heapSize = 0;
+        uint64_t heapAlignment = 1;
+        for (auto& range : ranges)
+        {
+            range.offset = align_to(range.alignment, heapSize);
+            heapSize = range.offset + range.size;
+            heapAlignment = std::max(heapAlignment, range.alignment);
+        }
+
+        mpTransientHeap = ResourceHeap::create(heapSize, heapAlignment);
+        if (mpTransientHeap == nullptr) return false;
+
+        std::vector<Texture::SharedPtr> textures;
+        for (const auto& t : resources)
+        {
+            const MemoryRange& range = ranges[t.range];
+            Texture::SharedPtr pTexture = Texture::createPlaced(mpTransientHeap, range.offset, t.desc.type, t.desc.width, t.desc.height, t.desc.depth, t.desc.format, t.desc.sampleCount, t.desc.bindFlags);
+            if (pTexture == nullptr)
+            {
+                mpTransientHeap = nullptr;
+                return false;
+            }
+            textures.push_back(pTexture);
+        }
+
+        // Resources sharing a range need to be activated at the start of their lifetime, including the first one in the frame, since the last one used the memory in the previous frame
+        for (size_t i = 0; i < resources.size(); i++)
+        {
+            auto& data = mResourceData[resources[i].index];
+            data.pResource = textures[i];
+            data.dirty = false;
+
+            if (ranges[resources[i].range].residentCount > 1)
+            {
+                if (mActivations.size() <= data.firstUsed) mActivations.resize(data.firstUsed + 1);
+                mActivations[data.firstUsed].push_back(resources[i].index);
+            }
+        }
+
+        mMemoryStats.aliasedBytes = mpTransientHeap->getSize();
+        mMemoryStats.memoryRangeCount = (uint32_t)ranges.size();
+        return true;
+    }
+
+    void ResourceCache::beginTimePoint(RenderContext* pContext, uint32_t timePoint)
     {
-        for (auto& data : mResourceData)
+        if (timePoint >= mActivations.size()) return;
+
+        for (uint32_t index : mActivations[timePoint])
         {
-            if ((data.pResource == nullptr || data.dirty) && data.field.isValid())
+            Texture::SharedPtr pTexture = std::dynamic_pointer_cast<Texture>(mResourceData[index].pResource);
+            if (pTexture == nullptr) continue;
+
+            // Placed render-targets and depth-stencils must be initialized after taking over memory from another resource. Other textures just have undefined contents.
+            pContext->aliasingBarrier(nullptr, pTexture.get());
+            if (is_set(pTexture->getBindFlags(), Resource::BindFlags::RenderTarget))
             {
-                data.pResource = createTextureForPass(params, data.field);
-                data.dirty = false;
+                pContext->clearRtv(pTexture->getRTV().get(), vec4(0));
+            }
+            else if (is_set(pTexture->getBindFlags(), Resource::BindFlags::DepthStencil))
+            {
+                pContext->clearDsv(pTexture->getDSV().get(), 1.0f, 0);
             }
         }
     }
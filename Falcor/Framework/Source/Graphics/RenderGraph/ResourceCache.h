@@ -33,6 +33,8 @@ namespace Falcor
 {
     class RenderPass;
     class Resource;
+    class RenderContext;
+    class ResourceHeap;
     
     class ResourceCache : public std::enable_shared_from_this<ResourceCache>
     {
@@ -68,9 +70,32 @@ namespace Falcor
 
         /** Allocate all resources that need to be created/updated. 
             This includes new resources, resources whose properties have been updated since last allocation call.
+            Transient resources (those that are neither graph outputs nor internal to a pass) whose lifetimes don't overlap are placed in the same memory when aliasing is enabled.
         */
         void allocateResources(const DefaultProperties& params);
 
+        /** Prepare the resources whose lifetime starts at a time point. Must be called before executing the pass at that time point.
+            Resources sharing memory with other resources get an aliasing barrier, and render-targets and depth-stencils among them are cleared.
+        */
+        void beginTimePoint(RenderContext* pContext, uint32_t timePoint);
+
+        /** Enable/disable aliasing of transient resources. Takes effect the next time resources are allocated.
+        */
+        void setAliasingEnabled(bool enabled) { mAliasingEnabled = enabled; }
+        bool isAliasingEnabled() const { return mAliasingEnabled; }
+
+        /** Memory used by the resources allocated in the last allocateResources() call
+        */
+        struct MemoryStats
+        {
+            uint32_t transientCount = 0;        ///< Number of transient resources
+            uint32_t memoryRangeCount = 0;      ///< Number of distinct memory ranges the transient resources were placed in
+            uint64_t transientBytes = 0;        ///< Memory the transient resources need when each has its own allocation
+            uint64_t aliasedBytes = 0;          ///< Memory the transient resources use when aliased. Equals transientBytes if aliasing is disabled or unsupported.
+            uint64_t persistentBytes = 0;       ///< Memory used by graph outputs and internal resources, which are never aliased
+        };
+        const MemoryStats& getMemoryStats() const { return mMemoryStats; }
+
         /** Clears all registered field/resource properties and allocated resources.
         */
         void reset();
@@ -89,6 +114,8 @@ namespace Falcor
 
             std::shared_ptr<Resource> pResource;
         };
+
+        bool placeTransientResources(const DefaultProperties& params, const std::vector<uint32_t>& transients);
         
         // Resources and properties for fields within (and therefore owned by) a render graph
         std::unordered_map<std::string, uint32_t> mNameToIndex;
@@ -96,6 +123,12 @@ namespace Falcor
 
         // References to output resources not to be allocated by the render graph
         std::unordered_map<std::string, std::shared_ptr<Resource>> mExternalInputs;
+
+        // Aliasing of transient resources
+        bool mAliasingEnabled = true;
+        std::shared_ptr<ResourceHeap> mpTransientHeap;
+        std::vector<std::vector<uint32_t>> mActivations;    // For each time point, the resources that share memory and start being used then
+        MemoryStats mMemoryStats;
     };
 
 }
\ No newline at end of file
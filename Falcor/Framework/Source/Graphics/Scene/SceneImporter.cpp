@@ -36,6 +36,12 @@
 #include "Graphics/TextureHelper.h"
 #include "API/Device.h"
 #include "Data/HostDeviceSharedMacros.h"
+#include "Graphics/Model/Loaders/AssimpModelImporter.h"
+#include "Graphics/AssetRegistry.h"
+#include <map>
+#include <thread>
+#include <future>
+#include <atomic>
 
 #define SCENE_IMPORTER
 #include "SceneExportImportCommon.h"
@@ -101,6 +107,10 @@ namespace Falcor
 
     bool SceneImporter::loadScene(Scene& scene, const std::string& filename, Model::LoadFlags modelLoadFlags, Scene::LoadFlags sceneLoadFlags)
     {
+        Logger::ScopedSubsystem logSubsystem("SceneImporter");
+        // Share identical textures and materials between all the models in the scene, including the ones in included files
+        AssetRegistry::ScopedActivation registryScope;
+
         SceneImporter importer(scene);
         return importer.load(filename, modelLoadFlags, sceneLoadFlags);
     }
@@ -175,7 +185,7 @@ namespace Falcor
         return true;
     }
 
-    bool SceneImporter::createModel(const rapidjson::Value& jsonModel)
+    bool SceneImporter::getModelFileAndFlags(const rapidjson::Value& jsonModel, std::string& file, Model::LoadFlags& modelFlags)
     {
         // Model must have at least a filename
         if (jsonModel.HasMember(SceneKeys::kFilename) == false)
@@ -190,14 +200,14 @@ namespace Falcor
             return error("Model filename must be a string");
         }
 
-        std::string file = mDirectory + '/' + modelFile.GetString();
+        file = mDirectory + '/' + modelFile.GetString();
         if (doesFileExist(file) == false)
         {
             file = modelFile.GetString();
         }
 
         // Parse additional properties that affect loading
-        Model::LoadFlags modelFlags = mModelLoadFlags;
+        modelFlags = mModelLoadFlags;
         if (jsonModel.HasMember(SceneKeys::kMaterial))
         {
             const auto& materialSettings = jsonModel[SceneKeys::kMaterial];
@@ -217,7 +227,11 @@ namespace Falcor
                 }
             }
         }
+        return true;
+    }
 
+    bool SceneImporter::createModel(const rapidjson::Value& jsonModel, const std::string& file, Model::LoadFlags modelFlags)
+    {
         // Load the model
         auto pModel = Model::createFromFile(file.c_str(), modelFlags);
         if (pModel == nullptr)
@@ -296,15 +310,104 @@ namespace Falcor
             return error("models section should be an array of objects.");
         }
 
-        // Loop over the array
+        // Resolve the files first, so that they can be parsed in parallel
+        struct ModelFile
+        {
+            std::string file;
+            Model::LoadFlags flags;
+            uint32_t prefetchTask;
+        };
+        std::vector<ModelFile> modelFiles(jsonVal.Size());
+        std::vector<ModelFile*> prefetchTasks;
+        std::vector<uint32_t> prefetchUseCounts;
+        std::map<std::string, uint32_t> fileToTask;
         for (uint32_t i = 0; i < jsonVal.Size(); i++)
         {
-            if (createModel(jsonVal[i]) == false)
+            ModelFile& m = modelFiles[i];
+            if (getModelFileAndFlags(jsonVal[i], m.file, m.flags) == false)
             {
                 return false;
             }
+
+            // Models which share parsed data are parsed once, using the importer's own key. Binary models don't go through Assimp and are loaded on this thread.
+            // Files which can't be found aren't prefetched; createModel() reports the error.
+            m.prefetchTask = uint32_t(-1);
+            std::string key = hasSuffix(m.file, ".bin", false) ? "" : AssimpModelImporter::getPrefetchKey(m.file, m.flags);
+            if (key.empty() == false)
+            {
+                auto it = fileToTask.find(key);
+                if (it == fileToTask.end())
+                {
+                    it = fileToTask.insert({ key, uint32_t(prefetchTasks.size()) }).first;
+                    prefetchTasks.push_back(&m);
+                    prefetchUseCounts.push_back(0);
+                }
+                m.prefetchTask = it->second;
+                prefetchUseCounts[m.prefetchTask]++;
+            }
         }
-        return true;
+
+        // Parse the files on worker threads. Parsing doesn't touch the device; creating the GPU resources, instances and ids happens below
+        // on this thread, in the order the models appear in the scene file, so the result doesn't depend on which file finishes parsing first.
+        std::vector<std::promise<void>> prefetchDone(prefetchTasks.size());
+        std::vector<std::shared_future<void>> prefetchFutures;
+        for (auto& p : prefetchDone) prefetchFutures.push_back(p.get_future().share());
+
+        std::atomic<uint32_t> nextTask(0);
+        std::vector<std::thread> workers;
+
+        // Stops and joins the workers however this function exits, including through an exception, since destroying a joinable thread terminates the application
+        struct WorkerGuard
+        {
+            std::vector<std::thread>& workers;
+            std::atomic<uint32_t>& nextTask;
+            uint32_t taskCount;
+            ~WorkerGuard()
+            {
+                nextTask = taskCount;
+                for (auto& worker : workers) worker.join();
+                AssimpModelImporter::releasePrefetchedFiles();
+            }
+        } workerGuard{ workers, nextTask, uint32_t(prefetchTasks.size()) };
+
+        size_t workerCount = std::min<size_t>(prefetchTasks.size(), std::max(1u, std::thread::hardware_concurrency()));
+        for (size_t i = 0; i < workerCount; i++)
+        {
+            workers.emplace_back([&]()
+            {
+                for (uint32_t t = nextTask++; t < prefetchTasks.size(); t = nextTask++)
+                {
+                    // A failed prefetch isn't fatal. createModel() parses the file again and reports the error on this thread
+                    try
+                    {
+                        AssimpModelImporter::prefetch(prefetchTasks[t]->file, prefetchTasks[t]->flags, prefetchUseCounts[t]);
+                    }
+                    catch (const std::exception& e)
+                    {
+                        logWarning("Prefetching model '" + prefetchTasks[t]->file + "' failed: " + e.what());
+                    }
+                    catch (...)
+                    {
+                        logWarning("Prefetching model '" + prefetchTasks[t]->file + "' failed.");
+                    }
+                    prefetchDone[t].set_value();
+                }
+            });
+        }
+
+        bool result = true;
+        for (uint32_t i = 0; i < jsonVal.Size(); i++)
+        {
+            const ModelFile& m = modelFiles[i];
+            if (m.prefetchTask != uint32_t(-1)) prefetchFutures[m.prefetchTask].wait();
+            if (createModel(jsonVal[i], m.file, m.flags) == false)
+            {
+                result = false;
+                break;
+            }
+        }
+
+        return result;
     }
 
     bool SceneImporter::createDirLight(const rapidjson::Value& jsonLight)
@@ -240,7 +240,7 @@ namespace Falcor
         currentData.pContext->drawIndexedInstanced(indexCount, instanceCount, 0, 0, 0);
     }
 
-    void SceneRenderer::draw(CurrentWorkingData& currentData, const Mesh* pMesh, uint32_t instanceCount)
+    void SceneRenderer::draw(CurrentWorkingData& currentData, const Mesh* pMesh, uint32_t lod, uint32_t instanceCount)
     {
         currentData.pMaterial = pMesh->getMaterial().get();
         // Bind material
@@ -258,7 +258,8 @@ namespace Falcor
             }
         }
 
-        executeDraw(currentData, pMesh->getIndexCount(), instanceCount);
+        executeDraw(currentData, pMesh->getLodIndexCount(lod), instanceCount);
+        mTrianglesDrawn += uint64_t(pMesh->getLodPrimitiveCount(lod)) * instanceCount;
         postFlushDraw(currentData);
         currentData.pState->getProgram()->removeDefine("_MS_STATIC_MATERIAL_FLAGS");
     }
@@ -274,6 +275,31 @@ namespace Falcor
         return currentData.pCamera->isObjectCulled(box);
     }
 
+    uint32_t SceneRenderer::selectMeshInstanceLod(const CurrentWorkingData& currentData, const Scene::ModelInstance* pModelInstance, const Model::MeshInstance* pMeshInstance)
+    {
+        const Mesh* pMesh = pMeshInstance->getObject().get();
+        if (mLodEnabled == false || pMesh->getLodCount() == 1) return 0;
+
+        // Project the LOD error at the point of the bounding-box closest to the camera
+        glm::mat4 worldMat = pModelInstance->getTransformMatrix() * pMeshInstance->getTransformMatrix();
+        float scale = max(max(length(vec3(worldMat[0])), length(vec3(worldMat[1]))), length(vec3(worldMat[2])));
+        BoundingBox box = pMeshInstance->getBoundingBox().transform(pModelInstance->getTransformMatrix());
+        float distance = length(box.center - currentData.pCamera->getPosition()) - length(box.extent);
+        if (distance <= 0) return 0;
+
+        // projMat[1][1] is cot(fovY/2), which converts view-space sizes at unit distance to NDC
+        float viewportHeight = currentData.pState->getViewport(0).height;
+        float pixelsPerUnit = currentData.pCamera->getProjMatrix()[1][1] * viewportHeight * 0.5f / distance;
+
+        uint32_t lod = 0;
+        while ((lod + 1 < pMesh->getLodCount()) && (pMesh->getLodError(lod + 1) * scale * pixelsPerUnit <= mLodErrorThreshold))
+        {
+            lod++;
+        }
+        mMaxLodErrorDrawn = max(mMaxLodErrorDrawn, pMesh->getLodError(lod) * scale);
+        return lod;
+    }
+
     void SceneRenderer::renderMeshInstances(CurrentWorkingData& currentData, const Scene::ModelInstance* pModelInstance, uint32_t meshID)
     {
         const Model* pModel = currentData.pModel;
@@ -288,10 +314,12 @@ namespace Falcor
                 pProgram->addDefine("_VERTEX_BLENDING");
             }
 
-            // Bind VAO and set topology            
-            currentData.pState->setVao(useVsSkinning ? pMesh->getVao() : pModel->getMeshVao(pMesh));
-
-            uint32_t activeInstances = 0;
+            // Gather the visible instances. Instances using different LODs can't share a draw-call, so they are bucketed by LOD.
+            mLodInstances.resize(max(pMesh->getLodCount(), (uint32_t)mLodInstances.size()));
+            for (auto& instances : mLodInstances)
+            {
+                instances.clear();
+            }
 
             const uint32_t instanceCount = pModel->getMeshInstanceCount(meshID);
             for (uint32_t instanceID = 0; instanceID < instanceCount; instanceID++)
@@ -302,25 +330,46 @@ namespace Falcor
                 {
                     if ((mCullEnabled == false) || (cullMeshInstance(currentData, pModelInstance, pMeshInstance) == false))
                     {
-                        if (setPerMeshInstanceData(currentData, pModelInstance, pMeshInstance, activeInstances))
-                        {
-                            currentData.drawID++;
-                            activeInstances++;
-
-                            if (activeInstances == mMaxInstanceCount)
-                            {
-                                // DISABLED_FOR_D3D12
-                                //pContext->setProgram(currentData.pProgram->getActiveProgramVersion());
-                                draw(currentData, pMesh, activeInstances);
-                                activeInstances = 0;
-                            }
-                        }
+                        mLodInstances[selectMeshInstanceLod(currentData, pModelInstance, pMeshInstance)].push_back(pMeshInstance);
                     }
                 }
             }
-            if(activeInstances != 0)
+
+            for (uint32_t lod = 0; lod < pMesh->getLodCount(); lod++)
             {
-                draw(currentData, pMesh, activeInstances);
+                if (mLodInstances[lod].empty()) continue;
+
+                // Bind VAO and set topology. Skinned meshes don't have LODs.
+                if (lod == 0)
+                {
+                    currentData.pState->setVao(useVsSkinning ? pMesh->getVao() : pModel->getMeshVao(pMesh));
+                }
+                else
+                {
+                    currentData.pState->setVao(pMesh->getLodVao(lod));
+                }
+
+                uint32_t activeInstances = 0;
+                for (const Model::MeshInstance* pMeshInstance : mLodInstances[lod])
+                {
+                    if (setPerMeshInstanceData(currentData, pModelInstance, pMeshInstance, activeInstances))
+                    {
+                        currentData.drawID++;
+                        activeInstances++;
+
+                        if (activeInstances == mMaxInstanceCount)
+                        {
+                            // DISABLED_FOR_D3D12
+                            //pContext->setProgram(currentData.pProgram->getActiveProgramVersion());
+                            draw(currentData, pMesh, lod, activeInstances);
+                            activeInstances = 0;
+                        }
+                    }
+                }
+                if (activeInstances != 0)
+                {
+                    draw(currentData, pMesh, lod, activeInstances);
+                }
             }
 
             // Restore the program state
@@ -85,6 +85,34 @@ namespace Falcor
         */
         void setMaxInstanceCount(uint32_t instanceCount) { mMaxInstanceCount = instanceCount; }
 
+        /** Enable/disable LOD selection. When enabled, meshes with a LOD chain are drawn with the coarsest LOD whose projected error is below the LOD error threshold.
+        */
+        void toggleLodSelection(bool enable) { mLodEnabled = enable; }
+
+        /** Check if LOD selection is enabled
+        */
+        bool isLodSelectionEnabled() const { return mLodEnabled; }
+
+        /** Set the largest screen-space error, in pixels, that a LOD may introduce
+        */
+        void setLodErrorThreshold(float pixels) { mLodErrorThreshold = pixels; }
+
+        /** Get the LOD error threshold in pixels
+        */
+        float getLodErrorThreshold() const { return mLodErrorThreshold; }
+
+        /** Get the number of triangles drawn since the last call to resetDrawStats(). Reset it at the beginning of a frame to get the per-frame count.
+        */
+        uint64_t getTrianglesDrawn() const { return mTrianglesDrawn; }
+
+        /** Get the largest world-space error of the LODs drawn since the last call to resetDrawStats(). The drawn surface may be this far from the full-resolution meshes.
+        */
+        float getMaxLodErrorDrawn() const { return mMaxLodErrorDrawn; }
+
+        /** Reset the counters returned by getTrianglesDrawn() and getMaxLodErrorDrawn()
+        */
+        void resetDrawStats() { mTrianglesDrawn = 0; mMaxLodErrorDrawn = 0; }
+
         enum class CameraControllerType
         {
             FirstPerson,
@@ -147,10 +175,11 @@ namespace Falcor
         virtual void executeDraw(const CurrentWorkingData& currentData, uint32_t indexCount, uint32_t instanceCount);
         virtual void postFlushDraw(const CurrentWorkingData& currentData);
         virtual bool cullMeshInstance(const CurrentWorkingData& currentData, const Scene::ModelInstance* pModelInstance, const Model::MeshInstance* pMeshInstance);
+        virtual uint32_t selectMeshInstanceLod(const CurrentWorkingData& currentData, const Scene::ModelInstance* pModelInstance, const Model::MeshInstance* pMeshInstance);
 
         void renderModelInstance(CurrentWorkingData& currentData, const Scene::ModelInstance* pModelInstance);
         void renderMeshInstances(CurrentWorkingData& currentData, const Scene::ModelInstance* pModelInstance, uint32_t meshID);
-        void draw(CurrentWorkingData& currentData, const Mesh* pMesh, uint32_t instanceCount);
+        void draw(CurrentWorkingData& currentData, const Mesh* pMesh, uint32_t lod, uint32_t instanceCount);
 
         void renderScene(CurrentWorkingData& currentData);
 
@@ -160,6 +189,11 @@ namespace Falcor
         uint32_t mMaxInstanceCount = 64;
         const Material* mpLastMaterial = nullptr;
         bool mCullEnabled = true;
+        bool mLodEnabled = true;
+        float mLodErrorThreshold = 1.0f;
+        std::vector<std::vector<const Model::MeshInstance*>> mLodInstances;   ///< Visible instances of the current mesh, bucketed by LOD
+        uint64_t mTrianglesDrawn = 0;
+        float mMaxLodErrorDrawn = 0;
         bool mCompileMaterialWithProgram = true;
     };
 }
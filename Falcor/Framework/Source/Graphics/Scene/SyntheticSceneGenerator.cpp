@@ -0,0 +1,222 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "SyntheticSceneGenerator.h"
+#include "Utils/Platform/OS.h"
+#include <fstream>
+#include <random>
+#include <cstdio>
+
+namespace Falcor
+{
+    namespace
+    {
+        // A sum of sines, evaluated in world-space so that neighboring tiles line up
+        struct Terrain
+        {
+            static const uint32_t kOctaves = 5;
+            vec2 frequency[kOctaves];
+            vec2 phase[kOctaves];
+            float amplitude[kOctaves];
+
+            Terrain(uint32_t seed, float tileSize)
+            {
+                std::mt19937 rng(seed);
+                std::uniform_real_distribution<float> dist(0, 1);
+                float wavelength = tileSize * 2;
+                float height = tileSize * 0.15f;
+                for (uint32_t i = 0; i < kOctaves; i++)
+                {
+                    frequency[i] = vec2((2.0f * (float)M_PI) / wavelength) * vec2(0.75f + 0.5f * dist(rng), 0.75f + 0.5f * dist(rng));
+                    phase[i] = vec2(dist(rng), dist(rng)) * (2.0f * (float)M_PI);
+                    amplitude[i] = height;
+                    wavelength *= 0.45f;
+                    height *= 0.4f;
+                }
+            }
+
+            float height(float x, float z) const
+            {
+                float h = 0;
+                for (uint32_t i = 0; i < kOctaves; i++)
+                {
+                    h += amplitude[i] * sin(frequency[i].x * x + phase[i].x) * cos(frequency[i].y * z + phase[i].y);
+                }
+                return h;
+            }
+
+            vec3 normal(float x, float z) const
+            {
+                float dx = 0;
+                float dz = 0;
+                for (uint32_t i = 0; i < kOctaves; i++)
+                {
+                    float sx = sin(frequency[i].x * x + phase[i].x);
+                    float cx = cos(frequency[i].x * x + phase[i].x);
+                    float sz = sin(frequency[i].y * z + phase[i].y);
+                    float cz = cos(frequency[i].y * z + phase[i].y);
+                    dx += amplitude[i] * frequency[i].x * cx * cz;
+                    dz -= amplitude[i] * frequency[i].y * sx * sz;
+                }
+                return glm::normalize(vec3(-dx, 1, -dz));
+            }
+        };
+
+        bool writeTile(const std::string& filename, const Terrain& terrain, vec2 origin, float tileSize, uint32_t quadsPerSide)
+        {
+            // Write to a temporary file and rename it, so that a partially written tile is never reused
+            std::string tempFile = filename + ".tmp";
+            {
+                std::ofstream stream(tempFile, std::ios::trunc);
+                if (stream.fail()) return false;
+
+                const uint32_t vertsPerSide = quadsPerSide + 1;
+                const float step = tileSize / quadsPerSide;
+                char line[128];
+
+                // Positions are relative to the tile origin. The instance in the scene file places the tile.
+                for (uint32_t z = 0; z < vertsPerSide; z++)
+                {
+                    for (uint32_t x = 0; x < vertsPerSide; x++)
+                    {
+                        float wx = origin.x + x * step;
+                        float wz = origin.y + z * step;
+                        vec3 n = terrain.normal(wx, wz);
+                        snprintf(line, sizeof(line), "v %.4f %.4f %.4f\nvn %.4f %.4f %.4f\nvt %.5f %.5f\n", x * step, terrain.height(wx, wz), z * step, n.x, n.y, n.z, float(x) / quadsPerSide, float(z) / quadsPerSide);
+                        stream << line;
+                    }
+                }
+
+                for (uint32_t z = 0; z < quadsPerSide; z++)
+                {
+                    for (uint32_t x = 0; x < quadsPerSide; x++)
+                    {
+                        // OBJ indices are 1-based
+                        uint32_t i0 = z * vertsPerSide + x + 1;
+                        uint32_t i1 = i0 + 1;
+                        uint32_t i2 = i0 + vertsPerSide;
+                        uint32_t i3 = i2 + 1;
+                        snprintf(line, sizeof(line), "f %u/%u/%u %u/%u/%u %u/%u/%u\nf %u/%u/%u %u/%u/%u %u/%u/%u\n", i0, i0, i0, i2, i2, i2, i1, i1, i1, i1, i1, i1, i2, i2, i2, i3, i3, i3);
+                        stream << line;
+                    }
+                }
+
+                if (stream.fail()) return false;
+            }
+            std::remove(filename.c_str());
+            return std::rename(tempFile.c_str(), filename.c_str()) == 0;
+        }
+
+        std::string vec3ToJson(const vec3& v)
+        {
+            return "[ " + std::to_string(v.x) + ", " + std::to_string(v.y) + ", " + std::to_string(v.z) + " ]";
+        }
+    }
+
+    std::string SyntheticSceneGenerator::generate(const Desc& desc)
+    {
+        std::string directory = desc.outputDirectory.empty() ? getExecutableDirectory() + "/SyntheticScenes" : desc.outputDirectory;
+        if (isDirectoryExists(directory) == false && createDirectory(directory) == false)
+        {
+            logError("SyntheticSceneGenerator: can't create directory '" + directory + "'.");
+            return "";
+        }
+
+        if (desc.tilesPerSide == 0 || desc.trianglesPerTile < 2 || desc.tileSize <= 0)
+        {
+            logError("SyntheticSceneGenerator: invalid scene description.");
+            return "";
+        }
+
+        // Each quad is 2 triangles
+        uint32_t quadsPerSide = std::max(1u, (uint32_t)std::sqrt(desc.trianglesPerTile / 2.0));
+        std::string prefix = "terrain_s" + std::to_string(desc.seed) + "_q" + std::to_string(quadsPerSide) + "_t" + std::to_string((uint32_t)desc.tileSize);
+        Terrain terrain(desc.seed, desc.tileSize);
+
+        std::string models;
+        for (uint32_t tz = 0; tz < desc.tilesPerSide; tz++)
+        {
+            for (uint32_t tx = 0; tx < desc.tilesPerSide; tx++)
+            {
+                std::string tileName = prefix + "_" + std::to_string(tx) + "_" + std::to_string(tz);
+                std::string tileFile = tileName + ".obj";
+                vec3 origin = vec3(tx, 0, tz) * desc.tileSize;
+
+                if (doesFileExist(directory + '/' + tileFile) == false)
+                {
+                    if (writeTile(directory + '/' + tileFile, terrain, vec2(origin.x, origin.z), desc.tileSize, quadsPerSide) == false)
+                    {
+                        logError("SyntheticSceneGenerator: can't write tile '" + tileFile + "'.");
+                        return "";
+                    }
+                }
+
+                if (models.size()) models += ",\n";
+                models += "        {\n";
+                models += "            \"file\": \"" + tileFile + "\",\n";
+                models += "            \"name\": \"" + tileName + "\",\n";
+                models += "            \"instances\": [ { \"name\": \"" + tileName + "_0\", \"translation\": " + vec3ToJson(origin) + ", \"scaling\": [ 1.0, 1.0, 1.0 ], \"rotation\": [ 0.0, 0.0, 0.0 ] } ]\n";
+                models += "        }";
+            }
+        }
+
+        // Place the camera above one corner, looking across the terrain
+        float sceneSize = desc.tileSize * desc.tilesPerSide;
+        vec3 cameraPos = vec3(desc.tileSize * 0.25f, desc.tileSize * 0.5f, desc.tileSize * 0.25f);
+        vec3 cameraTarget = vec3(sceneSize * 0.5f, 0, sceneSize * 0.5f);
+
+        std::string scene;
+        scene += "{\n";
+        scene += "    \"version\": 2,\n";
+        scene += "    \"camera_speed\": " + std::to_string(desc.tileSize * 0.25f) + ",\n";
+        scene += "    \"lighting_scale\": 1.0,\n";
+        scene += "    \"active_camera\": \"Camera0\",\n";
+        scene += "    \"models\": [\n" + models + "\n    ],\n";
+        scene += "    \"lights\": [\n";
+        scene += "        { \"name\": \"dirLight0\", \"type\": \"dir_light\", \"intensity\": [ 1.0, 1.0, 1.0 ], \"direction\": " + vec3ToJson(glm::normalize(vec3(0.4f, -0.6f, 0.7f))) + " }\n";
+        scene += "    ],\n";
+        scene += "    \"cameras\": [\n";
+        scene += "        { \"name\": \"Camera0\", \"pos\": " + vec3ToJson(cameraPos) + ", \"target\": " + vec3ToJson(cameraTarget) + ", \"up\": [ 0.0, 1.0, 0.0 ], ";
+        scene += "\"focal_length\": 21.0, \"depth_range\": [ 0.1, " + std::to_string(sceneSize * 2) + " ], \"aspect_ratio\": 1.0 }\n";
+        scene += "    ]\n";
+        scene += "}\n";
+
+        std::string sceneFile = directory + '/' + prefix + "_" + std::to_string(desc.tilesPerSide) + "x" + std::to_string(desc.tilesPerSide) + ".fscene";
+        std::ofstream stream(sceneFile, std::ios::trunc);
+        stream << scene;
+        if (stream.fail())
+        {
+            logError("SyntheticSceneGenerator: can't write scene file '" + sceneFile + "'.");
+            return "";
+        }
+
+        uint64_t triangleCount = 2ull * quadsPerSide * quadsPerSide * desc.tilesPerSide * desc.tilesPerSide;
+        logInfo("SyntheticSceneGenerator: wrote '" + sceneFile + "' with " + std::to_string(desc.tilesPerSide * desc.tilesPerSide) + " tiles and " + std::to_string(triangleCount) + " triangles.");
+        return sceneFile;
+    }
+}
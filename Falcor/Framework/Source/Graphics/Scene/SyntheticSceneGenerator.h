@@ -0,0 +1,54 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <string>
+
+namespace Falcor
+{
+    /** Generates scenes for stress-testing geometry streaming.
+        The scene is a grid of heightfield tiles. Each tile is a separate model with unique geometry, so the amount of geometry grows with the number of tiles and can't be reduced by instancing.
+    */
+    class SyntheticSceneGenerator
+    {
+    public:
+        struct Desc
+        {
+            std::string outputDirectory;            ///< Where the scene is written. If empty, uses '<executable directory>/SyntheticScenes'
+            uint32_t tilesPerSide = 8;              ///< The scene has tilesPerSide*tilesPerSide tiles
+            uint32_t trianglesPerTile = 1 << 19;    ///< Approximate number of triangles in each tile
+            float tileSize = 100;                   ///< World-space size of a tile
+            uint32_t seed = 0;                      ///< Seed of the terrain function
+        };
+
+        /** Write the tiles as OBJ files and a scene file which references them. Tiles which already exist are reused, so regenerating the same scene is cheap.
+            \param[in] desc The scene description
+            \return The full path of the scene file, or an empty string on failure
+        */
+        static std::string generate(const Desc& desc = Desc());
+    };
+}
@@ -0,0 +1,613 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "TextureStreamer.h"
+#include "Graphics/TextureHelper.h"
+#include "Graphics/Material/Material.h"
+#include "Graphics/Scene/Scene.h"
+#include "Graphics/Camera/Camera.h"
+#include "API/RenderContext.h"
+#include "Utils/Bitmap.h"
+#include "Utils/Gui.h"
+#include "Utils/Platform/OS.h"
+#include "Utils/Math/FalcorMath.h"
+#include <fstream>
+#include <algorithm>
+#include <cstdio>
+
+namespace Falcor
+{
+    static const uint32_t kCookedMagic = 0x58455446;    // 'FTEX'
+    static const uint32_t kCookedVersion = 1;
+
+    struct CookedHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t width;
+        uint32_t height;
+        uint32_t format;
+        uint32_t mipCount;
+        int64_t sourceTime;
+    };
+
+    static TextureStreamer::SharedPtr spGlobalStreamer;
+
+    static float srgbToLinear(float c)
+    {
+        return (c <= 0.04045f) ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+    }
+
+    static float linearToSrgb(float c)
+    {
+        return (c <= 0.0031308f) ? c * 12.92f : 1.055f * powf(c, 1.0f / 2.4f) - 0.055f;
+    }
+
+    /** Downsample a mip by 2x2 box-filtering. Odd dimensions clamp to the last row/column.
+        For 8-bit formats, the color channels can be filtered in linear space. Alpha is always filtered linearly.
+    */
+    template<typename T>
+    static void downsampleMip(const T* pSrc, uint32_t srcWidth, uint32_t srcHeight, T* pDst, uint32_t channels, bool srgb)
+    {
+        uint32_t dstWidth = std::max(1u, srcWidth >> 1);
+        uint32_t dstHeight = std::max(1u, srcHeight >> 1);
+        const float scale = std::is_same<T, uint8_t>::value ? 255.0f : 1.0f;
+
+        for (uint32_t y = 0; y < dstHeight; y++)
+        {
+            uint32_t y0 = std::min(y * 2, srcHeight - 1);
+            uint32_t y1 = std::min(y * 2 + 1, srcHeight - 1);
+            for (uint32_t x = 0; x < dstWidth; x++)
+            {
+                uint32_t x0 = std::min(x * 2, srcWidth - 1);
+                uint32_t x1 = std::min(x * 2 + 1, srcWidth - 1);
+                const T* pTexels[4] = { pSrc + (y0 * srcWidth + x0) * channels, pSrc + (y0 * srcWidth + x1) * channels, pSrc + (y1 * srcWidth + x0) * channels, pSrc + (y1 * srcWidth + x1) * channels };
+
+                for (uint32_t c = 0; c < channels; c++)
+                {
+                    bool linearize = srgb && (c < 3);
+                    float sum = 0;
+                    for (uint32_t t = 0; t < 4; t++)
+                    {
+                        float v = float(pTexels[t][c]) / scale;
+                        sum += linearize ? srgbToLinear(v) : v;
+                    }
+                    float avg = sum * 0.25f;
+                    if (linearize) avg = linearToSrgb(avg);
+                    if (std::is_same<T, uint8_t>::value)
+                    {
+                        pDst[(y * dstWidth + x) * channels + c] = T(glm::clamp(avg * scale + 0.5f, 0.0f, 255.0f));
+                    }
+                    else
+                    {
+                        pDst[(y * dstWidth + x) * channels + c] = T(avg);
+                    }
+                }
+            }
+        }
+    }
+
+    TextureStreamer::SharedPtr TextureStreamer::create(const Desc& desc)
+    {
+        return SharedPtr(new TextureStreamer(desc));
+    }
+
+    const TextureStreamer::SharedPtr& TextureStreamer::getGlobalStreamer(bool createIfMissing)
+    {
+        if (spGlobalStreamer == nullptr && createIfMissing)
+        {
+            spGlobalStreamer = create();
+        }
+        return spGlobalStreamer;
+    }
+
+    void TextureStreamer::setGlobalStreamer(const SharedPtr& pStreamer)
+    {
+        spGlobalStreamer = pStreamer;
+    }
+
+    TextureStreamer::TextureStreamer(const Desc& desc) : mDesc(desc)
+    {
+        if (mDesc.cacheDirectory.empty())
+        {
+            mDesc.cacheDirectory = getExecutableDirectory() + "/TextureCache";
+        }
+        if (isDirectoryExists(mDesc.cacheDirectory) == false && createDirectory(mDesc.cacheDirectory) == false)
+        {
+            logWarning("TextureStreamer: can't create cache directory '" + mDesc.cacheDirectory + "'.");
+        }
+        mDesc.mipTailSize = std::max(1u, mDesc.mipTailSize);
+        mIoThread = std::thread(&TextureStreamer::ioThreadFunc, this);
+    }
+
+    TextureStreamer::~TextureStreamer()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mIoMutex);
+            mTerminate = true;
+        }
+        mIoCondition.notify_all();
+        mIoThread.join();
+    }
+
+    bool TextureStreamer::cookTexture(const std::string& fullpath, bool loadAsSrgb, const std::string& cookedFile)
+    {
+        Bitmap::UniqueConstPtr pBitmap = Bitmap::createFromFile(fullpath, true);
+        if (pBitmap == nullptr) return false;
+
+        ResourceFormat format = pBitmap->getFormat();
+        bool isFloat = (format == ResourceFormat::RGBA32Float);
+        bool isUnorm8 = (format == ResourceFormat::BGRA8Unorm) || (format == ResourceFormat::BGRX8Unorm) || (format == ResourceFormat::RG8Unorm) || (format == ResourceFormat::R8Unorm);
+        if (isFloat == false && isUnorm8 == false)
+        {
+            // Only the common formats are streamed. The rest are loaded fully resident
+            return false;
+        }
+
+        if (loadAsSrgb) format = linearToSrgbFormat(format);
+        bool srgb = isSrgbFormat(format);
+
+        uint32_t width = pBitmap->getWidth();
+        uint32_t height = pBitmap->getHeight();
+        uint32_t mipCount = 1;
+        while ((std::max(width, height) >> mipCount) > 0) mipCount++;
+
+        // Build the full mip-chain
+        uint32_t bpp = getFormatBytesPerBlock(format);
+        uint32_t channels = bpp / (isFloat ? sizeof(float) : sizeof(uint8_t));
+        std::vector<std::vector<uint8_t>> mips(mipCount);
+        mips[0].assign(pBitmap->getData(), pBitmap->getData() + size_t(width) * height * bpp);
+        for (uint32_t m = 1; m < mipCount; m++)
+        {
+            uint32_t srcW = std::max(1u, width >> (m - 1));
+            uint32_t srcH = std::max(1u, height >> (m - 1));
+            mips[m].resize(size_t(std::max(1u, width >> m)) * std::max(1u, height >> m) * bpp);
+            if (isFloat)
+            {
+                downsampleMip((const float*)mips[m - 1].data(), srcW, srcH, (float*)mips[m].data(), channels, false);
+            }
+            else
+            {
+                downsampleMip(mips[m - 1].data(), srcW, srcH, mips[m].data(), channels, srgb);
+            }
+        }
+
+        // Write through a temporary file, so that a partially written file is never picked up
+        bool written = writeFileAtomic(cookedFile, [&](std::ostream& stream)
+        {
+            CookedHeader header = { kCookedMagic, kCookedVersion, width, height, uint32_t(format), mipCount, int64_t(getFileModifiedTime(fullpath)) };
+            stream.write((const char*)&header, sizeof(header));
+            uint64_t offset = sizeof(header) + mipCount * sizeof(uint64_t) * 2;
+            for (uint32_t m = 0; m < mipCount; m++)
+            {
+                uint64_t size = mips[m].size();
+                stream.write((const char*)&offset, sizeof(offset));
+                stream.write((const char*)&size, sizeof(size));
+                offset += size;
+            }
+            for (const auto& mip : mips)
+            {
+                stream.write((const char*)mip.data(), mip.size());
+            }
+            return true;
+        });
+        if (written == false) logWarning("TextureStreamer: can't write cooked texture '" + cookedFile + "'.");
+        return written;
+    }
+
+    bool TextureStreamer::readCookedHeader(StreamedTexture& tex)
+    {
+        std::ifstream stream(tex.cookedFile, std::ios::binary);
+        if (stream.is_open() == false) return false;
+
+        CookedHeader header;
+        stream.read((char*)&header, sizeof(header));
+        if (stream.good() == false || header.magic != kCookedMagic || header.version != kCookedVersion || header.mipCount == 0) return false;
+
+        tex.width = header.width;
+        tex.height = header.height;
+        tex.format = ResourceFormat(header.format);
+        tex.mipCount = header.mipCount;
+        tex.mipOffsets.resize(tex.mipCount);
+        tex.mipSizes.resize(tex.mipCount);
+        for (uint32_t m = 0; m < tex.mipCount; m++)
+        {
+            stream.read((char*)&tex.mipOffsets[m], sizeof(uint64_t));
+            stream.read((char*)&tex.mipSizes[m], sizeof(uint64_t));
+        }
+        return stream.good();
+    }
+
+    uint64_t TextureStreamer::getMipRangeSize(const StreamedTexture& tex, uint32_t firstMip, uint32_t endMip) const
+    {
+        uint64_t size = 0;
+        for (uint32_t m = firstMip; m < endMip; m++) size += tex.mipSizes[m];
+        return size;
+    }
+
+    Texture::SharedPtr TextureStreamer::loadTexture(const std::string& filename, bool loadAsSrgb)
+    {
+        std::string fullpath;
+        if (findFileInDataDirectories(filename, fullpath) == false)
+        {
+            logWarning("TextureStreamer: can't find texture file '" + filename + "'.");
+            return nullptr;
+        }
+
+        if (hasSuffix(fullpath, ".dds", false))
+        {
+            return createTextureFromFile(fullpath, true, loadAsSrgb);
+        }
+
+        std::string key = fullpath + (loadAsSrgb ? "|srgb" : "|linear");
+        auto it = mFileToId.find(key);
+        if (it != mFileToId.end())
+        {
+            return mTextures[it->second].pTexture;
+        }
+
+        StreamedTexture tex;
+        tex.cookedFile = mDesc.cacheDirectory + "/" + std::to_string(std::hash<std::string>()(key)) + ".ftex";
+
+        // Re-cook if the cooked file is missing, corrupted or older than the source
+        bool valid = false;
+        {
+            std::ifstream stream(tex.cookedFile, std::ios::binary);
+            CookedHeader header;
+            if (stream.is_open() && stream.read((char*)&header, sizeof(header)))
+            {
+                valid = (header.magic == kCookedMagic) && (header.version == kCookedVersion) && (header.sourceTime == int64_t(getFileModifiedTime(fullpath)));
+            }
+        }
+
+        if ((valid == false && cookTexture(fullpath, loadAsSrgb, tex.cookedFile) == false) || readCookedHeader(tex) == false)
+        {
+            return createTextureFromFile(fullpath, true, loadAsSrgb);
+        }
+
+        tex.tailMip = 0;
+        while ((tex.tailMip + 1 < tex.mipCount) && (std::max(tex.width, tex.height) >> tex.tailMip) > mDesc.mipTailSize) tex.tailMip++;
+
+        // Read the mip-tail. It's stored contiguously at the end of the file
+        std::vector<uint8_t> tailData(getMipRangeSize(tex, tex.tailMip, tex.mipCount));
+        {
+            std::ifstream stream(tex.cookedFile, std::ios::binary);
+            stream.seekg(tex.mipOffsets[tex.tailMip]);
+            if (stream.read((char*)tailData.data(), tailData.size()).good() == false)
+            {
+                logWarning("TextureStreamer: failed to read cooked texture '" + tex.cookedFile + "'.");
+                return createTextureFromFile(fullpath, true, loadAsSrgb);
+            }
+        }
+
+        tex.pTexture = Texture::create2D(std::max(1u, tex.width >> tex.tailMip), std::max(1u, tex.height >> tex.tailMip), tex.format, 1, tex.mipCount - tex.tailMip, tailData.data());
+        if (tex.pTexture == nullptr) return nullptr;
+        tex.pTexture->setSourceFilename(stripDataDirectories(fullpath));
+        tex.residentMip = tex.tailMip;
+        tex.requestedMip = tex.tailMip;
+        tex.lastUsedFrame = mFrameCount;
+
+        uint32_t id = (uint32_t)mTextures.size();
+        mFileToId[key] = id;
+        mTextureToId[tex.pTexture.get()] = id;
+        mStats.residentBytes += tailData.size();
+        mStats.peakResidentBytes = std::max(mStats.peakResidentBytes, mStats.residentBytes);
+        mStats.textureCount++;
+        mTextures.push_back(std::move(tex));
+        return mTextures.back().pTexture;
+    }
+
+    void TextureStreamer::registerMaterial(const Material::SharedPtr& pMaterial)
+    {
+        if (pMaterial == nullptr) return;
+        const Texture::SharedPtr textures[] = { pMaterial->getBaseColorTexture(), pMaterial->getSpecularTexture(), pMaterial->getEmissiveTexture(), pMaterial->getNormalMap(), pMaterial->getOcclusionMap(), pMaterial->getLightMap(), pMaterial->getHeightMap() };
+        for (const auto& pTex : textures)
+        {
+            auto it = pTex ? mTextureToId.find(pTex.get()) : mTextureToId.end();
+            if (it == mTextureToId.end()) continue;
+
+            auto& materials = mTextures[it->second].materials;
+            bool found = std::any_of(materials.begin(), materials.end(), [&pMaterial](const std::weak_ptr<Material>& p) { return p.lock() == pMaterial; });
+            if (found == false) materials.push_back(pMaterial);
+        }
+    }
+
+    void TextureStreamer::requestMip(const Texture* pTexture, uint32_t mipLevel)
+    {
+        auto it = mTextureToId.find(pTexture);
+        if (it == mTextureToId.end()) return;
+
+        StreamedTexture& tex = mTextures[it->second];
+        tex.requestedMip = std::min(tex.requestedMip, mipLevel);
+        tex.lastUsedFrame = mFrameCount;
+    }
+
+    void TextureStreamer::updateRequests(const Scene* pScene, const Camera* pCamera, uint32_t viewportHeight)
+    {
+        if (pScene == nullptr || pCamera == nullptr) return;
+        float tanHalfFovY = tanf(0.5f * focalLengthToFovY(pCamera->getFocalLength(), pCamera->getFrameHeight()));
+        const glm::vec3& camPos = pCamera->getPosition();
+
+        for (uint32_t modelId = 0; modelId < pScene->getModelCount(); modelId++)
+        {
+            const Model* pModel = pScene->getModel(modelId).get();
+            for (uint32_t modelInstanceId = 0; modelInstanceId < pScene->getModelInstanceCount(modelId); modelInstanceId++)
+            {
+                const auto& pModelInstance = pScene->getModelInstance(modelId, modelInstanceId);
+                if (pModelInstance->isVisible() == false) continue;
+
+                for (uint32_t meshId = 0; meshId < pModel->getMeshCount(); meshId++)
+                {
+                    for (uint32_t meshInstanceId = 0; meshInstanceId < pModel->getMeshInstanceCount(meshId); meshInstanceId++)
+                    {
+                        const auto& pMeshInstance = pModel->getMeshInstance(meshId, meshInstanceId);
+                        BoundingBox box = pMeshInstance->getBoundingBox().transform(pModelInstance->getTransformMatrix());
+                        if (pCamera->isObjectCulled(box)) continue;
+
+                        // Projected size of the bounding sphere in pixels
+                        float radius = glm::length(box.extent);
+                        float distance = std::max(glm::length(box.center - camPos) - radius, pCamera->getNearPlane());
+                        float projectedPixels = std::max(1.0f, float(viewportHeight) * radius / (distance * tanHalfFovY));
+
+                        const Material* pMaterial = pMeshInstance->getObject()->getMaterial().get();
+                        if (pMaterial == nullptr) continue;
+                        const Texture::SharedPtr textures[] = { pMaterial->getBaseColorTexture(), pMaterial->getSpecularTexture(), pMaterial->getEmissiveTexture(), pMaterial->getNormalMap(), pMaterial->getOcclusionMap(), pMaterial->getLightMap(), pMaterial->getHeightMap() };
+                        for (const auto& pTex : textures)
+                        {
+                            auto it = pTex ? mTextureToId.find(pTex.get()) : mTextureToId.end();
+                            if (it == mTextureToId.end()) continue;
+                            uint32_t texSize = std::max(mTextures[it->second].width, mTextures[it->second].height);
+                            float mip = std::max(0.0f, log2f(float(texSize) / projectedPixels));
+                            requestMip(pTex.get(), uint32_t(mip));
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    void TextureStreamer::replaceMaterialTextures(StreamedTexture& tex, const Texture::SharedPtr& pOld)
+    {
+        Texture::SharedPtr pNew = tex.pTexture;
+        auto it = tex.materials.begin();
+        while (it != tex.materials.end())
+        {
+            Material::SharedPtr pMaterial = it->lock();
+            if (pMaterial == nullptr)
+            {
+                it = tex.materials.erase(it);
+                continue;
+            }
+
+            if (pMaterial->getBaseColorTexture() == pOld) pMaterial->setBaseColorTexture(pNew);
+            if (pMaterial->getSpecularTexture() == pOld) pMaterial->setSpecularTexture(pNew);
+            if (pMaterial->getEmissiveTexture() == pOld) pMaterial->setEmissiveTexture(pNew);
+            if (pMaterial->getNormalMap() == pOld) pMaterial->setNormalMap(pNew);
+            if (pMaterial->getOcclusionMap() == pOld) pMaterial->setOcclusionMap(pNew);
+            if (pMaterial->getLightMap() == pOld) pMaterial->setLightMap(pNew);
+            if (pMaterial->getHeightMap() == pOld) pMaterial->setHeightMap(pNew);
+            it++;
+        }
+    }
+
+    void TextureStreamer::setResidentRange(RenderContext* pContext, uint32_t textureId, uint32_t newResidentMip, const IoResult* pResult)
+    {
+        StreamedTexture& tex = mTextures[textureId];
+        assert(newResidentMip <= tex.tailMip);
+        if (newResidentMip == tex.residentMip) return;
+
+        uint32_t mipCount = tex.mipCount - newResidentMip;
+        Texture::SharedPtr pNew = Texture::create2D(std::max(1u, tex.width >> newResidentMip), std::max(1u, tex.height >> newResidentMip), tex.format, 1, mipCount);
+        if (pNew == nullptr) return;
+        pNew->setSourceFilename(tex.pTexture->getSourceFilename());
+
+        for (uint32_t m = newResidentMip; m < tex.mipCount; m++)
+        {
+            if (m < tex.residentMip)
+            {
+                // New data from the I/O thread
+                assert(pResult && m >= pResult->request.firstMip && m < pResult->request.endMip);
+                pContext->updateSubresourceData(pNew.get(), m - newResidentMip, pResult->mipData[m - pResult->request.firstMip].data());
+            }
+            else
+            {
+                pContext->copySubresource(pNew.get(), m - newResidentMip, tex.pTexture.get(), m - tex.residentMip);
+            }
+        }
+
+        uint64_t oldBytes = getMipRangeSize(tex, tex.residentMip, tex.mipCount);
+        uint64_t newBytes = getMipRangeSize(tex, newResidentMip, tex.mipCount);
+        mStats.residentBytes = mStats.residentBytes - oldBytes + newBytes;
+        mStats.peakResidentBytes = std::max(mStats.peakResidentBytes, mStats.residentBytes);
+
+        Texture::SharedPtr pOld = tex.pTexture;
+        mTextureToId.erase(pOld.get());
+        tex.pTexture = pNew;
+        tex.residentMip = newResidentMip;
+        mTextureToId[pNew.get()] = textureId;
+        replaceMaterialTextures(tex, pOld);
+    }
+
+    bool TextureStreamer::evict(RenderContext* pContext, uint64_t requiredBytes, uint32_t excludeId)
+    {
+        // Candidates are textures which weren't used this frame, least-recently-used first
+        std::vector<uint32_t> candidates;
+        for (uint32_t i = 0; i < (uint32_t)mTextures.size(); i++)
+        {
+            const auto& tex = mTextures[i];
+            if (i != excludeId && tex.inFlight == false && tex.residentMip < tex.tailMip && tex.lastUsedFrame < mFrameCount)
+            {
+                candidates.push_back(i);
+            }
+        }
+        std::sort(candidates.begin(), candidates.end(), [this](uint32_t a, uint32_t b) { return mTextures[a].lastUsedFrame < mTextures[b].lastUsedFrame; });
+
+        for (uint32_t id : candidates)
+        {
+            if (mStats.residentBytes + requiredBytes <= mDesc.memoryBudget) break;
+
+            // Drop the finest mips until enough memory was released or the texture reached its mip-tail
+            StreamedTexture& tex = mTextures[id];
+            uint32_t newMip = tex.residentMip;
+            uint64_t released = 0;
+            while (newMip < tex.tailMip && mStats.residentBytes - released + requiredBytes > mDesc.memoryBudget)
+            {
+                released += tex.mipSizes[newMip];
+                newMip++;
+            }
+            mStats.evictedMips += newMip - tex.residentMip;
+            setResidentRange(pContext, id, newMip, nullptr);
+        }
+        return mStats.residentBytes + requiredBytes <= mDesc.memoryBudget;
+    }
+
+    void TextureStreamer::update(RenderContext* pContext)
+    {
+        // Upload completed requests
+        std::vector<IoResult> completed;
+        {
+            std::lock_guard<std::mutex> lock(mIoMutex);
+            completed.swap(mCompletedRequests);
+        }
+
+        for (const auto& result : completed)
+        {
+            uint32_t id = result.request.textureId;
+            StreamedTexture& tex = mTextures[id];
+            tex.inFlight = false;
+            if (result.success == false)
+            {
+                logWarning("TextureStreamer: failed to read mips from '" + tex.cookedFile + "'.");
+                continue;
+            }
+
+            // Only the part of the request finer than what's resident now is needed
+            if (result.request.endMip != tex.residentMip) continue;
+            uint64_t requiredBytes = getMipRangeSize(tex, result.request.firstMip, result.request.endMip);
+            if (mStats.residentBytes + requiredBytes > mDesc.memoryBudget && evict(pContext, requiredBytes, id) == false) continue;
+
+            setResidentRange(pContext, id, result.request.firstMip, &result);
+            double latency = CpuTimer::calcDuration(result.request.issueTime, CpuTimer::getCurrentTimePoint());
+            mStats.streamedMips += result.request.endMip - result.request.firstMip;
+            mStats.completedRequests++;
+            mTotalLatencyMs += latency;
+            mStats.maxLatencyMs = std::max(mStats.maxLatencyMs, latency);
+            mStats.avgLatencyMs = mTotalLatencyMs / mStats.completedRequests;
+        }
+
+        // The budget may have been lowered
+        if (mStats.residentBytes > mDesc.memoryBudget) evict(pContext, 0, uint32_t(-1));
+
+        // Issue new requests
+        std::vector<IoRequest> requests;
+        uint32_t inFlight = 0;
+        for (uint32_t i = 0; i < (uint32_t)mTextures.size(); i++)
+        {
+            StreamedTexture& tex = mTextures[i];
+            if (tex.inFlight == false && tex.requestedMip < tex.residentMip)
+            {
+                IoRequest request;
+                request.textureId = i;
+                request.firstMip = tex.requestedMip;
+                request.endMip = tex.residentMip;
+                request.cookedFile = tex.cookedFile;
+                request.fileOffset = tex.mipOffsets[request.firstMip];
+                request.mipSizes.assign(tex.mipSizes.begin() + request.firstMip, tex.mipSizes.begin() + request.endMip);
+                request.issueTime = CpuTimer::getCurrentTimePoint();
+                requests.push_back(std::move(request));
+                tex.inFlight = true;
+            }
+            tex.requestedMip = tex.tailMip;
+            inFlight += tex.inFlight ? 1 : 0;
+        }
+        mStats.pendingRequests = inFlight;
+
+        if (requests.size())
+        {
+            {
+                std::lock_guard<std::mutex> lock(mIoMutex);
+                for (auto& r : requests) mPendingRequests.push_back(std::move(r));
+            }
+            mIoCondition.notify_one();
+        }
+
+        mFrameCount++;
+    }
+
+    void TextureStreamer::ioThreadFunc()
+    {
+        while (true)
+        {
+            IoRequest request;
+            {
+                std::unique_lock<std::mutex> lock(mIoMutex);
+                mIoCondition.wait(lock, [this] { return mTerminate || mPendingRequests.size(); });
+                if (mTerminate) return;
+                request = std::move(mPendingRequests.front());
+                mPendingRequests.pop_front();
+            }
+
+            IoResult result;
+            result.mipData.resize(request.mipSizes.size());
+            std::ifstream stream(request.cookedFile, std::ios::binary);
+            result.success = stream.is_open() && stream.seekg(request.fileOffset).good();
+            for (size_t i = 0; i < request.mipSizes.size() && result.success; i++)
+            {
+                result.mipData[i].resize(request.mipSizes[i]);
+                result.success = stream.read((char*)result.mipData[i].data(), request.mipSizes[i]).good();
+            }
+            result.request = std::move(request);
+
+            std::lock_guard<std::mutex> lock(mIoMutex);
+            mCompletedRequests.push_back(std::move(result));
+        }
+    }
+
+    void TextureStreamer::renderUI(Gui* pGui, const char* uiGroup)
+    {
+        if (uiGroup == nullptr || pGui->beginGroup(uiGroup))
+        {
+            const double MB = 1024.0 * 1024.0;
+            std::string s = "Textures: " + std::to_string(mStats.textureCount) + "\n";
+            s += "Resident: " + std::to_string(mStats.residentBytes / MB) + " MB / " + std::to_string(mDesc.memoryBudget / MB) + " MB\n";
+            s += "Peak resident: " + std::to_string(mStats.peakResidentBytes / MB) + " MB\n";
+            s += "Pending requests: " + std::to_string(mStats.pendingRequests) + "\n";
+            s += "Streamed/evicted mips: " + std::to_string(mStats.streamedMips) + "/" + std::to_string(mStats.evictedMips) + "\n";
+            s += "Latency avg/max: " + std::to_string(mStats.avgLatencyMs) + "/" + std::to_string(mStats.maxLatencyMs) + " ms";
+            pGui->addText(s.c_str());
+
+            int32_t budgetMB = int32_t(mDesc.memoryBudget / (1024 * 1024));
+            if (pGui->addIntVar("Budget (MB)", budgetMB, 16))
+            {
+                mDesc.memoryBudget = uint64_t(budgetMB) * 1024 * 1024;
+            }
+
+            if (uiGroup) pGui->endGroup();
+        }
+    }
+}
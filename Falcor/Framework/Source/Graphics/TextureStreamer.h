@@ -0,0 +1,195 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "API/Texture.h"
+#include "Utils/CpuTimer.h"
+
+namespace Falcor
+{
+    class Material;
+    class Scene;
+    class Camera;
+    class Gui;
+    class RenderContext;
+
+    /** Streams texture mip-levels on demand.
+        Textures are cooked once into a file containing the full mip-chain. When a texture is loaded, only the mip-tail (the mips smaller than Desc::mipTailSize)
+        is made resident. Higher resolution mips are requested through requestMip() or updateRequests(), read from the cooked file on a background I/O thread,
+        and uploaded in update(). Whenever the resident mip-range of a texture changes, a new texture object is created and swapped into all materials registered with it.
+        Resident memory is kept under Desc::memoryBudget by dropping the finest mips of the least-recently-used textures.
+    */
+    class TextureStreamer : public std::enable_shared_from_this<TextureStreamer>
+    {
+    public:
+        using SharedPtr = std::shared_ptr<TextureStreamer>;
+        using SharedConstPtr = std::shared_ptr<const TextureStreamer>;
+
+        struct Desc
+        {
+            uint64_t memoryBudget = 1024ull * 1024ull * 1024ull;    ///< Maximum number of bytes of resident streamed texture data
+            uint32_t mipTailSize = 128;                             ///< Mips with both dimensions smaller or equal to this value are always resident
+            std::string cacheDirectory;                             ///< Where cooked textures are stored. If empty, uses '<executable directory>/TextureCache'
+        };
+
+        struct Stats
+        {
+            uint32_t textureCount = 0;          ///< Number of streamed textures
+            uint64_t residentBytes = 0;         ///< Bytes currently resident
+            uint64_t peakResidentBytes = 0;     ///< Largest value residentBytes reached
+            uint32_t pendingRequests = 0;       ///< Number of I/O requests that were issued but not uploaded yet
+            uint32_t streamedMips = 0;          ///< Total number of mips streamed in
+            uint32_t completedRequests = 0;     ///< Number of I/O requests whose mips were made resident
+            uint32_t evictedMips = 0;           ///< Total number of mips evicted
+            double avgLatencyMs = 0;            ///< Average time between issuing a request and the data being resident
+            double maxLatencyMs = 0;            ///< Longest request latency
+        };
+
+        /** Create a new streamer
+        */
+        static SharedPtr create(const Desc& desc = Desc());
+
+        /** Get the streamer used by the model importers when Model::LoadFlags::StreamTextures is set
+            \param[in] createIfMissing Create a streamer with the default settings if none exists
+        */
+        static const SharedPtr& getGlobalStreamer(bool createIfMissing = true);
+
+        /** Set the streamer used by the model importers. Pass nullptr to release it.
+        */
+        static void setGlobalStreamer(const SharedPtr& pStreamer);
+
+        ~TextureStreamer();
+
+        /** Load a texture. Only the mip-tail will be resident. The file is cooked on the first load.
+            DDS files and compressed formats are not streamed and are loaded fully resident through createTextureFromFile().
+            \param[in] filename Filename of the image. Can also include a full path or relative path from a data directory
+            \param[in] loadAsSrgb Load the texture using sRGB format
+            \return The texture object, or nullptr if loading failed. The object will be replaced once the resident mip-range changes.
+        */
+        Texture::SharedPtr loadTexture(const std::string& filename, bool loadAsSrgb);
+
+        /** Register a material. When a texture used by the material is replaced, the material will be updated to reference the new texture.
+        */
+        void registerMaterial(const std::shared_ptr<Material>& pMaterial);
+
+        /** Request a mip-level of a texture for the current frame. Requests for textures which are not streamed are ignored.
+            \param[in] pTexture A texture returned by loadTexture(), or one that replaced it
+            \param[in] mipLevel The mip-level, relative to the full-resolution image
+        */
+        void requestMip(const Texture* pTexture, uint32_t mipLevel);
+
+        /** Estimate the required mip-levels for all textures used by the visible mesh instances in a scene and request them.
+            The estimate is based on the projected size of each instance's bounding box and assumes each texture covers the mesh once.
+            \param[in] pScene The scene
+            \param[in] pCamera The camera used for rendering
+            \param[in] viewportHeight Height of the render target in pixels
+        */
+        void updateRequests(const Scene* pScene, const Camera* pCamera, uint32_t viewportHeight);
+
+        /** Issue I/O requests for this frame's requests, upload completed data and evict mips if over budget. Call once per frame.
+        */
+        void update(RenderContext* pContext);
+
+        /** Get streaming statistics
+        */
+        const Stats& getStats() const { return mStats; }
+
+        /** Render the streamer's UI
+        */
+        void renderUI(Gui* pGui, const char* uiGroup = nullptr);
+
+    private:
+        TextureStreamer(const Desc& desc);
+
+        struct StreamedTexture
+        {
+            std::string cookedFile;
+            ResourceFormat format = ResourceFormat::Unknown;
+            uint32_t width = 0;
+            uint32_t height = 0;
+            uint32_t mipCount = 0;
+            uint32_t tailMip = 0;                           ///< First mip of the always-resident mip-tail
+            std::vector<uint64_t> mipOffsets;               ///< Offset of each mip in the cooked file
+            std::vector<uint64_t> mipSizes;                 ///< Size in bytes of each mip
+            Texture::SharedPtr pTexture;
+            uint32_t residentMip = 0;                       ///< Finest resident mip
+            uint32_t requestedMip = 0;                      ///< Finest mip requested since the last update()
+            uint64_t lastUsedFrame = 0;
+            bool inFlight = false;
+            std::vector<std::weak_ptr<Material>> materials;
+        };
+
+        struct IoRequest
+        {
+            uint32_t textureId;
+            uint32_t firstMip;
+            uint32_t endMip;
+            std::string cookedFile;
+            uint64_t fileOffset;                            ///< Offset of firstMip in the cooked file. Mips are stored contiguously
+            std::vector<uint64_t> mipSizes;                 ///< [mip - firstMip]
+            CpuTimer::TimePoint issueTime;
+        };
+
+        struct IoResult
+        {
+            IoRequest request;
+            std::vector<std::vector<uint8_t>> mipData;      ///< [mip - firstMip]
+            bool success = false;
+        };
+
+        bool cookTexture(const std::string& fullpath, bool loadAsSrgb, const std::string& cookedFile);
+        bool readCookedHeader(StreamedTexture& tex);
+        uint64_t getMipRangeSize(const StreamedTexture& tex, uint32_t firstMip, uint32_t endMip) const;
+        void setResidentRange(RenderContext* pContext, uint32_t textureId, uint32_t newResidentMip, const IoResult* pResult);
+        void replaceMaterialTextures(StreamedTexture& tex, const Texture::SharedPtr& pOld);
+        bool evict(RenderContext* pContext, uint64_t requiredBytes, uint32_t excludeId);
+        void ioThreadFunc();
+
+        Desc mDesc;
+        Stats mStats;
+        uint64_t mFrameCount = 0;
+        double mTotalLatencyMs = 0;
+
+        std::vector<StreamedTexture> mTextures;
+        std::unordered_map<std::string, uint32_t> mFileToId;            ///< Keyed by full path and sRGB flag
+        std::unordered_map<const Texture*, uint32_t> mTextureToId;
+
+        std::thread mIoThread;
+        std::mutex mIoMutex;
+        std::condition_variable mIoCondition;
+        std::deque<IoRequest> mPendingRequests;
+        std::vector<IoResult> mCompletedRequests;
+        bool mTerminate = false;
+    };
+}
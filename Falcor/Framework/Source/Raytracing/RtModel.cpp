@@ -38,6 +38,13 @@ namespace Falcor
 	{
 		this->buildAccelerationStructure();
 	}
+    void RtModel::setLodBias(uint32_t lodBias)
+    {
+        if (mLodBias == lodBias) return;
+        mLodBias = lodBias;
+        buildAccelerationStructure();
+    }
+
 	RtModel::RtModel(const Model& model, RtBuildFlags buildFlags) : mBuildFlags(buildFlags), Model(model)
     {
     }
@@ -182,79 +189,106 @@ namespace Falcor
         return false;
     }
 
+    bool RtModel::rebuildAccelerationStructure(const std::unordered_set<const Mesh*>& meshes)
+    {
+        bool rebuilt = false;
+        for (auto& blasData : mBottomLevelData)
+        {
+            for (uint32_t meshIndex = blasData.meshBaseIndex; meshIndex < blasData.meshBaseIndex + blasData.meshCount; meshIndex++)
+            {
+                if (meshes.count(getMesh(meshIndex).get()))
+                {
+                    buildBottomLevelAS(blasData);
+                    rebuilt = true;
+                    break;
+                }
+            }
+        }
+        return rebuilt;
+    }
+
     void RtModel::buildAccelerationStructure()
+    {
+        // Create an AS for each mesh-group
+        for (auto& blasData : mBottomLevelData)
+        {
+            buildBottomLevelAS(blasData);
+        }
+    }
+
+    void RtModel::buildBottomLevelAS(BottomLevelData& blasData)
     {
         RenderContext* pContext = gpDevice->getRenderContext().get();
 
         auto dxrFlags = getDxrBuildFlags(mBuildFlags);
 
-        // Create an AS for each mesh-group
-        for (auto& blasData : mBottomLevelData)
+        std::vector<D3D12_RAYTRACING_GEOMETRY_DESC> geomDesc(blasData.meshCount);
+        for (size_t meshIndex = blasData.meshBaseIndex; meshIndex < blasData.meshBaseIndex + blasData.meshCount; meshIndex++)
         {
-            std::vector<D3D12_RAYTRACING_GEOMETRY_DESC> geomDesc(blasData.meshCount);
-            for (size_t meshIndex = blasData.meshBaseIndex; meshIndex < blasData.meshBaseIndex + blasData.meshCount; meshIndex++)
+            assert(meshIndex < mMeshes.size());
+            const Mesh* pMesh = getMesh((uint32_t)meshIndex).get();
+
+            D3D12_RAYTRACING_GEOMETRY_DESC& desc = geomDesc[meshIndex - blasData.meshBaseIndex];
+            desc.Type = D3D12_RAYTRACING_GEOMETRY_TYPE_TRIANGLES;
+            desc.Flags = D3D12_RAYTRACING_GEOMETRY_FLAG_NONE;
+            desc.Triangles.Transform3x4 = 0;
+
+            // Get the position VB
+            const Vao* pVao = getMeshVao(pMesh).get();
+            const auto& elemDesc = pVao->getElementIndexByLocation(VERTEX_POSITION_LOC);
+            const auto& pVbLayout = pVao->getVertexLayout()->getBufferLayout(elemDesc.vbIndex);
+
+            const Buffer* pVB = pVao->getVertexBuffer(elemDesc.vbIndex).get();
+            pContext->resourceBarrier(pVB, Resource::State::NonPixelShader);
+            desc.Triangles.VertexBuffer.StartAddress = pVB->getGpuAddress() + pVbLayout->getElementOffset(elemDesc.elementIndex);
+            desc.Triangles.VertexBuffer.StrideInBytes = pVbLayout->getStride();
+            desc.Triangles.VertexCount = pMesh->getVertexCount();
+            desc.Triangles.VertexFormat = getDxgiFormat(pVbLayout->getElementFormat(elemDesc.elementIndex));
+
+            // Get the IB. LODs share the vertex buffers and only have their own IB.
+            uint32_t lod = getMeshLod(pMesh);
+            const Buffer* pIB = (lod == 0) ? pVao->getIndexBuffer().get() : pMesh->getLodVao(lod)->getIndexBuffer().get();
+            pContext->resourceBarrier(pIB, Resource::State::NonPixelShader);
+            desc.Triangles.IndexBuffer = pIB->getGpuAddress();
+            desc.Triangles.IndexCount = pMesh->getLodIndexCount(lod);
+            desc.Triangles.IndexFormat = getDxgiFormat(pVao->getIndexBufferFormat());
+
+            // If this is an opaque mesh, set the opaque flag
+            if (pMesh->getMaterial()->getAlphaMode() == AlphaModeOpaque)
             {
-                assert(meshIndex < mMeshes.size());
-                const Mesh* pMesh = getMesh((uint32_t)meshIndex).get();
-
-                D3D12_RAYTRACING_GEOMETRY_DESC& desc = geomDesc[meshIndex - blasData.meshBaseIndex];
-                desc.Type = D3D12_RAYTRACING_GEOMETRY_TYPE_TRIANGLES;
-                desc.Flags = D3D12_RAYTRACING_GEOMETRY_FLAG_NONE;
-                desc.Triangles.Transform3x4 = 0;
-
-                // Get the position VB
-                const Vao* pVao = getMeshVao(pMesh).get();
-                const auto& elemDesc = pVao->getElementIndexByLocation(VERTEX_POSITION_LOC);
-                const auto& pVbLayout = pVao->getVertexLayout()->getBufferLayout(elemDesc.vbIndex);
-
-                const Buffer* pVB = pVao->getVertexBuffer(elemDesc.vbIndex).get();
-                pContext->resourceBarrier(pVB, Resource::State::NonPixelShader);
-                desc.Triangles.VertexBuffer.StartAddress = pVB->getGpuAddress() + pVbLayout->getElementOffset(elemDesc.elementIndex);
-                desc.Triangles.VertexBuffer.StrideInBytes = pVbLayout->getStride();
-                desc.Triangles.VertexCount = pMesh->getVertexCount();
-                desc.Triangles.VertexFormat = getDxgiFormat(pVbLayout->getElementFormat(elemDesc.elementIndex));
-
-                // Get the IB
-                const Buffer* pIB = pVao->getIndexBuffer().get();
-                pContext->resourceBarrier(pIB, Resource::State::NonPixelShader);
-                desc.Triangles.IndexBuffer = pIB->getGpuAddress();
-                desc.Triangles.IndexCount = pMesh->getIndexCount();
-                desc.Triangles.IndexFormat = getDxgiFormat(pVao->getIndexBufferFormat());
-
-                // If this is an opaque mesh, set the opaque flag
-                if (pMesh->getMaterial()->getAlphaMode() == AlphaModeOpaque)
-                {
-                    desc.Flags = D3D12_RAYTRACING_GEOMETRY_FLAG_OPAQUE;
-                }
+                desc.Flags = D3D12_RAYTRACING_GEOMETRY_FLAG_OPAQUE;
             }
+        }
 
-            // Create the acceleration and aux buffers
-            D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_INPUTS inputs = {};
-            inputs.Type = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL;
-            inputs.Flags = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_NONE;
-            inputs.DescsLayout = D3D12_ELEMENTS_LAYOUT_ARRAY;
-            inputs.NumDescs = (uint32_t)geomDesc.size();
-            inputs.pGeometryDescs = geomDesc.data();
+        // Create the acceleration and aux buffers
+        D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_INPUTS inputs = {};
+        inputs.Type = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL;
+        inputs.Flags = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_NONE;
+        inputs.DescsLayout = D3D12_ELEMENTS_LAYOUT_ARRAY;
+        inputs.NumDescs = (uint32_t)geomDesc.size();
+        inputs.pGeometryDescs = geomDesc.data();
 
-            D3D12_RAYTRACING_ACCELERATION_STRUCTURE_PREBUILD_INFO info;
-            GET_COM_INTERFACE(gpDevice->getApiHandle(), ID3D12Device5, pDevice5);
-            pDevice5->GetRaytracingAccelerationStructurePrebuildInfo(&inputs, &info);
+        D3D12_RAYTRACING_ACCELERATION_STRUCTURE_PREBUILD_INFO info;
+        GET_COM_INTERFACE(gpDevice->getApiHandle(), ID3D12Device5, pDevice5);
+        pDevice5->GetRaytracingAccelerationStructurePrebuildInfo(&inputs, &info);
 
-            Buffer::SharedPtr pScratchBuffer = Buffer::create(info.ScratchDataSizeInBytes, Buffer::BindFlags::UnorderedAccess, Buffer::CpuAccess::None);
-            blasData.pBlas = Buffer::create(info.ResultDataMaxSizeInBytes, Buffer::BindFlags::AccelerationStructure, Buffer::CpuAccess::None);
+        Buffer::SharedPtr pScratchBuffer = Buffer::create(info.ScratchDataSizeInBytes, Buffer::BindFlags::UnorderedAccess, Buffer::CpuAccess::None);
+        blasData.pBlas = Buffer::create(info.ResultDataMaxSizeInBytes, Buffer::BindFlags::AccelerationStructure, Buffer::CpuAccess::None);
+        blasData.pBlas->setName("BLAS " + getName());
+        pScratchBuffer->setName("BLAS scratch " + getName());
+        MemoryTracker::setCategory(pScratchBuffer.get(), MemoryTracker::Category::AccelerationStructure);
 
-            // Build the AS
-            D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_DESC asDesc = {};
-            asDesc.Inputs = inputs;
-            asDesc.DestAccelerationStructureData = blasData.pBlas->getGpuAddress();
-            asDesc.ScratchAccelerationStructureData = pScratchBuffer->getGpuAddress();
+        // Build the AS
+        D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_DESC asDesc = {};
+        asDesc.Inputs = inputs;
+        asDesc.DestAccelerationStructureData = blasData.pBlas->getGpuAddress();
+        asDesc.ScratchAccelerationStructureData = pScratchBuffer->getGpuAddress();
 
-            GET_COM_INTERFACE(pContext->getLowLevelData()->getCommandList(), ID3D12GraphicsCommandList4, pList4);
-            pList4->BuildRaytracingAccelerationStructure(&asDesc, 0, nullptr);
+        GET_COM_INTERFACE(pContext->getLowLevelData()->getCommandList(), ID3D12GraphicsCommandList4, pList4);
+        pList4->BuildRaytracingAccelerationStructure(&asDesc, 0, nullptr);
 
-            // Insert a UAV barrier
-            pContext->uavBarrier(blasData.pBlas.get());
-        }
+        // Insert a UAV barrier
+        pContext->uavBarrier(blasData.pBlas.get());
     }
 
     RtModel::SharedPtr RtModel::createFromFile(const char* filename, RtBuildFlags buildFlags, Model::LoadFlags flags)
@@ -27,6 +27,7 @@
 ***************************************************************************/
 #pragma once
 #include "Graphics/Model/Model.h"
+#include <unordered_set>
 
 namespace Falcor
 {
@@ -52,13 +53,35 @@ namespace Falcor
         const BottomLevelData& getBottomLevelData(uint32_t index) const { return mBottomLevelData[index]; }
 		void updateBottomLevelData();
 
+        /** Build the acceleration structures from coarser LODs. Useful when the model is only hit by secondary rays, where the lower geometric accuracy is hard to notice.
+            Meshes without enough LODs use their coarsest LOD. Changing the bias rebuilds the bottom-level acceleration structures.
+            \param[in] lodBias The LOD to use for each mesh. 0 uses the full-resolution meshes.
+        */
+        void setLodBias(uint32_t lodBias);
+
+        /** Get the LOD bias
+        */
+        uint32_t getLodBias() const { return mLodBias; }
+
+        /** Get the LOD of a mesh which is used in the acceleration structures
+        */
+        uint32_t getMeshLod(const Mesh* pMesh) const { return std::min(mLodBias, pMesh->getLodCount() - 1); }
+
+        /** Rebuild the bottom-level acceleration structures which contain any of the meshes. Call after the geometry of some of the model's meshes was replaced, for example by the GeometryStreamer.
+            \param[in] meshes The meshes which changed. Meshes which don't belong to the model are ignored.
+            \return Whether any acceleration structure was rebuilt
+        */
+        bool rebuildAccelerationStructure(const std::unordered_set<const Mesh*>& meshes);
+
     private:
         RtModel(const Model& model, RtBuildFlags buildFlags);
         bool update() override;            // Override update() from Model, which updates vertices for skinned models
         void buildAccelerationStructure();
+        void buildBottomLevelAS(BottomLevelData& blasData);
 
         std::vector<BottomLevelData> mBottomLevelData;
         RtBuildFlags mBuildFlags;
+        uint32_t mLodBias = 0;
         void createBottomLevelData();
     };
 }
\ No newline at end of file
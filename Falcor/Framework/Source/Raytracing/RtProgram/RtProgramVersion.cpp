@@ -33,7 +33,7 @@
 
 namespace Falcor
 {
-    uint64_t RtProgramVersion::sProgId = 0;
+    std::atomic<uint64_t> RtProgramVersion::sProgId(0);
     ProgramReflection::SharedPtr createProgramReflection(const Shader::SharedConstPtr pShaders[], std::string& log);
 
     RtProgramVersion::RtProgramVersion(std::shared_ptr<ProgramReflection> pReflector, Type progType, RtShader::SharedPtr const* ppShaders, size_t shaderCount, const std::string& name, uint32_t maxPayloadSize, uint32_t maxAttributeSize)
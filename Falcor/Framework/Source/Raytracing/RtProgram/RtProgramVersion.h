@@ -29,6 +29,7 @@
 #include "Graphics/Program/ProgramVersion.h"
 #include "../RtShader.h"
 #include "API/VAO.h"
+#include <atomic>
 
 namespace Falcor
 {
@@ -74,7 +75,7 @@ namespace Falcor
         Type mType;
         std::wstring mExportName;
 
-        static uint64_t sProgId;
+        static std::atomic<uint64_t> sProgId;
         uint32_t mMaxPayloadSize;
         uint32_t mMaxAttributeSize;
     };
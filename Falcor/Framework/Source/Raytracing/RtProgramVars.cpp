@@ -121,6 +121,7 @@ namespace Falcor
         // Create the buffer and allocate the temporary storage
         mpShaderTable = Buffer::create(numEntries * mRecordSize, Resource::BindFlags::ShaderResource, Buffer::CpuAccess::None);
         assert(mpShaderTable);
+        mpShaderTable->setName("Shader table");
         mShaderTableData.resize(mpShaderTable->getSize());
 
         // Create the global variables
@@ -30,6 +30,7 @@
 #include "Graphics/Scene/SceneImporter.h"
 #include "API/DescriptorSet.h"
 #include "API/Device.h"
+#include <unordered_set>
 
 namespace Falcor
 {
@@ -120,6 +121,61 @@ namespace Falcor
             pRtModel->attachSkinningCache(mpSkinningCache);
             pRtModel->animate(0);
         }
+
+        pRtModel->setLodBias(mLodBias);
+    }
+
+    void RtScene::setLodBias(uint32_t lodBias)
+    {
+        if (mLodBias == lodBias) return;
+        mLodBias = lodBias;
+
+        for (uint32_t modelId = 0; modelId < getModelCount(); modelId++)
+        {
+            RtModel* pModel = dynamic_cast<RtModel*>(getModel(modelId).get());
+            assert(pModel);
+            pModel->setLodBias(lodBias);
+        }
+
+        // The BLASes were re-created, so the TLAS must be rebuilt
+        mTlasHitProgCount = -1;
+        mRefit = false;
+    }
+
+    float RtScene::getMaxLodError() const
+    {
+        float maxError = 0;
+        if (mLodBias == 0) return maxError;
+
+        for (uint32_t modelId = 0; modelId < getModelCount(); modelId++)
+        {
+            const RtModel* pModel = dynamic_cast<const RtModel*>(getModel(modelId).get());
+            assert(pModel);
+            for (uint32_t meshId = 0; meshId < pModel->getMeshCount(); meshId++)
+            {
+                const Mesh* pMesh = pModel->getMesh(meshId).get();
+                float error = pMesh->getLodError(pModel->getMeshLod(pMesh));
+                if (error == 0) continue;
+
+                for (uint32_t instanceId = 0; instanceId < getModelInstanceCount(modelId); instanceId++)
+                {
+                    for (uint32_t meshInstance = 0; meshInstance < pModel->getMeshInstanceCount(meshId); meshInstance++)
+                    {
+                        glm::mat4 worldMat = getModelInstance(modelId, instanceId)->getTransformMatrix() * pModel->getMeshInstance(meshId, meshInstance)->getTransformMatrix();
+                        float scale = max(max(length(vec3(worldMat[0])), length(vec3(worldMat[1]))), length(vec3(worldMat[2])));
+                        maxError = max(maxError, error * scale);
+                    }
+                }
+            }
+        }
+        return maxError;
+    }
+
+    void RtScene::updateMeshGeometry(const std::vector<const Mesh*>& meshes)
+    {
+        if (meshes.empty()) return;
+        mChangedMeshes.insert(meshes.begin(), meshes.end());
+        mTlasHitProgCount = -1;
     }
 
     std::vector<D3D12_RAYTRACING_INSTANCE_DESC> RtScene::createInstanceDesc(const RtScene* pScene, uint32_t hitProgCount)
@@ -222,6 +278,18 @@ namespace Falcor
         if (mTlasHitProgCount == hitProgCount) return;
         mTlasHitProgCount = hitProgCount;
 
+        // Rebuild the BLASes of the meshes which changed since the last build. Their addresses changed, so the TLAS can't be refit.
+        if (mChangedMeshes.size())
+        {
+            for (uint32_t modelId = 0; modelId < getModelCount(); modelId++)
+            {
+                RtModel* pModel = dynamic_cast<RtModel*>(getModel(modelId).get());
+                assert(pModel);
+                if (pModel->rebuildAccelerationStructure(mChangedMeshes)) mRefit = false;
+            }
+            mChangedMeshes.clear();
+        }
+
         // Early out if hit program count is zero or if scene is empty.
         if (hitProgCount == 0 || getModelCount() == 0)
         {
@@ -258,10 +326,13 @@ namespace Falcor
         pDevice5->GetRaytracingAccelerationStructurePrebuildInfo(&inputs, &info);
 
         Buffer::SharedPtr pScratchBuffer = Buffer::create(align_to(D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT, info.ScratchDataSizeInBytes), Buffer::BindFlags::UnorderedAccess, Buffer::CpuAccess::None);
+        pScratchBuffer->setName("TLAS scratch");
+        MemoryTracker::setCategory(pScratchBuffer.get(), MemoryTracker::Category::AccelerationStructure);
 
         if (!isRefitPossible)
         {
             mpTopLevelAS = Buffer::create(align_to(D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT, info.ResultDataMaxSizeInBytes), Buffer::BindFlags::AccelerationStructure, Buffer::CpuAccess::None);
+            mpTopLevelAS->setName("TLAS");
         }
         else
         {
@@ -269,6 +340,8 @@ namespace Falcor
         }
 
         Buffer::SharedPtr pInstanceData = Buffer::create(mInstanceCount * sizeof(D3D12_RAYTRACING_INSTANCE_DESC), Buffer::BindFlags::None, Buffer::CpuAccess::None, instanceDesc.data());
+        pInstanceData->setName("TLAS instance descs");
+        MemoryTracker::setCategory(pInstanceData.get(), MemoryTracker::Category::AccelerationStructure);
         assert((mInstanceCount != 0) && pInstanceData->getApiHandle() && mpTopLevelAS->getApiHandle() && pScratchBuffer->getApiHandle());
 
         // Create the TLAS
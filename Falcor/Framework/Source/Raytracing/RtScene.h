@@ -60,6 +60,22 @@ namespace Falcor
 
         void setRefit(bool enableRefit) { mEnableRefit = enableRefit; }
 
+        /** Trace rays against coarser mesh LODs. Intended for pipelines where primary visibility is rasterized and only secondary rays are traced.
+            See RtModel::setLodBias()
+        */
+        void setLodBias(uint32_t lodBias);
+        uint32_t getLodBias() const { return mLodBias; }
+
+        /** Get the largest world-space error of the mesh LODs the acceleration structures are built from. Rays may hit geometry this far from the full-resolution meshes.
+        */
+        float getMaxLodError() const;
+
+        /** Queue a rebuild of the bottom-level acceleration structures which contain any of the meshes. Call after the geometry of the meshes was replaced.
+            The queued rebuilds run the next time the TLAS is needed, so all the changes of a frame are built together and each BLAS is rebuilt at most once.
+            \param[in] meshes The meshes which changed, as returned by GeometryStreamer::getChangedMeshes()
+        */
+        void updateMeshGeometry(const std::vector<const Mesh*>& meshes);
+
     protected:
         RtScene(RtBuildFlags rtFlags) : mRtFlags(rtFlags), mpSkinningCache(SkinningCache::create()) {}
         uint32_t mTlasHitProgCount = -1;
@@ -86,7 +102,10 @@ namespace Falcor
 
         SkinningCache::SharedPtr mpSkinningCache;
 
+        std::unordered_set<const Mesh*> mChangedMeshes;     // Meshes whose BLAS must be rebuilt before the next TLAS build. See updateMeshGeometry()
+
         bool mEnableRefit = false;
+        uint32_t mLodBias = 0;
         bool mRefit = false;
     };
 }
\ No newline at end of file
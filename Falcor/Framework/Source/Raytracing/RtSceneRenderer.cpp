@@ -96,7 +96,11 @@ namespace Falcor
 
         if (mMeshBufferLocations.indices.setIndex != ProgramReflection::kInvalidLocation)
         {
-            auto pSrv = pVao->getIndexBuffer() ? pVao->getIndexBuffer()->getSRV() : nullptr;
+            // The TLAS may have been built from a coarser LOD, whose indices must be used to fetch the vertex attributes
+            const RtModel* pRtModel = dynamic_cast<const RtModel*>(pModelInstance->getObject().get());
+            uint32_t lod = pRtModel ? pRtModel->getMeshLod(pMesh) : 0;
+            const Buffer* pIB = (lod == 0) ? pVao->getIndexBuffer().get() : pMesh->getLodVao(lod)->getIndexBuffer().get();
+            auto pSrv = pIB ? pIB->getSRV() : nullptr;
             pVars->getDefaultBlock()->setSrv(mMeshBufferLocations.indices, 0, pSrv);
         }
 
@@ -31,7 +31,10 @@
 #include <fstream>
 #include "API/Window.h"
 #include "Graphics/Program/Program.h"
+#include "Graphics/Program/ShaderCache.h"
+#include "Graphics/Program/ProgramCompiler.h"
 #include "Utils/Platform/OS.h"
+#include "Utils/MemoryTracker.h"
 #include "API/FBO.h"
 #include "VR/OpenVR/VRSystem.h"
 #include "Utils/Platform/ProgressBar.h"
@@ -280,8 +283,10 @@ namespace Falcor
         mFrameRate.resetClock();
         mpWindow->msgLoop();
 
+        ProgramCompiler::shutdown();
         mpRenderer->onShutdown(this);
         if (gpDevice) gpDevice->flushAndSync();
+        ShaderCache::logStats();
         mpRenderer = nullptr;
         Logger::shutdown();
     }
@@ -496,6 +501,7 @@ namespace Falcor
 #if _PROFILING_ENABLED
             Profiler::endFrame();
 #endif
+            MemoryTracker::endFrame();
             // Capture video frame after UI is rendered
             if (captureVideoUI)
             {
@@ -90,7 +90,8 @@ namespace Falcor
         }
 
         uint32_t bpp = FreeImage_GetBPP(pDib);
-        bool rgb32FloatSupported = gpDevice->isRgb32FloatSupported();
+        // Without a device (e.g., in command-line tools and CPU benchmarks), 96-bit images are converted to RGBA
+        bool rgb32FloatSupported = gpDevice ? gpDevice->isRgb32FloatSupported() : false;
 
         switch(bpp)
         {
@@ -0,0 +1,577 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "Utils/ImageCompare.h"
+#include "Utils/Bitmap.h"
+#include "glm/gtc/packing.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cmath>
+#include <thread>
+
+namespace Falcor
+{
+    namespace
+    {
+        const char* kMetricNames[] = { "mse", "psnr", "relmse", "ssim", "flip" };
+        static_assert(arraysize(kMetricNames) == (size_t)ImageCompare::Metric::Count, "Metric names don't match the Metric enum");
+
+        const double kMaxPsnr = 100.0;              // Reported for identical images
+        const float kRelMseEpsilon = 0.01f;         // Keeps the relative error finite on black pixels
+        const float kSsimC1 = 0.01f * 0.01f;        // SSIM stabilization constants, for a dynamic range of 1
+        const float kSsimC2 = 0.03f * 0.03f;
+
+        // FLIP constants. See "FLIP: A Difference Evaluator for Alternating Images", Andersson et al. 2020
+        const float kFlipGamma = 0.7f;              // Exponent applied to the color difference
+        const float kFlipPc = 0.4f;                 // Color difference remapping knee
+        const float kFlipPt = 0.95f;
+        const float kFlipFeatureWidth = 0.082f;     // Edge and point detector width, in degrees
+        const float kFlipFeatureExponent = 0.5f;
+        const glm::vec3 kD65White(0.950428545f, 1.0f, 1.088900371f);
+
+        struct Tile
+        {
+            uint32_t x0, y0, x1, y1;
+        };
+
+        uint32_t getTileCount(uint32_t width, uint32_t height, const ImageCompare::Options& options)
+        {
+            uint32_t tileSize = std::max(options.tileSize, 8u);
+            return ((width + tileSize - 1) / tileSize) * ((height + tileSize - 1) / tileSize);
+        }
+
+        // Run func(tileIndex, tile) on every tile of the image. Each thread takes the next unprocessed tile until there are none left.
+        template<typename FuncType>
+        void forEachTile(uint32_t width, uint32_t height, const ImageCompare::Options& options, const FuncType& func)
+        {
+            uint32_t tileSize = std::max(options.tileSize, 8u);
+            uint32_t tilesX = (width + tileSize - 1) / tileSize;
+            uint32_t tileCount = getTileCount(width, height, options);
+            uint32_t threadCount = options.threadCount ? options.threadCount : std::max(1u, std::thread::hardware_concurrency());
+            threadCount = std::max(1u, std::min(threadCount, tileCount));
+
+            std::atomic<uint32_t> nextTile(0);
+            auto worker = [&]()
+            {
+                for (uint32_t i = nextTile++; i < tileCount; i = nextTile++)
+                {
+                    Tile tile;
+                    tile.x0 = (i % tilesX) * tileSize;
+                    tile.y0 = (i / tilesX) * tileSize;
+                    tile.x1 = std::min(width, tile.x0 + tileSize);
+                    tile.y1 = std::min(height, tile.y0 + tileSize);
+                    func(i, tile);
+                }
+            };
+
+            std::vector<std::thread> threads;
+            for (uint32_t i = 1; i < threadCount; i++)
+            {
+                threads.emplace_back(worker);
+            }
+            worker();
+            for (auto& t : threads) t.join();
+        }
+
+        // Sum func(x, y) over all pixels. Partial sums are kept per tile and added in order, so the result doesn't depend on the thread count.
+        template<typename FuncType>
+        double sumPixels(uint32_t width, uint32_t height, const ImageCompare::Options& options, const FuncType& func)
+        {
+            std::vector<double> tileSums(getTileCount(width, height, options), 0.0);
+            forEachTile(width, height, options, [&](uint32_t tileIndex, const Tile& tile)
+            {
+                double sum = 0;
+                for (uint32_t y = tile.y0; y < tile.y1; y++)
+                {
+                    for (uint32_t x = tile.x0; x < tile.x1; x++) sum += func(x, y);
+                }
+                tileSums[tileIndex] = sum;
+            });
+
+            double sum = 0;
+            for (double s : tileSums) sum += s;
+            return sum;
+        }
+
+        // Separable convolution, clamping to the edges. Kernels have an odd size, and are centered.
+        // For vector images, each channel can have its own kernel.
+        template<typename T>
+        void convolve(const std::vector<T>& src, std::vector<T>& dst, uint32_t width, uint32_t height, const std::vector<T>& kernelX, const std::vector<T>& kernelY, const ImageCompare::Options& options)
+        {
+            std::vector<T> rows(src.size());
+            int32_t radiusX = int32_t(kernelX.size() / 2);
+            forEachTile(width, height, options, [&](uint32_t, const Tile& tile)
+            {
+                for (uint32_t y = tile.y0; y < tile.y1; y++)
+                {
+                    const T* pRow = &src[y * width];
+                    for (uint32_t x = tile.x0; x < tile.x1; x++)
+                    {
+                        T sum(0);
+                        for (int32_t k = 0; k < int32_t(kernelX.size()); k++)
+                        {
+                            int32_t sx = glm::clamp(int32_t(x) + k - radiusX, 0, int32_t(width) - 1);
+                            sum += pRow[sx] * kernelX[k];
+                        }
+                        rows[y * width + x] = sum;
+                    }
+                }
+            });
+
+            dst.resize(src.size());
+            int32_t radiusY = int32_t(kernelY.size() / 2);
+            forEachTile(width, height, options, [&](uint32_t, const Tile& tile)
+            {
+                for (uint32_t y = tile.y0; y < tile.y1; y++)
+                {
+                    for (uint32_t x = tile.x0; x < tile.x1; x++)
+                    {
+                        T sum(0);
+                        for (int32_t k = 0; k < int32_t(kernelY.size()); k++)
+                        {
+                            int32_t sy = glm::clamp(int32_t(y) + k - radiusY, 0, int32_t(height) - 1);
+                            sum += rows[sy * width + x] * kernelY[k];
+                        }
+                        dst[y * width + x] = sum;
+                    }
+                }
+            });
+        }
+
+        enum class KernelType
+        {
+            Gaussian,
+            FirstDerivative,
+            SecondDerivative
+        };
+
+        // A 1D Gaussian, or one of its derivatives, over [-radius, radius].
+        // The Gaussian sums to 1. The derivatives sum to 0, and their positive weights sum to 1.
+        std::vector<float> createKernel(KernelType type, float sigma, int32_t radius)
+        {
+            std::vector<float> kernel(2 * radius + 1);
+            for (int32_t i = -radius; i <= radius; i++)
+            {
+                float x = float(i);
+                float g = std::exp(-x * x / (2 * sigma * sigma));
+                if (type == KernelType::Gaussian) kernel[i + radius] = g;
+                else if (type == KernelType::FirstDerivative) kernel[i + radius] = -x * g;
+                else kernel[i + radius] = (x * x / (sigma * sigma) - 1) * g;
+            }
+
+            if (type == KernelType::Gaussian)
+            {
+                float sum = 0;
+                for (float w : kernel) sum += w;
+                for (float& w : kernel) w /= sum;
+                return kernel;
+            }
+
+            if (type == KernelType::SecondDerivative)
+            {
+                float mean = 0;
+                for (float w : kernel) mean += w;
+                mean /= kernel.size();
+                for (float& w : kernel) w -= mean;
+            }
+            float positiveSum = 0;
+            for (float w : kernel) positiveSum += std::max(w, 0.0f);
+            for (float& w : kernel) w /= positiveSum;
+            return kernel;
+        }
+
+        // Combine three 1D kernels into a per-channel kernel. Shorter kernels are padded with zeros.
+        std::vector<glm::vec3> combineKernels(const std::vector<float>& r, const std::vector<float>& g, const std::vector<float>& b)
+        {
+            size_t size = std::max(r.size(), std::max(g.size(), b.size()));
+            std::vector<glm::vec3> kernel(size, glm::vec3(0));
+            auto copy = [&](const std::vector<float>& src, uint32_t channel)
+            {
+                size_t offset = (size - src.size()) / 2;
+                for (size_t i = 0; i < src.size(); i++) kernel[offset + i][channel] = src[i];
+            };
+            copy(r, 0);
+            copy(g, 1);
+            copy(b, 2);
+            return kernel;
+        }
+
+        int32_t getKernelRadius(float sigma)
+        {
+            return std::max(1, int32_t(std::ceil(3.0f * sigma)));
+        }
+
+        float luminance(const glm::vec3& rgb)
+        {
+            return glm::dot(rgb, glm::vec3(0.2126f, 0.7152f, 0.0722f));
+        }
+
+        float srgbToLinear(float c)
+        {
+            return (c <= 0.04045f) ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+        }
+
+        glm::vec3 linearRgbToXyz(const glm::vec3& c)
+        {
+            return glm::vec3(
+                0.4124564f * c.r + 0.3575761f * c.g + 0.1804375f * c.b,
+                0.2126729f * c.r + 0.7151522f * c.g + 0.0721750f * c.b,
+                0.0193339f * c.r + 0.1191920f * c.g + 0.9503041f * c.b);
+        }
+
+        glm::vec3 xyzToLinearRgb(const glm::vec3& c)
+        {
+            return glm::vec3(
+                3.2404542f * c.x - 1.5371385f * c.y - 0.4985314f * c.z,
+                -0.9692660f * c.x + 1.8760108f * c.y + 0.0415560f * c.z,
+                0.0556434f * c.x - 0.2040259f * c.y + 1.0572252f * c.z);
+        }
+
+        // The opponent color space FLIP filters in. Unlike L*a*b*, it's linear in XYZ.
+        glm::vec3 xyzToYcxcz(const glm::vec3& xyz)
+        {
+            glm::vec3 n = xyz / kD65White;
+            return glm::vec3(116.0f * n.y - 16.0f, 500.0f * (n.x - n.y), 200.0f * (n.y - n.z));
+        }
+
+        glm::vec3 ycxczToXyz(const glm::vec3& c)
+        {
+            float y = (c.x + 16.0f) / 116.0f;
+            return glm::vec3(c.y / 500.0f + y, y, y - c.z / 200.0f) * kD65White;
+        }
+
+        // L*a*b*, with a* and b* scaled by the lightness (the Hunt effect: colors look less saturated when dark)
+        glm::vec3 xyzToHuntLab(const glm::vec3& xyz)
+        {
+            auto f = [](float t) { const float delta = 6.0f / 29.0f; return (t > delta * delta * delta) ? std::cbrt(t) : t / (3 * delta * delta) + 4.0f / 29.0f; };
+            glm::vec3 n = xyz / kD65White;
+            float l = 116.0f * f(n.y) - 16.0f;
+            float a = 500.0f * (f(n.x) - f(n.y));
+            float b = 200.0f * (f(n.y) - f(n.z));
+            return glm::vec3(l, 0.01f * l * a, 0.01f * l * b);
+        }
+
+        // Distance in the HyAB space: city-block on lightness, Euclidean on chroma
+        float hyab(const glm::vec3& a, const glm::vec3& b)
+        {
+            return std::abs(a.x - b.x) + glm::length(glm::vec2(a.y - b.y, a.z - b.z));
+        }
+
+        // Display-referred linear RGB. HDR images are compared in the [0, 1] range.
+        glm::vec3 toLinearDisplay(const glm::vec3& c, bool isHdr)
+        {
+            glm::vec3 clamped = glm::clamp(c, glm::vec3(0), glm::vec3(1));
+            return isHdr ? clamped : glm::vec3(srgbToLinear(clamped.r), srgbToLinear(clamped.g), srgbToLinear(clamped.b));
+        }
+
+        struct FlipFeatures
+        {
+            std::vector<float> edges;
+            std::vector<float> points;
+        };
+
+        // Magnitude of the edges and points of an image's normalized luminance
+        FlipFeatures detectFeatures(const std::vector<glm::vec3>& ycxcz, uint32_t width, uint32_t height, const ImageCompare::Options& options)
+        {
+            float sigma = 0.5f * kFlipFeatureWidth * options.pixelsPerDegree;
+            int32_t radius = getKernelRadius(sigma);
+            std::vector<float> g = createKernel(KernelType::Gaussian, sigma, radius);
+            std::vector<float> dg = createKernel(KernelType::FirstDerivative, sigma, radius);
+            std::vector<float> ddg = createKernel(KernelType::SecondDerivative, sigma, radius);
+
+            std::vector<glm::vec3> y(ycxcz.size());
+            std::vector<float> yScalar(ycxcz.size());
+            for (size_t i = 0; i < ycxcz.size(); i++)
+            {
+                yScalar[i] = (ycxcz[i].x + 16.0f) / 116.0f;
+                y[i] = glm::vec3(yScalar[i]);
+            }
+
+            // Channels are (edge x, edge y, point x), then point y
+            std::vector<glm::vec3> filtered;
+            std::vector<float> pointsY;
+            convolve(y, filtered, width, height, combineKernels(dg, g, ddg), combineKernels(g, dg, g), options);
+            convolve(yScalar, pointsY, width, height, g, ddg, options);
+
+            FlipFeatures features;
+            features.edges.resize(ycxcz.size());
+            features.points.resize(ycxcz.size());
+            for (size_t i = 0; i < ycxcz.size(); i++)
+            {
+                features.edges[i] = glm::length(glm::vec2(filtered[i].x, filtered[i].y));
+                features.points[i] = glm::length(glm::vec2(filtered[i].z, pointsY[i]));
+            }
+            return features;
+        }
+
+        // Per-pixel FLIP-style error: a color difference of the images filtered by the contrast sensitivity of the eye, amplified where edges and points differ.
+        // Simplifications compared to the reference implementation: each contrast sensitivity filter is a single Gaussian, and HDR images are clamped instead of tone mapped at several exposures.
+        void computeFlip(const ImageCompare::Image& reference, const ImageCompare::Image& test, const ImageCompare::Options& options, std::vector<float>& errorMap)
+        {
+            uint32_t width = reference.width;
+            uint32_t height = reference.height;
+            std::vector<glm::vec3> refYcxcz(reference.pixels.size());
+            std::vector<glm::vec3> testYcxcz(test.pixels.size());
+            forEachTile(width, height, options, [&](uint32_t, const Tile& tile)
+            {
+                for (uint32_t y = tile.y0; y < tile.y1; y++)
+                {
+                    for (uint32_t x = tile.x0; x < tile.x1; x++)
+                    {
+                        uint32_t i = y * width + x;
+                        refYcxcz[i] = xyzToYcxcz(linearRgbToXyz(toLinearDisplay(reference.pixels[i], reference.isHdr)));
+                        testYcxcz[i] = xyzToYcxcz(linearRgbToXyz(toLinearDisplay(test.pixels[i], test.isHdr)));
+                    }
+                }
+            });
+
+            // Contrast sensitivity, as Gaussians with the spread of the achromatic, red-green and blue-yellow filters of FLIP
+            const glm::vec3 spreads(0.0047f, 0.0053f, 0.04f);
+            glm::vec3 sigmas = options.pixelsPerDegree * glm::sqrt(spreads / (2.0f * glm::pi<float>() * glm::pi<float>()));
+            int32_t radius = getKernelRadius(std::max(sigmas.x, std::max(sigmas.y, sigmas.z)));
+            std::vector<glm::vec3> csf = combineKernels(createKernel(KernelType::Gaussian, sigmas.x, radius), createKernel(KernelType::Gaussian, sigmas.y, radius), createKernel(KernelType::Gaussian, sigmas.z, radius));
+            std::vector<glm::vec3> refFiltered, testFiltered;
+            convolve(refYcxcz, refFiltered, width, height, csf, csf, options);
+            convolve(testYcxcz, testFiltered, width, height, csf, csf, options);
+
+            FlipFeatures refFeatures = detectFeatures(refYcxcz, width, height, options);
+            FlipFeatures testFeatures = detectFeatures(testYcxcz, width, height, options);
+
+            // The largest color difference, between green and blue
+            float maxColorDiff = std::pow(hyab(xyzToHuntLab(linearRgbToXyz(glm::vec3(0, 1, 0))), xyzToHuntLab(linearRgbToXyz(glm::vec3(0, 0, 1)))), kFlipGamma);
+            float knee = kFlipPc * maxColorDiff;
+
+            errorMap.resize(reference.pixels.size());
+            forEachTile(width, height, options, [&](uint32_t, const Tile& tile)
+            {
+                for (uint32_t y = tile.y0; y < tile.y1; y++)
+                {
+                    for (uint32_t x = tile.x0; x < tile.x1; x++)
+                    {
+                        uint32_t i = y * width + x;
+                        glm::vec3 refRgb = glm::clamp(xyzToLinearRgb(ycxczToXyz(refFiltered[i])), glm::vec3(0), glm::vec3(1));
+                        glm::vec3 testRgb = glm::clamp(xyzToLinearRgb(ycxczToXyz(testFiltered[i])), glm::vec3(0), glm::vec3(1));
+                        float colorDiff = std::pow(hyab(xyzToHuntLab(linearRgbToXyz(refRgb)), xyzToHuntLab(linearRgbToXyz(testRgb))), kFlipGamma);
+                        colorDiff = (colorDiff < knee) ? colorDiff * kFlipPt / knee : kFlipPt + (colorDiff - knee) / (maxColorDiff - knee) * (1.0f - kFlipPt);
+                        colorDiff = std::min(colorDiff, 1.0f);
+
+                        float edgeDiff = std::abs(refFeatures.edges[i] - testFeatures.edges[i]);
+                        float pointDiff = std::abs(refFeatures.points[i] - testFeatures.points[i]);
+                        float featureDiff = std::pow(std::min(1.0f, std::max(edgeDiff, pointDiff) / std::sqrt(2.0f)), kFlipFeatureExponent);
+
+                        errorMap[i] = std::pow(colorDiff, 1.0f - featureDiff);
+                    }
+                }
+            });
+        }
+
+        double computeSsim(const ImageCompare::Image& reference, const ImageCompare::Image& test, const ImageCompare::Options& options)
+        {
+            uint32_t width = reference.width;
+            uint32_t height = reference.height;
+
+            // Local means and moments, as (x, y, xy) and (x^2, y^2, 0)
+            std::vector<glm::vec3> moments1(reference.pixels.size());
+            std::vector<glm::vec3> moments2(reference.pixels.size());
+            for (size_t i = 0; i < reference.pixels.size(); i++)
+            {
+                float x = luminance(reference.pixels[i]);
+                float y = luminance(test.pixels[i]);
+                moments1[i] = glm::vec3(x, y, x * y);
+                moments2[i] = glm::vec3(x * x, y * y, 0);
+            }
+
+            std::vector<float> g = createKernel(KernelType::Gaussian, 1.5f, 5);
+            std::vector<glm::vec3> window = combineKernels(g, g, g);
+            convolve(moments1, moments1, width, height, window, window, options);
+            convolve(moments2, moments2, width, height, window, window, options);
+
+            double sum = sumPixels(width, height, options, [&](uint32_t x, uint32_t y)
+            {
+                uint32_t i = y * width + x;
+                float muX = moments1[i].x;
+                float muY = moments1[i].y;
+                float covariance = moments1[i].z - muX * muY;
+                float varianceX = moments2[i].x - muX * muX;
+                float varianceY = moments2[i].y - muY * muY;
+                return double(((2 * muX * muY + kSsimC1) * (2 * covariance + kSsimC2)) / ((muX * muX + muY * muY + kSsimC1) * (varianceX + varianceY + kSsimC2)));
+            });
+            return sum / reference.pixels.size();
+        }
+    }
+
+    bool ImageCompare::loadImage(const std::string& filename, Image& image)
+    {
+        std::string fullpath;
+        if (findFileInDataDirectories(filename, fullpath) == false)
+        {
+            logError("ImageCompare::loadImage() - can't find " + filename);
+            return false;
+        }
+
+        Bitmap::UniqueConstPtr pBitmap = Bitmap::createFromFile(fullpath, true);
+        if (pBitmap == nullptr) return false;
+        return convertBitmap(pBitmap.get(), image);
+    }
+
+    bool ImageCompare::convertBitmap(const Bitmap* pBitmap, Image& image)
+    {
+        image.width = pBitmap->getWidth();
+        image.height = pBitmap->getHeight();
+        image.pixels.resize(image.width * image.height);
+        image.isHdr = true;
+
+        const uint8_t* pData = pBitmap->getData();
+        const float* pFloats = reinterpret_cast<const float*>(pData);
+        const uint16_t* pHalfs = reinterpret_cast<const uint16_t*>(pData);
+        for (size_t i = 0; i < image.pixels.size(); i++)
+        {
+            glm::vec3& p = image.pixels[i];
+            switch (pBitmap->getFormat())
+            {
+            case ResourceFormat::RGBA32Float:
+                p = glm::vec3(pFloats[i * 4], pFloats[i * 4 + 1], pFloats[i * 4 + 2]);
+                break;
+            case ResourceFormat::RGB32Float:
+                p = glm::vec3(pFloats[i * 3], pFloats[i * 3 + 1], pFloats[i * 3 + 2]);
+                break;
+            case ResourceFormat::RGBA16Float:
+                p = glm::vec3(glm::unpackHalf1x16(pHalfs[i * 4]), glm::unpackHalf1x16(pHalfs[i * 4 + 1]), glm::unpackHalf1x16(pHalfs[i * 4 + 2]));
+                break;
+            case ResourceFormat::RGB16Float:
+                p = glm::vec3(glm::unpackHalf1x16(pHalfs[i * 3]), glm::unpackHalf1x16(pHalfs[i * 3 + 1]), glm::unpackHalf1x16(pHalfs[i * 3 + 2]));
+                break;
+            case ResourceFormat::BGRA8Unorm:
+            case ResourceFormat::BGRX8Unorm:
+                p = glm::vec3(pData[i * 4 + 2], pData[i * 4 + 1], pData[i * 4]) / 255.0f;
+                image.isHdr = false;
+                break;
+            case ResourceFormat::RG8Unorm:
+                p = glm::vec3(pData[i * 2], pData[i * 2 + 1], 0) / 255.0f;
+                image.isHdr = false;
+                break;
+            case ResourceFormat::R8Unorm:
+                p = glm::vec3(pData[i]) / 255.0f;
+                image.isHdr = false;
+                break;
+            default:
+                logError("ImageCompare::convertBitmap() - unsupported format " + to_string(pBitmap->getFormat()));
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool ImageCompare::compare(const Image& reference, const Image& test, Result& result, const Options& options)
+    {
+        if (reference.width != test.width || reference.height != test.height || reference.pixels.empty())
+        {
+            logError("ImageCompare::compare() - the images have different sizes, or are empty");
+            return false;
+        }
+        if (reference.isHdr != test.isHdr)
+        {
+            logWarning("ImageCompare::compare() - comparing an HDR image with an LDR image");
+        }
+
+        uint32_t width = reference.width;
+        uint32_t height = reference.height;
+        double pixelCount = double(reference.pixels.size());
+        result = Result();
+        result.errorMap.resize(reference.pixels.size());
+
+        double squaredError = sumPixels(width, height, options, [&](uint32_t x, uint32_t y)
+        {
+            uint32_t i = y * width + x;
+            glm::vec3 diff = test.pixels[i] - reference.pixels[i];
+            float error = glm::dot(diff, diff) / 3.0f;
+            result.errorMap[i] = error;
+            return double(error);
+        });
+        double relativeError = sumPixels(width, height, options, [&](uint32_t x, uint32_t y)
+        {
+            uint32_t i = y * width + x;
+            glm::vec3 diff = test.pixels[i] - reference.pixels[i];
+            glm::vec3 relative = (diff * diff) / (reference.pixels[i] * reference.pixels[i] + kRelMseEpsilon);
+            return double(relative.x + relative.y + relative.z) / 3.0;
+        });
+
+        double mse = squaredError / pixelCount;
+        result.values[(size_t)Metric::MSE] = mse;
+        result.values[(size_t)Metric::PSNR] = (mse > 0) ? std::min(kMaxPsnr, -10.0 * std::log10(mse)) : kMaxPsnr;
+        result.values[(size_t)Metric::RelMSE] = relativeError / pixelCount;
+        if (options.computeSsim) result.values[(size_t)Metric::SSIM] = computeSsim(reference, test, options);
+        if (options.computeFlip)
+        {
+            computeFlip(reference, test, options, result.errorMap);
+            double flip = sumPixels(width, height, options, [&](uint32_t x, uint32_t y) { return double(result.errorMap[y * width + x]); });
+            result.values[(size_t)Metric::Flip] = flip / pixelCount;
+        }
+        return true;
+    }
+
+    void ImageCompare::saveErrorMap(const std::string& filename, const Result& result, uint32_t width, uint32_t height, float maxError)
+    {
+        std::vector<uint8_t> pixels(result.errorMap.size() * 4);
+        for (size_t i = 0; i < result.errorMap.size(); i++)
+        {
+            uint8_t value = uint8_t(glm::clamp(result.errorMap[i] / maxError, 0.0f, 1.0f) * 255.0f + 0.5f);
+            pixels[i * 4] = pixels[i * 4 + 1] = pixels[i * 4 + 2] = value;
+            pixels[i * 4 + 3] = 255;
+        }
+        Bitmap::saveImage(filename, width, height, Bitmap::FileFormat::PngFile, Bitmap::ExportFlags::None, ResourceFormat::RGBA8Unorm, true, pixels.data());
+    }
+
+    const char* ImageCompare::getMetricName(Metric metric)
+    {
+        assert(metric < Metric::Count);
+        return kMetricNames[(size_t)metric];
+    }
+
+    bool ImageCompare::findMetric(const std::string& name, Metric& metric)
+    {
+        std::string lowerName = name;
+        std::transform(lowerName.begin(), lowerName.end(), lowerName.begin(), [](char c) { return char(std::tolower(c)); });
+        for (uint32_t i = 0; i < (uint32_t)Metric::Count; i++)
+        {
+            if (lowerName == kMetricNames[i])
+            {
+                metric = (Metric)i;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool ImageCompare::isWithinThreshold(Metric metric, double value, double threshold)
+    {
+        bool higherIsBetter = (metric == Metric::PSNR || metric == Metric::SSIM);
+        return higherIsBetter ? (value >= threshold) : (value <= threshold);
+    }
+}
@@ -0,0 +1,109 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <string>
+#include <vector>
+#include "glm/vec3.hpp"
+
+namespace Falcor
+{
+    class Bitmap;
+
+    /** Compares images with error metrics, to check renders against references when they can't match exactly (e.g., noisy path-traced images).
+        Supports MSE/PSNR, relative MSE for HDR images, SSIM and a FLIP-style perceptual metric. The work is split in tiles, processed by several threads.
+    */
+    class ImageCompare
+    {
+    public:
+        /** An image, as floating-point RGB values. 8-bit images are in [0, 1] and still sRGB-encoded, HDR images are linear.
+        */
+        struct Image
+        {
+            uint32_t width = 0;
+            uint32_t height = 0;
+            bool isHdr = false;
+            std::vector<glm::vec3> pixels;      ///< Top row first
+        };
+
+        enum class Metric
+        {
+            MSE,            ///< Mean squared error over pixels and channels
+            PSNR,           ///< Peak signal-to-noise ratio, in dB, with a peak value of 1
+            RelMSE,         ///< MSE relative to the reference's squared value. Meant for HDR images
+            SSIM,           ///< Mean structural similarity of the luminance, with an 11x11 Gaussian window
+            Flip,           ///< Mean FLIP-style perceptual error, in [0, 1]
+            Count
+        };
+
+        struct Options
+        {
+            bool computeSsim = true;
+            bool computeFlip = true;
+            float pixelsPerDegree = 67.0f;      ///< Viewing condition for the perceptual metric. 67 is a 0.7m wide 4K monitor seen from 0.7m
+            uint32_t tileSize = 64;
+            uint32_t threadCount = 0;           ///< 0 to use every core
+        };
+
+        struct Result
+        {
+            double values[(size_t)Metric::Count] = {};
+            std::vector<float> errorMap;        ///< Per-pixel error. FLIP if computed, otherwise the squared error averaged over channels
+
+            double get(Metric metric) const { return values[(size_t)metric]; }
+        };
+
+        /** Load an image file. EXR, PFM and HDR files are loaded as HDR images.
+            \return false if the file can't be loaded
+        */
+        static bool loadImage(const std::string& filename, Image& image);
+
+        /** Convert a bitmap to an image. Supports the formats Bitmap::createFromFile() creates.
+        */
+        static bool convertBitmap(const Bitmap* pBitmap, Image& image);
+
+        /** Compare an image to a reference. The images must have the same size.
+            \return false if the images can't be compared
+        */
+        static bool compare(const Image& reference, const Image& test, Result& result, const Options& options);
+
+        /** Save an error map as a grayscale PNG. Errors are scaled so that maxError is white.
+        */
+        static void saveErrorMap(const std::string& filename, const Result& result, uint32_t width, uint32_t height, float maxError = 1.0f);
+
+        static const char* getMetricName(Metric metric);
+
+        /** Find a metric from its name, as returned by getMetricName(). Case-insensitive.
+            \return false if there's no such metric
+        */
+        static bool findMetric(const std::string& name, Metric& metric);
+
+        /** Check whether a metric value is within a threshold. Higher is better for PSNR and SSIM, lower is better for the other metrics.
+        */
+        static bool isWithinThreshold(Metric metric, double value, double threshold);
+    };
+}
@@ -29,6 +29,13 @@
 #include "Logger.h"
 #include "Utils/Platform/OS.h"
 #include <cstdio>
+#include <algorithm>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
+#include <unordered_map>
 
 namespace Falcor
 {
@@ -40,6 +47,133 @@ namespace Falcor
 
     FILE* Logger::sLogFile = nullptr;
     Logger::Level Logger::sVerbosity = Logger::Level::Warning;
+    Logger::FlushPolicy Logger::sFlushPolicy = Logger::FlushPolicy::Async;
+
+    namespace
+    {
+        struct LogEntry
+        {
+            Logger::Level level = Logger::Level::Info;
+            uint32_t threadId = 0;
+            const char* subsystem = nullptr;
+            double time = 0;
+            std::string msg;
+        };
+
+        /** Bounded multi-producer/single-consumer queue.
+            Each slot has a sequence number telling if it's free for the producer which claimed its position, or ready for the writer thread. Producers never block each other.
+        */
+        class LogQueue
+        {
+        public:
+            static const uint32_t kCapacity = 4096;  // Must be a power of 2
+
+            LogQueue() : mSlots(new Slot[kCapacity])
+            {
+                for (uint32_t i = 0; i < kCapacity; i++) mSlots[i].sequence.store(i, std::memory_order_relaxed);
+            }
+
+            /** Returns false if the queue is full, in which case the entry is untouched
+            */
+            bool push(LogEntry& entry)
+            {
+                uint64_t pos = mEnqueuePos.load(std::memory_order_relaxed);
+                while (true)
+                {
+                    Slot& slot = mSlots[pos & (kCapacity - 1)];
+                    int64_t diff = (int64_t)slot.sequence.load(std::memory_order_acquire) - (int64_t)pos;
+                    if (diff == 0)
+                    {
+                        if (mEnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        {
+                            slot.entry = std::move(entry);
+                            slot.sequence.store(pos + 1, std::memory_order_release);
+                            return true;
+                        }
+                    }
+                    else if (diff < 0)
+                    {
+                        return false;
+                    }
+                    else
+                    {
+                        pos = mEnqueuePos.load(std::memory_order_relaxed);
+                    }
+                }
+            }
+
+            /** Only called by the writer thread
+            */
+            bool pop(LogEntry& entry)
+            {
+                Slot& slot = mSlots[mDequeuePos & (kCapacity - 1)];
+                if (slot.sequence.load(std::memory_order_acquire) != mDequeuePos + 1) return false;
+                entry = std::move(slot.entry);
+                slot.sequence.store(mDequeuePos + kCapacity, std::memory_order_release);
+                mDequeuePos++;
+                return true;
+            }
+
+            uint64_t getPushedCount() const { return mEnqueuePos.load(std::memory_order_acquire); }
+            uint64_t getPoppedCount() const { return mDequeuePos; }
+
+        private:
+            struct Slot
+            {
+                std::atomic<uint64_t> sequence;
+                LogEntry entry;
+            };
+            std::unique_ptr<Slot[]> mSlots;
+            alignas(64) std::atomic<uint64_t> mEnqueuePos{ 0 };
+            alignas(64) uint64_t mDequeuePos = 0;
+        };
+
+        /** Occurrences of a message during the current rate limit window
+        */
+        struct RepeatState
+        {
+            double windowStart = 0;
+            uint32_t count = 0;
+            uint32_t suppressed = 0;
+            LogEntry last;
+        };
+
+        // Programs can be compiled on worker threads, which log their errors and warnings. The mutex guards the file and the rate limiter.
+        std::mutex sLogMutex;
+        std::unordered_map<std::string, RepeatState> sRepeats;
+        double sLastRepeatsPrune = 0;
+        std::atomic<uint32_t> sRateLimit(10);
+
+        LogQueue sQueue;
+        std::thread sWriterThread;
+        std::atomic<bool> sWriterRunning(false);
+        std::atomic<bool> sWriterWaiting(false);
+        std::atomic<bool> sFlushRequested(false);
+        bool sStopWriter = false;
+        std::mutex sWakeMutex;
+        std::condition_variable sWakeCv;
+        std::atomic<uint32_t> sFlushIntervalMs(250);
+
+        // Number of entries written and flushed by the writer thread
+        std::atomic<uint64_t> sFlushedCount(0);
+        std::mutex sFlushedMutex;
+        std::condition_variable sFlushedCv;
+
+        thread_local const char* sSubsystem = nullptr;
+        const std::chrono::steady_clock::time_point sStartTime = std::chrono::steady_clock::now();
+
+        double getLogTime()
+        {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - sStartTime).count();
+        }
+
+        uint32_t getLogThreadId()
+        {
+            static std::atomic<uint32_t> sNextThreadId(0);
+            static thread_local uint32_t threadId = sNextThreadId++;
+            return threadId;
+        }
+    }
 
     static FILE* openLogFile()
     {
@@ -66,21 +200,189 @@ namespace Falcor
         return pFile;
     }
 
+    const char* getLogLevelString(Logger::Level L)
+    {
+        const char* c = nullptr;
+#define create_level_case(_l) case _l: c = "(" #_l ")" ;break;
+        switch(L)
+        {
+            create_level_case(Logger::Level::Info);
+            create_level_case(Logger::Level::Warning);
+            create_level_case(Logger::Level::Error);
+            create_level_case(Logger::Level::Fatal);
+        default:
+            should_not_get_here();
+        }
+#undef create_level_case
+        return c;
+    }
+
+    // The functions below are called with sLogMutex locked
+
+    static void writeLine(FILE* pFile, const LogEntry& entry, const std::string& msg)
+    {
+        char prefix[64];
+        snprintf(prefix, sizeof(prefix), "%10.3f T%-3u ", entry.time, entry.threadId);
+        std::string s = prefix + std::string(getLogLevelString(entry.level)) + "\t";
+        if (entry.subsystem) s += std::string("[") + entry.subsystem + "] ";
+        s += msg + "\n";
+
+        std::fprintf(pFile, "%s", s.c_str());
+        if (isDebuggerPresent())
+        {
+            printToDebugWindow(s);
+        }
+    }
+
+    static void reportSuppressed(FILE* pFile, RepeatState& state)
+    {
+        if (state.suppressed == 0) return;
+        writeLine(pFile, state.last, "Repeated " + std::to_string(state.suppressed) + " more times: " + state.last.msg);
+        state.suppressed = 0;
+    }
+
+    static void pruneRepeats(FILE* pFile, double time, bool force)
+    {
+        // The map only holds the messages seen during the last second, so we don't need to go through it often
+        if (!force && time - sLastRepeatsPrune < 1.0) return;
+        sLastRepeatsPrune = time;
+
+        for (auto it = sRepeats.begin(); it != sRepeats.end();)
+        {
+            if (force || time - it->second.windowStart >= 1.0)
+            {
+                reportSuppressed(pFile, it->second);
+                it = sRepeats.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    static void writeEntry(FILE* pFile, const LogEntry& entry)
+    {
+        // Errors are never dropped
+        uint32_t rateLimit = sRateLimit.load(std::memory_order_relaxed);
+        if (rateLimit > 0 && entry.level < Logger::Level::Error)
+        {
+            RepeatState& state = sRepeats[entry.msg];
+            if (entry.time - state.windowStart >= 1.0 || state.count == 0)
+            {
+                reportSuppressed(pFile, state);
+                state.windowStart = entry.time;
+                state.count = 0;
+            }
+
+            state.count++;
+            if (state.count > rateLimit)
+            {
+                state.suppressed++;
+                state.last = entry;
+                return;
+            }
+        }
+        writeLine(pFile, entry, entry.msg);
+    }
+
+    static void writerThreadFunc(FILE* pFile)
+    {
+        auto lastFlush = std::chrono::steady_clock::now();
+        bool dirty = false;
+        bool stop = false;
+        LogEntry entry;
+
+        while (!stop)
+        {
+            auto interval = std::chrono::milliseconds(sFlushIntervalMs.load());
+            {
+                std::unique_lock<std::mutex> lock(sWakeMutex);
+                sWriterWaiting = true;
+                // Producers don't take the mutex, so a wake-up can be missed. The timeout bounds the delay.
+                sWakeCv.wait_for(lock, interval, [] { return sStopWriter || sFlushRequested; });
+                sWriterWaiting = false;
+                stop = sStopWriter;
+            }
+
+            bool flushRequested = sFlushRequested.exchange(false);
+            bool flushNow = flushRequested || stop;
+            {
+                std::lock_guard<std::mutex> lock(sLogMutex);
+                while (sQueue.pop(entry))
+                {
+                    writeEntry(pFile, entry);
+                    dirty = true;
+                    flushNow = flushNow || entry.level >= Logger::Level::Error;
+                }
+                pruneRepeats(pFile, getLogTime(), stop);
+
+                auto now = std::chrono::steady_clock::now();
+                if (dirty && (flushNow || now - lastFlush >= interval))
+                {
+                    fflush(pFile);
+                    lastFlush = now;
+                    dirty = false;
+                }
+            }
+
+            if (!dirty && sFlushedCount != sQueue.getPoppedCount())
+            {
+                {
+                    std::lock_guard<std::mutex> lock(sFlushedMutex);
+                    sFlushedCount = sQueue.getPoppedCount();
+                }
+                sFlushedCv.notify_all();
+            }
+        }
+    }
+
+    static void wakeWriter()
+    {
+        if (sWriterWaiting) sWakeCv.notify_one();
+    }
+
     bool Logger::init()
     {
 #if _LOG_ENABLED
         sLogFile = openLogFile();
         sInit = sLogFile != nullptr;
         assert(sInit);
+        if (sInit)
+        {
+            sWriterThread = std::thread(writerThreadFunc, sLogFile);
+            sWriterRunning = true;
+        }
 #endif
         return sInit;
     }
 
     bool Logger::sInit = Logger::init();
 
+    // Stops the writer thread if the application didn't call shutdown(), since a joinable thread can't be destroyed
+    static struct LoggerShutdown
+    {
+        ~LoggerShutdown() { Logger::shutdown(); }
+    } sLoggerShutdown;
+
     void Logger::shutdown()
     {
 #if _LOG_ENABLED
+        if (sWriterRunning)
+        {
+            {
+                std::lock_guard<std::mutex> lock(sWakeMutex);
+                sStopWriter = true;
+            }
+            sWakeCv.notify_one();
+            sWriterThread.join();
+            {
+                std::lock_guard<std::mutex> lock(sFlushedMutex);
+                sWriterRunning = false;
+            }
+            sFlushedCv.notify_all();
+        }
+
         if(sLogFile)
         {
             fclose(sLogFile);
@@ -90,20 +392,53 @@ namespace Falcor
 #endif
     }
 
-    const char* getLogLevelString(Logger::Level L)
+    void Logger::flush()
     {
-        const char* c = nullptr;
-#define create_level_case(_l) case _l: c = "(" #_l ")" ;break;
-        switch(L)
+#if _LOG_ENABLED
+        if (sWriterRunning)
         {
-            create_level_case(Logger::Level::Info);
-            create_level_case(Logger::Level::Warning);
-            create_level_case(Logger::Level::Error);
-        default:
-            should_not_get_here();
+            uint64_t target = sQueue.getPushedCount();
+            {
+                std::lock_guard<std::mutex> lock(sWakeMutex);
+                sFlushRequested = true;
+            }
+            sWakeCv.notify_one();
+
+            std::unique_lock<std::mutex> lock(sFlushedMutex);
+            sFlushedCv.wait(lock, [target] { return sFlushedCount >= target || !sWriterRunning; });
         }
-#undef create_level_case
-        return c;
+        else if (sLogFile)
+        {
+            std::lock_guard<std::mutex> lock(sLogMutex);
+            fflush(sLogFile);
+        }
+#endif
+    }
+
+    void Logger::setFlushPolicy(FlushPolicy policy)
+    {
+        flush();
+        sFlushPolicy = policy;
+    }
+
+    void Logger::setFlushInterval(float seconds)
+    {
+        sFlushIntervalMs = (uint32_t)(std::max(seconds, 0.001f) * 1000.0f);
+    }
+
+    void Logger::setRateLimit(uint32_t maxRepeats)
+    {
+        sRateLimit = maxRepeats;
+    }
+
+    Logger::ScopedSubsystem::ScopedSubsystem(const char* name) : mPrevName(sSubsystem)
+    {
+        sSubsystem = name;
+    }
+
+    Logger::ScopedSubsystem::~ScopedSubsystem()
+    {
+        sSubsystem = mPrevName;
     }
 
     void Logger::log(Level L, const std::string& msg, bool forceMsgBox)
@@ -113,12 +448,32 @@ namespace Falcor
         {
             if(L >= sVerbosity)
             {
-                std::string s = getLogLevelString(L) + std::string("\t") + msg + "\n";
-                std::fprintf(sLogFile, "%s", s.c_str());
-                fflush(sLogFile);   // Slows down execution, but ensures that the message will be printed in case of a crash
-                if (isDebuggerPresent())
+                LogEntry entry;
+                entry.level = L;
+                entry.threadId = getLogThreadId();
+                entry.subsystem = sSubsystem;
+                entry.time = getLogTime();
+                entry.msg = msg;
+
+                if (sFlushPolicy == FlushPolicy::Async && sWriterRunning)
+                {
+                    // When the queue is full, wait for the writer thread to drain it
+                    while (sQueue.push(entry) == false)
+                    {
+                        flush();
+                    }
+                    wakeWriter();
+
+                    // Make sure errors reach the file before breaking into the debugger or crashing
+                    if (L >= Level::Error) flush();
+                }
+                else
                 {
-                    printToDebugWindow(s);
+                    std::lock_guard<std::mutex> lock(sLogMutex);
+                    writeEntry(sLogFile, entry);
+                    // The writer thread may not be running, so forget old messages and report their suppressed repeats here too
+                    pruneRepeats(sLogFile, entry.time, false);
+                    fflush(sLogFile);   // Slows down execution, but ensures that the message will be printed in case of a crash
                 }
             }
         }
@@ -141,4 +496,4 @@ namespace Falcor
 
         if (L >= Level::Fatal) assert(false);   // PETRIK: Assert on errors even without debugger attached
     }
-}
\ No newline at end of file
+}
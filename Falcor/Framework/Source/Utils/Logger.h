@@ -27,6 +27,7 @@
 ***************************************************************************/
 #pragma once
 #include <string>
+#include <cstdint>
 #include "FalcorConfig.h"
 
 namespace Falcor
@@ -34,6 +35,8 @@ namespace Falcor
     /** Container class for logging messages. 
     *   To enable log messages, make sure _LOG_ENABLED is set to true in FalcorConfig.h.
     *   Messages are printed to a log file in the application directory. Using Logger#ShowBoxOnError() you can control if a message box will be shown as well.
+    *   By default, messages are queued and written by a background thread, so logging doesn't stall the calling thread. Each line holds the time since startup, the logging thread, the level and the subsystem.
+    *   Errors are written before the log call returns. Identical messages repeated many times in a short time are collapsed into a count.
     */
     class Logger
     {
@@ -49,6 +52,27 @@ namespace Falcor
             Disabled = -1
         };
 
+        /** When messages are written to the log file
+        */
+        enum class FlushPolicy
+        {
+            Immediate,      ///< Write and flush each message on the calling thread. Slow, but nothing is lost if the application crashes.
+            Async,          ///< Queue messages for the writer thread, which flushes the file periodically and after errors
+        };
+
+        /** Names the subsystem of the messages logged by the current thread while the object is alive. Scopes can be nested.
+        */
+        class ScopedSubsystem
+        {
+        public:
+            /** \param[in] name The subsystem name. It's stored as is, so it must outlive the object (a string literal, usually).
+            */
+            ScopedSubsystem(const char* name);
+            ~ScopedSubsystem();
+        private:
+            const char* mPrevName;
+        };
+
         /** Shutdown the logger and close the log file.
         */
         static void shutdown();
@@ -71,6 +95,28 @@ namespace Falcor
         */
         static void setVerbosity(Level level) { sVerbosity = level; }
 
+        /** Set when messages are written. Pending messages are written first.
+        */
+        static void setFlushPolicy(FlushPolicy policy);
+
+        /** Get the flush policy
+        */
+        static FlushPolicy getFlushPolicy() { return sFlushPolicy; }
+
+        /** Set how often the writer thread flushes the file with FlushPolicy::Async
+            \param[in] seconds Maximum time, in seconds, between a message being written and the file being flushed
+        */
+        static void setFlushInterval(float seconds);
+
+        /** Set how many times an identical message is written per second. Further repeats are counted and reported once the second is over.
+            \param[in] maxRepeats Maximum number of identical messages per second. 0 disables the limit.
+        */
+        static void setRateLimit(uint32_t maxRepeats);
+
+        /** Block until all the messages logged so far are written and flushed to the log file
+        */
+        static void flush();
+
     private:
         friend void logInfo(const std::string& msg, bool forceMsgBox);
         friend void logWarning(const std::string& msg, bool forceMsgBox);
@@ -84,6 +130,7 @@ namespace Falcor
         static FILE* sLogFile;
         static bool sInit;
         static Level sVerbosity;
+        static FlushPolicy sFlushPolicy;
         static bool init();
     };
 
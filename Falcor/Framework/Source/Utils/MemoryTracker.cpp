@@ -0,0 +1,245 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "Utils/MemoryTracker.h"
+#include "Utils/Platform/OS.h"
+#include "Utils/StringUtils.h"
+#include <algorithm>
+#include <fstream>
+#include <map>
+
+namespace Falcor
+{
+    std::mutex MemoryTracker::sMutex;
+    std::unordered_map<const void*, MemoryTracker::Allocation> MemoryTracker::sAllocations;
+    MemoryTracker::CategoryStats MemoryTracker::sCategories[(size_t)MemoryTracker::Category::Count];
+    uint64_t MemoryTracker::sTotalBytes = 0;
+    uint64_t MemoryTracker::sFramePeakBytes = 0;
+    uint64_t MemoryTracker::sLastFramePeakBytes = 0;
+    uint64_t MemoryTracker::sLastFrameCpuBytes = 0;
+
+    namespace
+    {
+        std::string formatBytes(uint64_t bytes)
+        {
+            char buf[64];
+            if (bytes >= (1ull << 30)) snprintf(buf, sizeof(buf), "%.2f GB", double(bytes) / (1ull << 30));
+            else if (bytes >= (1ull << 20)) snprintf(buf, sizeof(buf), "%.1f MB", double(bytes) / (1ull << 20));
+            else snprintf(buf, sizeof(buf), "%.1f KB", double(bytes) / (1ull << 10));
+            return buf;
+        }
+    }
+
+    void MemoryTracker::trackAllocation(const void* pObject, Category category, uint64_t size, const std::string& owner)
+    {
+        if (pObject == nullptr) return;
+        std::lock_guard<std::mutex> lock(sMutex);
+
+        // An object can be re-initialized (e.g., a buffer getting a new allocation). Don't count it twice.
+        auto it = sAllocations.find(pObject);
+        bool isTracked = (it != sAllocations.end());
+        if (isTracked)
+        {
+            CategoryStats& oldStats = sCategories[(size_t)it->second.category];
+            oldStats.bytes -= it->second.size;
+            oldStats.count--;
+            sTotalBytes -= it->second.size;
+        }
+
+        Allocation& allocation = sAllocations[pObject];
+        allocation.category = category;
+        allocation.size = size;
+        if (owner.size() || !isTracked) allocation.owner = owner;
+
+        CategoryStats& stats = sCategories[(size_t)category];
+        stats.bytes += size;
+        stats.count++;
+        stats.peakBytes = std::max(stats.peakBytes, stats.bytes);
+        sTotalBytes += size;
+        sFramePeakBytes = std::max(sFramePeakBytes, sTotalBytes);
+    }
+
+    void MemoryTracker::releaseAllocation(const void* pObject)
+    {
+        std::lock_guard<std::mutex> lock(sMutex);
+        auto it = sAllocations.find(pObject);
+        if (it == sAllocations.end()) return;
+
+        CategoryStats& stats = sCategories[(size_t)it->second.category];
+        stats.bytes -= it->second.size;
+        stats.count--;
+        sTotalBytes -= it->second.size;
+        sAllocations.erase(it);
+    }
+
+    void MemoryTracker::setOwner(const void* pObject, const std::string& owner)
+    {
+        std::lock_guard<std::mutex> lock(sMutex);
+        auto it = sAllocations.find(pObject);
+        if (it != sAllocations.end()) it->second.owner = owner;
+    }
+
+    void MemoryTracker::setCategory(const void* pObject, Category category)
+    {
+        std::lock_guard<std::mutex> lock(sMutex);
+        auto it = sAllocations.find(pObject);
+        if (it == sAllocations.end() || it->second.category == category) return;
+
+        CategoryStats& oldStats = sCategories[(size_t)it->second.category];
+        oldStats.bytes -= it->second.size;
+        oldStats.count--;
+
+        it->second.category = category;
+        CategoryStats& stats = sCategories[(size_t)category];
+        stats.bytes += it->second.size;
+        stats.count++;
+        stats.peakBytes = std::max(stats.peakBytes, stats.bytes);
+    }
+
+    MemoryTracker::CategoryStats MemoryTracker::getCategoryStats(Category category)
+    {
+        std::lock_guard<std::mutex> lock(sMutex);
+        return sCategories[(size_t)category];
+    }
+
+    uint64_t MemoryTracker::getTotalBytes()
+    {
+        std::lock_guard<std::mutex> lock(sMutex);
+        return sTotalBytes;
+    }
+
+    std::vector<MemoryTracker::OwnerStats> MemoryTracker::getOwnerStats(uint32_t maxCount)
+    {
+        std::map<std::pair<std::string, Category>, OwnerStats> owners;
+        {
+            std::lock_guard<std::mutex> lock(sMutex);
+            for (const auto& a : sAllocations)
+            {
+                const std::string& owner = a.second.owner.size() ? a.second.owner : "<unnamed>";
+                OwnerStats& stats = owners[std::make_pair(owner, a.second.category)];
+                stats.owner = owner;
+                stats.category = a.second.category;
+                stats.bytes += a.second.size;
+                stats.count++;
+            }
+        }
+
+        std::vector<OwnerStats> result;
+        result.reserve(owners.size());
+        for (auto& o : owners) result.push_back(std::move(o.second));
+        std::sort(result.begin(), result.end(), [](const OwnerStats& a, const OwnerStats& b) { return a.bytes > b.bytes; });
+        if (result.size() > maxCount) result.resize(maxCount);
+        return result;
+    }
+
+    void MemoryTracker::endFrame()
+    {
+        uint64_t cpuBytes = getProcessUsedVirtualMemory();
+
+        std::lock_guard<std::mutex> lock(sMutex);
+        sLastFramePeakBytes = sFramePeakBytes;
+        sLastFrameCpuBytes = cpuBytes;
+        sFramePeakBytes = sTotalBytes;
+    }
+
+    uint64_t MemoryTracker::getLastFramePeakBytes()
+    {
+        std::lock_guard<std::mutex> lock(sMutex);
+        return sLastFramePeakBytes;
+    }
+
+    uint64_t MemoryTracker::getLastFrameCpuBytes()
+    {
+        std::lock_guard<std::mutex> lock(sMutex);
+        return sLastFrameCpuBytes;
+    }
+
+    const char* MemoryTracker::getCategoryName(Category category)
+    {
+        switch (category)
+        {
+        case Category::Texture:                 return "Textures";
+        case Category::RenderTarget:            return "Render targets";
+        case Category::Channel:                 return "Channels";
+        case Category::TextureHeap:             return "Texture heaps";
+        case Category::Buffer:                  return "Buffers";
+        case Category::AccelerationStructure:   return "Acceleration structures";
+        case Category::Readback:                return "Readback buffers";
+        case Category::UploadHeap:              return "Upload heap";
+        default:                                should_not_get_here(); return "";
+        }
+    }
+
+    std::string MemoryTracker::getSummaryString()
+    {
+        std::string summary;
+        for (uint32_t i = 0; i < (uint32_t)Category::Count; i++)
+        {
+            CategoryStats stats = getCategoryStats((Category)i);
+            if (stats.peakBytes == 0) continue;
+            summary += std::string(getCategoryName((Category)i)) + ": " + formatBytes(stats.bytes) + " in " + std::to_string(stats.count) + " allocations (peak " + formatBytes(stats.peakBytes) + ")\n";
+        }
+        summary += "Total GPU: " + formatBytes(getTotalBytes()) + ", peak last frame " + formatBytes(getLastFramePeakBytes()) + "\n";
+        summary += "Process CPU: " + formatBytes(getLastFrameCpuBytes()) + "\n";
+        return summary;
+    }
+
+    bool MemoryTracker::dumpJson(const std::string& filename)
+    {
+        std::ofstream file(filename);
+        if (file.fail())
+        {
+            logWarning("MemoryTracker::dumpJson() - can't open " + filename);
+            return false;
+        }
+
+        file << "{\n";
+        file << "  \"totalBytes\": " << getTotalBytes() << ",\n";
+        file << "  \"processCpuBytes\": " << getProcessUsedVirtualMemory() << ",\n";
+        file << "  \"categories\": [\n";
+        for (uint32_t i = 0; i < (uint32_t)Category::Count; i++)
+        {
+            CategoryStats stats = getCategoryStats((Category)i);
+            file << "    { \"name\": \"" << getCategoryName((Category)i) << "\", \"bytes\": " << stats.bytes << ", \"peakBytes\": " << stats.peakBytes << ", \"count\": " << stats.count << " }";
+            file << ((i + 1 < (uint32_t)Category::Count) ? ",\n" : "\n");
+        }
+        file << "  ],\n";
+
+        std::vector<OwnerStats> owners = getOwnerStats();
+        file << "  \"owners\": [\n";
+        for (size_t i = 0; i < owners.size(); i++)
+        {
+            file << "    { \"owner\": \"" << escapeJsonString(owners[i].owner) << "\", \"category\": \"" << getCategoryName(owners[i].category) << "\", \"bytes\": " << owners[i].bytes << ", \"count\": " << owners[i].count << " }";
+            file << ((i + 1 < owners.size()) ? ",\n" : "\n");
+        }
+        file << "  ]\n}\n";
+
+        logInfo("MemoryTracker: wrote memory usage to " + filename);
+        return true;
+    }
+}
@@ -0,0 +1,148 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Falcor
+{
+    /** Keeps count of the GPU memory allocated by Falcor, by category and owner, to find out where the memory goes.
+        Textures, buffers, upload pages and heaps report their allocations when they are created and destroyed. Code creating resources can then name their owner (a file name, a channel, a model) and refine their category.
+        Thread-safe.
+    */
+    class MemoryTracker
+    {
+    public:
+        enum class Category
+        {
+            Texture,                ///< Textures created with initial data, or without render-target/depth-stencil bindings
+            RenderTarget,           ///< Render-target and depth-stencil textures
+            Channel,                ///< Textures shared between render passes (e.g., a G-buffer)
+            TextureHeap,            ///< Heaps textures are placed in. Placed textures are not counted separately
+            Buffer,
+            AccelerationStructure,  ///< Ray tracing acceleration structures and the scratch buffers used to build them
+            Readback,               ///< CPU-readable buffers
+            UploadHeap,             ///< Pages of the upload heap used for dynamic buffers and resource uploads
+            Count
+        };
+
+        struct CategoryStats
+        {
+            uint64_t bytes = 0;
+            uint64_t peakBytes = 0;     ///< Since the application started
+            uint32_t count = 0;
+        };
+
+        /** Memory used by one owner, in one category
+        */
+        struct OwnerStats
+        {
+            std::string owner;
+            Category category;
+            uint64_t bytes = 0;
+            uint32_t count = 0;
+        };
+
+        /** Record a new allocation.
+            \param[in] pObject The object owning the memory. Used to identify the allocation.
+            \param[in] category The kind of allocation
+            \param[in] size The size of the allocation, in bytes
+            \param[in] owner Who uses the allocation. Can be set later with setOwner()
+        */
+        static void trackAllocation(const void* pObject, Category category, uint64_t size, const std::string& owner = "");
+
+        /** Record that an allocation was freed. Does nothing if the object's memory isn't tracked.
+        */
+        static void releaseAllocation(const void* pObject);
+
+        /** Name who uses an allocation. Does nothing if the object's memory isn't tracked.
+        */
+        static void setOwner(const void* pObject, const std::string& owner);
+
+        /** Change the category of an allocation. Does nothing if the object's memory isn't tracked.
+        */
+        static void setCategory(const void* pObject, Category category);
+
+        /** Get the current usage of a category
+        */
+        static CategoryStats getCategoryStats(Category category);
+
+        /** Get the memory currently allocated, in bytes
+        */
+        static uint64_t getTotalBytes();
+
+        /** Get the usage of each owner, largest first
+            \param[in] maxCount Maximum number of owners returned
+        */
+        static std::vector<OwnerStats> getOwnerStats(uint32_t maxCount = UINT32_MAX);
+
+        /** Mark the end of a frame. Records the frame's memory watermarks, returned by getLastFramePeakBytes() and getLastFrameCpuBytes().
+        */
+        static void endFrame();
+
+        /** Get the largest amount of memory allocated at any point during the last frame
+        */
+        static uint64_t getLastFramePeakBytes();
+
+        /** Get the CPU memory used by the process at the end of the last frame
+        */
+        static uint64_t getLastFrameCpuBytes();
+
+        /** Get a category's name
+        */
+        static const char* getCategoryName(Category category);
+
+        /** Get a short, human-readable summary of the memory usage, one category per line
+        */
+        static std::string getSummaryString();
+
+        /** Write the memory usage by category and by owner to a JSON file.
+            \return false if the file can't be written
+        */
+        static bool dumpJson(const std::string& filename);
+
+    private:
+        struct Allocation
+        {
+            Category category;
+            uint64_t size;
+            std::string owner;
+        };
+
+        static std::mutex sMutex;
+        static std::unordered_map<const void*, Allocation> sAllocations;
+        static CategoryStats sCategories[(size_t)Category::Count];
+        static uint64_t sTotalBytes;
+        static uint64_t sFramePeakBytes;        ///< Peak of the frame in progress
+        static uint64_t sLastFramePeakBytes;
+        static uint64_t sLastFrameCpuBytes;
+    };
+}
@@ -36,6 +36,7 @@
 #include <sys/ptrace.h>
 #include <gtk/gtk.h>
 #include <fstream>
+#include <cstdio>
 #include <fcntl.h>
 #include <libgen.h>
 #include <errno.h>
@@ -188,6 +189,12 @@ namespace Falcor
         struct stat sb;
         return (stat(pathname, &sb) == 0) && S_ISDIR(sb.st_mode);
     }
+
+    bool replaceFile(const std::string& src, const std::string& dst)
+    {
+        // rename() atomically replaces an existing destination
+        return std::rename(src.c_str(), dst.c_str()) == 0;
+    }
     
     void monitorFileUpdates(const std::string& filePath, const std::function<void()>& callback)
     {
@@ -29,6 +29,7 @@
 #include "Utils/Platform/OS.h"
 #include "Utils/StringUtils.h"
 #include <fstream>
+#include <cstdio>
 #include <experimental/filesystem>
 namespace fs = std::experimental::filesystem;
 
@@ -204,4 +205,28 @@ namespace Falcor
         str.assign(std::istreambuf_iterator<char>(filestream), std::istreambuf_iterator<char>());
         return str;
     }
+
+    bool writeFileAtomic(const std::string& filename, const std::function<bool(std::ostream&)>& writeFunc)
+    {
+        std::string tempFile = filename + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+        {
+            std::ofstream stream(tempFile, std::ios::binary | std::ios::trunc);
+            if (stream.is_open() == false) return false;
+
+            bool written = writeFunc(stream) && stream.good();
+            stream.close();
+            if (written == false || stream.fail())
+            {
+                std::remove(tempFile.c_str());
+                return false;
+            }
+        }
+
+        if (replaceFile(tempFile, filename) == false)
+        {
+            std::remove(tempFile.c_str());
+            return false;
+        }
+        return true;
+    }
 }
\ No newline at end of file
@@ -30,6 +30,7 @@
 #include <vector>
 #include <thread>
 #include <functional>
+#include <iosfwd>
 #include "API/Window.h"
 
 namespace Falcor
@@ -306,6 +307,21 @@ namespace Falcor
     */
     std::string readFile(const std::string& filename);
 
+    /** Move a file, replacing the destination if it exists (std::rename() fails on Windows when the destination exists)
+        \param[in] src The file to move
+        \param[in] dst The new path of the file
+        \return true if the file was moved
+    */
+    bool replaceFile(const std::string& src, const std::string& dst);
+
+    /** Write a file through a temporary file, which replaces the file once it's complete. Readers never see a partially written file, and an existing file is replaced.
+        The temporary file's name is unique to the calling thread, so threads and processes can write the same file at the same time; the last one to finish wins.
+        \param[in] filename The file to write
+        \param[in] writeFunc Writes the content to the stream. If it returns false, or the stream is in an error state afterwards, the file is left untouched.
+        \return true if the file was written
+    */
+    bool writeFileAtomic(const std::string& filename, const std::function<bool(std::ostream&)>& writeFunc);
+
     /** Load a shared-library
     */
     DllHandle loadDll(const std::string& libPath);
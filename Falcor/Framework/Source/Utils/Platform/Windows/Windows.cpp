@@ -108,6 +108,11 @@ namespace Falcor
         return res == TRUE;
     }
 
+    bool replaceFile(const std::string& src, const std::string& dst)
+    {
+        return MoveFileExA(src.c_str(), dst.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+    }
+
     std::string getTempFilename()
     {
         char* error = nullptr;
@@ -29,11 +29,17 @@
 #include "Profiler.h"
 #include "API/GpuTimer.h"
 #include "API/LowLevel/FencedPool.h"
+#include "Utils/StringUtils.h"
 
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <cstdio>
+#include <atomic>
+#include <algorithm>
+#include <cfloat>
+#include <mutex>
+#include <thread>
 
 namespace Falcor
 {
@@ -43,12 +49,66 @@ namespace Falcor
     uint32_t Profiler::sCurrentLevel = 0;
     uint32_t Profiler::sGpuTimerIndex = 0;
     std::vector<Profiler::EventData*> Profiler::sProfilerVector;
+    std::vector<Profiler::EventData*> Profiler::sWorkerEvents;
+    std::string Profiler::sWorkerEventsString;
+
+    bool Profiler::sTraceEnabled = false;
+    CpuTimer::TimePoint Profiler::sTraceEpoch;
+    uint64_t Profiler::sTraceFrameId = 0;
+    std::vector<Profiler::TraceFrame> Profiler::sTraceFrames;
+    std::vector<Profiler::PendingGpuEvent> Profiler::sPendingGpuEvents[2];
+
+    static const uint64_t kInvalidTraceFrame = uint64_t(-1);
+
+    // Interned events. The table has a fixed size so other threads can index it while events are being registered.
+    static const uint32_t kMaxEvents = 4096;
+    static Profiler::EventData* sEventTable[kMaxEvents];
+    static std::atomic<uint32_t> sEventCount(0);
+    static std::mutex sEventMutex;
+
+    // GPU timers are recorded into the render context's command list, so only this thread times the GPU
+    static const std::thread::id sMainThreadId = std::this_thread::get_id();
+
+    static uint32_t getTraceThreadId()
+    {
+        static std::atomic<uint32_t> sNextThreadId(0);
+        static thread_local uint32_t threadId = sNextThreadId++;
+        return threadId;
+    }
+
+    /** Events recorded by a thread other than the main thread.
+        A single-producer/single-consumer ring: the owning thread writes records and advances head, endFrame() reads them and advances tail.
+    */
+    struct Profiler::ThreadEventBuffer
+    {
+        struct Record
+        {
+            EventId id;
+            uint32_t isEnd;
+            CpuTimer::TimePoint time;
+        };
+
+        static const uint32_t kCapacity = 16384;
+        Record records[kCapacity];
+        std::atomic<uint64_t> head{ 0 };
+        std::atomic<uint64_t> tail{ 0 };
+        std::atomic<uint64_t> droppedCount{ 0 };    ///< Records lost because the ring was full
+        uint32_t threadId = 0;
+        std::vector<Record> openEvents;             ///< Begin records waiting for their end record. Only accessed by the merging thread
+        uint64_t mergedDroppedCount = 0;            ///< droppedCount when the merging thread last checked it
+    };
+
+    static std::mutex sThreadBuffersMutex;
+    std::vector<std::shared_ptr<Profiler::ThreadEventBuffer>> Profiler::sThreadBuffers;
 
     std::hash<std::string> HashedString::hashFunc;
 
     void Profiler::initNewEvent(EventData *pEvent, const HashedString& name)
     {
         pEvent->name = name.str;
+        pEvent->id = sEventCount.load();
+        sEventTable[pEvent->id] = pEvent;
+        sEventCount.store(pEvent->id + 1);
         sProfilerEvents[name.hash] = pEvent;
     }
 
@@ -61,6 +121,7 @@ namespace Falcor
 
     Profiler::EventData* Profiler::isEventRegistered(const HashedString& name)
     {
+        std::lock_guard<std::mutex> lock(sEventMutex);
         auto event = sProfilerEvents.find(name.hash);
         if (event == sProfilerEvents.end())
         {
@@ -72,22 +133,50 @@ namespace Falcor
         }
     }
 
-    Profiler::EventData* Profiler::getEvent(const HashedString& name)
+    Profiler::EventId Profiler::registerEvent(const HashedString& name)
     {
-        auto event = isEventRegistered(name);
-        if (event)
-        {
-            return event;
-        }
-        else
+        std::lock_guard<std::mutex> lock(sEventMutex);
+        auto event = sProfilerEvents.find(name.hash);
+        if (event != sProfilerEvents.end()) return event->second->id;
+
+        if (sEventCount.load() >= kMaxEvents)
         {
-            return createNewEvent(name);
+            logWarning("Profiler::registerEvent() - too many events. Ignoring '" + name.str + "'");
+            return kInvalidEventId;
         }
+        return createNewEvent(name)->id;
+    }
+
+    Profiler::EventData* Profiler::getEventData(EventId id)
+    {
+        return id < sEventCount.load(std::memory_order_acquire) ? sEventTable[id] : nullptr;
+    }
+
+    Profiler::EventData* Profiler::getEvent(const HashedString& name)
+    {
+        return getEventData(registerEvent(name));
     }
 
     void Profiler::startEvent(const HashedString& name, bool showInMsg)
     {
-        EventData* pData = getEvent(name);
+        startEvent(registerEvent(name), showInMsg);
+    }
+
+    void Profiler::endEvent(const HashedString& name)
+    {
+        endEvent(registerEvent(name));
+    }
+
+    void Profiler::startEvent(EventId id, bool showInMsg)
+    {
+        if (std::this_thread::get_id() != sMainThreadId)
+        {
+            recordThreadEvent(id, false);
+            return;
+        }
+
+        EventData* pData = getEventData(id);
+        if (pData == nullptr) return;
         sProfilerVector.push_back(pData);
         pData->showInMsg = showInMsg;
         pData->level = sCurrentLevel;
@@ -98,16 +187,25 @@ namespace Falcor
             frame.pTimers.push_back(GpuTimer::create());
         }
         frame.pTimers[frame.currentTimer]->begin();
+        if (sTraceEnabled) recordTraceBegin(pData, frame.pTimers[frame.currentTimer]);
         pData->callStack.push(frame.currentTimer);
         frame.currentTimer++;
         sCurrentLevel++;
     }
 
-    void Profiler::endEvent(const HashedString& name)
+    void Profiler::endEvent(EventId id)
     {
-        EventData* pData = getEvent(name);
+        if (std::this_thread::get_id() != sMainThreadId)
+        {
+            recordThreadEvent(id, true);
+            return;
+        }
+
+        EventData* pData = getEventData(id);
+        if (pData == nullptr || pData->callStack.empty()) return;
         pData->cpuEnd = CpuTimer::getCurrentTimePoint();
         pData->cpuTotal += CpuTimer::calcDuration(pData->cpuStart, pData->cpuEnd);
+        if (sTraceEnabled) recordTraceEnd(pData);
 
         pData->frameData[sGpuTimerIndex].pTimers[pData->callStack.top()]->end();
         pData->callStack.pop();
@@ -115,6 +213,111 @@ namespace Falcor
         sCurrentLevel--;
     }
 
+    void Profiler::recordThreadEvent(EventId id, bool isEnd)
+    {
+        if (id == kInvalidEventId) return;
+
+        static thread_local std::shared_ptr<ThreadEventBuffer> pBuffer;
+        if (pBuffer == nullptr)
+        {
+            pBuffer = std::make_shared<ThreadEventBuffer>();
+            pBuffer->threadId = getTraceThreadId();
+            std::lock_guard<std::mutex> lock(sThreadBuffersMutex);
+            sThreadBuffers.push_back(pBuffer);
+        }
+
+        uint64_t head = pBuffer->head.load(std::memory_order_relaxed);
+        if (head - pBuffer->tail.load(std::memory_order_acquire) >= ThreadEventBuffer::kCapacity)
+        {
+            pBuffer->droppedCount.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        ThreadEventBuffer::Record& record = pBuffer->records[head % ThreadEventBuffer::kCapacity];
+        record.id = id;
+        record.isEnd = isEnd ? 1 : 0;
+        record.time = CpuTimer::getCurrentTimePoint();
+        pBuffer->head.store(head + 1, std::memory_order_release);
+    }
+
+    void Profiler::mergeThreadEvents()
+    {
+        std::vector<std::shared_ptr<ThreadEventBuffer>> buffers;
+        {
+            std::lock_guard<std::mutex> lock(sThreadBuffersMutex);
+            buffers = sThreadBuffers;
+        }
+
+        for (auto& pBuffer : buffers)
+        {
+            uint64_t head = pBuffer->head.load(std::memory_order_acquire);
+            uint64_t tail = pBuffer->tail.load(std::memory_order_relaxed);
+            for (uint64_t i = tail; i < head; i++)
+            {
+                const ThreadEventBuffer::Record& record = pBuffer->records[i % ThreadEventBuffer::kCapacity];
+                if (record.isEnd == 0)
+                {
+                    pBuffer->openEvents.push_back(record);
+                    continue;
+                }
+
+                // Events are scoped, so an end record closes the innermost open event with its id, and any event opened after it lost its end record.
+                // An end record without an open event lost its begin record.
+                auto match = std::find_if(pBuffer->openEvents.rbegin(), pBuffer->openEvents.rend(), [&record](const ThreadEventBuffer::Record& r) { return r.id == record.id; });
+                if (match == pBuffer->openEvents.rend()) continue;
+                ThreadEventBuffer::Record begin = *match;
+                pBuffer->openEvents.erase(std::prev(match.base()), pBuffer->openEvents.end());
+
+                EventData* pData = getEventData(record.id);
+                float duration = CpuTimer::calcDuration(begin.time, record.time);
+                if (pData->isWorkerEvent == false)
+                {
+                    pData->isWorkerEvent = true;
+                    sWorkerEvents.push_back(pData);
+                }
+                pData->workerCpuTotal += duration;
+
+                if (sTraceEnabled)
+                {
+                    TraceEvent event;
+                    event.eventId = record.id;
+                    event.threadId = pBuffer->threadId;
+                    event.start = CpuTimer::calcDuration(sTraceEpoch, begin.time) * 1000.0;
+                    event.duration = duration * 1000.0;
+                    getCurrentTraceFrame().cpuEvents.push_back(event);
+                }
+            }
+
+            // Records are only dropped while the ring is full, so the dropped ones came after all the records merged above.
+            // There is no telling which of the open events lost their end record, so start pairing from scratch.
+            uint64_t droppedCount = pBuffer->droppedCount.load(std::memory_order_relaxed);
+            if (droppedCount != pBuffer->mergedDroppedCount)
+            {
+                pBuffer->openEvents.clear();
+                pBuffer->mergedDroppedCount = droppedCount;
+            }
+            pBuffer->tail.store(head, std::memory_order_release);
+        }
+
+        // Forget the threads that exited, once their last events are merged
+        buffers.clear();
+        std::lock_guard<std::mutex> lock(sThreadBuffersMutex);
+        for (size_t i = 0; i < sThreadBuffers.size();)
+        {
+            const auto& pBuffer = sThreadBuffers[i];
+            bool drained = pBuffer->head.load(std::memory_order_acquire) == pBuffer->tail.load(std::memory_order_relaxed);
+            // The thread's own reference goes away when it exits
+            if (pBuffer.use_count() == 1 && drained)
+            {
+                sThreadBuffers.erase(sThreadBuffers.begin() + i);
+            }
+            else
+            {
+                i++;
+            }
+        }
+    }
+
     double Profiler::getEventGpuTime(const HashedString& name)
     {
         const auto& pEvent = getEvent(name);
@@ -127,6 +330,12 @@ namespace Falcor
         return pEvent ? getCpuTime(pEvent) : 0;
     }
 
+    void Profiler::setEventAnnotation(const HashedString& name, const std::string& annotation)
+    {
+        EventData* pEvent = getEvent(name);
+        if (pEvent) pEvent->annotation = annotation;
+    }
+
     double Profiler::getGpuTime(const EventData* pData)
     {
         double gpuTime = 0;
@@ -156,7 +365,8 @@ namespace Falcor
             char event[1000];
             uint32_t nameIndent = pData->level * 2 + 1;
             uint32_t cpuIndent = 30 - (nameIndent + (uint32_t)pData->name.size());
-            snprintf(event, 1000, "%*s%s %*.2f %14.2f\n", nameIndent, " ", pData->name.c_str(), cpuIndent, getCpuTime(pData), gpuTime);
+            snprintf(event, 1000, "%*s%s %*.2f %14.2f%s%s\n", nameIndent, " ", pData->name.c_str(), cpuIndent, getCpuTime(pData), gpuTime,
+                pData->annotation.empty() ? "" : "   ", pData->annotation.c_str());
 #if _PROFILING_LOG == 1
             pData->cpuMs[pData->stepNr] = pData->cpuTotal;
             pData->gpuMs[pData->stepNr] = (float)gpuTime;
@@ -178,11 +388,42 @@ namespace Falcor
             results += event;
         }
 
-        return results;
+        return results + sWorkerEventsString;
     }
 
     void Profiler::endFrame()
     {
+        // Collect the events other threads recorded during the frame. They are displayed during the next frame, alongside the GPU times.
+        mergeThreadEvents();
+        sWorkerEventsString.clear();
+        if (sWorkerEvents.size())
+        {
+            sWorkerEventsString = "Other threads (CPU time summed over threads)\n";
+            for (EventData* pData : sWorkerEvents)
+            {
+                char event[1000];
+                uint32_t cpuIndent = 30 - std::min(29u, 3 + (uint32_t)pData->name.size());
+                snprintf(event, 1000, "%*s%s %*.2f\n", 3, " ", pData->name.c_str(), cpuIndent, pData->workerCpuTotal);
+                sWorkerEventsString += event;
+                pData->workerCpuTotal = 0;
+                pData->isWorkerEvent = false;
+            }
+            sWorkerEvents.clear();
+        }
+
+        if (sTraceEnabled)
+        {
+            resolveTraceFrame();
+
+            // Start the next frame, recycling the oldest one in the ring
+            sTraceFrameId++;
+            TraceFrame& next = sTraceFrames[sTraceFrameId % sTraceFrames.size()];
+            next.frameId = sTraceFrameId;
+            next.cpuEvents.clear();
+            next.gpuEvents.clear();
+            next.gpuResolved = false;
+        }
+
         for (EventData* pData : sProfilerVector)
         {
             pData->showInMsg = false;
@@ -213,13 +454,225 @@ namespace Falcor
 
     void Profiler::clearEvents()
     {
-        for (EventData* pData : sProfilerVector)
+        // Events are interned and their IDs may be cached by callers, so only reset their data
+        mergeThreadEvents();
+        uint32_t eventCount = sEventCount.load();
+        for (uint32_t i = 0; i < eventCount; i++)
         {
-            delete pData;
+            EventData* pData = sEventTable[i];
+            pData->showInMsg = false;
+            pData->cpuTotal = 0;
+            pData->workerCpuTotal = 0;
+            pData->isWorkerEvent = false;
+            pData->annotation.clear();
+            pData->callStack = std::stack<size_t>();
+            pData->traceStack = std::stack<size_t>();
+            pData->frameData[0].currentTimer = 0;
+            pData->frameData[1].currentTimer = 0;
         }
-        sProfilerEvents.clear();
         sProfilerVector.clear();
+        sWorkerEvents.clear();
+        sWorkerEventsString.clear();
         sCurrentLevel = 0;
         sGpuTimerIndex = 0;
+        sPendingGpuEvents[0].clear();
+        sPendingGpuEvents[1].clear();
+    }
+
+    void Profiler::setTraceEnabled(bool enabled, uint32_t frameWindow)
+    {
+        // GPU results arrive a frame late, so the ring needs room for at least the previous frame
+        frameWindow = std::max(frameWindow, 2u);
+        if (enabled == sTraceEnabled && (enabled == false || frameWindow == sTraceFrames.size())) return;
+
+        if (enabled && (sTraceEnabled == false || frameWindow != sTraceFrames.size()))
+        {
+            sTraceEpoch = CpuTimer::getCurrentTimePoint();
+            sTraceFrameId = 0;
+            sTraceFrames.assign(frameWindow, TraceFrame());
+            for (auto& frame : sTraceFrames) frame.frameId = kInvalidTraceFrame;
+            sTraceFrames[0].frameId = 0;
+        }
+        sPendingGpuEvents[0].clear();
+        sPendingGpuEvents[1].clear();
+        uint32_t eventCount = sEventCount.load();
+        for (uint32_t i = 0; i < eventCount; i++)
+        {
+            sEventTable[i]->traceStack = std::stack<size_t>();
+        }
+        sTraceEnabled = enabled;
+    }
+
+    uint32_t Profiler::getTraceFrameCount()
+    {
+        uint32_t count = 0;
+        for (const auto& frame : sTraceFrames)
+        {
+            if (frame.frameId < sTraceFrameId) count++;
+        }
+        return count;
+    }
+
+    void Profiler::recordTraceBegin(EventData* pData, const GpuTimer::SharedPtr& pTimer)
+    {
+        TraceFrame& frame = getCurrentTraceFrame();
+        TraceEvent event;
+        event.eventId = pData->id;
+        event.threadId = getTraceThreadId();
+        event.start = CpuTimer::calcDuration(sTraceEpoch, pData->cpuStart) * 1000.0;
+        event.duration = 0;
+        pData->traceStack.push(frame.cpuEvents.size());
+        frame.cpuEvents.push_back(event);
+        sPendingGpuEvents[sGpuTimerIndex].push_back({ pData->id, pTimer });
+    }
+
+    void Profiler::recordTraceEnd(EventData* pData)
+    {
+        // The event may have been opened before tracing started
+        if (pData->traceStack.empty()) return;
+        TraceFrame& frame = getCurrentTraceFrame();
+        size_t index = pData->traceStack.top();
+        pData->traceStack.pop();
+        if (index < frame.cpuEvents.size())
+        {
+            frame.cpuEvents[index].duration = CpuTimer::calcDuration(pData->cpuStart, pData->cpuEnd) * 1000.0;
+        }
+    }
+
+    void Profiler::resolveTraceFrame()
+    {
+        // The other half of the double-buffered timers holds the previous frame's queries. They are reused next frame, so read them now.
+        auto& pending = sPendingGpuEvents[1 - sGpuTimerIndex];
+        TraceFrame& frame = sTraceFrames[(sTraceFrameId - 1) % sTraceFrames.size()];
+        if (sTraceFrameId > 0 && frame.frameId == sTraceFrameId - 1 && pending.size())
+        {
+            double gpuStart = DBL_MAX;
+            for (const auto& p : pending)
+            {
+                TraceEvent event;
+                event.eventId = p.eventId;
+                event.threadId = 0;
+                event.duration = p.pTimer->getElapsedTime() * 1000.0;
+                event.start = p.pTimer->getStartTime() * 1000.0;
+                gpuStart = std::min(gpuStart, event.start);
+                frame.gpuEvents.push_back(event);
+            }
+
+            // Line the GPU timeline up with the frame's first CPU event
+            double cpuStart = frame.cpuEvents.size() ? frame.cpuEvents[0].start : 0;
+            for (auto& event : frame.gpuEvents) event.start += cpuStart - gpuStart;
+            frame.gpuResolved = true;
+        }
+        pending.clear();
+    }
+
+    bool Profiler::exportTrace(const std::string& filename)
+    {
+        std::ofstream out(filename.c_str());
+        if (out.fail())
+        {
+            logWarning("Profiler::exportTrace() - can't open " + filename + " for writing");
+            return false;
+        }
+
+        // Chrome trace timestamps are in microseconds. CPU threads are in process 0, the GPU queue in process 1.
+        char buf[512];
+        out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"args\":{\"name\":\"CPU\"}},\n";
+        out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"GPU\"}},\n";
+        out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"Direct queue\"}}";
+
+        uint32_t maxThreadId = 0;
+        uint32_t frameCount = 0;
+        size_t ringSize = sTraceFrames.size();
+        for (size_t i = 1; i <= ringSize; i++)
+        {
+            // Oldest frame first. The frame currently being recorded is incomplete, so it is skipped.
+            const TraceFrame& frame = sTraceFrames[(sTraceFrameId + i) % ringSize];
+            if (frame.frameId >= sTraceFrameId) continue;
+            frameCount++;
+
+            for (int gpu = 0; gpu < 2; gpu++)
+            {
+                const auto& events = gpu ? frame.gpuEvents : frame.cpuEvents;
+                for (const auto& e : events)
+                {
+                    maxThreadId = gpu ? maxThreadId : std::max(maxThreadId, e.threadId);
+                    snprintf(buf, arraysize(buf), "\",\"ph\":\"X\",\"pid\":%d,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"frame\":%llu}}",
+                        gpu, e.threadId, e.start, e.duration, (unsigned long long)frame.frameId);
+                    out << ",\n{\"name\":\"" << escapeJsonString(sEventTable[e.eventId]->name) << buf;
+                }
+            }
+        }
+
+        for (uint32_t t = 0; t <= maxThreadId; t++)
+        {
+            snprintf(buf, arraysize(buf), ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"Thread %u\"}}", t, t);
+            out << buf;
+        }
+        out << "\n]}\n";
+        out.close();
+
+        logInfo("Profiler: wrote " + std::to_string(frameCount) + " frames to " + filename);
+        return true;
+    }
+
+    double Profiler::runOverheadBenchmark(uint32_t threadCount, uint32_t eventsPerThread)
+    {
+        EventId id = registerEvent("Profiler::runOverheadBenchmark");
+        std::vector<std::thread> threads;
+        std::vector<double> threadTimes(threadCount, 0);
+        std::atomic<uint32_t> runningCount(threadCount);
+        std::atomic<bool> start(false);
+
+        uint64_t droppedBefore = 0;
+        {
+            std::lock_guard<std::mutex> lock(sThreadBuffersMutex);
+            for (const auto& pBuffer : sThreadBuffers) droppedBefore += pBuffer->droppedCount.load();
+        }
+
+        for (uint32_t t = 0; t < threadCount; t++)
+        {
+            threads.push_back(std::thread([&, t]()
+            {
+                while (start.load() == false) std::this_thread::yield();
+                auto begin = CpuTimer::getCurrentTimePoint();
+                for (uint32_t i = 0; i < eventsPerThread; i++)
+                {
+                    startEvent(id);
+                    endEvent(id);
+                }
+                threadTimes[t] = CpuTimer::calcDuration(begin, CpuTimer::getCurrentTimePoint());
+
+                // Lets the merge loop below know this thread is done
+                runningCount--;
+            }));
+        }
+
+        // Merge while the threads run, like endFrame() would, so the rings don't fill up
+        start = true;
+        while (runningCount.load() > 0)
+        {
+            mergeThreadEvents();
+            std::this_thread::yield();
+        }
+
+        uint64_t dropped = 0;
+        {
+            std::lock_guard<std::mutex> lock(sThreadBuffersMutex);
+            for (const auto& pBuffer : sThreadBuffers) dropped += pBuffer->droppedCount.load();
+        }
+        dropped -= std::min(dropped, droppedBefore);
+        for (auto& t : threads) t.join();
+        mergeThreadEvents();
+
+        double totalTime = 0;
+        for (double time : threadTimes) totalTime += time;
+        double nsPerEvent = totalTime * 1.0e6 / (double(threadCount) * double(eventsPerThread));
+
+        std::string msg = "Profiler overhead with " + std::to_string(threadCount) + " threads: " + std::to_string(nsPerEvent) + " ns per startEvent()/endEvent() pair";
+        if (dropped) msg += " (" + std::to_string(dropped) + " records dropped because the merge couldn't keep up)";
+        logInfo(msg);
+        return nsPerEvent;
     }
 }
@@ -58,10 +58,15 @@ namespace Falcor
         This class uses the most accurately available CPU and GPU timers to profile given events. It automatically creates event hierarchies based on the order of the calls made.
         This class uses a double-buffering scheme for GPU profiling to avoid GPU stalls.
         CProfilerEvent is a wrapper class which together with scoping can simplify event profiling.
+        Events can be profiled from any thread. Events on the thread that loaded Falcor are timed on the CPU and the GPU. Other threads only time the CPU: they write into a lock-free per-thread buffer which endFrame() merges.
     */
     class Profiler
     {
     public:
+        /** Interned event ID. Resolving it once with registerEvent() avoids hashing and looking up the event name on every call.
+        */
+        using EventId = uint32_t;
+        static const EventId kInvalidEventId = EventId(-1);
 
 #if _PROFILING_LOG == 1
         static void flushLog();
@@ -79,10 +84,15 @@ namespace Falcor
             FrameData frameData[2]; // Double-buffering, to avoid GPU flushes
             bool showInMsg;
             std::stack<size_t> callStack;
+            std::stack<size_t> traceStack;  ///< Indices of the open trace events, see Profiler::setTraceEnabled()
             CpuTimer::TimePoint cpuStart;
             CpuTimer::TimePoint cpuEnd;
             float cpuTotal = 0;
+            float workerCpuTotal = 0;   ///< CPU time spent in the event on other threads this frame, summed over the threads
+            bool isWorkerEvent = false; ///< The event ran on another thread this frame
+            std::string annotation;     ///< Shown after the event's times, see Profiler::setEventAnnotation()
             uint32_t level;
+            EventId id;
 #if _PROFILING_LOG == 1
             int stepNr = 0;
             int filesWritten = 0;
@@ -96,11 +106,25 @@ namespace Falcor
         */
         static void startEvent(const HashedString& name, bool showInMsg = true);
 
+        /** Start profiling an event, using an ID returned by registerEvent()
+        */
+        static void startEvent(EventId id, bool showInMsg = true);
+
         /** Finish profiling a new event and update the events hierarchies.
             \param[in] name The event name.
         */
         static void endEvent(const HashedString& name);
 
+        /** Finish profiling an event, using an ID returned by registerEvent()
+        */
+        static void endEvent(EventId id);
+
+        /** Get the ID of an event, registering the event if it doesn't exist yet. Thread-safe.
+            \param[in] name The event name.
+            \return The event's ID, or kInvalidEventId if too many events were registered
+        */
+        static EventId registerEvent(const HashedString& name);
+
         /** Finish profiling for the entire frame.
             Due to the double-buffering nature of the profiler, the results returned are for the previous frame.
             \param[out] profileResults A string containing the the profiling results.
@@ -118,6 +142,7 @@ namespace Falcor
         
         /** Initialize a previously generated event.
             Used to do the default initialization without creating the actual event instance, to support derived event types. See \ref Cuda::Profiler::EventData.
+            Must be called from registerEvent(), which serializes the registration.
             \param[out] pEvent Event to initialize
             \param[in] name New event name
         */
@@ -138,24 +163,98 @@ namespace Falcor
         */
         static double getEventGpuTime(const HashedString& name);
 
+        /** Set a short note to display after an event's times in getEventsString(), such as the throughput of the profiled work.
+            \param[in] name The event name.
+            \param[in] annotation The note. It's kept until replaced. Pass an empty string to remove it.
+        */
+        static void setEventAnnotation(const HashedString& name, const std::string& annotation);
+
         /** Returns the event or \c nullptr if the event is not known.
             Can be used as a predicate.
         */
         static EventData* isEventRegistered(const HashedString& name);
 
-        /** Clears all the events. 
+        /** Clears the data recorded for all the events. Event IDs remain valid.
             Useful if you want to start profiling a different technique with different events.
         */
         static void clearEvents();
 
+        /** Measure the cost of profiling events on worker threads.
+            \param[in] threadCount Number of threads profiling events concurrently
+            \param[in] eventsPerThread Number of startEvent()/endEvent() pairs each thread issues
+            \return The average cost of a startEvent()/endEvent() pair, in nanoseconds
+        */
+        static double runOverheadBenchmark(uint32_t threadCount = 32, uint32_t eventsPerThread = 100000);
+
+        /** Start or stop recording a trace of the profiled events.
+            While enabled, the CPU begin/end timestamps of every event and the GPU timestamps of its queries are kept in a ring buffer holding the last frames. Events are only generated while profiling is enabled (see gProfileEnabled).
+            \param[in] enabled Whether to record
+            \param[in] frameWindow How many frames the ring buffer holds. Changing it discards the recorded frames.
+        */
+        static void setTraceEnabled(bool enabled, uint32_t frameWindow = 120);
+
+        static bool isTraceEnabled() { return sTraceEnabled; }
+
+        /** Get the number of frames currently in the trace ring buffer
+        */
+        static uint32_t getTraceFrameCount();
+
+        /** Write the recorded frames as a Chrome trace (JSON), which can be loaded in chrome://tracing or Perfetto.
+            CPU events are placed on a track per thread. GPU events are placed on a track for the direct queue. The GPU and CPU clocks aren't synchronized, so each frame's GPU events are shifted to start with the frame's first CPU event; durations and gaps within a frame are exact.
+            \param[in] filename The output file
+            \return true if the file was written
+        */
+        static bool exportTrace(const std::string& filename);
+
     private:
         static double getGpuTime(const EventData* pData);
         static double getCpuTime(const EventData* pData);
+        static EventData* getEventData(EventId id);
+
+        struct ThreadEventBuffer;
+        static void recordThreadEvent(EventId id, bool isEnd);
+        static void mergeThreadEvents();
+        static std::vector<std::shared_ptr<ThreadEventBuffer>> sThreadBuffers;
 
         static std::map<size_t, EventData*> sProfilerEvents;
+        static std::vector<EventData*> sWorkerEvents;       ///< Events that ran on other threads this frame
+        static std::string sWorkerEventsString;             ///< Other threads' results from the last frame
         static std::vector<EventData*> sProfilerVector;
         static uint32_t sCurrentLevel;
         static uint32_t sGpuTimerIndex;
+
+        struct TraceEvent
+        {
+            EventId eventId;
+            uint32_t threadId;
+            double start;           ///< Microseconds. CPU events are relative to when the trace started, GPU events are in the GPU clock domain until the frame is resolved
+            double duration;        ///< Microseconds
+        };
+
+        struct TraceFrame
+        {
+            uint64_t frameId = 0;
+            std::vector<TraceEvent> cpuEvents;
+            std::vector<TraceEvent> gpuEvents;
+            bool gpuResolved = false;
+        };
+
+        struct PendingGpuEvent
+        {
+            EventId eventId;
+            GpuTimer::SharedPtr pTimer;
+        };
+
+        static void recordTraceBegin(EventData* pData, const GpuTimer::SharedPtr& pTimer);
+        static void recordTraceEnd(EventData* pData);
+        static TraceFrame& getCurrentTraceFrame() { return sTraceFrames[sTraceFrameId % sTraceFrames.size()]; }
+        static void resolveTraceFrame();
+
+        static bool sTraceEnabled;
+        static CpuTimer::TimePoint sTraceEpoch;
+        static uint64_t sTraceFrameId;
+        static std::vector<TraceFrame> sTraceFrames;                ///< Ring buffer, indexed by frame ID modulo its size
+        static std::vector<PendingGpuEvent> sPendingGpuEvents[2];   ///< GPU queries issued in the frames using each half of the double-buffered timers
     };
 
     /** Helper class for starting and ending profiling events.
@@ -167,17 +266,18 @@ namespace Falcor
     public:
         /** C'tor
         */
-        ProfilerEvent(const HashedString& name) : mName(name) { if(gProfileEnabled) { Profiler::startEvent(name); } }
+        ProfilerEvent(const HashedString& name) : mId(gProfileEnabled ? Profiler::registerEvent(name) : Profiler::kInvalidEventId) { if(gProfileEnabled) { Profiler::startEvent(mId); } }
+        ProfilerEvent(Profiler::EventId id) : mId(id) { if(gProfileEnabled) { Profiler::startEvent(mId); } }
         /** D'tor
         */
-        ~ProfilerEvent() { if(gProfileEnabled) {Profiler::endEvent(mName); }}
+        ~ProfilerEvent() { if(gProfileEnabled) {Profiler::endEvent(mId); }}
 
     private:
-        const HashedString mName;
+        const Profiler::EventId mId;
     };
 
 #if _PROFILING_ENABLED
-#define PROFILE(_name) static const Falcor::HashedString hashed ## _name(#_name); Falcor::ProfilerEvent _profileEvent(hashed ## _name);
+#define PROFILE(_name) static const Falcor::Profiler::EventId eventId ## _name = Falcor::Profiler::registerEvent(#_name); Falcor::ProfilerEvent _profileEvent(eventId ## _name);
 #else
 #define PROFILE(_name)
 #endif
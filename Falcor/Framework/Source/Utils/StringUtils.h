@@ -196,6 +196,61 @@ namespace Falcor
         return res;
     }
 
+    /** Escape a string for use inside a JSON string literal. Quotes, backslashes and control characters are escaped, other characters are copied as is.
+    */
+    inline std::string escapeJsonString(const std::string& str)
+    {
+        static const char kHexDigits[] = "0123456789abcdef";
+        std::string result;
+        result.reserve(str.size());
+        for (char c : str)
+        {
+            switch (c)
+            {
+            case '"':  result += "\\\""; break;
+            case '\\': result += "\\\\"; break;
+            case '\b': result += "\\b"; break;
+            case '\f': result += "\\f"; break;
+            case '\n': result += "\\n"; break;
+            case '\r': result += "\\r"; break;
+            case '\t': result += "\\t"; break;
+            default:
+                if ((unsigned char)c < 0x20)
+                {
+                    result += "\\u00";
+                    result += kHexDigits[(c >> 4) & 0xf];
+                    result += kHexDigits[c & 0xf];
+                }
+                else
+                {
+                    result += c;
+                }
+            }
+        }
+        return result;
+    }
+
+    /** Offset basis of the 64-bit FNV-1a hash. Pass it to hashBytes() to start a new hash.
+    */
+    const uint64_t kFnv1aOffsetBasis = 0xcbf29ce484222325ull;
+
+    /** Add a block of memory to a 64-bit FNV-1a hash. Calls can be chained to hash several blocks.
+        \param[in] hash The hash so far, or kFnv1aOffsetBasis to start a new hash
+        \param[in] pData The data to hash
+        \param[in] size Size of the data in bytes
+        \return The updated hash
+    */
+    inline uint64_t hashBytes(uint64_t hash, const void* pData, size_t size)
+    {
+        const uint8_t* pBytes = (const uint8_t*)pData;
+        for (size_t i = 0; i < size; i++)
+        {
+            hash ^= pBytes[i];
+            hash *= 0x100000001b3ull;
+        }
+        return hash;
+    }
+
     /** Parses a string in the format <name>[<index>]. If format is valid, outputs the base name and the array index.
         \param[in] name String to parse
         \param[out] nonArray Becomes set to the non-array index portion of the string
@@ -0,0 +1,115 @@
+import argparse
+import json
+import sys
+
+# Compare two benchmark reports written by RenderingPipeline::startBenchmark() or CpuBenchmarks, and flag the passes that got slower.
+
+# Load a report, returning None on failure.
+def load_report(filepath):
+    try:
+        with open(filepath) as report_file:
+            return json.load(report_file)
+    except (IOError, OSError, ValueError) as e:
+        print("Error reading benchmark report : " + filepath + " : " + str(e))
+        return None
+
+# Warn about differences in the setup, which make the timings incomparable.
+def check_setup(base_report, new_report):
+    for key in ['scene', 'resolution', 'build', 'sceneStats', 'frames', 'timeDelta', 'rayCounting', 'samples']:
+        if base_report.get(key) != new_report.get(key):
+            print("Warning : '" + key + "' differs : " + str(base_report.get(key)) + " vs " + str(new_report.get(key)))
+
+# Compare one timing of one pass. Returns true if it regressed.
+def compare_timing(base_stats, new_stats, statistic, threshold, min_difference):
+    base_value = base_stats[statistic]
+    new_value = new_stats[statistic]
+    difference = new_value - base_value
+    # Small absolute differences are noise, whatever the ratio.
+    return difference > min_difference and difference > base_value * threshold / 100.0
+
+def compare_reports(base_report, new_report, statistic, threshold, min_difference):
+    check_setup(base_report, new_report)
+
+    base_passes = {p['name'] : p for p in base_report['passes']}
+    new_passes = {p['name'] : p for p in new_report['passes']}
+    regressions = []
+
+    print('{:<32} {:>10} {:>10} {:>8}   {:>10} {:>10} {:>8}'.format('Pass (' + statistic + ', ms)', 'CPU base', 'CPU new', 'CPU %', 'GPU base', 'GPU new', 'GPU %'))
+    for name, new_pass in new_passes.items():
+        if name not in base_passes:
+            print('{:<32} (new pass)'.format(name))
+            continue
+
+        base_pass = base_passes[name]
+        line = '{:<32}'.format(name)
+        # CpuBenchmarks reports only have CPU timings
+        for timer in [t for t in ['cpu', 'gpu'] if t in base_pass and t in new_pass]:
+            base_value = base_pass[timer][statistic]
+            new_value = new_pass[timer][statistic]
+            change = (new_value - base_value) * 100.0 / base_value if base_value > 0 else 0.0
+            regressed = compare_timing(base_pass[timer], new_pass[timer], statistic, threshold, min_difference)
+            if regressed:
+                regressions.append(name + ' (' + timer.upper() + ')')
+            line += ' {:>10.3f} {:>10.3f} {:>7.1f}{}'.format(base_value, new_value, change, '!' if regressed else ' ')
+            line += ' '
+        print(line)
+
+    for name in base_passes:
+        if name not in new_passes:
+            print('{:<32} (removed)'.format(name))
+
+    return regressions
+
+# Print the ray tracing throughput of the passes both reports counted rays for (see -countRays).
+def compare_throughput(base_report, new_report):
+    base_passes = {p['name'] : p for p in base_report['passes'] if 'rays' in p}
+    new_passes = [p for p in new_report['passes'] if 'rays' in p and p['name'] in base_passes]
+    if not new_passes:
+        return
+
+    print('\n{:<32} {:>12} {:>12} {:>8}   {:>12} {:>12}'.format('Pass (throughput)', 'Mrays/s base', 'Mrays/s new', '%', 'Rays/frame b', 'Rays/frame n'))
+    for new_pass in new_passes:
+        base_rays = base_passes[new_pass['name']]['rays']
+        new_rays = new_pass['rays']
+        base_value = base_rays['mraysPerSec']
+        new_value = new_rays['mraysPerSec']
+        change = (new_value - base_value) * 100.0 / base_value if base_value > 0 else 0.0
+        print('{:<32} {:>12.1f} {:>12.1f} {:>7.1f}    {:>12.0f} {:>12.0f}'.format(new_pass['name'], base_value, new_value, change, base_rays['perFrame'], new_rays['perFrame']))
+
+# Print the GPU memory watermarks and the process' CPU memory of both runs.
+def compare_memory(base_report, new_report):
+    if 'memory' not in base_report or 'memory' not in new_report:
+        return
+
+    print('\n{:<32} {:>12} {:>12} {:>8}'.format('Memory (MB)', 'Base', 'New', '%'))
+    for key in ['peakBytes', 'meanFramePeakBytes', 'cpuPeakBytes']:
+        base_value = base_report['memory'][key] / (1024.0 * 1024.0)
+        new_value = new_report['memory'][key] / (1024.0 * 1024.0)
+        change = (new_value - base_value) * 100.0 / base_value if base_value > 0 else 0.0
+        print('{:<32} {:>12.1f} {:>12.1f} {:>7.1f}'.format(key, base_value, new_value, change))
+
+def main():
+    parser = argparse.ArgumentParser(description='Compare two benchmark reports and flag regressions.')
+    parser.add_argument('base', help='Report to compare against (.json)')
+    parser.add_argument('new', help='Report to check (.json)')
+    parser.add_argument('-statistic', default='median', choices=['mean', 'median', 'p95', 'p99'], help='Statistic to compare')
+    parser.add_argument('-threshold', type=float, default=5.0, help='Slowdown, in percent, counted as a regression')
+    parser.add_argument('-min_difference', type=float, default=0.05, help='Slowdown, in ms, below which differences are ignored')
+    args = parser.parse_args()
+
+    base_report = load_report(args.base)
+    new_report = load_report(args.new)
+    if base_report is None or new_report is None:
+        sys.exit(2)
+
+    regressions = compare_reports(base_report, new_report, args.statistic, args.threshold, args.min_difference)
+    compare_throughput(base_report, new_report)
+    compare_memory(base_report, new_report)
+    if regressions:
+        print('\nRegressions : ' + ', '.join(regressions))
+        sys.exit(1)
+
+    print('\nNo regressions.')
+
+if __name__ == '__main__':
+    main()
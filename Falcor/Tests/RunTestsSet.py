@@ -160,6 +160,7 @@ def run_tests_set(main_directory, rebuild, json_filepath, results_directory, ref
             # Initialize all the results.
             current_tests_group['Results']['Run Results'] = {}
             current_tests_group['Results']['Directory'] = current_results_directory
+            current_tests_group['Results']['Executable Directory'] = executable_directory
             current_tests_group['Results']['Filename'] = {}
             current_tests_group['Results']['Success'] = True
 
@@ -234,7 +235,18 @@ def analyze_tests_group(tests_set_data, current_test_group_name):
                 if 'Test Config' in current_test_group and 'Tolerance' in current_test_group['Test Config']:
                     tolerance = current_test_group['Test Config']['Tolerance']
 
-                screen_capture_checks = analyze_screen_captures(tolerance, result_json_data, current_test_result_directory, current_test_reference_directory)
+                compare_images = lambda result_image, reference_image, compare_image: compare_with_imagemagick(tolerance, result_image, reference_image, compare_image)
+                screen_capture_checks = analyze_screen_captures(compare_images, result_json_data, current_test_result_directory, current_test_reference_directory)
+
+            # Compare the screen captures with error metrics, for noisy images. Thresholds are given per metric, e.g. { "flip" : 0.05, "psnr" : 30 }
+            elif current_test_group['Test Config']['Type'] == "Image Metric":
+                image_compare_executable = os.path.join(current_test_group['Results']['Executable Directory'], 'ImageCompare')
+                if os.name == 'nt':
+                    image_compare_executable += '.exe'
+                thresholds = current_test_group['Test Config']['Thresholds']
+
+                compare_images = lambda result_image, reference_image, compare_image: compare_with_metrics(image_compare_executable, thresholds, result_image, reference_image, compare_image)
+                screen_capture_checks = analyze_screen_captures(compare_images, result_json_data, current_test_result_directory, current_test_reference_directory)
 
             # # Analyze the performance checks.
             # if current_test_group['Test Config']['Type'] == "Performance Test":
@@ -259,7 +271,62 @@ def analyze_performance_checks(result_json_data):
 def analyze_memory_checks(result_json_data):
     return []
 
-def analyze_screen_captures(tolerance, result_json_data, current_test_result_directory, current_test_reference_directory):
+# Compare two images with ImageMagick's MSE.
+def compare_with_imagemagick(tolerance, test_result_image_filename, test_reference_image_filename, test_compare_image_filepath):
+    image_compare_command = ['magick', 'compare', '-metric', 'MSE', '-compose', 'Src', '-highlight-color', 'White', '-lowlight-color', 'Black', test_result_image_filename, test_reference_image_filename, test_compare_image_filepath]
+
+    if os.name == 'nt':
+        image_compare_process = subprocess.Popen(image_compare_command, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, shell=True)
+    else:
+        #don't need "magick" first  or shell=True if on linux
+        image_compare_command.pop(0)            
+        image_compare_process = subprocess.Popen(image_compare_command, stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
+
+    image_compare_result = image_compare_process.communicate()[0]
+
+    # Decode if image compare result is a "binary" string
+    try:
+        image_compare_result = image_compare_result.decode('ascii')
+    except AttributeError:
+        pass
+
+    # Keep the Return Code and the Result.
+    result = {}
+
+    # Image compare succeeded
+    if image_compare_process.returncode <= 1: # 0: Success, 1: Does not match, 2: File not found, or other error?
+        result_str = image_compare_result[:image_compare_result.find(' ')]
+        result['Compare Result'] = result_str
+        result['Test Passed'] = float(result_str) <= tolerance
+    # Error
+    else:
+        result['Compare Result'] = "Error"
+        result['Test Passed'] = False
+
+    result['Return Code'] = image_compare_process.returncode
+    return result
+
+# Compare two images with Falcor's ImageCompare tool, and check the metrics against thresholds.
+def compare_with_metrics(image_compare_executable, thresholds, test_result_image_filename, test_reference_image_filename, test_compare_image_filepath):
+    image_compare_command = [image_compare_executable, test_reference_image_filename, test_result_image_filename, '-errorMap', test_compare_image_filepath]
+    for metric, threshold in thresholds.items():
+        image_compare_command += ['-threshold', metric, str(threshold)]
+
+    image_compare_process = subprocess.Popen(image_compare_command, stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
+    image_compare_result = image_compare_process.communicate()[0]
+    try:
+        image_compare_result = image_compare_result.decode('ascii')
+    except AttributeError:
+        pass
+
+    # 0: Within the thresholds, 1: Outside the thresholds, 2: Error
+    result = {}
+    result['Compare Result'] = image_compare_result.strip() if image_compare_process.returncode <= 1 else "Error"
+    result['Test Passed'] = image_compare_process.returncode == 0
+    result['Return Code'] = image_compare_process.returncode
+    return result
+
+def analyze_screen_captures(compare_images, result_json_data, current_test_result_directory, current_test_reference_directory):
 
     screen_captures_results = {}
     screen_captures_results['Success'] = True
@@ -278,38 +345,7 @@ def analyze_screen_captures(tolerance, result_json_data, current_test_result_dir
             # Create the test compare image.
             test_compare_image_filepath = os.path.join(current_test_result_directory, os.path.splitext(frame_screen_captures['Filename'])[0] + '_Compare.png')
 
-            # Run ImageMagick
-            image_compare_command = ['magick', 'compare', '-metric', 'MSE', '-compose', 'Src', '-highlight-color', 'White', '-lowlight-color', 'Black', test_result_image_filename, test_reference_image_filename, test_compare_image_filepath]
-
-            if os.name == 'nt':
-                image_compare_process = subprocess.Popen(image_compare_command, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, shell=True)
-            else:
-                #don't need "magick" first  or shell=True if on linux
-                image_compare_command.pop(0)            
-                image_compare_process = subprocess.Popen(image_compare_command, stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
-
-            image_compare_result = image_compare_process.communicate()[0]
-
-            # Decode if image compare result is a "binary" string
-            try:
-                image_compare_result = image_compare_result.decode('ascii')
-            except AttributeError:
-                pass
-
-            # Keep the Return Code and the Result.
-            result = {}
-
-            # Image compare succeeded
-            if image_compare_process.returncode <= 1: # 0: Success, 1: Does not match, 2: File not found, or other error?
-                result_str = image_compare_result[:image_compare_result.find(' ')]
-                result['Compare Result'] = result_str
-                result['Test Passed'] = float(result_str) <= tolerance
-            # Error
-            else:
-                result['Compare Result'] = "Error"
-                result['Test Passed'] = False
-
-            result['Return Code'] = image_compare_process.returncode
+            result = compare_images(test_result_image_filename, test_reference_image_filename, test_compare_image_filepath)
             result['Source Filename'] = test_result_image_filename
             result['Reference Filename'] = test_reference_image_filename
 
@@ -0,0 +1,524 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "CpuBenchmarks.h"
+#include "Graphics/Scene/SceneImporter.h"
+#include "Graphics/Scene/SceneExporter.h"
+#include "Graphics/Model/Loaders/BinaryModelImporter.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+
+CpuBenchmarks::Options CpuBenchmarks::sOptions;
+std::vector<CpuBenchmarks::Result> CpuBenchmarks::sResults;
+
+namespace
+{
+    const uint32_t kBoneCount = 64;
+    const uint32_t kLargeRigBoneCount = 200;
+    const uint32_t kKeysPerChannel = 240;
+    const float kTicksPerSecond = 30.0f;
+    const uint32_t kBitmapSize = 1024;
+
+    // Deterministic pseudo-random numbers, so every run does the same work
+    class Lcg
+    {
+    public:
+        float next() { mState = mState * 1664525u + 1013904223u; return float(mState >> 8) / float(1 << 24); }
+        float next(float minValue, float maxValue) { return minValue + (maxValue - minValue) * next(); }
+    private:
+        uint32_t mState = 12345u;
+    };
+
+    bool isFinite(const glm::vec3& v)
+    {
+        return std::isfinite(v.x) && std::isfinite(v.y) && std::isfinite(v.z);
+    }
+
+    // A binary tree of bones, each animated by all three channels
+    AnimationController::UniquePtr createAnimatedSkeleton(uint32_t boneCount)
+    {
+        std::vector<Bone> bones(boneCount);
+        std::vector<Animation::AnimationSet> animationSets(boneCount);
+        for (uint32_t i = 0; i < boneCount; i++)
+        {
+            Bone& bone = bones[i];
+            bone.boneID = i;
+            bone.parentID = (i == 0) ? AnimationController::kInvalidBoneID : (i - 1) / 2;
+            bone.name = "Bone" + std::to_string(i);
+            bone.offset = glm::mat4(1);
+            bone.localTransform = bone.originalLocalTransform = bone.globalTransform = glm::mat4(1);
+
+            Animation::AnimationSet& set = animationSets[i];
+            set.boneID = i;
+            for (uint32_t k = 0; k < kKeysPerChannel; k++)
+            {
+                float time = float(k);
+                float phase = time * 0.1f + float(i);
+                set.translation.addKey(glm::vec3(sin(phase), cos(phase), 0.1f * phase), time);
+                set.scaling.addKey(glm::vec3(1.0f + 0.1f * sin(phase)), time);
+                set.rotation.addKey(glm::angleAxis(phase, glm::normalize(glm::vec3(1, 2, 3))), time);
+            }
+        }
+
+        AnimationController::UniquePtr pController = AnimationController::create(bones);
+        pController->addAnimation(Animation::create("Benchmark", animationSets, float(kKeysPerChannel), kTicksPerSecond));
+        pController->setActiveAnimation(0);
+        return pController;
+    }
+
+    bool areBonesFinite(const AnimationController* pController)
+    {
+        const glm::mat4& m = pController->getBoneMatrices().back();
+        return isFinite(glm::vec3(m[3])) && isFinite(glm::vec3(m[0]));
+    }
+
+    std::string getBitmapFilename() { return getExecutableDirectory() + "/CpuBenchmarks.png"; }
+    std::string getSceneFilename() { return getExecutableDirectory() + "/CpuBenchmarks.fscene"; }
+
+    void saveBenchmarkBitmap()
+    {
+        std::vector<uint8_t> pixels(kBitmapSize * kBitmapSize * 4);
+        Lcg rng;
+        for (uint32_t y = 0; y < kBitmapSize; y++)
+        {
+            for (uint32_t x = 0; x < kBitmapSize; x++)
+            {
+                // A gradient with some noise, so the PNG compressor has realistic work to do
+                uint8_t* pPixel = &pixels[(y * kBitmapSize + x) * 4];
+                pPixel[0] = uint8_t(x * 255 / kBitmapSize);
+                pPixel[1] = uint8_t(y * 255 / kBitmapSize);
+                pPixel[2] = uint8_t(rng.next() * 32.0f);
+                pPixel[3] = 255;
+            }
+        }
+        Bitmap::saveImage(getBitmapFilename(), kBitmapSize, kBitmapSize, Bitmap::FileFormat::PngFile, Bitmap::ExportFlags::None, ResourceFormat::RGBA8Unorm, true, pixels.data());
+    }
+
+    // A scene without models, so that only the importer's own parsing is measured
+    void saveBenchmarkScene(uint32_t lightCount, uint32_t cameraCount, uint32_t pathCount)
+    {
+        Lcg rng;
+        Scene::SharedPtr pScene = Scene::create();
+        for (uint32_t i = 0; i < lightCount; i++)
+        {
+            PointLight::SharedPtr pLight = PointLight::create();
+            pLight->setName("PointLight" + std::to_string(i));
+            pLight->setWorldPosition(glm::vec3(rng.next(-50, 50), rng.next(0, 20), rng.next(-50, 50)));
+            pLight->setIntensity(glm::vec3(rng.next(), rng.next(), rng.next()));
+            pScene->addLight(pLight);
+        }
+        for (uint32_t i = 0; i < cameraCount; i++)
+        {
+            Camera::SharedPtr pCamera = Camera::create();
+            pCamera->setName("Camera" + std::to_string(i));
+            pCamera->setPosition(glm::vec3(rng.next(-50, 50), rng.next(0, 20), rng.next(-50, 50)));
+            pScene->addCamera(pCamera);
+        }
+        for (uint32_t i = 0; i < pathCount; i++)
+        {
+            ObjectPath::SharedPtr pPath = ObjectPath::create();
+            pPath->setName("Path" + std::to_string(i));
+            for (uint32_t k = 0; k < 32; k++)
+            {
+                pPath->addKeyFrame(float(k), glm::vec3(rng.next(-50, 50), rng.next(0, 20), rng.next(-50, 50)), glm::vec3(0), glm::vec3(0, 1, 0));
+            }
+            pPath->attachObject(pScene->getCamera(i % cameraCount));
+            pScene->addPath(pPath);
+        }
+        pScene->setActiveCamera(0);
+        SceneExporter::saveScene(getSceneFilename(), pScene);
+    }
+
+    struct TimingStats
+    {
+        double mean = 0, median = 0, p95 = 0, p99 = 0, stddev = 0, min = 0, max = 0;
+    };
+
+    TimingStats computeTimingStats(std::vector<float> samples)
+    {
+        TimingStats stats;
+        if (samples.empty()) return stats;
+        std::sort(samples.begin(), samples.end());
+        size_t n = samples.size();
+
+        // Nearest-rank percentiles
+        auto percentile = [&samples, n](double p) { size_t rank = size_t(std::ceil(p * n)); return double(samples[std::min(n - 1, rank > 0 ? rank - 1 : 0)]); };
+
+        double sum = 0;
+        for (float x : samples) sum += x;
+        stats.mean = sum / n;
+        double variance = 0;
+        for (float x : samples) variance += (x - stats.mean) * (x - stats.mean);
+        stats.stddev = std::sqrt(variance / n);
+        stats.median = (n % 2) ? samples[n / 2] : 0.5 * (samples[n / 2 - 1] + samples[n / 2]);
+        stats.p95 = percentile(0.95);
+        stats.p99 = percentile(0.99);
+        stats.min = samples.front();
+        stats.max = samples.back();
+        return stats;
+    }
+}
+
+CpuBenchmarks::CpuBenchmarks(const Options& options)
+{
+    sOptions = options;
+    if (sOptions.reportFilename.empty()) sOptions.reportFilename = getExecutableDirectory() + "/CpuBenchmarks.json";
+}
+
+void CpuBenchmarks::addTests()
+{
+    addTestToList<AnimationKeyLookup>();
+    addTestToList<AnimationRandomAccess>();
+    addTestToList<AnimationLargeRig>();
+    addTestToList<CubicSplineEvaluation>();
+    addTestToList<CameraFrustumCulling>();
+    addTestToList<ObjectPathAnimation>();
+    addTestToList<BitmapSave>();
+    addTestToList<BitmapLoad>();
+    addTestToList<SceneImporterParse>();
+    addTestToList<BinaryModelImport>();
+    addTestToList<TangentGeneration>();
+    addTestToList<ProfilerWorkerEvents>();
+    addTestToList<CpuSkinning>();
+}
+
+void CpuBenchmarks::onInit()
+{
+    // Nobody is there to close message boxes, and the importers' statistics would drown the results
+    Logger::showBoxOnError(false);
+    Logger::setVerbosity(Logger::Level::Error);
+    sResults.clear();
+}
+
+testing_func(CpuBenchmarks, AnimationKeyLookup)
+{
+    // Playback at 60 FPS, where each key lookup continues from the previous one
+    AnimationController::UniquePtr pController = createAnimatedSkeleton(kBoneCount);
+    const uint32_t frameCount = 600;
+    double time = 0;
+    measure(mName, frameCount, [&]()
+    {
+        for (uint32_t i = 0; i < frameCount; i++)
+        {
+            pController->animate(time);
+            time += 1.0 / 60.0;
+        }
+    });
+
+    if (!areBonesFinite(pController.get())) return test_fail("Invalid bone transforms");
+    return test_pass();
+}
+
+testing_func(CpuBenchmarks, AnimationRandomAccess)
+{
+    // Scrubbing through the animation, so the key lookups can't continue from the previous key
+    AnimationController::UniquePtr pController = createAnimatedSkeleton(kBoneCount);
+    const uint32_t frameCount = 600;
+    const double duration = kKeysPerChannel / kTicksPerSecond;
+    Lcg rng;
+    measure(mName, frameCount, [&]()
+    {
+        for (uint32_t i = 0; i < frameCount; i++)
+        {
+            pController->animate(rng.next() * duration);
+        }
+    });
+
+    if (!areBonesFinite(pController.get())) return test_fail("Invalid bone transforms");
+    return test_pass();
+}
+
+testing_func(CpuBenchmarks, AnimationLargeRig)
+{
+    // A character-sized rig played at 60 FPS, jumping back half a second every second like a user scrubbing the timeline
+    AnimationController::UniquePtr pController = createAnimatedSkeleton(kLargeRigBoneCount);
+    const uint32_t frameCount = 600;
+    double time = 0;
+    measure(mName, frameCount, [&]()
+    {
+        for (uint32_t i = 0; i < frameCount; i++)
+        {
+            pController->animate(time);
+            time += ((i % 60) == 59) ? -0.5 : 1.0 / 60.0;
+        }
+    });
+
+    if (!areBonesFinite(pController.get())) return test_fail("Invalid bone transforms");
+    return test_pass();
+}
+
+testing_func(CpuBenchmarks, CubicSplineEvaluation)
+{
+    const uint32_t pointCount = 64;
+    std::vector<glm::vec3> points(pointCount);
+    Lcg rng;
+    for (auto& p : points) p = glm::vec3(rng.next(-10, 10), rng.next(-10, 10), rng.next(-10, 10));
+    CubicSpline<glm::vec3> spline(points.data(), pointCount);
+
+    const uint32_t evalCount = 1000000;
+    glm::vec3 sum(0);
+    measure(mName, evalCount, [&]()
+    {
+        for (uint32_t i = 0; i < evalCount; i++)
+        {
+            sum += spline.interpolate(i % (pointCount - 1), float(i & 1023) / 1024.0f);
+        }
+    });
+
+    if (!isFinite(sum)) return test_fail("Invalid spline values");
+    return test_pass();
+}
+
+testing_func(CpuBenchmarks, CameraFrustumCulling)
+{
+    Camera::SharedPtr pCamera = Camera::create();
+    pCamera->setPosition(glm::vec3(0, 0, 0));
+    pCamera->setTarget(glm::vec3(0, 0, -1));
+    pCamera->setUpVector(glm::vec3(0, 1, 0));
+    pCamera->setAspectRatio(16.0f / 9.0f);
+    pCamera->setDepthRange(0.1f, 1000.0f);
+
+    const uint32_t boxCount = 100000;
+    std::vector<BoundingBox> boxes(boxCount);
+    Lcg rng;
+    for (auto& box : boxes)
+    {
+        box.center = glm::vec3(rng.next(-500, 500), rng.next(-500, 500), rng.next(-500, 500));
+        box.extent = glm::vec3(rng.next(0.5f, 5.0f));
+    }
+
+    uint32_t culledCount = 0;
+    measure(mName, boxCount, [&]()
+    {
+        culledCount = 0;
+        for (const auto& box : boxes)
+        {
+            if (pCamera->isObjectCulled(box)) culledCount++;
+        }
+    });
+
+    if (culledCount == 0 || culledCount == boxCount) return test_fail("Either all or none of the boxes were culled");
+    return test_pass();
+}
+
+testing_func(CpuBenchmarks, ObjectPathAnimation)
+{
+    ObjectPath::SharedPtr pPath = ObjectPath::create();
+    pPath->setInterpolationMode(ObjectPath::Interpolation::CubicSpline);
+    pPath->setAnimationRepeat(true);
+    Lcg rng;
+    for (uint32_t k = 0; k < 64; k++)
+    {
+        pPath->addKeyFrame(float(k), glm::vec3(rng.next(-50, 50), rng.next(0, 20), rng.next(-50, 50)), glm::vec3(rng.next(-1, 1), 0, rng.next(-1, 1)), glm::vec3(0, 1, 0));
+    }
+    Camera::SharedPtr pCamera = Camera::create();
+    pPath->attachObject(pCamera);
+
+    const uint32_t frameCount = 10000;
+    double time = 0;
+    measure(mName, frameCount, [&]()
+    {
+        for (uint32_t i = 0; i < frameCount; i++)
+        {
+            pPath->animate(time);
+            time += 1.0 / 60.0;
+        }
+    });
+
+    if (!isFinite(pCamera->getPosition())) return test_fail("Invalid camera position");
+    return test_pass();
+}
+
+testing_func(CpuBenchmarks, BitmapSave)
+{
+    measure(mName, 1, []() { saveBenchmarkBitmap(); });
+    if (!doesFileExist(getBitmapFilename())) return test_fail("Can't write " + getBitmapFilename());
+    return test_pass();
+}
+
+testing_func(CpuBenchmarks, BitmapLoad)
+{
+    if (!doesFileExist(getBitmapFilename())) saveBenchmarkBitmap();
+
+    uint32_t width = 0;
+    measure(mName, 1, [&]()
+    {
+        Bitmap::UniqueConstPtr pBitmap = Bitmap::createFromFile(getBitmapFilename(), true);
+        width = pBitmap ? pBitmap->getWidth() : 0;
+    });
+
+    if (width != kBitmapSize) return test_fail("Can't load " + getBitmapFilename());
+    return test_pass();
+}
+
+testing_func(CpuBenchmarks, SceneImporterParse)
+{
+    const uint32_t lightCount = 256;
+    saveBenchmarkScene(lightCount, 32, 16);
+
+    const uint32_t loadCount = 10;
+    uint32_t loadedLights = 0;
+    measure(mName, loadCount, [&]()
+    {
+        for (uint32_t i = 0; i < loadCount; i++)
+        {
+            Scene::SharedPtr pScene = Scene::create();
+            SceneImporter::loadScene(*pScene, getSceneFilename(), Model::LoadFlags::None, Scene::LoadFlags::None);
+            loadedLights = pScene->getLightCount();
+        }
+    });
+
+    if (loadedLights != lightCount) return test_fail("Loaded " + std::to_string(loadedLights) + " lights instead of " + std::to_string(lightCount));
+    return test_pass();
+}
+
+testing_func(CpuBenchmarks, BinaryModelImport)
+{
+    // The importer creates the model's vertex buffers, so it needs a device
+    if (sOptions.binaryModel.empty()) return TestBase::TestData(TestBase::TestResult::Pass, mName, "Skipped. Run with -binaryModel <file> to measure the binary importer");
+
+    bool imported = true;
+    measure(mName, 1, [&]()
+    {
+        Model::SharedPtr pModel = Model::create();
+        imported = imported && BinaryModelImporter::import(*pModel, sOptions.binaryModel, Model::LoadFlags::None);
+    });
+
+    if (!imported) return test_fail("Can't import " + sOptions.binaryModel);
+    return test_pass();
+}
+
+testing_func(CpuBenchmarks, TangentGeneration)
+{
+    // Each sample generates the bitangents of a 256K triangle mesh three times: scalar reference, SIMD and SIMD multi-threaded
+    bool matched = true;
+    measure(mName, 1, [&]() { matched = TangentGenerator::runSelfTest(1 << 18) && matched; });
+
+    if (!matched) return test_fail("Bitangents don't match the scalar reference");
+    return test_pass();
+}
+
+testing_func(CpuBenchmarks, ProfilerWorkerEvents)
+{
+    // Worker threads profiling events while this thread merges their records, as endFrame() does.
+    // A few threads measure the cost of an event, 32 threads (runOverheadBenchmark()'s default) show how the merge copes with contention.
+    const uint32_t threadCounts[] = { 4, 32 };
+    const uint32_t eventsPerThread = 50000;
+    for (uint32_t threadCount : threadCounts)
+    {
+        double nsPerEvent = 0;
+        measure(mName + "_" + std::to_string(threadCount) + "Threads", threadCount * eventsPerThread, [&]() { nsPerEvent = Profiler::runOverheadBenchmark(threadCount, eventsPerThread); });
+        if (!(nsPerEvent > 0)) return test_fail("No events were timed with " + std::to_string(threadCount) + " threads");
+    }
+    return test_pass();
+}
+
+testing_func(CpuBenchmarks, CpuSkinning)
+{
+    // Loading the model and checking the results against the compute shader need a device
+    if (sOptions.skinnedModel.empty()) return TestBase::TestData(TestBase::TestResult::Pass, mName, "Skipped. Run with -skinnedModel <file> to measure CPU skinning");
+
+    Model::SharedPtr pModel = Model::createFromFile(sOptions.skinnedModel.c_str());
+    if (!pModel || !pModel->hasBones()) return test_fail("Can't load a model with bones from " + sOptions.skinnedModel);
+
+    // Pose the model, so that the comparison doesn't only cover the bind pose
+    pModel->animate(0.5);
+    if (!SkinningCache::validateCpuSkinning(pModel.get())) return test_fail("CPU skinning doesn't match the compute shader");
+
+    // The first update sets up the meshes, so it's not timed. The skinned vertices are never uploaded, since nothing calls getVao().
+    SkinningCache::SharedPtr pCache = SkinningCache::create(SkinningCache::Mode::Cpu);
+    pCache->update(pModel.get());
+    double time = 0;
+    measure(mName, 1, [&]()
+    {
+        pModel->animate(time);
+        time += 1.0 / 60.0;
+        pCache->update(pModel.get());
+    });
+    return test_pass();
+}
+
+bool CpuBenchmarks::writeReport() const
+{
+    std::ofstream json(sOptions.reportFilename);
+    if (json.fail())
+    {
+        std::cerr << "Can't write the benchmark report to " << sOptions.reportFilename << std::endl;
+        return false;
+    }
+
+#ifdef _DEBUG
+    json << "{\n  \"build\": \"Debug\",\n";
+#else
+    json << "{\n  \"build\": \"Release\",\n";
+#endif
+    json << "  \"samples\": " << sOptions.samples << ",\n";
+    json << "  \"warmupSamples\": " << sOptions.warmupSamples << ",\n";
+    json << "  \"passes\": [\n";
+    for (size_t i = 0; i < sResults.size(); i++)
+    {
+        const Result& result = sResults[i];
+        TimingStats stats = computeTimingStats(result.samples);
+        char buf[512];
+        snprintf(buf, sizeof(buf), "{ \"mean\": %.4f, \"median\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"stddev\": %.4f, \"min\": %.4f, \"max\": %.4f }",
+            stats.mean, stats.median, stats.p95, stats.p99, stats.stddev, stats.min, stats.max);
+        json << "    { \"name\": \"" << result.name << "\", \"iterations\": " << result.iterations;
+        json << ", \"usPerIteration\": " << stats.median * 1000.0 / result.iterations << ",\n";
+        json << "      \"cpu\": " << buf << " }" << ((i + 1 < sResults.size()) ? ",\n" : "\n");
+
+        std::cout << result.name << ": " << stats.median << " ms median, " << stats.min << " ms min, " << stats.stddev << " ms stddev (" << result.iterations << " iterations)" << std::endl;
+    }
+    json << "  ]\n}\n";
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    CpuBenchmarks::Options options;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "-samples" && hasValue) options.samples = uint32_t(std::max(1, atoi(argv[++i])));
+        else if (arg == "-warmup" && hasValue) options.warmupSamples = uint32_t(std::max(0, atoi(argv[++i])));
+        else if (arg == "-report" && hasValue) options.reportFilename = argv[++i];
+        else if (arg == "-binaryModel" && hasValue) options.binaryModel = argv[++i];
+        else if (arg == "-skinnedModel" && hasValue) options.skinnedModel = argv[++i];
+        else
+        {
+            std::cerr << "Usage: CpuBenchmarks [-samples N] [-warmup N] [-report file.json] [-binaryModel file.bin] [-skinnedModel file]" << std::endl;
+            return 2;
+        }
+    }
+
+    CpuBenchmarks benchmarks(options);
+    benchmarks.init(!options.binaryModel.empty() || !options.skinnedModel.empty());
+    benchmarks.run();
+    return benchmarks.writeReport() ? 0 : 1;
+}
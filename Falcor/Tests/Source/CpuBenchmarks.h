@@ -0,0 +1,100 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include "TestBase.h"
+
+/** Timings of the framework's CPU hot paths: animation, splines, culling, image and scene I/O, tangent generation, worker thread profiling and CPU skinning.
+    Runs without a device, except for the binary model importer and CPU skinning, which create vertex buffers and only run when a model is given (-binaryModel, -skinnedModel).
+    Every benchmark times a fixed amount of work several times, and the distribution of the timings is written to a JSON report which CompareBenchmarks.py can compare against another run.
+*/
+class CpuBenchmarks : public TestBase
+{
+public:
+    struct Options
+    {
+        uint32_t samples = 30;          ///< Timed repetitions of each benchmark
+        uint32_t warmupSamples = 3;     ///< Untimed repetitions run first, to warm up the caches and the allocator
+        std::string reportFilename;     ///< Defaults to CpuBenchmarks.json, next to the executable
+        std::string binaryModel;        ///< Model file for the binary importer benchmark
+        std::string skinnedModel;       ///< Model file with bones for the CPU skinning benchmark
+    };
+
+    CpuBenchmarks(const Options& options);
+
+    /** Write the timings of the benchmarks run so far
+    */
+    bool writeReport() const;
+
+private:
+    void addTests() override;
+    void onInit() override;
+    register_testing_func(AnimationKeyLookup);
+    register_testing_func(AnimationRandomAccess);
+    register_testing_func(AnimationLargeRig);
+    register_testing_func(CubicSplineEvaluation);
+    register_testing_func(CameraFrustumCulling);
+    register_testing_func(ObjectPathAnimation);
+    register_testing_func(BitmapSave);
+    register_testing_func(BitmapLoad);
+    register_testing_func(SceneImporterParse);
+    register_testing_func(BinaryModelImport);
+    register_testing_func(TangentGeneration);
+    register_testing_func(ProfilerWorkerEvents);
+    register_testing_func(CpuSkinning);
+
+    struct Result
+    {
+        std::string name;
+        uint32_t iterations;            ///< Calls to the benchmarked code per sample
+        std::vector<float> samples;     ///< Time of each sample, in ms
+    };
+
+    /** Time a benchmark. Runs the warmup samples, then the timed ones.
+        \param[in] name The benchmark's name in the report
+        \param[in] iterations Number of calls to the benchmarked code that one call of func() makes. Only used to report the time per call
+        \param[in] func Runs one sample. It's called once per sample
+    */
+    template<typename Func>
+    static void measure(const std::string& name, uint32_t iterations, Func func)
+    {
+        Result result;
+        result.name = name;
+        result.iterations = iterations;
+        for (uint32_t i = 0; i < sOptions.warmupSamples; i++) func();
+        for (uint32_t i = 0; i < sOptions.samples; i++)
+        {
+            CpuTimer::TimePoint start = CpuTimer::getCurrentTimePoint();
+            func();
+            result.samples.push_back(CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint()));
+        }
+        sResults.push_back(result);
+    }
+
+    static Options sOptions;
+    static std::vector<Result> sResults;
+};
@@ -0,0 +1,244 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Falcor.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <experimental/filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+
+using namespace Falcor;
+namespace fs = std::experimental::filesystem;
+
+// Compares images, or directories of images, with error metrics and thresholds. Meant for checking renders against references in automated tests.
+// Exits with 0 if every image is within the thresholds, 1 if one isn't, and 2 on errors.
+
+namespace
+{
+    struct Settings
+    {
+        std::string reference;
+        std::string test;
+        std::map<ImageCompare::Metric, double> thresholds;
+        std::string errorMap;           ///< File, or directory when comparing directories
+        std::string reportFilename;
+        ImageCompare::Options options;
+    };
+
+    struct ImageResult
+    {
+        std::string reference;
+        std::string test;
+        bool loaded = false;
+        bool passed = false;
+        ImageCompare::Result result;
+    };
+
+    bool isImageFile(const fs::path& path)
+    {
+        std::string extension = path.extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return char(std::tolower(c)); });
+        for (const char* supported : { ".png", ".exr", ".pfm", ".hdr", ".jpg", ".bmp", ".tga" })
+        {
+            if (extension == supported) return true;
+        }
+        return false;
+    }
+
+    ImageResult compareFiles(const std::string& reference, const std::string& test, const std::string& errorMap, const Settings& settings)
+    {
+        ImageResult image;
+        image.reference = reference;
+        image.test = test;
+
+        ImageCompare::Image referenceImage, testImage;
+        if (!ImageCompare::loadImage(reference, referenceImage) || !ImageCompare::loadImage(test, testImage)) return image;
+        if (!ImageCompare::compare(referenceImage, testImage, image.result, settings.options)) return image;
+        image.loaded = true;
+
+        image.passed = true;
+        for (const auto& threshold : settings.thresholds)
+        {
+            image.passed &= ImageCompare::isWithinThreshold(threshold.first, image.result.get(threshold.first), threshold.second);
+        }
+        if (!errorMap.empty()) ImageCompare::saveErrorMap(errorMap, image.result, referenceImage.width, referenceImage.height);
+        return image;
+    }
+
+    void printResult(const ImageResult& image)
+    {
+        std::cout << image.test << ":";
+        if (!image.loaded)
+        {
+            std::cout << " error" << std::endl;
+            return;
+        }
+        for (uint32_t i = 0; i < (uint32_t)ImageCompare::Metric::Count; i++)
+        {
+            std::cout << " " << ImageCompare::getMetricName((ImageCompare::Metric)i) << "=" << image.result.values[i];
+        }
+        std::cout << (image.passed ? " PASS" : " FAIL") << std::endl;
+    }
+
+    bool writeReport(const std::string& filename, const std::vector<ImageResult>& images, const Settings& settings)
+    {
+        std::ofstream json(filename);
+        if (json.fail())
+        {
+            std::cerr << "Can't write the report to " << filename << std::endl;
+            return false;
+        }
+
+        json << "{\n  \"thresholds\": {";
+        const char* separator = " ";
+        for (const auto& threshold : settings.thresholds)
+        {
+            json << separator << "\"" << ImageCompare::getMetricName(threshold.first) << "\": " << threshold.second;
+            separator = ", ";
+        }
+        json << " },\n  \"images\": [\n";
+        for (size_t i = 0; i < images.size(); i++)
+        {
+            const ImageResult& image = images[i];
+            json << "    { \"reference\": \"" << escapeJsonString(image.reference) << "\", \"test\": \"" << escapeJsonString(image.test) << "\", \"loaded\": " << (image.loaded ? "true" : "false");
+            json << ", \"passed\": " << (image.passed ? "true" : "false") << ", \"metrics\": {";
+            separator = " ";
+            for (uint32_t m = 0; image.loaded && m < (uint32_t)ImageCompare::Metric::Count; m++)
+            {
+                json << separator << "\"" << ImageCompare::getMetricName((ImageCompare::Metric)m) << "\": " << image.result.values[m];
+                separator = ", ";
+            }
+            json << " } }" << ((i + 1 < images.size()) ? ",\n" : "\n");
+        }
+        json << "  ]\n}\n";
+        return true;
+    }
+
+    void printUsage()
+    {
+        std::cerr << "Usage: ImageCompare <reference> <test> [-threshold <metric> <value>]... [-errorMap <file.png>] [-report <file.json>] [-ppd <pixels per degree>] [-threads <count>] [-noSsim] [-noFlip]" << std::endl;
+        std::cerr << "    <reference> and <test> are both images, or both directories. Images in the reference directory are compared with the test images of the same name." << std::endl;
+        std::cerr << "    Metrics: mse, relmse, flip (lower is better), psnr, ssim (higher is better)." << std::endl;
+    }
+
+    bool parseArgs(int argc, char** argv, Settings& settings)
+    {
+        std::vector<std::string> positional;
+        for (int i = 1; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            if (arg == "-threshold" && i + 2 < argc)
+            {
+                ImageCompare::Metric metric;
+                if (!ImageCompare::findMetric(argv[i + 1], metric))
+                {
+                    std::cerr << "Unknown metric " << argv[i + 1] << std::endl;
+                    return false;
+                }
+                settings.thresholds[metric] = atof(argv[i + 2]);
+                i += 2;
+            }
+            else if (arg == "-errorMap" && i + 1 < argc) settings.errorMap = argv[++i];
+            else if (arg == "-report" && i + 1 < argc) settings.reportFilename = argv[++i];
+            else if (arg == "-ppd" && i + 1 < argc) settings.options.pixelsPerDegree = float(atof(argv[++i]));
+            else if (arg == "-threads" && i + 1 < argc) settings.options.threadCount = uint32_t(std::max(0, atoi(argv[++i])));
+            else if (arg == "-noSsim") settings.options.computeSsim = false;
+            else if (arg == "-noFlip") settings.options.computeFlip = false;
+            else if (!arg.empty() && arg[0] != '-') positional.push_back(arg);
+            else return false;
+        }
+        if (positional.size() != 2) return false;
+        settings.reference = positional[0];
+        settings.test = positional[1];
+
+        // Thresholds on metrics that aren't computed would always pass or always fail
+        if ((!settings.options.computeSsim && settings.thresholds.count(ImageCompare::Metric::SSIM)) || (!settings.options.computeFlip && settings.thresholds.count(ImageCompare::Metric::Flip)))
+        {
+            std::cerr << "Thresholds are set on metrics that are disabled" << std::endl;
+            return false;
+        }
+        return true;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Settings settings;
+    if (!parseArgs(argc, argv, settings))
+    {
+        printUsage();
+        return 2;
+    }
+    Logger::showBoxOnError(false);
+
+    std::vector<ImageResult> images;
+    if (isDirectoryExists(settings.reference))
+    {
+        if (!isDirectoryExists(settings.test))
+        {
+            std::cerr << settings.test << " isn't a directory" << std::endl;
+            return 2;
+        }
+        if (!settings.errorMap.empty()) fs::create_directories(settings.errorMap);
+
+        std::vector<fs::path> referenceFiles;
+        for (const auto& entry : fs::directory_iterator(settings.reference))
+        {
+            if (fs::is_regular_file(entry.path()) && isImageFile(entry.path())) referenceFiles.push_back(entry.path());
+        }
+        std::sort(referenceFiles.begin(), referenceFiles.end());
+
+        for (const fs::path& referenceFile : referenceFiles)
+        {
+            fs::path testFile = fs::path(settings.test) / referenceFile.filename();
+            std::string errorMap = settings.errorMap.empty() ? "" : (fs::path(settings.errorMap) / (referenceFile.stem().string() + "_Error.png")).string();
+            images.push_back(compareFiles(referenceFile.string(), testFile.string(), errorMap, settings));
+            printResult(images.back());
+        }
+        if (images.empty()) std::cerr << "No images in " << settings.reference << std::endl;
+    }
+    else
+    {
+        images.push_back(compareFiles(settings.reference, settings.test, settings.errorMap, settings));
+        printResult(images.back());
+    }
+
+    if (!settings.reportFilename.empty() && !writeReport(settings.reportFilename, images, settings)) return 2;
+
+    bool allLoaded = !images.empty();
+    bool allPassed = true;
+    for (const ImageResult& image : images)
+    {
+        allLoaded &= image.loaded;
+        allPassed &= image.passed;
+    }
+    if (!allLoaded) return 2;
+    return allPassed ? 0 : 1;
+}
@@ -31,8 +31,10 @@
 TestBase::TestBase()
 {
     mTestName = getExecutableName();
+#ifdef _WIN32
     //slice off '.exe'
     mTestName = mTestName.substr(0, mTestName.size() - 4);
+#endif
 }
 
 TestBase::~TestBase()
@@ -43,10 +45,12 @@ TestBase::~TestBase()
 
 void TestBase::init(bool initDevice /* = false */)
 {
+#ifdef _WIN32
     //Turns off error message boxes
     SetErrorMode(GetErrorMode() | SEM_NOGPFAULTERRORBOX);
     _CrtSetReportMode(_CRT_ASSERT, 0);
     _set_error_mode(_OUT_TO_STDERR);
+#endif
 
     addTests();
 
@@ -63,6 +63,9 @@ float probabilityToSampleDiffuse(float3 difColor, float3 specColor)
 	return lumDiffuse / (lumDiffuse + lumSpecular);
 }
 
+// Optional counters of the rays we trace: countRay(), countIndirectRay()
+#include "CommonPasses/rayCounters.hlsli"
+
 // Include shader entries, data structures, and utility functions to spawn rays
 #include "standardShadowRay.hlsli"
 #include "indirectRay.hlsli"
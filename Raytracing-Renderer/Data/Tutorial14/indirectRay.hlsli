@@ -40,6 +40,7 @@ float3 shootIndirectRay(float3 rayOrigin, float3 rayDir, float minT, uint curPat
 	payload.rayDepth = curDepth + 1;
 
 	// Trace our ray to get a color in the indirect direction.  Use hit group #1 and miss shader #1
+	countIndirectRay(curDepth);
 	TraceRay(gRtScene, 0, 0xFF, 1, hitProgramCount, 1, rayColor, payload);
 
 	// Return the color we got from our ray
@@ -0,0 +1,81 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+// Temporal accumulation that keeps its history in a pair of ping-ponged render targets.  Each frame reads the
+//     history written last frame, writes the new history into the other render target, and writes the
+//     accumulated color straight back into the buffer being accumulated (through a UAV, since each pixel only
+//     touches itself).  This avoids copying the result into the output and into the history afterwards.
+
+cbuffer PerFrameCB
+{
+    uint gAccumCount;
+}
+
+Texture2D<float4>   gLastFrame;       // Last frame's history:  running average, or running sum in high-precision mode
+RWTexture2D<float4> gCurFrame;        // Input this frame; overwritten with the accumulated result
+
+#ifdef HIGH_PRECISION_ACCUMULATION
+// Kahan-compensated summation.  Averaging directly loses the new sample's low-order bits once the running
+//     average dominates; keeping the rounding error of the sum around recovers them over long accumulations.
+Texture2D<float4>   gLastCompensation;
+
+struct PsOut
+{
+    float4 sum          : SV_Target0;
+    float4 compensation : SV_Target1;
+};
+
+PsOut main(float2 texC : TEXCOORD, float4 pos : SV_Position)
+{
+    uint2 pixelPos = (uint2)pos.xy;
+    float4 curColor = gCurFrame[pixelPos];
+
+    // On the first frame the history holds stale data (possibly NaNs), so ignore it entirely
+    float4 sum          = (gAccumCount == 0) ? float4(0, 0, 0, 0) : gLastFrame[pixelPos];
+    float4 compensation = (gAccumCount == 0) ? float4(0, 0, 0, 0) : gLastCompensation[pixelPos];
+
+    // 'precise' stops the compiler from simplifying (t - sum) - y to zero
+    precise float4 y = curColor - compensation;
+    precise float4 t = sum + y;
+    precise float4 c = (t - sum) - y;
+
+    gCurFrame[pixelPos] = t / float(gAccumCount + 1);
+
+    PsOut result;
+    result.sum = t;
+    result.compensation = c;
+    return result;
+}
+#else
+float4 main(float2 texC : TEXCOORD, float4 pos : SV_Position) : SV_Target0
+{
+    uint2 pixelPos = (uint2)pos.xy;
+    float4 curColor = gCurFrame[pixelPos];
+
+    // On the first frame the history holds stale data (possibly NaNs), so ignore it entirely
+    float4 accumColor = curColor;
+    if (gAccumCount > 0)
+    {
+        float4 prevColor = gLastFrame[pixelPos];
+        accumColor = (gAccumCount * prevColor + curColor) / (gAccumCount + 1);
+    }
+
+    gCurFrame[pixelPos] = accumColor;
+    return accumColor;
+}
+#endif
@@ -37,6 +37,7 @@ float shadowRayVisibility(float3 origin, float3 direction, float minT, float max
 	ShadowRayPayload payload = { 0.0f };
 
 	// Query if anything is between the current point and the light
+	countRay(RAY_COUNT_SHADOW);
 	TraceRay(gRtScene,
 		RAY_FLAG_ACCEPT_FIRST_HIT_AND_END_SEARCH | RAY_FLAG_SKIP_CLOSEST_HIT_SHADER,
 		0xFF, 0, hitProgramCount, 0, ray, payload);
@@ -35,9 +35,9 @@ bool AmbientOcclusionPass::initialize(RenderContext* pRenderContext, ResourceMan
 	mpResManager = pResManager;
 
 	// Note that we need the G-buffer's position and normal buffer, plus the standard output buffer
-	mPositionIndex = mpResManager->requestTextureResource("WorldPosition");
-	mNormalIndex   = mpResManager->requestTextureResource("WorldNormal");
-	mOutputIndex   = mpResManager->requestTextureResource(mOutputTexName);
+	mPositionIndex = mpResManager->requestTextureResource("WorldPosition", ResourceManager::ChannelAccess::Read);
+	mNormalIndex   = mpResManager->requestTextureResource("WorldNormal", ResourceManager::ChannelAccess::Read);
+	mOutputIndex   = mpResManager->requestTextureResource(mOutputTexName, ResourceManager::ChannelAccess::Write);
 
 	// Create our wrapper around a ray tracing pass.  Tell it where our ray generation shader and ray-specific shaders are
 	mpRays = RayLaunch::create(kFileRayTrace, kEntryPointRayGen);
@@ -23,7 +23,7 @@ bool CopyToOutputPass::initialize(RenderContext* pRenderContext, ResourceManager
 	// Stash a copy of our resource manager, allowing us to access shared rendering resources
 	//    We need an output buffer; tell our resource manager we expect the standard output channel
 	mpResManager = pResManager;
-	mpResManager->requestTextureResource(ResourceManager::kOutputChannel);
+	mpResManager->requestTextureResource(ResourceManager::kOutputChannel, ResourceManager::ChannelAccess::Write);
 
 	// Create a dropdown list to display in the GUI.  Start with no displayable output buffers. 
 	mDisplayableBuffers.push_back({ -1, "< None >" });
@@ -33,7 +33,9 @@ bool CopyToOutputPass::initialize(RenderContext* pRenderContext, ResourceManager
 void CopyToOutputPass::renderGui(Gui* pGui)
 {
 	// Add a widget to allow us to select our buffer to display
-	pGui->addDropdown("Displayed", mDisplayableBuffers, mSelectedBuffer);
+	// Changing the displayed buffer changes which passes the output depends on, so have the pipeline re-declare our input
+	if (pGui->addDropdown("Displayed", mDisplayableBuffers, mSelectedBuffer))
+		setRebindFlag();
 }
 
 void CopyToOutputPass::execute(RenderContext* pRenderContext)
@@ -92,4 +94,12 @@ void CopyToOutputPass::pipelineUpdated(ResourceManager::SharedPtr pResManager)
 		mDisplayableBuffers.push_back({ -1, "< None >" });
 		mSelectedBuffer = uint32_t(-1);
 	}
+
+	// Tell the pipeline which channel we read now, so the passes writing it are kept and ordered before us
+	if (int32_t(mSelectedBuffer) != mDeclaredInput)
+	{
+		mpResManager->withdrawChannelAccess(mDeclaredInput);
+		mDeclaredInput = int32_t(mSelectedBuffer);
+		mpResManager->declareChannelAccess(mDeclaredInput, ResourceManager::ChannelAccess::Read);
+	}
 }
\ No newline at end of file
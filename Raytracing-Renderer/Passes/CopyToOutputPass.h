@@ -50,4 +50,5 @@ protected:
 
 	Gui::DropdownList mDisplayableBuffers;  
 	uint32_t          mSelectedBuffer = 0xFFFFFFFFu;
+	int32_t           mDeclaredInput = -1;      ///< The channel we last told the resource manager we read
  };
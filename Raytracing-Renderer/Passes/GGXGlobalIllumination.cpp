@@ -39,9 +39,19 @@ bool GGXGlobalIlluminationPass::initialize(RenderContext* pRenderContext, Resour
 {
 	// Stash a copy of our resource manager so we can get rendering resources
 	mpResManager = pResManager;
-	mpResManager->requestTextureResources({ "WorldPosition", "WorldNormal", "MaterialDiffuse", "MaterialSpecRough", "MaterialExtraParams", "Emissive" });
-	mpResManager->requestTextureResource(mOutputTextureName);
-	mpResManager->requestTextureResource(ResourceManager::kEnvironmentMap);
+	mpResManager->requestTextureResources({ "WorldPosition", "WorldNormal", "MaterialDiffuse", "MaterialSpecRough", "MaterialExtraParams", "Emissive" }, ResourceManager::ChannelAccess::Read);
+	mpResManager->requestTextureResource(mOutputTextureName, ResourceManager::ChannelAccess::Write);
+	mpResManager->requestTextureResource(ResourceManager::kEnvironmentMap, ResourceManager::ChannelAccess::Read);
+
+	// Look up our channels once, rather than by name every frame
+	mOutputTex   = mpResManager->getTextureHandle(mOutputTextureName);
+	mPosTex      = mpResManager->getTextureHandle("WorldPosition");
+	mNormTex     = mpResManager->getTextureHandle("WorldNormal");
+	mDiffuseTex  = mpResManager->getTextureHandle("MaterialDiffuse");
+	mSpecTex     = mpResManager->getTextureHandle("MaterialSpecRough");
+	mExtraTex    = mpResManager->getTextureHandle("MaterialExtraParams");
+	mEmissiveTex = mpResManager->getTextureHandle("Emissive");
+	mEnvMapTex   = mpResManager->getTextureHandle(ResourceManager::kEnvironmentMap);
 
 	// Set the default scene to load
 	mpResManager->setDefaultSceneName("Data/pink_room/pink_room.fscene");
@@ -80,33 +90,39 @@ void GGXGlobalIlluminationPass::renderGui(Gui* pGui)
 	dirty |= (int)pGui->addCheckBox(mDoIndirectGI ? "Shooting global illumination rays" : "Skipping global illumination", 
 		                            mDoIndirectGI);
 	if (dirty) setRefreshFlag();
+
+	// Log how much the handles save over name lookups when setting our per-frame constants
+	if (mpRays && mpRays->readyToRender() && pGui->addButton("Time GlobalCB assignments"))
+	{
+		mpRays->getGlobalVars()->runBindingBenchmark("GlobalCB", "gFrameCount");
+	}
 }
 
 
 void GGXGlobalIlluminationPass::execute(RenderContext* pRenderContext)
 {
 	// Get the output buffer we're writing into
-	Texture::SharedPtr pDstTex = mpResManager->getClearedTexture(mOutputTextureName, vec4(0.0f, 0.0f, 0.0f, 0.0f));
+	Texture::SharedPtr pDstTex = mpResManager->getClearedTexture(mOutputTex, vec4(0.0f, 0.0f, 0.0f, 0.0f));
 
 	// Do we have all the resources we need to render?  If not, return
 	if (!pDstTex || !mpRays || !mpRays->readyToRender()) return;
 
 	// Set our variables into the global HLSL namespace
 	auto globalVars = mpRays->getGlobalVars();
-	globalVars["GlobalCB"]["gMinT"]         = mpResManager->getMinTDist();
-	globalVars["GlobalCB"]["gFrameCount"]   = mFrameCount++;
-	globalVars["GlobalCB"]["gDoIndirectGI"] = mDoIndirectGI;
-	globalVars["GlobalCB"]["gDoDirectGI"]   = mDoDirectGI;
-	globalVars["GlobalCB"]["gMaxDepth"]     = mUserSpecifiedRayDepth;
-    globalVars["GlobalCB"]["gEmitMult"]     = 1.0f;
-	globalVars["gPos"]         = mpResManager->getTexture("WorldPosition");
-	globalVars["gNorm"]        = mpResManager->getTexture("WorldNormal");
-	globalVars["gDiffuseMatl"] = mpResManager->getTexture("MaterialDiffuse");
-	globalVars["gSpecMatl"]    = mpResManager->getTexture("MaterialSpecRough");
-	globalVars["gExtraMatl"]   = mpResManager->getTexture("MaterialExtraParams");
-    globalVars["gEmissive"]    = mpResManager->getTexture("Emissive");
+	globalVars[mMinTVar]         = mpResManager->getMinTDist();
+	globalVars[mFrameCountVar]   = mFrameCount++;
+	globalVars[mDoIndirectGIVar] = mDoIndirectGI;
+	globalVars[mDoDirectGIVar]   = mDoDirectGI;
+	globalVars[mMaxDepthVar]     = mUserSpecifiedRayDepth;
+	globalVars[mEmitMultVar]     = 1.0f;
+	globalVars["gPos"]         = mpResManager->getTexture(mPosTex);
+	globalVars["gNorm"]        = mpResManager->getTexture(mNormTex);
+	globalVars["gDiffuseMatl"] = mpResManager->getTexture(mDiffuseTex);
+	globalVars["gSpecMatl"]    = mpResManager->getTexture(mSpecTex);
+	globalVars["gExtraMatl"]   = mpResManager->getTexture(mExtraTex);
+    globalVars["gEmissive"]    = mpResManager->getTexture(mEmissiveTex);
 	globalVars["gOutput"]      = pDstTex;
-	globalVars["gEnvMap"] = mpResManager->getTexture(ResourceManager::kEnvironmentMap);
+	globalVars["gEnvMap"] = mpResManager->getTexture(mEnvMapTex);
 
 	// Shoot our rays and shade our primary hit points
 	mpRays->execute( pRenderContext, mpResManager->getScreenSize() );
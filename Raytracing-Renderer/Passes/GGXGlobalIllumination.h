@@ -61,6 +61,17 @@ protected:
 
 	// What texture should was ask the resource manager to store our result in?
 	std::string             mOutputTextureName;
+
+	// Handles to the channels we read and write every frame, resolved once in initialize()
+	ResourceManager::TextureHandle mOutputTex, mPosTex, mNormTex, mDiffuseTex, mSpecTex, mExtraTex, mEmissiveTex, mEnvMapTex;
+
+	// Handles to the GlobalCB variables we set every frame
+	SimpleVars::VarHandle   mMinTVar         = { "GlobalCB", "gMinT" };
+	SimpleVars::VarHandle   mFrameCountVar   = { "GlobalCB", "gFrameCount" };
+	SimpleVars::VarHandle   mDoIndirectGIVar = { "GlobalCB", "gDoIndirectGI" };
+	SimpleVars::VarHandle   mDoDirectGIVar   = { "GlobalCB", "gDoDirectGI" };
+	SimpleVars::VarHandle   mMaxDepthVar     = { "GlobalCB", "gMaxDepth" };
+	SimpleVars::VarHandle   mEmitMultVar     = { "GlobalCB", "gEmitMult" };
     
 	// Various internal parameters
 	uint32_t                mFrameCount = 0x1337u;        ///< A frame counter to vary random numbers over time
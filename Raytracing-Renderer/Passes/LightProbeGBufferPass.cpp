@@ -43,12 +43,15 @@ bool LightProbeGBufferPass::initialize(RenderContext* pRenderContext, ResourceMa
 	mpResManager = pResManager;
 
 	// We write to these textures; tell our resource manager that we expect them
-	mpResManager->requestTextureResource("WorldPosition");
-	mpResManager->requestTextureResource("WorldNormal", ResourceFormat::RGBA16Float);
-	mpResManager->requestTextureResource("MaterialDiffuse", ResourceFormat::RGBA16Float);
-	mpResManager->requestTextureResource("MaterialSpecRough", ResourceFormat::RGBA16Float);
-	mpResManager->requestTextureResource("MaterialExtraParams", ResourceFormat::RGBA16Float);
-	mpResManager->requestTextureResource("Emissive", ResourceFormat::RGBA16Float);
+	mpResManager->requestTextureResource("WorldPosition", ResourceManager::ChannelAccess::Write);
+	mpResManager->requestTextureResource("WorldNormal", ResourceManager::ChannelAccess::Write, ResourceFormat::RGBA16Float);
+	mpResManager->requestTextureResource("MaterialDiffuse", ResourceManager::ChannelAccess::Write, ResourceFormat::RGBA16Float);
+	mpResManager->requestTextureResource("MaterialSpecRough", ResourceManager::ChannelAccess::Write, ResourceFormat::RGBA16Float);
+	mpResManager->requestTextureResource("MaterialExtraParams", ResourceManager::ChannelAccess::Write, ResourceFormat::RGBA16Float);
+	mpResManager->requestTextureResource("Emissive", ResourceManager::ChannelAccess::Write, ResourceFormat::RGBA16Float);
+
+	// Rays that miss the scene look up the light probe
+	mpResManager->requestTextureResource(ResourceManager::kEnvironmentMap, ResourceManager::ChannelAccess::Read);
 
 	mpResManager->setDefaultSceneName("Data/pink_room/pink_room.fscene");
 
@@ -38,7 +38,7 @@ bool RayTracedGBufferPass::initialize(RenderContext* pRenderContext, ResourceMan
 	// We need a bunch of textures to store our G-buffer.  Ask for a list of them.  They all get the same 
 	//     format (in this case, the default, RGBA32F) and size (in this case, the default, screen sized)
 	mpResManager->requestTextureResources({ "WorldPosition", "WorldNormal", "MaterialDiffuse", 
-		                                    "MaterialSpecRough", "MaterialExtraParams", "Emissive" });
+		                                    "MaterialSpecRough", "MaterialExtraParams", "Emissive" }, ResourceManager::ChannelAccess::Write);
 
 	// Set the default scene to load
 	mpResManager->setDefaultSceneName("Data/pink_room/pink_room.fscene");
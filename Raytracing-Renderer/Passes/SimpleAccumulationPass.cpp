@@ -19,7 +19,7 @@
 #include "SimpleAccumulationPass.h"
 
 namespace {
-    const char *kAccumShader = "CommonPasses\\accumulate.ps.hlsl";
+    const char *kAccumShader = "Tutorial14\\pingPongAccumulate.ps.hlsl";
 };
 
 SimpleAccumulationPass::SimpleAccumulationPass(const std::string &bufferToAccumulate)
@@ -62,16 +62,21 @@ void SimpleAccumulationPass::initScene(RenderContext* pRenderContext, Scene::Sha
 void SimpleAccumulationPass::resize(uint32_t width, uint32_t height)
 {
     // Resize internal resources
-    mpLastFrame = Texture::create2D(width, height, ResourceFormat::RGBA32Float, 1, 1, nullptr, Resource::BindFlags::ShaderResource | Resource::BindFlags::UnorderedAccess | Resource::BindFlags::RenderTarget);
-
-    // We need a framebuffer to attach to our graphics pipe state (when running our full-screen pass)
-	mpInternalFbo = ResourceManager::createFbo(width, height, ResourceFormat::RGBA32Float);
-    mpGfxState->setFbo(mpInternalFbo);
+	createHistory(width, height);
 
     // Whenever we resize, we'd better force accumulation to restart
 	mAccumCount = 0;
 }
 
+void SimpleAccumulationPass::createHistory(uint32_t width, uint32_t height)
+{
+	// In high-precision mode, each history buffer holds a running sum plus the rounding error it has accumulated
+	std::vector<ResourceFormat> formats(mHighPrecision ? 2 : 1, ResourceFormat::RGBA32Float);
+	mpHistoryFbo[0] = ResourceManager::createFbo(width, height, formats);
+	mpHistoryFbo[1] = ResourceManager::createFbo(width, height, formats);
+	mHistoryIdx = 0;
+}
+
 void SimpleAccumulationPass::renderGui(Gui* pGui)
 {
 	// Print the name of the buffer we're accumulating from and into.  Add a blank line below that for clarity
@@ -86,6 +91,19 @@ void SimpleAccumulationPass::renderGui(Gui* pGui)
         setRefreshFlag();
     }
 
+	// The high-precision mode stores different data in the history, so switching restarts accumulation
+	if (pGui->addCheckBox("High-precision accumulation", mHighPrecision))
+	{
+		if (mHighPrecision)
+			mpAccumShader->addDefine("HIGH_PRECISION_ACCUMULATION", "");
+		else
+			mpAccumShader->removeDefine("HIGH_PRECISION_ACCUMULATION");
+
+		if (mpHistoryFbo[0])
+			createHistory(mpHistoryFbo[0]->getWidth(), mpHistoryFbo[0]->getHeight());
+		mAccumCount = 0;
+	}
+
 	// Display a count of accumulated frames
 	pGui->addText("");
 	pGui->addText((std::string("Frames accumulated: ") + std::to_string(mAccumCount)).c_str());
@@ -114,20 +132,24 @@ void SimpleAccumulationPass::execute(RenderContext* pRenderContext)
 		mpLastCameraMatrix = mpScene->getActiveCamera()->getViewMatrix();
 	}
 
-    // Set shader parameters for our accumulation
+	// Read last frame's history and write this frame's into the other buffer
+	uint32_t lastIdx = mHistoryIdx;
+	uint32_t curIdx  = 1 - mHistoryIdx;
+
+    // Set shader parameters for our accumulation.  The shader writes the result directly back into the input/output buffer.
 	auto shaderVars = mpAccumShader->getVars();
-	shaderVars["PerFrameCB"]["gAccumCount"] = mAccumCount++;
-	shaderVars["gLastFrame"] = mpLastFrame;
+	shaderVars[mAccumCountVar] = mAccumCount++;
+	shaderVars["gLastFrame"] = mpHistoryFbo[lastIdx]->getColorTexture(0);
 	shaderVars["gCurFrame"]  = inputTexture;
+	if (mHighPrecision)
+		shaderVars["gLastCompensation"] = mpHistoryFbo[lastIdx]->getColorTexture(1);
 
     // Do the accumulation
+	mpGfxState->setFbo(mpHistoryFbo[curIdx]);
     mpAccumShader->execute(pRenderContext, mpGfxState);
 
-    // We've accumulated our result.  Copy that back to the input/output buffer
-    pRenderContext->blit(mpInternalFbo->getColorTexture(0)->getSRV(), inputTexture->getRTV());
-
-    // Keep a copy for next frame (we need this to avoid reading & writing to the same resource)
-    pRenderContext->blit(mpInternalFbo->getColorTexture(0)->getSRV(), mpLastFrame->getRTV());
+	// What we just wrote is next frame's history
+	mHistoryIdx = curIdx;
 }
 
 void SimpleAccumulationPass::stateRefreshed()
@@ -48,14 +48,20 @@ protected:
 	// A helper utility to determine if the current scene (if any) has had any camera motion
 	bool hasCameraMoved();
 
+	// (Re)create the ping-pong history buffers, with an extra compensation target in high-precision mode
+	void createHistory(uint32_t width, uint32_t height);
+
     // Information about the rendering texture we're accumulating into
 	std::string                   mAccumChannel;
 
 	// State for our accumulation shader
 	FullscreenLaunch::SharedPtr   mpAccumShader;
 	GraphicsState::SharedPtr      mpGfxState;
-	Texture::SharedPtr            mpLastFrame;
-	Fbo::SharedPtr                mpInternalFbo;
+	SimpleVars::VarHandle         mAccumCountVar = { "PerFrameCB", "gAccumCount" };
+
+	// Accumulation history.  We read one and write the other, swapping each frame, so no copies are needed
+	Fbo::SharedPtr                mpHistoryFbo[2];
+	uint32_t                      mHistoryIdx = 0;     ///< Which history buffer holds last frame's result
 
 	// We stash a copy of our current scene.  Why?  To detect if changes have occurred.
 	Scene::SharedPtr              mpScene;
@@ -64,6 +70,9 @@ protected:
 	// Is our accumulation enabled?
 	bool                          mDoAccumulation = true;
 
+	// Use Kahan-compensated summation, which stays accurate over very long accumulations
+	bool                          mHighPrecision = false;
+
 	// How many frames have we accumulated so far?
 	uint32_t                      mAccumCount = 0;
 };
@@ -39,9 +39,9 @@ bool SimpleDiffuseGIPass::initialize(RenderContext* pRenderContext, ResourceMana
 {
 	// Stash a copy of our resource manager so we can get rendering resources
 	mpResManager = pResManager;
-	mpResManager->requestTextureResources({ "WorldPosition", "WorldNormal", "MaterialDiffuse" });
-	mpResManager->requestTextureResource(mOutputTexName);
-	mpResManager->requestTextureResource(ResourceManager::kEnvironmentMap);
+	mpResManager->requestTextureResources({ "WorldPosition", "WorldNormal", "MaterialDiffuse" }, ResourceManager::ChannelAccess::Read);
+	mpResManager->requestTextureResource(mOutputTexName, ResourceManager::ChannelAccess::Write);
+	mpResManager->requestTextureResource(ResourceManager::kEnvironmentMap, ResourceManager::ChannelAccess::Read);
 
 	// Set the default scene to load
 	//mpResManager->setDefaultSceneName("Data/pink_room/pink_room.fscene");
@@ -33,10 +33,10 @@ bool SimpleGBufferPass::initialize(RenderContext* pRenderContext, ResourceManage
 	// We need a bunch of textures to store our G-buffer.  Ask for a list of them.  They all get the same 
 	//     format (in this case, the default, RGBA32F) and size (in this case, the default, screen sized)
 	mpResManager->requestTextureResources({ "WorldPosition", "WorldNormal", "MaterialDiffuse", 
-		                                    "MaterialSpecRough", "MaterialExtraParams" });
+		                                    "MaterialSpecRough", "MaterialExtraParams" }, ResourceManager::ChannelAccess::Write);
 
 	// We also need a depth buffer to use when rendering our g-buffer.  Ask for one, with appropriate format and binding flags.
-	mpResManager->requestTextureResource("Z-Buffer", ResourceFormat::D24UnormS8, ResourceManager::kDepthBufferFlags);
+	mpResManager->requestTextureResource("Z-Buffer", ResourceManager::ChannelAccess::Write, ResourceFormat::D24UnormS8, ResourceManager::kDepthBufferFlags);
 
 	// Set the default scene to load
 	mpResManager->setDefaultSceneName("Data/pink_room/pink_room.fscene");
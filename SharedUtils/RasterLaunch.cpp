@@ -18,6 +18,7 @@
 
 #include "RasterLaunch.h"
 
+RasterLaunch::DrawStats RasterLaunch::sCollectedDrawStats;
 
 RasterLaunch::SharedPtr RasterLaunch::RasterLaunch::create(GraphicsProgram::SharedPtr &existingProgram)
 {
@@ -124,5 +125,16 @@ void RasterLaunch::execute(RenderContext* pRenderContext, GraphicsState::SharedP
 		mpSceneRenderer->renderScene(pRenderContext);
 		pRenderContext->popGraphicsVars();
 		pRenderContext->popGraphicsState();
+
+		sCollectedDrawStats.trianglesDrawn += mpSceneRenderer->getTrianglesDrawn();
+		sCollectedDrawStats.maxLodError = std::max(sCollectedDrawStats.maxLodError, mpSceneRenderer->getMaxLodErrorDrawn());
+		mpSceneRenderer->resetDrawStats();
 	}
+}
+
+RasterLaunch::DrawStats RasterLaunch::collectDrawStats()
+{
+	DrawStats stats = sCollectedDrawStats;
+	sCollectedDrawStats = DrawStats();
+	return stats;
 }
\ No newline at end of file
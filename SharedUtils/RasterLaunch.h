@@ -72,6 +72,15 @@ public:
 	// Want to sent variables to your HLSL code, you do that via the SimpleVars structure
 	SimpleVars::SharedPtr getVars();
 
+	// Draw stats of our scene renderers.  Each execute() adds its renderer's stats to a shared total, which collectDrawStats()
+	//     returns and resets, so callers can attribute the draws to whatever ran since the last call.
+	struct DrawStats
+	{
+		uint64_t trianglesDrawn = 0;      ///< Triangles rasterized
+		float    maxLodError = 0.0f;      ///< Largest world-space error of the mesh LODs rasterized (see SceneRenderer::getMaxLodErrorDrawn())
+	};
+	static DrawStats collectDrawStats();
+
 protected:
 	RasterLaunch(GraphicsProgram::SharedPtr &existingProgram);
 	
@@ -82,4 +91,6 @@ protected:
 	SimpleVars::SharedPtr       mpSimpleVars;
 	SceneRenderer::SharedPtr    mpSceneRenderer;
 	bool                        mInvalidVarReflector;
+
+	static DrawStats            sCollectedDrawStats;
 };
\ No newline at end of file
@@ -18,9 +18,22 @@
 
 #include "RayLaunch.h"
 
+bool RayLaunch::sRayCountingEnabled = false;
+RayLaunch::RayCounts RayLaunch::sCollectedRayCounts;
+std::vector<std::weak_ptr<RayLaunch>> RayLaunch::sRayLaunches;
+
+namespace {
+	const char* kRayCountingDefine = "RAY_COUNTERS";
+};
+
 RayLaunch::SharedPtr RayLaunch::RayLaunch::create(const std::string &rayGenFile, const std::string& rayGenEntryPoint, int recursionDepth)
 {
-	return SharedPtr(new RayLaunch(rayGenFile, rayGenEntryPoint, recursionDepth));
+	SharedPtr pLaunch = SharedPtr(new RayLaunch(rayGenFile, rayGenEntryPoint, recursionDepth));
+
+	// Remember our live launches, so toggling ray counting can update them
+	sRayLaunches.erase(std::remove_if(sRayLaunches.begin(), sRayLaunches.end(), [](const std::weak_ptr<RayLaunch>& p) { return p.expired(); }), sRayLaunches.end());
+	sRayLaunches.push_back(pLaunch);
+	return pLaunch;
 }
 
 RayLaunch::RayLaunch(const std::string &rayGenFile, const std::string& rayGenEntryPoint, int recursionDepth)
@@ -70,8 +83,40 @@ void RayLaunch::compileRayProgram()
 	mpRayState->setProgram(mpRayProg);
 	mInvalidVarReflector = true;
 
-	// Since generating ray tracing variables take a while, try to do it now.
-	createRayTracingVariables();
+	mRayCountingDefined = sRayCountingEnabled;
+	if (mRayCountingDefined) mpRayProg->addDefine(kRayCountingDefine);
+
+	// Compiling the shaders takes a while.  Do it on Falcor's compiler threads, alongside other passes' programs.
+	submitRayProgram();
+}
+
+void RayLaunch::submitRayProgram()
+{
+	if (!mpRayProg) return;
+
+	// Each ray gen, miss and hit program links separately, so they can all compile in parallel
+	std::vector<Program::SharedPtr> programs = { mpRayProg->getRayGenProgram() };
+	for (uint32_t i = 0; i < mpRayProg->getMissProgramCount(); i++)
+		programs.push_back(mpRayProg->getMissProgram(i));
+	for (uint32_t i = 0; i < mpRayProg->getHitProgramCount(); i++)
+		programs.push_back(mpRayProg->getHitProgram(i));
+
+	mpCompileJob = ProgramCompiler::submit(programs);
+}
+
+bool RayLaunch::isCompiling() const
+{
+	return mpCompileJob && !mpCompileJob->isDone();
+}
+
+void RayLaunch::waitForCompile()
+{
+	if (!mpCompileJob) return;
+
+	mpCompileJob->wait();
+	if (!mpCompileJob->succeeded())
+		logWarning("RayLaunch: one or more ray tracing programs failed to compile");
+	mpCompileJob = nullptr;
 }
 
 bool RayLaunch::readyToRender()
@@ -79,6 +124,9 @@ bool RayLaunch::readyToRender()
 	// Do we already know everything is ready?
 	if (!mInvalidVarReflector && mpRayProg && mpRayVars) return true;
 
+	// Still compiling in the background?  Don't stall the frame waiting on it.
+	if (isCompiling()) return false;
+
 	// No?  Try creating our variable reflector.
 	createRayTracingVariables();
 
@@ -105,23 +153,29 @@ void RayLaunch::setScene(RtScene::SharedPtr pScene)
 	mInvalidVarReflector = true;
 
 	// Since generating our ray tracing variables take quite a while (incl. build time), check if we can do it now
-	if (mpRayProg) createRayTracingVariables();
+	if (mpRayProg && !isCompiling()) createRayTracingVariables();
 }
 
 void RayLaunch::addDefine(const std::string& name, const std::string& value)
 {
-	mpRayProg->addDefine(name, value);
+	// The compiler threads may still be using the program's current define list
+	waitForCompile();
+	if (mpRayProg->addDefine(name, value)) submitRayProgram();
 	mInvalidVarReflector = true;
 }
 
 void RayLaunch::removeDefine(const std::string& name)
 {
-	mpRayProg->removeDefine(name);
+	waitForCompile();
+	if (mpRayProg->removeDefine(name)) submitRayProgram();
 	mInvalidVarReflector = true;
 }
 
 void RayLaunch::createRayTracingVariables()
 {
+	// Creating variables needs the programs' reflection data, so finish any background compile first
+	waitForCompile();
+
 	if (mpRayProg && mpScene)
 	{
 		mpRayVars = RtProgramVars::create(mpRayProg, mpScene);
@@ -189,6 +243,9 @@ void RayLaunch::execute(RenderContext::SharedPtr pRenderContext, uvec2 rayLaunch
 
 void RayLaunch::execute(RenderContext* pRenderContext, uvec2 rayLaunchDimensions, Camera::SharedPtr viewCamera)
 {
+	// Nothing to launch until our shaders finish compiling
+	if (isCompiling()) return;
+
 	// Ok.  We're executing.  If we still have an invalid shader variable reflector, we'd better get one now!
 	if (mInvalidVarReflector) createRayTracingVariables();
 
@@ -209,7 +266,9 @@ void RayLaunch::execute(RenderContext* pRenderContext, uvec2 rayLaunchDimensions
 	}
 
 	// Ok.  We're ready and have done all our error checking.  Launch the ray tracing!
+	beginRayCounting(pRenderContext);
 	mpSceneRenderer->renderScene(pRenderContext, mpRayVars, mpRayState, uvec3(rayLaunchDimensions.x, rayLaunchDimensions.y, 1), camPtr);
+	endRayCounting(pRenderContext);
 }
 
 void RayLaunch::experimentalExecute(RenderContext::SharedPtr pRenderContext, uvec2 rayLaunchDimensions)
@@ -220,3 +279,121 @@ void RayLaunch::experimentalExecute(RenderContext::SharedPtr pRenderContext, uve
 	// Ok.  We're ready and have done all our error checking.  Launch the ray tracing!
 	mpSceneRenderer->renderScene(pRenderContext.get(), mpRayVars, mpRayState, uvec3(rayLaunchDimensions.x, rayLaunchDimensions.y, 1), nullptr);
 }
+
+uint64_t RayLaunch::RayCounts::getTotal() const
+{
+	uint64_t total = 0;
+	for (uint32_t i = 0; i < kRayCountSlotCount; i++) total += slots[i];
+	return total;
+}
+
+RayLaunch::RayCounts& RayLaunch::RayCounts::operator+=(const RayCounts& other)
+{
+	for (uint32_t i = 0; i < kRayCountSlotCount; i++) slots[i] += other.slots[i];
+	return *this;
+}
+
+void RayLaunch::setRayCountingEnabled(bool enabled)
+{
+	if (sRayCountingEnabled == enabled) return;
+	sRayCountingEnabled = enabled;
+	sCollectedRayCounts = RayCounts();
+
+	for (auto it = sRayLaunches.begin(); it != sRayLaunches.end();)
+	{
+		RayLaunch::SharedPtr pLaunch = it->lock();
+		if (!pLaunch)
+		{
+			it = sRayLaunches.erase(it);
+			continue;
+		}
+		pLaunch->updateRayCountingDefine();
+		++it;
+	}
+}
+
+RayLaunch::RayCounts RayLaunch::collectRayCounts()
+{
+	RayCounts counts = sCollectedRayCounts;
+	sCollectedRayCounts = RayCounts();
+	return counts;
+}
+
+std::string RayLaunch::getRayCountSlotName(uint32_t slot)
+{
+	switch (slot)
+	{
+	case kPrimaryRays: return "primary";
+	case kShadowRays:  return "shadow";
+	case kAoRays:      return "AO";
+	default:           return (slot < kRayCountSlotCount) ? "indirect " + std::to_string(slot - kIndirectRays) : "<invalid>";
+	}
+}
+
+void RayLaunch::updateRayCountingDefine()
+{
+	if (!mpRayProg || mRayCountingDefined == sRayCountingEnabled) return;
+
+	// Changing the define recompiles our programs in the background
+	mRayCountingDefined = sRayCountingEnabled;
+	if (mRayCountingDefined)
+		addDefine(kRayCountingDefine, "");
+	else
+		removeDefine(kRayCountingDefine);
+
+	// Don't keep counter resources around when we're not counting
+	if (!mRayCountingDefined)
+	{
+		mpRayCounterBuffer = nullptr;
+		for (auto& readback : mRayCountReadback) readback = RayCountReadback();
+	}
+	mRayCounts = RayCounts();
+	mRayCountersBound = false;
+}
+
+void RayLaunch::beginRayCounting(RenderContext* pRenderContext)
+{
+	mRayCountersBound = false;
+	if (!mRayCountingDefined) return;
+
+	if (!mpRayCounterBuffer)
+	{
+		size_t size = kRayCountSlotCount * sizeof(uint32_t);
+		mpRayCounterBuffer = Buffer::create(size, Buffer::BindFlags::UnorderedAccess, Buffer::CpuAccess::None);
+		for (auto& readback : mRayCountReadback)
+		{
+			readback.pBuffer = Buffer::create(size, Buffer::BindFlags::None, Buffer::CpuAccess::Read);
+			readback.fenceValue = 0;
+		}
+		mRayCountReadbackIdx = 0;
+	}
+
+	// Shaders that don't call countRay() don't declare the counters; there's nothing to count for them
+	mRayCountersBound = mpGlobalVars && mpGlobalVars->setRawBuffer("gRayCounters", mpRayCounterBuffer);
+	if (mRayCountersBound) pRenderContext->clearUAV(mpRayCounterBuffer->getUAV().get(), uvec4(0));
+}
+
+void RayLaunch::endRayCounting(RenderContext* pRenderContext)
+{
+	if (!mRayCountersBound) return;
+
+	// Read back the counts of the launch that used the oldest readback buffer, if the GPU is done with them.  If
+	//     it's not (the GPU is more than a few frames behind), reuse our last counts rather than stall.
+	RayCountReadback& readback = mRayCountReadback[mRayCountReadbackIdx];
+	const GpuFence::SharedPtr& pFrameFence = gpDevice->getFrameFence();
+	bool readbackBusy = readback.fenceValue && pFrameFence->getGpuValue() < readback.fenceValue;
+	if (readback.fenceValue && !readbackBusy)
+	{
+		const uint32_t* pCounts = (const uint32_t*)readback.pBuffer->map(Buffer::MapType::Read);
+		for (uint32_t i = 0; i < kRayCountSlotCount; i++) mRayCounts.slots[i] = pCounts[i];
+		readback.pBuffer->unmap();
+	}
+	sCollectedRayCounts += mRayCounts;
+	if (readbackBusy) return;
+
+	// Record the copy of this launch's counts.  It's submitted with the rest of the frame, and done once the GPU
+	//     passes the frame fence signal at the end of this frame.
+	pRenderContext->copyResource(readback.pBuffer.get(), mpRayCounterBuffer.get());
+	readback.fenceValue = pFrameFence->getCpuValue();
+	mRayCountReadbackIdx = (mRayCountReadbackIdx + 1) % kRayCountReadbackLatency;
+}
@@ -94,10 +94,11 @@ public:
 	//    Create a new hit group with closest hit, any-hit, and intersection shader. Use the null string "" for no shader.
 	uint32_t addHitGroup(const std::string& hitShaderFile, const std::string& closestHitEntryPoint, const std::string& anyHitEntryPoint, const std::string& intersectionEntryPoint);
 
-	// Call once you have added all the desired ray types
+	// Call once you have added all the desired ray types.  Compilation happens asynchronously; see readyToRender()
 	void compileRayProgram();
 
-	// Returns true if we have everything needed to call execute().
+	// Returns true if we have everything needed to call execute().  Returns false (without blocking) while the
+	//     programs from compileRayProgram() are still compiling in the background.
 	bool readyToRender();
 
 	// If you use #define's in this pass' shaders and need to set them programmatically, use these methods (rather
@@ -132,10 +133,52 @@ public:
 	using SimpleVarsVector = std::vector<SimpleVars::SharedPtr>;
 	SimpleVarsVector &getHitVars(uint32_t rayType);
 
+	// Optional ray counting.  Shaders count the rays they trace by calling countRay() next to TraceRay() (see
+	//     CommonPasses/rayCounters.hlsli).  This only gets compiled in while counting is enabled, as the atomics
+	//     are not free.  Counts are read back a few frames late, so as not to stall on the GPU.
+	//     Slots must match the RAY_COUNT_* defines in the shader header.
+	static const uint32_t kMaxCountedDepth = 8;     // Deeper indirect rays are counted in the last depth slot
+	enum RayCountSlot : uint32_t
+	{
+		kPrimaryRays = 0,
+		kShadowRays,
+		kAoRays,
+		kIndirectRays,                              // One slot per depth, starting here
+		kRayCountSlotCount = kIndirectRays + kMaxCountedDepth,
+	};
+
+	struct RayCounts
+	{
+		uint64_t slots[kRayCountSlotCount] = {};
+
+		uint64_t getTotal() const;
+		RayCounts& operator+=(const RayCounts& other);
+	};
+
+	// Turns ray counting on or off for every RayLaunch.  Recompiles the ray tracing programs (in the background).
+	static void setRayCountingEnabled(bool enabled);
+	static bool isRayCountingEnabled() { return sRayCountingEnabled; }
+
+	// Returns the rays counted by the launches executed since the last call, and resets them.  Call this
+	//     after each pass to get the pass' counts.
+	static RayCounts collectRayCounts();
+
+	// Returns a short name for a counter slot (e.g., "shadow", "indirect 2")
+	static std::string getRayCountSlotName(uint32_t slot);
+
+	// The latest counts read back for this launch
+	const RayCounts& getRayCounts() const { return mRayCounts; }
+
 protected:
 	RayLaunch(const std::string &rayGenFile, const std::string& rayGenEntryPoint, int recursionDepth=2);
 
 	void createRayTracingVariables();
+	void submitRayProgram();
+	bool isCompiling() const;
+	void waitForCompile();
+	void updateRayCountingDefine();
+	void beginRayCounting(RenderContext* pRenderContext);
+	void endRayCounting(RenderContext* pRenderContext);
 
 	RtProgram::SharedPtr          mpRayProg;        ///< Most abstract ray tracing pipeline (includes ray gen, miss, and hit shaders)
 	RtProgram::Desc               mpRayProgDesc;   
@@ -155,6 +198,26 @@ protected:
 	RtSceneRenderer::SharedPtr    mpSceneRenderer;
 	RtScene::SharedPtr            mpScene;
 	bool                          mInvalidVarReflector = true;
+	ProgramCompiler::Job::SharedPtr mpCompileJob;   ///< Background compilation of mpRayProg, null when there's none in flight
+
+	// Ray counting.  Each launch copies its counters to one of a few readback buffers, which are only mapped
+	//     once the device's frame fence says the GPU has finished the frame that copied them.
+	static const uint32_t         kRayCountReadbackLatency = 3;
+	struct RayCountReadback
+	{
+		Buffer::SharedPtr         pBuffer;
+		uint64_t                  fenceValue = 0;   ///< Frame fence value that marks the copy done.  0 when no copy is in flight
+	};
+	bool                          mRayCountingDefined = false;  ///< Is RAY_COUNTERS defined in mpRayProg?
+	bool                          mRayCountersBound = false;    ///< Do our shaders declare gRayCounters?
+	Buffer::SharedPtr             mpRayCounterBuffer;
+	RayCountReadback              mRayCountReadback[kRayCountReadbackLatency];
+	uint32_t                      mRayCountReadbackIdx = 0;
+	RayCounts                     mRayCounts;
+
+	static bool                   sRayCountingEnabled;
+	static RayCounts              sCollectedRayCounts;
+	static std::vector<std::weak_ptr<RayLaunch>> sRayLaunches;  ///< Live launches, to update when counting is toggled
 
 	// Used only to return a zero-length list of hit shaders
 	SimpleVarsVector mDefaultHitVarList;
@@ -21,10 +21,109 @@
 #include "Externals/dear_imgui/imgui.h"
 #include "SceneLoaderWrapper.h"
 #include <algorithm>
+#include <ctime>
+#include <fstream>
 
 namespace {
 	const char     *kNullPassDescriptor = "< None >";   ///< Name used in dropdown lists when no pass is selected.
 	const uint32_t  kNullPassId = 0xFFFFFFFFu;          ///< Id used to represent the null pass (using -1).
+
+	bool readsChannel(ResourceManager::ChannelAccess access)  { return (uint32_t(access) & uint32_t(ResourceManager::ChannelAccess::Read)) != 0; }
+	bool writesChannel(ResourceManager::ChannelAccess access) { return (uint32_t(access) & uint32_t(ResourceManager::ChannelAccess::Write)) != 0; }
+
+	// Distribution of a benchmark's per-frame timings, in ms
+	struct TimingStats
+	{
+		double mean = 0, median = 0, p95 = 0, p99 = 0, stddev = 0, min = 0, max = 0;
+	};
+
+	TimingStats computeTimingStats(std::vector<float> samples)
+	{
+		TimingStats stats;
+		if (samples.empty()) return stats;
+		std::sort(samples.begin(), samples.end());
+		size_t n = samples.size();
+
+		// Nearest-rank percentiles
+		auto percentile = [&samples, n](double p) { size_t rank = size_t(std::ceil(p * n)); return double(samples[std::min(n - 1, rank > 0 ? rank - 1 : 0)]); };
+
+		double sum = 0;
+		for (float x : samples) sum += x;
+		stats.mean = sum / n;
+		double variance = 0;
+		for (float x : samples) variance += (x - stats.mean) * (x - stats.mean);
+		stats.stddev = std::sqrt(variance / n);
+		stats.median = (n % 2) ? samples[n / 2] : 0.5 * (samples[n / 2 - 1] + samples[n / 2]);
+		stats.p95 = percentile(0.95);
+		stats.p99 = percentile(0.99);
+		stats.min = samples.front();
+		stats.max = samples.back();
+		return stats;
+	}
+
+	std::string timingStatsToJson(const TimingStats& stats)
+	{
+		char buf[512];
+		sprintf_s(buf, "{ \"mean\": %.4f, \"median\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"stddev\": %.4f, \"min\": %.4f, \"max\": %.4f }",
+			stats.mean, stats.median, stats.p95, stats.p99, stats.stddev, stats.min, stats.max);
+		return buf;
+	}
+
+	std::string timingStatsToCsv(const TimingStats& stats)
+	{
+		char buf[512];
+		sprintf_s(buf, "%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f", stats.mean, stats.median, stats.p95, stats.p99, stats.stddev, stats.min, stats.max);
+		return buf;
+	}
+
+	// Throughput of a pass tracing the given rays in the given GPU time
+	double computeMraysPerSec(uint64_t rays, double gpuTimeMs)
+	{
+		return (gpuTimeMs > 0) ? double(rays) / (gpuTimeMs * 1000.0) : 0.0;
+	}
+
+	std::string rayCountsToJson(const RayLaunch::RayCounts& counts, uint32_t frameCount, double gpuTimeMs)
+	{
+		char buf[512];
+		sprintf_s(buf, "{ \"perFrame\": %.1f, \"mraysPerSec\": %.3f, \"byType\": {", double(counts.getTotal()) / frameCount, computeMraysPerSec(counts.getTotal(), gpuTimeMs));
+		std::string json = buf;
+		const char* separator = " ";
+		for (uint32_t slot = 0; slot < RayLaunch::kRayCountSlotCount; slot++)
+		{
+			if (counts.slots[slot] == 0) continue;
+			sprintf_s(buf, "%s\"%s\": %.1f", separator, RayLaunch::getRayCountSlotName(slot).c_str(), double(counts.slots[slot]) / frameCount);
+			json += buf;
+			separator = ", ";
+		}
+		return json + " } }";
+	}
+
+	// Memory watermarks of a benchmark run, and the GPU memory each category holds at its end
+	std::string memoryPeaksToJson(const std::vector<uint64_t>& gpuFramePeaks, uint64_t cpuPeak)
+	{
+		uint64_t peak = 0;
+		double mean = 0;
+		for (uint64_t bytes : gpuFramePeaks)
+		{
+			peak = std::max(peak, bytes);
+			mean += double(bytes);
+		}
+		if (!gpuFramePeaks.empty()) mean /= gpuFramePeaks.size();
+
+		char buf[512];
+		sprintf_s(buf, "{ \"peakBytes\": %llu, \"meanFramePeakBytes\": %.0f, \"cpuPeakBytes\": %llu, \"byCategory\": {", (unsigned long long)peak, mean, (unsigned long long)cpuPeak);
+		std::string json = buf;
+		const char* separator = " ";
+		for (uint32_t i = 0; i < uint32_t(MemoryTracker::Category::Count); i++)
+		{
+			MemoryTracker::CategoryStats stats = MemoryTracker::getCategoryStats(MemoryTracker::Category(i));
+			if (stats.bytes == 0) continue;
+			sprintf_s(buf, "%s\"%s\": %llu", separator, MemoryTracker::getCategoryName(MemoryTracker::Category(i)), (unsigned long long)stats.bytes);
+			json += buf;
+			separator = ", ";
+		}
+		return json + " } }";
+	}
 };
 
 
@@ -42,6 +141,9 @@ uint32_t RenderingPipeline::addPass(::RenderPass::SharedPtr pNewPass)
 
 void RenderingPipeline::onLoad(SampleCallbacks* pSample, const RenderContext::SharedPtr &pRenderContext)
 {
+	mLoadStartTime = CpuTimer::getCurrentTimePoint();
+	mLoadCompileStats = ProgramCompiler::getStats();
+
 	// Give the GUI some heft, so we don't need to resize all the time
 	pSample->setDefaultGuiSize(300, 800);
 
@@ -49,13 +151,16 @@ void RenderingPipeline::onLoad(SampleCallbacks* pSample, const RenderContext::Sh
 	mpResourceManager = ResourceManager::create(mLastKnownSize.x, mLastKnownSize.y, pSample);
 	mOutputBufferIndex = mpResourceManager->requestTextureResource(ResourceManager::kOutputChannel);
 
-	// Initialize all of the RenderPasses we have available to select for our pipeline
+	// Initialize all of the RenderPasses we have available to select for our pipeline.  Passes submit their shaders to
+	//    Falcor's ProgramCompiler, so they compile in parallel and each pass becomes ready (see readyToRender()) when its own finish.
 	for (uint32_t i = 0; i < mAvailPasses.size(); i++)
 	{
 		if (mAvailPasses[i])
 		{
-			// Initialize.  If failure, remove this pass from the list.
+			// Initialize.  If failure, remove this pass from the list.  Channels requested here are recorded as used by this pass.
+			mpResourceManager->setRequestingPass(mAvailPasses[i].get());
 			bool initialized = mAvailPasses[i]->onInitialize(pRenderContext.get(), mpResourceManager);
+			mpResourceManager->setRequestingPass(nullptr);
 			if (!initialized) mAvailPasses[i] = nullptr;
 		}
 	}
@@ -284,6 +389,19 @@ void RenderingPipeline::onGuiRender(SampleCallbacks* pSample, Gui* pGui)
 			mpResourceManager->setMinTDist(mMinTArray[mMinTSelection]);
 			mGlobalPipeRefresh = true;
 		}
+
+		// Our ray tracing passes trace from a rasterized G-buffer, so every ray is a secondary ray and can use coarser LODs
+		RtScene::SharedPtr pRtScene = std::dynamic_pointer_cast<RtScene>(mpScene);
+		if (pRtScene && pGui->addIntVar("Ray tracing mesh LOD", mRtLodBias, 0, 8))
+		{
+			pRtScene->setLodBias(uint32_t(mRtLodBias));
+			mGlobalPipeRefresh = true;
+		}
+		if (mPipeRequiresRaster && (mRasterLodError + mRtLodError > 0.0f))
+		{
+			std::string offsetMsg = "Min traversal distance offset for mesh LODs:  " + std::to_string(mRasterLodError + mRtLodError);
+			pGui->addText(offsetMsg.c_str());
+		}
 		pGui->addSeparator();
 	}
 
@@ -303,6 +421,16 @@ void RenderingPipeline::onGuiRender(SampleCallbacks* pSample, Gui* pGui)
 		pGui->addText(""); 
 	}
 
+	if (!mStartupReported)
+	{
+		std::string pending = "Compiling shaders (" + std::to_string(ProgramCompiler::getStats().pendingCount) + " programs left)...";
+		pGui->addText(pending.c_str());
+	}
+	else
+	{
+		pGui->addText(mStartupReport.c_str());
+	}
+
 	pGui->addText("");
 	pGui->addText("Ordered list of passes in rendering pipeline:");
 	pGui->addText("       (Click the boxes at left to toggle GUIs)");
@@ -352,6 +480,42 @@ void RenderingPipeline::onGuiRender(SampleCallbacks* pSample, Gui* pGui)
 			yGuiOffset += mActivePasses[i]->getGuiSize().y; 
 	}
 
+	// Show which passes depend on each other, which are skipped, and any ordering problems
+	if (pGui->beginGroup("Pass dependency graph", !mPassHazards.empty()))
+	{
+		if (pGui->addCheckBox("Skip passes with unused outputs", mCullUnusedPasses))
+		{
+			mPipelineChanged = true;
+		}
+		pGui->addText(getPassGraphDump().c_str());
+		if (pGui->addButton("Write graph to log"))
+		{
+			logInfo("Rendering pipeline pass graph:\n" + getPassGraphDump());
+		}
+		if (mpResourceManager && pGui->addButton("Time channel lookups", true))
+		{
+			mpResourceManager->runLookupBenchmark();
+		}
+		pGui->endGroup();
+	}
+
+	// Show where the GPU memory goes
+	if (pGui->beginGroup("Memory"))
+	{
+		pGui->addText(MemoryTracker::getSummaryString().c_str());
+		pGui->addText("Largest users:");
+		for (const MemoryTracker::OwnerStats& owner : MemoryTracker::getOwnerStats(10))
+		{
+			char buf[256];
+			sprintf_s(buf, "    %s (%s):  %.1f MB", owner.owner.empty() ? "<unnamed>" : owner.owner.c_str(), MemoryTracker::getCategoryName(owner.category), owner.bytes / (1024.0 * 1024.0));
+			pGui->addText(buf);
+		}
+		std::string filename;
+		if (pGui->addButton("Save memory report") && saveFileDialog("JSON\0*.json\0\0", filename))
+			MemoryTracker::dumpJson(filename);
+		pGui->endGroup();
+	}
+
 	pGui->addText("");
 
 	// Enable an option to enable/disable binding of the camera to a path
@@ -379,12 +543,119 @@ void RenderingPipeline::onGuiRender(SampleCallbacks* pSample, Gui* pGui)
 		}
 	}
 
+	// Display the number of triangles rasterized last frame, which drops as distant meshes switch to coarser LODs
+	std::string triangleMsg = "Triangles rasterized:  " + std::to_string(mLastFrameTriangles);
+	pGui->addText(triangleMsg.c_str());
+
+	// Display texture streaming statistics, if enabled
+	if (TextureStreamer::getGlobalStreamer(false))
+	{
+		TextureStreamer::getGlobalStreamer(false)->renderUI(pGui, "Texture streaming");
+	}
+
+	// Display geometry streaming statistics, and allow generating a scene too large to be fully resident
+	if (GeometryStreamer::getGlobalStreamer(false))
+	{
+		GeometryStreamer::getGlobalStreamer(false)->renderUI(pGui, "Geometry streaming");
+		if (mPipeRequiresScene && pGui->addButton("Generate large test scene"))
+		{
+			std::string sceneFile = SyntheticSceneGenerator::generate();
+			RtScene::SharedPtr loadedScene = sceneFile.empty() ? nullptr : loadScene(mLastKnownSize, sceneFile.c_str());
+			if (loadedScene)
+			{
+				onInitNewScene(pSample->getRenderContext().get(), loadedScene);
+				mGlobalPipeRefresh = true;
+			}
+		}
+	}
+
     pGui->addText("");
     pGui->addSeparator();
     pGui->addText(Falcor::gProfileEnabled ? "Press (P):  Hide profiling window" : "Press (P):  Show profiling window");
+	if (Falcor::gProfileEnabled)
+	{
+		// Keep a trace of the last frames' profiler events, which can be saved and opened in chrome://tracing or Perfetto
+		bool recordTrace = Profiler::isTraceEnabled();
+		if (pGui->addIntVar("Trace frame window", mTraceFrameWindow, 2, 10000) && recordTrace)
+			Profiler::setTraceEnabled(true, uint32_t(mTraceFrameWindow));
+		if (pGui->addCheckBox("Record trace", recordTrace))
+			Profiler::setTraceEnabled(recordTrace, uint32_t(mTraceFrameWindow));
+		if (recordTrace)
+		{
+			std::string frames = "    " + std::to_string(Profiler::getTraceFrameCount()) + " frames recorded";
+			pGui->addText(frames.c_str());
+			std::string filename;
+			if (pGui->addButton("Save trace") && saveFileDialog("Chrome Trace\0*.json\0\0", filename))
+				Profiler::exportTrace(filename);
+		}
+	}
+
+	// Count the rays each pass traces, to see how efficiently it traces them.  The counters cost a little GPU time.
+	bool countRays = RayLaunch::isRayCountingEnabled();
+	if (pGui->addCheckBox("Count rays", countRays)) setRayCountingEnabled(countRays);
+	if (countRays)
+	{
+		for (const PassNode& node : mPassGraph)
+		{
+			uint64_t rays = node.rayCounts.getTotal();
+			if (node.isCulled || rays == 0) continue;
+
+			// Pass times are only measured while profiling
+			char buf[256];
+			if (Falcor::gProfileEnabled)
+				sprintf_s(buf, "    %s:  %.2f Mrays, %.1f Mrays/s", node.passName.c_str(), rays / 1.0e6, computeMraysPerSec(rays, Profiler::getEventGpuTime(node.passName)));
+			else
+				sprintf_s(buf, "    %s:  %.2f Mrays", node.passName.c_str(), rays / 1.0e6);
+			pGui->addText(buf);
+			for (uint32_t slot = 0; slot < RayLaunch::kRayCountSlotCount; slot++)
+			{
+				if (node.rayCounts.slots[slot] == 0) continue;
+				sprintf_s(buf, "        %s:  %.2f Mrays", RayLaunch::getRayCountSlotName(slot).c_str(), node.rayCounts.slots[slot] / 1.0e6);
+				pGui->addText(buf);
+			}
+		}
+	}
+    pGui->addSeparator();
+
+	// Benchmark the current pipeline
+	if (isBenchmarkRunning())
+	{
+		std::string progress = "Benchmark:  ";
+		if (mBenchmark.state == BenchmarkState::Pending) progress += "waiting for shaders to compile";
+		else if (mBenchmark.state == BenchmarkState::Warmup) progress += "warming up (" + std::to_string(mBenchmark.frame) + "/" + std::to_string(mBenchmark.desc.warmupFrames) + ")";
+		else progress += "measuring (" + std::to_string(mBenchmark.frame) + "/" + std::to_string(mBenchmark.desc.frameCount) + ")";
+		pGui->addText(progress.c_str());
+		if (pGui->addButton("Cancel benchmark")) finishBenchmark(pSample, false);
+	}
+	else
+	{
+		pGui->addIntVar("Benchmark warmup frames", mBenchmarkWarmupFrames, 0, 100000);
+		pGui->addIntVar("Benchmark frames", mBenchmarkFrameCount, 1, 100000);
+		if (pGui->addButton("Run benchmark"))
+		{
+			BenchmarkDesc desc;
+			desc.warmupFrames = uint32_t(mBenchmarkWarmupFrames);
+			desc.frameCount = uint32_t(mBenchmarkFrameCount);
+			startBenchmark(desc);
+		}
+	}
     pGui->addSeparator();
 }
 
+void RenderingPipeline::enableTextureStreaming(uint64_t memoryBudget)
+{
+	TextureStreamer::Desc desc;
+	desc.memoryBudget = memoryBudget;
+	TextureStreamer::setGlobalStreamer(TextureStreamer::create(desc));
+}
+
+void RenderingPipeline::enableGeometryStreaming(uint64_t memoryBudget)
+{
+	GeometryStreamer::Desc desc;
+	desc.memoryBudget = memoryBudget;
+	GeometryStreamer::setGlobalStreamer(GeometryStreamer::create(desc));
+}
+
 void RenderingPipeline::removePassFromPipeline(uint32_t passNum)
 {
 	// Check index validity (and don't allow removal of the last list entry)
@@ -605,6 +876,23 @@ void RenderingPipeline::onFirstRun(SampleCallbacks* pSample)
 		if (loadedScene) onInitNewScene(pSample->getRenderContext().get(), loadedScene);
 	}
 
+	// Run a benchmark from the command line?  Usage:  -benchmark [warmupFrames frameCount [reportFilename]] [-countRays]
+	ArgList args = pSample->getArgList();
+	if (args.argExists("benchmark"))
+	{
+		std::vector<ArgList::Arg> values = args.getValues("benchmark");
+		BenchmarkDesc desc;
+		if (values.size() >= 2)
+		{
+			desc.warmupFrames = values[0].asUint();
+			desc.frameCount = values[1].asUint();
+		}
+		if (values.size() >= 3) desc.reportFilename = values[2].asString();
+		desc.countRays = args.argExists("countRays");
+		startBenchmark(desc);
+		mBenchmark.exitWhenDone = true;
+	}
+
 	mFirstFrame = false;
 }
 
@@ -613,6 +901,23 @@ void RenderingPipeline::onFrameRender(SampleCallbacks* pSample, const RenderCont
 	// Is this the first time we've run onFrameRender()?  If som take care of things that happen on first execution.
 	if (mFirstFrame) onFirstRun(pSample);
 
+	// Once the shaders submitted during startup are done compiling, report how long startup took
+	if (!mStartupReported && ProgramCompiler::getStats().pendingCount == 0)
+	{
+		mStartupReported = true;
+		ProgramCompiler::Stats stats = ProgramCompiler::getStats();
+		double wallTime = CpuTimer::calcDuration(mLoadStartTime, CpuTimer::getCurrentTimePoint());
+		double compileTime = stats.compileTime - mLoadCompileStats.compileTime;
+		uint32_t programCount = stats.programCount - mLoadCompileStats.programCount;
+		char buf[256];
+		sprintf_s(buf, "Startup: %.0f ms wall time, %.0f ms compiling %u programs on %u threads", wallTime, compileTime, programCount, ProgramCompiler::getWorkerCount());
+		mStartupReport = buf;
+		logInfo(mStartupReport);
+	}
+
+	// When benchmarking, lock the animation time to the frame number
+	if (isBenchmarkRunning()) beginBenchmarkFrame(pSample);
+
 	// Bind our default state to the graphics pipe
 	pRenderContext->pushGraphicsState(mpDefaultGfxState);
 
@@ -628,6 +933,26 @@ void RenderingPipeline::onFrameRender(SampleCallbacks* pSample, const RenderCont
 		// Make sure we're updateing the correct camera, then update the scene
 		mpCameraControl->attachCamera(mpScene->getActiveCamera() ? mpScene->getActiveCamera() : nullptr);
 		mpScene->update(pSample->getCurrentTime(), mpCameraControl.get());
+
+		// Request the texture mips needed this frame, and upload whatever finished streaming in
+		const TextureStreamer::SharedPtr& pStreamer = TextureStreamer::getGlobalStreamer(false);
+		if (pStreamer)
+		{
+			pStreamer->updateRequests(mpScene.get(), mpScene->getActiveCamera().get(), mLastKnownSize.y);
+			pStreamer->update(pRenderContext.get());
+		}
+
+		// Page in the mesh clusters near the camera or in view, and rebuild the acceleration structures of the ones that changed
+		const GeometryStreamer::SharedPtr& pGeometryStreamer = GeometryStreamer::getGlobalStreamer(false);
+		if (pGeometryStreamer)
+		{
+			pGeometryStreamer->updateResidency(mpScene.get(), mpScene->getActiveCamera().get(), mLastKnownSize.y);
+			RtScene::SharedPtr pRtScene = std::dynamic_pointer_cast<RtScene>(mpScene);
+			if (pGeometryStreamer->update() && pRtScene)
+			{
+				pRtScene->updateMeshGeometry(pGeometryStreamer->getChangedMeshes());
+			}
+		}
 	}
 
 	// Check if the pipeline has changed since last frame and needs updating
@@ -639,12 +964,15 @@ void RenderingPipeline::onFrameRender(SampleCallbacks* pSample, const RenderCont
 		{
 			if (mActivePasses[passNum])
 			{
+				mpResourceManager->setRequestingPass(mActivePasses[passNum].get());
 				mActivePasses[passNum]->onPipelineUpdate( mpResourceManager );
+				mpResourceManager->setRequestingPass(nullptr);
 			}
 		}
 
-		// Update our flags
+		// Update our flags, and work out which passes depend on each other in the new pipeline
 		updatePipelineRequirementFlags();
+		buildPassGraph();
 		updatedPipeline = true;
 	}
 
@@ -662,25 +990,48 @@ void RenderingPipeline::onFrameRender(SampleCallbacks* pSample, const RenderCont
 		mGlobalPipeRefresh = false;
 	}
 
-    // Execute all of the passes in the current pipeline
-    for (uint32_t passNum = 0; passNum < mActivePasses.size(); passNum++)
+    // Rays counted outside of our passes aren't attributed to any of them
+    if (RayLaunch::isRayCountingEnabled()) RayLaunch::collectRayCounts();
+
+    // Start this frame's draw stats.  Triangles drawn outside of our passes aren't counted.
+    RasterLaunch::collectDrawStats();
+    mFrameTriangles = 0;
+    mRasterLodError = 0.0f;
+    RtScene::SharedPtr pRtScene = std::dynamic_pointer_cast<RtScene>(mpScene);
+    mRtLodError = pRtScene ? pRtScene->getMaxLodError() : 0.0f;
+    updateLodRayOffset();
+
+    // Execute the passes in the current pipeline, skipping those whose outputs nobody uses
+    for (uint32_t nodeIdx = 0; nodeIdx < mPassGraph.size(); nodeIdx++)
     {
-        if (mActivePasses[passNum])
+        const PassNode& node = mPassGraph[nodeIdx];
+        if (node.isCulled) continue;
+
+        // Transition the pass' channels up front, so the transitions Falcor does when binding them are no-ops
+        issuePassBarriers(pRenderContext.get(), nodeIdx);
+
+        const ::RenderPass::SharedPtr& pPass = mActivePasses[node.passNum];
+        if (Falcor::gProfileEnabled)
+        {
+            // Insert a per-pass profiling event.  
+            assert(node.passNum < mProfileNames.size());
+            Falcor::ProfilerEvent _profileEvent(pPass->getName().c_str());
+            pPass->onExecute(pRenderContext.get());
+        }
+        else
         {
-            if (Falcor::gProfileEnabled)
-            {
-                // Insert a per-pass profiling event.  
-                assert(passNum < mProfileNames.size());
-                Falcor::ProfilerEvent _profileEvent(mActivePasses[passNum]->getName().c_str());
-                mActivePasses[passNum]->onExecute(pRenderContext.get());
-            }
-            else
-            {
-                mActivePasses[passNum]->onExecute(pRenderContext.get());
-            }
+            pPass->onExecute(pRenderContext.get());
         }
+
+        if (RayLaunch::isRayCountingEnabled()) updatePassRayCounts(nodeIdx);
+        updateLodRayOffset();
     }
 
+	if (isBenchmarkRunning()) endBenchmarkFrame(pSample);
+
+	// Remember how many triangles our passes drew this frame
+	mLastFrameTriangles = mFrameTriangles;
+
 	// Now that we're done rendering, grab out output texture and blit it into our target FBO
 	if (pTargetFbo && mpResourceManager->getTexture(mOutputBufferIndex))
 	{
@@ -694,12 +1045,31 @@ void RenderingPipeline::onFrameRender(SampleCallbacks* pSample, const RenderCont
 	pRenderContext->popGraphicsState();
 }
 
+void RenderingPipeline::updateLodRayOffset(void)
+{
+	RasterLaunch::DrawStats stats = RasterLaunch::collectDrawStats();
+	mFrameTriangles += stats.trianglesDrawn;
+	mRasterLodError = std::max(mRasterLodError, stats.maxLodError);
+
+	// Rays leave the rasterized surface, but are traced against the LODs in the acceleration structures.  Each LOD is within its error
+	//    of the full-resolution mesh, so the two surfaces are at most the sum of the errors apart.  Starting rays past that gap keeps them
+	//    from hitting the surface they left, at the cost of missing geometry closer than that.
+	if (mpResourceManager)
+	{
+		mpResourceManager->setMinTDist(mMinTArray[mMinTSelection] + mRasterLodError + mRtLodError);
+	}
+}
+
 void RenderingPipeline::onInitNewScene(RenderContext* pRenderContext, Scene::SharedPtr pScene)
 {
 	// Stash the scene in the pipeline
 	if (pScene) 
 		mpScene = pScene;
 
+	// Keep using the ray tracing LOD selected in the UI
+	RtScene::SharedPtr pRtScene = std::dynamic_pointer_cast<RtScene>(pScene);
+	if (pRtScene) pRtScene->setLodBias(uint32_t(mRtLodBias));
+
 	// When a new scene is loaded, we'll tell all our passes about it (not just active passes)
 	for (uint32_t i = 0; i < mAvailPasses.size(); i++)
 	{
@@ -746,6 +1116,10 @@ void RenderingPipeline::onShutdown(SampleCallbacks* pSample)
 			mAvailPasses[i]->onShutdown();
 		}
 	}
+
+	// Stop the streaming threads before the device goes away
+	TextureStreamer::setGlobalStreamer(nullptr);
+	GeometryStreamer::setGlobalStreamer(nullptr);
 }
 
 bool RenderingPipeline::onKeyEvent(SampleCallbacks* pSample, const KeyboardEvent& keyEvent)
@@ -843,6 +1217,285 @@ void RenderingPipeline::addPipeInstructions(const std::string &str)
 	mPipeDescription.push_back(str);
 }
 
+void RenderingPipeline::startBenchmark(const BenchmarkDesc& desc)
+{
+	if (isBenchmarkRunning())
+	{
+		logWarning("RenderingPipeline::startBenchmark() - a benchmark is already running");
+		return;
+	}
+
+	mBenchmark = BenchmarkRun();
+	mBenchmark.desc = desc;
+	mBenchmark.desc.frameCount = std::max(1u, desc.frameCount);
+	mBenchmark.state = BenchmarkState::Pending;
+}
+
+void RenderingPipeline::beginBenchmarkFrame(SampleCallbacks* pSample)
+{
+	if (mBenchmark.state == BenchmarkState::Pending)
+	{
+		// Counting rays recompiles the ray tracing shaders, so turn it on before waiting for them
+		if (mBenchmark.desc.countRays && !RayLaunch::isRayCountingEnabled())
+		{
+			setRayCountingEnabled(true);
+			mBenchmark.enabledRayCounting = true;
+		}
+
+		// Don't start until every pass can render, or the first frames would measure passes that skip their work
+		if (ProgramCompiler::getStats().pendingCount > 0) return;
+		if (mPipeRequiresScene && !mpScene) return;
+
+		mBenchmark.passNames.clear();
+		for (const PassNode& node : mPassGraph)
+		{
+			if (!node.isCulled) mBenchmark.passNames.push_back(mActivePasses[node.passNum]->getName());
+		}
+		mBenchmark.cpuTimes.assign(mBenchmark.passNames.size() + 1, std::vector<float>(mBenchmark.desc.frameCount, 0.0f));
+		mBenchmark.gpuTimes.assign(mBenchmark.passNames.size() + 1, std::vector<float>(mBenchmark.desc.frameCount, 0.0f));
+		mBenchmark.rayCounts.assign(mBenchmark.passNames.size() + 1, RayLaunch::RayCounts());
+		mBenchmark.gpuMemoryPeaks.assign(mBenchmark.desc.frameCount, 0);
+		mBenchmark.cpuMemoryPeak = 0;
+
+		// Passes are only timed while the profiler is enabled
+		mBenchmark.profileEnabled = Falcor::gProfileEnabled;
+		Falcor::gProfileEnabled = true;
+
+		// Follow the scene's camera path, if any
+		if (mpScene && mpScene->getPathCount() && !mUseSceneCameraPath)
+		{
+			mpScene->getPath(0)->attachObject(mpScene->getActiveCamera());
+			mBenchmark.attachedCameraPath = true;
+		}
+
+		// Describe what is being measured
+		char buf[1024];
+		uint64_t triangles = 0, modelInstances = 0, meshInstances = 0;
+		uint32_t lights = 0;
+		std::string sceneName;
+		if (mpScene)
+		{
+			for (uint32_t m = 0; m < mpScene->getModelCount(); m++)
+			{
+				uint32_t instanceCount = mpScene->getModelInstanceCount(m);
+				triangles += uint64_t(mpScene->getModel(m)->getPrimitiveCount()) * instanceCount;
+				modelInstances += instanceCount;
+				meshInstances += uint64_t(mpScene->getModel(m)->getInstanceCount()) * instanceCount;
+			}
+			lights = mpScene->getLightCount() + mpScene->getAreaLightCount();
+			sceneName = mpScene->getFilename();
+		}
+#ifdef _DEBUG
+		const char* configuration = "Debug";
+#else
+		const char* configuration = "Release";
+#endif
+#ifdef FALCOR_D3D12
+		const char* api = "D3D12";
+#else
+		const char* api = "Vulkan";
+#endif
+		sprintf_s(buf, "  \"scene\": \"%s\",\n  \"resolution\": [%u, %u],\n  \"build\": { \"configuration\": \"%s\", \"api\": \"%s\" },\n"
+			"  \"sceneStats\": { \"triangles\": %llu, \"modelInstances\": %llu, \"meshInstances\": %llu, \"lights\": %u },\n",
+			escapeJsonString(sceneName).c_str(), mLastKnownSize.x, mLastKnownSize.y, configuration, api,
+			(unsigned long long)triangles, (unsigned long long)modelInstances, (unsigned long long)meshInstances, lights);
+		mBenchmark.sceneStats = buf;
+
+		mBenchmark.state = BenchmarkState::Warmup;
+		mBenchmark.frame = 0;
+	}
+
+	// Each phase replays the same animation, starting at time 0
+	pSample->setCurrentTime(mBenchmark.desc.timeDelta * float(mBenchmark.frame));
+}
+
+void RenderingPipeline::endBenchmarkFrame(SampleCallbacks* pSample)
+{
+	if (mBenchmark.state == BenchmarkState::Pending) return;
+
+	// The measurements only make sense for the pipeline we started with
+	size_t passIdx = 0;
+	bool pipelineChanged = false;
+	for (const PassNode& node : mPassGraph)
+	{
+		if (node.isCulled) continue;
+		pipelineChanged |= (passIdx >= mBenchmark.passNames.size() || mBenchmark.passNames[passIdx] != mActivePasses[node.passNum]->getName());
+		passIdx++;
+	}
+	if (pipelineChanged || passIdx != mBenchmark.passNames.size())
+	{
+		logWarning("RenderingPipeline: the pipeline changed during the benchmark.  Cancelling it.");
+		finishBenchmark(pSample, false);
+		return;
+	}
+
+	if (mBenchmark.state == BenchmarkState::Warmup)
+	{
+		if (++mBenchmark.frame >= mBenchmark.desc.warmupFrames)
+		{
+			mBenchmark.state = BenchmarkState::Measure;
+			mBenchmark.frame = 0;
+		}
+		return;
+	}
+
+	// The profiler reports this frame's CPU times, but the GPU times of the previous frame.  So we measure
+	//    one extra frame, and file GPU times under the frame before.
+	uint32_t frame = mBenchmark.frame;
+	uint32_t passCount = uint32_t(mBenchmark.passNames.size());
+	float cpuTotal = 0, gpuTotal = 0;
+	for (uint32_t i = 0; i < passCount; i++)
+	{
+		const std::string& name = mBenchmark.passNames[i];
+		if (frame < mBenchmark.desc.frameCount)
+		{
+			float cpuTime = float(Profiler::getEventCpuTime(name));
+			mBenchmark.cpuTimes[i][frame] = cpuTime;
+			cpuTotal += cpuTime;
+		}
+		if (frame > 0)
+		{
+			float gpuTime = float(Profiler::getEventGpuTime(name));
+			mBenchmark.gpuTimes[i][frame - 1] = gpuTime;
+			gpuTotal += gpuTime;
+		}
+	}
+	if (frame < mBenchmark.desc.frameCount) mBenchmark.cpuTimes[passCount][frame] = cpuTotal;
+	if (frame > 0) mBenchmark.gpuTimes[passCount][frame - 1] = gpuTotal;
+
+	// Memory watermarks are also recorded when a frame ends, so they're filed like GPU times
+	if (frame > 0)
+	{
+		mBenchmark.gpuMemoryPeaks[frame - 1] = MemoryTracker::getLastFramePeakBytes();
+		mBenchmark.cpuMemoryPeak = std::max(mBenchmark.cpuMemoryPeak, MemoryTracker::getLastFrameCpuBytes());
+	}
+
+	// Ray counts are read back a few frames late.  Summed over the run, that makes a negligible difference.
+	if (mBenchmark.desc.countRays && frame < mBenchmark.desc.frameCount)
+	{
+		uint32_t passIdx = 0;
+		for (const PassNode& node : mPassGraph)
+		{
+			if (node.isCulled) continue;
+			mBenchmark.rayCounts[passIdx++] += node.rayCounts;
+			mBenchmark.rayCounts[passCount] += node.rayCounts;
+		}
+	}
+
+	if (++mBenchmark.frame > mBenchmark.desc.frameCount) finishBenchmark(pSample, true);
+}
+
+void RenderingPipeline::finishBenchmark(SampleCallbacks* pSample, bool writeReport)
+{
+	if (mBenchmark.state != BenchmarkState::Pending && mBenchmark.state != BenchmarkState::Idle)
+	{
+		Falcor::gProfileEnabled = mBenchmark.profileEnabled;
+		if (mBenchmark.attachedCameraPath && mpScene && mpScene->getPathCount())
+		{
+			mpScene->getPath(0)->detachObject(mpScene->getActiveCamera());
+		}
+	}
+	mBenchmark.state = BenchmarkState::Idle;
+	if (mBenchmark.enabledRayCounting)
+	{
+		setRayCountingEnabled(false);
+		mBenchmark.enabledRayCounting = false;
+	}
+
+	if (writeReport) writeBenchmarkReport();
+	if (mBenchmark.exitWhenDone) pSample->shutdown();
+}
+
+bool RenderingPipeline::writeBenchmarkReport()
+{
+	std::string filename = mBenchmark.desc.reportFilename;
+	if (filename.empty())
+	{
+		char date[64];
+		std::time_t now = std::time(nullptr);
+		std::strftime(date, sizeof(date), "%Y%m%d_%H%M%S", std::localtime(&now));
+		filename = getExecutableDirectory() + "/benchmark_" + date;
+	}
+
+	std::ofstream json(filename + ".json");
+	std::ofstream csv(filename + ".csv");
+	if (json.fail() || csv.fail())
+	{
+		logWarning("RenderingPipeline: can't write the benchmark report to " + filename + ".json/.csv");
+		return false;
+	}
+
+	json << "{\n" << mBenchmark.sceneStats;
+	json << "  \"warmupFrames\": " << mBenchmark.desc.warmupFrames << ",\n";
+	json << "  \"frames\": " << mBenchmark.desc.frameCount << ",\n";
+	json << "  \"timeDelta\": " << mBenchmark.desc.timeDelta << ",\n";
+	json << "  \"rayCounting\": " << (mBenchmark.desc.countRays ? "true" : "false") << ",\n";
+	json << "  \"memory\": " << memoryPeaksToJson(mBenchmark.gpuMemoryPeaks, mBenchmark.cpuMemoryPeak) << ",\n";
+	json << "  \"passes\": [\n";
+	csv << "pass,cpu_mean,cpu_median,cpu_p95,cpu_p99,cpu_stddev,cpu_min,cpu_max,gpu_mean,gpu_median,gpu_p95,gpu_p99,gpu_stddev,gpu_min,gpu_max,rays_per_frame,mrays_per_sec\n";
+
+	for (size_t i = 0; i <= mBenchmark.passNames.size(); i++)
+	{
+		std::string name = (i < mBenchmark.passNames.size()) ? mBenchmark.passNames[i] : "Total";
+		TimingStats cpu = computeTimingStats(mBenchmark.cpuTimes[i]);
+		TimingStats gpu = computeTimingStats(mBenchmark.gpuTimes[i]);
+		json << "    { \"name\": \"" << escapeJsonString(name) << "\",\n";
+		json << "      \"cpu\": " << timingStatsToJson(cpu) << ",\n";
+		json << "      \"gpu\": " << timingStatsToJson(gpu);
+
+		// Throughput, over the GPU time of all the measured frames
+		uint64_t rays = 0;
+		double mraysPerSec = 0;
+		if (mBenchmark.desc.countRays)
+		{
+			double gpuTimeMs = 0;
+			for (float t : mBenchmark.gpuTimes[i]) gpuTimeMs += t;
+			rays = mBenchmark.rayCounts[i].getTotal();
+			mraysPerSec = computeMraysPerSec(rays, gpuTimeMs);
+			json << ",\n      \"rays\": " << rayCountsToJson(mBenchmark.rayCounts[i], mBenchmark.desc.frameCount, gpuTimeMs);
+		}
+		json << " }" << ((i < mBenchmark.passNames.size()) ? ",\n" : "\n");
+		csv << "\"" << name << "\"," << timingStatsToCsv(cpu) << "," << timingStatsToCsv(gpu) << "," << (rays / mBenchmark.desc.frameCount) << "," << mraysPerSec << "\n";
+	}
+	json << "  ]\n}\n";
+
+	logInfo("RenderingPipeline: wrote benchmark report to " + filename + ".json");
+	return true;
+}
+
+void RenderingPipeline::setRayCountingEnabled(bool enabled)
+{
+	RayLaunch::setRayCountingEnabled(enabled);
+
+	// Forget the last counts, and their throughput in the profiler window
+	for (PassNode& node : mPassGraph)
+	{
+		node.rayCounts = RayLaunch::RayCounts();
+		if (!enabled) Profiler::setEventAnnotation(node.passName, "");
+	}
+}
+
+void RenderingPipeline::updatePassRayCounts(uint32_t nodeIdx)
+{
+	PassNode& node = mPassGraph[nodeIdx];
+	node.rayCounts = RayLaunch::collectRayCounts();
+
+	// Show the pass' throughput next to its times in the profiler window.  The profiler's GPU times are a frame late,
+	//    and the counts a few frames late, which is close enough for a display.
+	if (Falcor::gProfileEnabled)
+	{
+		uint64_t rays = node.rayCounts.getTotal();
+		std::string annotation;
+		if (rays > 0)
+		{
+			char buf[64];
+			sprintf_s(buf, "%.1f Mrays/s", computeMraysPerSec(rays, Profiler::getEventGpuTime(node.passName)));
+			annotation = buf;
+		}
+		Profiler::setEventAnnotation(node.passName, annotation);
+	}
+}
+
 void RenderingPipeline::extractProfilingData(void)
 {
 	// This is a pretty ugly method.  It basically undoes Falcor's standard
@@ -883,6 +1536,267 @@ void RenderingPipeline::extractProfilingData(void)
 }
 
 
+void RenderingPipeline::buildPassGraph(void)
+{
+	mPassGraph.clear();
+	for (uint32_t passNum = 0; passNum < mActivePasses.size(); passNum++)
+	{
+		if (!mActivePasses[passNum]) continue;
+
+		PassNode node;
+		node.passNum = passNum;
+		node.passName = mActivePasses[passNum]->getName();
+		node.usage = mpResourceManager->getChannelUsage(mActivePasses[passNum].get());
+		mPassGraph.push_back(node);
+	}
+	uint32_t nodeCount = uint32_t(mPassGraph.size());
+
+	// Find how a node accesses a channel (returns nullptr if it doesn't)
+	auto findUsage = [this](uint32_t nodeIdx, int32_t channel) -> const ResourceManager::ChannelUsage*
+	{
+		for (const auto& use : mPassGraph[nodeIdx].usage)
+		{
+			if (use.channel == channel) return &use;
+		}
+		return nullptr;
+	};
+
+	// Find the node whose output <reader> sees when reading <channel>: the closest writer earlier in the pipeline or, failing that,
+	//    the last writer in the pipeline (whose output is left over from the previous frame).  Returns -1 if no pass writes the channel.
+	auto findProducer = [&](uint32_t reader, int32_t channel) -> int32_t
+	{
+		for (uint32_t i = 1; i <= nodeCount; i++)
+		{
+			uint32_t nodeIdx = (reader + nodeCount - i) % nodeCount;
+			const ResourceManager::ChannelUsage* pUse = findUsage(nodeIdx, channel);
+			if (pUse && writesChannel(pUse->access)) return int32_t(nodeIdx);
+		}
+		return -1;
+	};
+
+	// Build the edges, and look for reads that will not see what the pipeline order suggests.  Undeclared accesses are
+	//    assumed to read and write, so they create edges, but we can't tell whether they are hazards.
+	std::vector<std::string> hazards;
+	for (uint32_t nodeIdx = 0; nodeIdx < nodeCount; nodeIdx++)
+	{
+		PassNode& node = mPassGraph[nodeIdx];
+		for (const auto& use : node.usage)
+		{
+			std::string channelName = mpResourceManager->getTextureName(use.channel);
+			if (readsChannel(use.access))
+			{
+				int32_t producer = findProducer(nodeIdx, use.channel);
+				if (producer < 0)
+				{
+					if (use.declared && !mpResourceManager->isExternalTexture(use.channel))
+						hazards.push_back("'" + node.passName + "' reads '" + channelName + "', which no active pass writes");
+				}
+				else if (producer != int32_t(nodeIdx))
+				{
+					bool previousFrame = producer > int32_t(nodeIdx);
+					node.dependencies.push_back({ uint32_t(producer), use.channel, previousFrame });
+					if (previousFrame && use.declared && use.access == ResourceManager::ChannelAccess::Read)
+					{
+						hazards.push_back("'" + node.passName + "' reads '" + channelName + "' before '" + mPassGraph[producer].passName +
+							"' writes it, so it sees the previous frame's data");
+					}
+				}
+			}
+
+			// A write that the next pass accessing the channel overwrites without reading is lost
+			if (use.declared && use.access == ResourceManager::ChannelAccess::Write)
+			{
+				for (uint32_t next = nodeIdx + 1; next < nodeCount; next++)
+				{
+					const ResourceManager::ChannelUsage* pNextUse = findUsage(next, use.channel);
+					if (!pNextUse) continue;
+					if (pNextUse->declared && pNextUse->access == ResourceManager::ChannelAccess::Write)
+					{
+						hazards.push_back("'" + mPassGraph[next].passName + "' overwrites '" + channelName + "' before anything reads what '" +
+							node.passName + "' wrote");
+					}
+					break;
+				}
+			}
+		}
+	}
+
+	// Mark the passes that contribute to the output.  We only skip passes that declared all their accesses and write something,
+	//    since a pass that doesn't tell us what it does may have side effects we can't see.
+	std::vector<bool> isLive(nodeCount, false);
+	std::vector<uint32_t> liveStack;
+	for (uint32_t nodeIdx = 0; nodeIdx < nodeCount; nodeIdx++)
+	{
+		const auto& usage = mPassGraph[nodeIdx].usage;
+		bool allDeclared = std::all_of(usage.begin(), usage.end(), [](const ResourceManager::ChannelUsage& use) { return use.declared; });
+		bool writesAnything = std::any_of(usage.begin(), usage.end(), [](const ResourceManager::ChannelUsage& use) { return writesChannel(use.access); });
+		const ResourceManager::ChannelUsage* pOutputUse = findUsage(nodeIdx, mOutputBufferIndex);
+		bool writesOutput = pOutputUse && writesChannel(pOutputUse->access);
+
+		if (!mCullUnusedPasses || usage.empty() || !allDeclared || !writesAnything || writesOutput)
+		{
+			isLive[nodeIdx] = true;
+			liveStack.push_back(nodeIdx);
+		}
+	}
+	while (!liveStack.empty())
+	{
+		uint32_t nodeIdx = liveStack.back();
+		liveStack.pop_back();
+		for (const auto& use : mPassGraph[nodeIdx].usage)
+		{
+			if (!readsChannel(use.access)) continue;
+			int32_t producer = findProducer(nodeIdx, use.channel);
+			if (producer >= 0 && !isLive[producer])
+			{
+				isLive[producer] = true;
+				liveStack.push_back(uint32_t(producer));
+			}
+		}
+	}
+
+	// Work out the barriers each live pass needs by tracking the state of every channel through the pipeline.  The first iteration finds
+	//    the states channels are left in at the end of a frame, which is what the next frame starts with; the second records the barriers.
+	//    Reads use the same state Falcor transitions shader resources to when they're bound, so these never add work at bind time.
+	struct ChannelState
+	{
+		Resource::State state;
+		int32_t lastWriter;
+	};
+	std::unordered_map<int32_t, ChannelState> channelStates;
+	for (uint32_t iteration = 0; iteration < 2; iteration++)
+	{
+		for (uint32_t nodeIdx = 0; nodeIdx < nodeCount; nodeIdx++)
+		{
+			PassNode& node = mPassGraph[nodeIdx];
+			node.isCulled = !isLive[nodeIdx];
+			if (node.isCulled) continue;
+
+			const ::RenderPass::SharedPtr& pPass = mActivePasses[node.passNum];
+			bool writesUavs = pPass->usesRayTracing() || pPass->usesCompute();
+			for (const auto& use : node.usage)
+			{
+				Texture::SharedPtr pTex = mpResourceManager->getTexture(use.channel);
+				if (!pTex) continue;
+
+				// We don't know what state an undeclared access leaves the channel in, so leave its barriers to Falcor
+				if (!use.declared)
+				{
+					channelStates.erase(use.channel);
+					continue;
+				}
+
+				Resource::State required = Resource::State::ShaderResource;
+				if (writesChannel(use.access))
+				{
+					if (isDepthStencilFormat(pTex->getFormat()))
+						required = Resource::State::DepthStencil;
+					else if (writesUavs && is_set(pTex->getBindFlags(), Resource::BindFlags::UnorderedAccess))
+						required = Resource::State::UnorderedAccess;
+					else
+						required = Resource::State::RenderTarget;
+				}
+
+				auto state = channelStates.find(use.channel);
+				if (iteration > 0)
+				{
+					if (state == channelStates.end() || state->second.state != required)
+						node.barriers.push_back({ use.channel, required, false });
+					else if (required == Resource::State::UnorderedAccess && state->second.lastWriter >= 0 && state->second.lastWriter != int32_t(nodeIdx))
+						node.barriers.push_back({ use.channel, required, true });
+				}
+
+				int32_t lastWriter = (state == channelStates.end()) ? -1 : state->second.lastWriter;
+				channelStates[use.channel] = { required, writesChannel(use.access) ? int32_t(nodeIdx) : lastWriter };
+			}
+		}
+
+		// The output is blitted to the screen after the passes execute
+		channelStates[mOutputBufferIndex] = { Resource::State::ShaderResource, -1 };
+	}
+
+	// Report new problems once, when the pipeline changes, rather than every frame
+	if (hazards != mPassHazards)
+	{
+		for (const auto& hazard : hazards)
+		{
+			logWarning("Rendering pipeline hazard: " + hazard);
+		}
+	}
+	mPassHazards = hazards;
+}
+
+void RenderingPipeline::issuePassBarriers(RenderContext* pRenderContext, uint32_t nodeIdx)
+{
+	for (const PassBarrier& barrier : mPassGraph[nodeIdx].barriers)
+	{
+		Texture::SharedPtr pTex = mpResourceManager->getTexture(barrier.channel);
+		if (!pTex) continue;
+
+		if (barrier.isUavBarrier)
+			pRenderContext->uavBarrier(pTex.get());
+		else
+			pRenderContext->resourceBarrier(pTex.get(), barrier.state);
+	}
+}
+
+std::string RenderingPipeline::getPassGraphDump() const
+{
+	// List channels a node accesses in a particular way.  Undeclared accesses are marked with a '?'
+	auto listChannels = [this](const PassNode& node, bool wantWrites) -> std::string
+	{
+		std::string list;
+		for (const auto& use : node.usage)
+		{
+			if ((wantWrites ? writesChannel(use.access) : readsChannel(use.access)) == false) continue;
+			list += (list.empty() ? "" : ", ") + mpResourceManager->getTextureName(use.channel) + (use.declared ? "" : "?");
+		}
+		return list.empty() ? "-" : list;
+	};
+
+	std::string dump;
+	for (const PassNode& node : mPassGraph)
+	{
+		dump += std::to_string(node.passNum) + ": " + node.passName + (node.isCulled ? "  (skipped, outputs unused)" : "") + "\n";
+		dump += "    reads:    " + listChannels(node, false) + "\n";
+		dump += "    writes:   " + listChannels(node, true) + "\n";
+
+		if (!node.dependencies.empty())
+		{
+			dump += "    after:    ";
+			for (size_t i = 0; i < node.dependencies.size(); i++)
+			{
+				const PassDependency& dep = node.dependencies[i];
+				dump += (i > 0 ? ", " : "") + std::to_string(mPassGraph[dep.node].passNum) + " (" + mpResourceManager->getTextureName(dep.channel) +
+					(dep.previousFrame ? ", last frame)" : ")");
+			}
+			dump += "\n";
+		}
+
+		if (!node.isCulled && !node.barriers.empty())
+		{
+			dump += "    barriers: ";
+			for (size_t i = 0; i < node.barriers.size(); i++)
+			{
+				const PassBarrier& barrier = node.barriers[i];
+				dump += (i > 0 ? ", " : "") + mpResourceManager->getTextureName(barrier.channel) + " -> " +
+					(barrier.isUavBarrier ? std::string("UAV barrier") : to_string(barrier.state));
+			}
+			dump += "\n";
+		}
+	}
+
+	if (!mPassHazards.empty())
+	{
+		dump += "Hazards:\n";
+		for (const auto& hazard : mPassHazards)
+		{
+			dump += "    " + hazard + "\n";
+		}
+	}
+	return dump;
+}
+
 void RenderingPipeline::run(RenderingPipeline *pipe, SampleConfig &config)
 {
 	pipe->updatePipelineRequirementFlags();
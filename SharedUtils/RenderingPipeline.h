@@ -19,6 +19,8 @@
 #pragma once
 #include "Falcor.h"
 #include "RenderPass.h"
+#include "RayLaunch.h"
+#include "RasterLaunch.h"
 #include "ResourceManager.h"
 
 class RenderingPipeline : public Renderer, inherit_shared_from_this<Renderer, RenderingPipeline>
@@ -49,6 +51,45 @@ public:
 	*/
 	uint32_t addPass(::RenderPass::SharedPtr pNewPass);
 
+	/** Stream scene textures on demand instead of loading them fully resident.  Must be called before the scene is loaded.
+	    \param[in] memoryBudget Maximum number of bytes of streamed texture data resident at once
+	*/
+	void enableTextureStreaming(uint64_t memoryBudget);
+
+	/** Page scene geometry in and out on demand, so that scenes larger than GPU memory can be rendered.  Must be called before the scene is loaded.
+	    Large meshes are split into clusters; clusters that aren't resident are drawn with a coarse proxy.
+	    \param[in] memoryBudget Maximum number of bytes of streamed geometry resident at once
+	*/
+	void enableGeometryStreaming(uint64_t memoryBudget);
+
+	/** Settings for a benchmark run.  See startBenchmark().
+	*/
+	struct BenchmarkDesc
+	{
+		uint32_t warmupFrames = 120;        ///< Frames rendered before measuring, so caches, streaming and shader compilation settle
+		uint32_t frameCount = 600;          ///< Frames measured
+		float timeDelta = 1.0f / 60.0f;     ///< Animation time advanced per frame, independent of the actual frame rate
+		std::string reportFilename;         ///< Report path without extension.  Defaults to "benchmark_<date>_<time>" next to the executable
+		bool countRays = false;             ///< Also report the rays each pass traces, and its Mrays/s.  The counters add a little GPU time
+	};
+
+	/** Render a fixed sequence of frames and write per-pass CPU and GPU timing statistics (mean, median, p95, p99, stddev) to <reportFilename>.json and .csv.
+	    The camera follows the scene's first camera path, if it has one, and animation time is advanced by a fixed step per frame, so runs are reproducible.
+	    Also started by the "-benchmark [warmupFrames frameCount [reportFilename]]" command line argument, in which case the application exits when done.
+	    Add "-countRays" to the command line to count rays, as with BenchmarkDesc::countRays.
+	    Compare two reports with Falcor/Tests/CompareBenchmarks.py.
+	*/
+	void startBenchmark(const BenchmarkDesc& desc);
+
+	/** Returns true while a benchmark is running.
+	*/
+	bool isBenchmarkRunning() const { return mBenchmark.state != BenchmarkState::Idle; }
+
+	/** Returns a human-readable description of the pass dependency graph derived from the channels each active pass reads and writes:
+	    execution order, channels, dependencies, skipped passes, barriers, and any read-after-write hazards.
+	*/
+	std::string getPassGraphDump() const;
+
 	/** To start running the application with this rendering pipeline, call this method
 	*/
 	static void run(RenderingPipeline *pipe, SampleConfig &config);
@@ -111,9 +152,29 @@ private:
 	// Update the mPipeRequires* member variables
 	void updatePipelineRequirementFlags(void);
 
+	// Collect the draw stats of the raster passes run since the last call, and move the ray tracing min traversal distance past the gap
+	//     between the rasterized mesh LODs and the ones in the acceleration structures.  Called after each pass, so later passes use it.
+	void updateLodRayOffset(void);
+
 	// Extract profiling data
 	void extractProfilingData(void);
 
+	// Benchmark mode.  Called at the start of each frame to lock time and the camera, and after the passes ran to record their timings.
+	void beginBenchmarkFrame(SampleCallbacks* pSample);
+	void endBenchmarkFrame(SampleCallbacks* pSample);
+	void finishBenchmark(SampleCallbacks* pSample, bool writeReport);
+	bool writeBenchmarkReport();
+
+	// Ray counting (see RayLaunch::setRayCountingEnabled()).  Attributes the rays counted since the last call to a pass.
+	void setRayCountingEnabled(bool enabled);
+	void updatePassRayCounts(uint32_t nodeIdx);
+
+	// Rebuild the pass dependency graph from the channel usage the active passes declared to the resource manager
+	void buildPassGraph(void);
+
+	// Issue the resource barriers a pass needs before it executes
+	void issuePassBarriers(RenderContext* pRenderContext, uint32_t nodeIdx);
+
 	enum UIOptions { CanRemove = 0x1u, CanAddAfter = 0x2u };
 
 	// Internal state
@@ -128,10 +189,43 @@ private:
 	bool mIsInitialized = false;
 	bool mDoProfiling = false;
     bool mProfileToggle = false;
+	int32_t mTraceFrameWindow = 120;                        ///< Number of frames kept by the profiler's trace
+
+	enum class BenchmarkState { Idle, Pending, Warmup, Measure };
+	struct BenchmarkRun
+	{
+		BenchmarkDesc desc;
+		BenchmarkState state = BenchmarkState::Idle;
+		uint32_t frame = 0;                                 ///< Frame within the current state
+		bool exitWhenDone = false;
+		std::vector< std::string > passNames;               ///< Passes measured, in execution order.  The profiler events have the same names
+		std::vector< std::vector<float> > cpuTimes;         ///< [pass][frame], in ms.  The last entry is the sum over passes
+		std::vector< std::vector<float> > gpuTimes;
+		std::vector< RayLaunch::RayCounts > rayCounts;      ///< [pass], summed over the measured frames.  The last entry is the sum over passes
+		std::vector< uint64_t > gpuMemoryPeaks;             ///< [frame], the most GPU memory allocated during the frame, in bytes
+		uint64_t cpuMemoryPeak = 0;                         ///< The most CPU memory the process used at the end of a measured frame, in bytes
+		std::string sceneStats;                             ///< Scene, resolution and build description, as JSON members
+
+		// State restored when the run ends
+		bool profileEnabled = false;
+		bool attachedCameraPath = false;
+		bool enabledRayCounting = false;
+	} mBenchmark;
+	int32_t mBenchmarkWarmupFrames = 120;                   ///< UI settings for the next benchmark run
+	int32_t mBenchmarkFrameCount = 600;
 	bool mFirstFrame = true;
 	bool mUseSceneCameraPath = false;
 	bool mFreezeTime = true;
 	bool mGlobalPipeRefresh = false;
+	int32_t mRtLodBias = 0;                                 ///< Mesh LOD used when building ray tracing acceleration structures
+	uint64_t mLastFrameTriangles = 0;                       ///< Triangles rasterized by scene renderers during the last frame
+	uint64_t mFrameTriangles = 0;                           ///< Triangles rasterized so far this frame
+	float mRasterLodError = 0.0f;                           ///< Largest world-space error of the mesh LODs rasterized so far this frame
+	float mRtLodError = 0.0f;                               ///< Largest world-space error of the mesh LODs in the acceleration structures
+	CpuTimer::TimePoint mLoadStartTime;                     ///< When onLoad() started.  Used to report how long it took for every pass' shaders to compile
+	ProgramCompiler::Stats mLoadCompileStats;               ///< Compiler stats when onLoad() started
+	bool mStartupReported = false;
+	std::string mStartupReport;                             ///< Startup time vs. shader compile time, displayed in the UI
 	ResourceManager::SharedPtr mpResourceManager;
 	int32_t mOutputBufferIndex = 0;
 	Scene::SharedPtr mpScene = nullptr;                     ///< Stash a copy of our scene
@@ -142,6 +236,33 @@ private:
 	std::vector< double > mProfileGPUTimes;
     std::vector< double > mProfileLastGPUTimes;
 
+	// The pass dependency graph.  Passes still execute in slot order; the graph decides which of them run and what barriers precede them.
+	struct PassDependency
+	{
+		uint32_t node;                                      ///< The node producing the channel
+		int32_t  channel;                                   ///< The channel read
+		bool     previousFrame;                             ///< The producer runs later in the pipeline, so this reads last frame's data
+	};
+	struct PassBarrier
+	{
+		int32_t         channel;
+		Resource::State state;
+		bool            isUavBarrier;                       ///< Wait for earlier UAV writes instead of transitioning
+	};
+	struct PassNode
+	{
+		uint32_t passNum;                                   ///< Slot in mActivePasses
+		std::string passName;
+		std::vector<ResourceManager::ChannelUsage> usage;   ///< Channels the pass accesses
+		std::vector<PassDependency> dependencies;
+		std::vector<PassBarrier> barriers;                  ///< Issued before the pass executes
+		bool isCulled = false;                              ///< Nothing consumes the pass' outputs, so it is skipped
+		RayLaunch::RayCounts rayCounts;                     ///< Rays the pass traced in a recent frame, while counting rays
+	};
+	std::vector< PassNode > mPassGraph;                     ///< One node per non-null active pass, in execution order
+	std::vector< std::string > mPassHazards;                ///< Problems found in the current pipeline, displayed in the UI
+	bool mCullUnusedPasses = true;                          ///< Skip passes whose outputs nobody reads
+
 	// Are we storing an environment map?
 	Gui::DropdownList mEnvMapSelector;
 
@@ -17,11 +17,22 @@
 **********************************************************************************************************************/
 
 #include "ResourceManager.h"
+#include <algorithm>
 
 // The fixed resource name of our output channel
 const std::string ResourceManager::kOutputChannel  = "PipelineOutput";
 const std::string ResourceManager::kEnvironmentMap = "EnvironmentMap";
 
+namespace {
+	// Account a channel's texture under the channel's name in the memory tracker
+	void tagChannelTexture(const Texture::SharedPtr &texture, const std::string &name)
+	{
+		if (!texture) return;
+		texture->setName("Channel " + name);
+		MemoryTracker::setCategory(texture.get(), MemoryTracker::Category::Channel);
+	}
+};
+
 ResourceManager::SharedPtr ResourceManager::create(uint32_t width, uint32_t height, SampleCallbacks *callbacks)
 {
 	return SharedPtr(new ResourceManager(width, height, callbacks));
@@ -47,10 +58,12 @@ void ResourceManager::resize(uint32_t width, uint32_t height)
 	for (int32_t i = 0; i < int32_t(mTextures.size()); i++)
 	{
 		// Only resize textures that are defined to be screensize
-		if (mTextureSizes[i] != ivec2(-1, -1)) continue;
+		ManagedTexture &tex = mTextures[i];
+		if (tex.size != ivec2(-1, -1)) continue;
 
 		// Recreate our texture with the new size
-		mTextures[i] = Texture::create2D(mWidth, mHeight, mTextureFormat[i], 1u, 1u, nullptr, mTextureFlags[i]);
+		tex.texture = Texture::create2D(mWidth, mHeight, tex.format, 1u, 1u, nullptr, tex.flags);
+		tagChannelTexture(tex.texture, tex.name);
 	}
 
 	mUpdatedFlag = true;
@@ -62,12 +75,16 @@ void ResourceManager::initializeResources()
 	for (int32_t i = 0; i < int32_t(mTextures.size()); i++)
 	{
 		// Either use explicitly specified texture sizes, or if no size specified texture is assumed to be full-screen
-		uint32_t texWidth = mTextureSizes[i].x <= 0 ? mWidth : mTextureSizes[i].x;
-		uint32_t texHeight = mTextureSizes[i].y <= 0 ? mHeight : mTextureSizes[i].y;
+		ManagedTexture &tex = mTextures[i];
+		uint32_t texWidth = tex.size.x <= 0 ? mWidth : tex.size.x;
+		uint32_t texHeight = tex.size.y <= 0 ? mHeight : tex.size.y;
 
 		// Create the resource (unless it already exists, because a pass created it and passed it in to be managed)
-		if (!mTextures[i])
-			mTextures[i] = Texture::create2D(texWidth, texHeight, mTextureFormat[i], 1u, 1u, nullptr, mTextureFlags[i]);
+		if (!tex.texture)
+		{
+			tex.texture = Texture::create2D(texWidth, texHeight, tex.format, 1u, 1u, nullptr, tex.flags);
+			tagChannelTexture(tex.texture, tex.name);
+		}
 	}
 
 	mIsInitialized = true;
@@ -115,7 +132,7 @@ uvec2 ResourceManager::getEnvironmentMapSize() const
 	int32_t existingIndex = getTextureIndex(ResourceManager::kEnvironmentMap);
 	if (existingIndex < 0) return uvec2(0, 0);
 
-	return uvec2( mTextureSizes[existingIndex] );
+	return uvec2( mTextures[existingIndex].size );
 }
 
 int32_t ResourceManager::manageTextureResource(const std::string &channelName, Texture::SharedPtr sharedTex)
@@ -124,50 +141,64 @@ int32_t ResourceManager::manageTextureResource(const std::string &channelName, T
 	int32_t existingIndex = getTextureIndex(channelName);
 
 	// No existing resource with that name.  Create one.
-	if (existingIndex <= 0)
+	if (existingIndex < 0)
 	{
-		existingIndex = int32_t(mTextures.size());
-		mTextures.push_back(nullptr);
-		mTextureSizes.push_back(ivec2(-1, -1));
-		mTextureNames.push_back(channelName);
-		mTextureFlags.push_back(kDefaultFlags);
-		mTextureFormat.push_back(sharedTex->getFormat());
+		existingIndex = addTexture(channelName, ivec2(-1, -1), kDefaultFlags, sharedTex->getFormat());
 	}
 
 	// Override requested resolution and format based on the incoming texture
-	mTextureFormat[existingIndex] = sharedTex->getFormat();
-	mTextureSizes[existingIndex] = ivec2(sharedTex->getWidth(), sharedTex->getHeight());
+	ManagedTexture &tex = mTextures[existingIndex];
+	tex.format = sharedTex->getFormat();
+	tex.size = ivec2(sharedTex->getWidth(), sharedTex->getHeight());
 
 	// Store our texture pointer
-	mTextures[existingIndex] = sharedTex;
+	tex.texture = sharedTex;
 
 	// Since we passed in an existing texture, it has the usage flags it was created with. 
-	mTextureFlags[existingIndex] = kDefaultFlags;
+	tex.flags = kDefaultFlags;
+
+	// Not produced by a pass every frame, so readers don't need an earlier pass in the pipeline to write it
+	tex.isExternal = true;
 
 	// Make sure to note that our resources have updated
 	mUpdatedFlag = true;
 	return existingIndex;
 }
 
+int32_t ResourceManager::addTexture(const std::string &channelName, const glm::ivec2 &size, Resource::BindFlags flags, ResourceFormat format)
+{
+	int32_t index = int32_t(mTextures.size());
+	mTextures.push_back({ nullptr, channelName, size, flags, format, false });
+	mTextureIndices[channelName] = index;
+	return index;
+}
+
 int32_t ResourceManager::getTextureIndex(const std::string &channelName) const
 {
-	auto item = std::find(mTextureNames.begin(), mTextureNames.end(), channelName);
-	int32_t channelIdx = int32_t(item - mTextureNames.begin());
-	return (channelIdx >= mTextureNames.size()) ? -1 : channelIdx;
+	auto item = mTextureIndices.find(channelName);
+	return (item == mTextureIndices.end()) ? -1 : item->second;
 }
 
 std::string ResourceManager::getTextureName(int32_t channelIdx)
 {
-	if (channelIdx < 0 || channelIdx >= mTextureNames.size()) 
+	if (channelIdx < 0 || channelIdx >= int32_t(mTextures.size())) 
 		return std::string("< Invalid Channel >");
-	return mTextureNames[channelIdx];
+	return mTextures[channelIdx].name;
 }
 
 Texture::SharedPtr ResourceManager::getTexture(int32_t channelIdx)
 {
-	if (channelIdx < 0 || channelIdx >= mTextures.size())
+	if (channelIdx < 0 || channelIdx >= int32_t(mTextures.size()))
 		return nullptr;
-	return mTextures[channelIdx];
+	return mTextures[channelIdx].texture;
+}
+
+const Texture::SharedPtr &ResourceManager::getTexture(TextureHandle handle) const
+{
+	static const Texture::SharedPtr kNullTexture;
+	if (handle.mIndex < 0 || handle.mIndex >= int32_t(mTextures.size()))
+		return kNullTexture;
+	return mTextures[handle.mIndex].texture;
 }
 
 Texture::SharedPtr ResourceManager::getTexture(const std::string &channelName)
@@ -193,6 +224,15 @@ Texture::SharedPtr ResourceManager::getClearedTexture(int32_t channelIdx, vec4 &
 	return channel;
 }
 
+Texture::SharedPtr ResourceManager::getClearedTexture(TextureHandle handle, const vec4 &clearColor)
+{
+	const Texture::SharedPtr &channel = getTexture(handle);
+	if (!channel) return nullptr;
+
+	mpAppCallbacks->getRenderContext()->clearUAV(channel->getUAV().get(), clearColor);
+	return channel;
+}
+
 void ResourceManager::clearTexture(Texture::SharedPtr &tex, const vec4 &clearColor)
 {
 	// Figure out what type of texture this is
@@ -209,6 +249,25 @@ void ResourceManager::clearTexture(Texture::SharedPtr &tex, const vec4 &clearCol
 
 int32_t ResourceManager::requestTextureResource(const std::string &channelName, 
 	ResourceFormat channelFormat, Resource::BindFlags usageFlags, int32_t channelWidth, int32_t channelHeight)
+{
+	int32_t index = requestChannel(channelName, channelFormat, usageFlags, channelWidth, channelHeight);
+
+	// We don't know how the pass uses this channel, so the pipeline has to assume the worst.  (Record usage even if the request
+	//    conflicted with an earlier one; the pass may still access the existing channel by name.)
+	recordChannelUsage(getTextureIndex(channelName), ChannelAccess::ReadWrite, false);
+	return index;
+}
+
+int32_t ResourceManager::requestTextureResource(const std::string &channelName, ChannelAccess access,
+	ResourceFormat channelFormat, Resource::BindFlags usageFlags, int32_t channelWidth, int32_t channelHeight)
+{
+	int32_t index = requestChannel(channelName, channelFormat, usageFlags, channelWidth, channelHeight);
+	recordChannelUsage(getTextureIndex(channelName), access, true);
+	return index;
+}
+
+int32_t ResourceManager::requestChannel(const std::string &channelName, 
+	ResourceFormat channelFormat, Resource::BindFlags usageFlags, int32_t channelWidth, int32_t channelHeight)
 {
 	// See if we've already defined this texture
 	int32_t existingIndex = getTextureIndex(channelName);
@@ -216,23 +275,19 @@ int32_t ResourceManager::requestTextureResource(const std::string &channelName,
 	if (existingIndex >= 0)
 	{
 		// Check for mismatches that might mean requestors for this buffer have conflicting needs
-		if (channelFormat != mTextureFormat[existingIndex]) return -1;
-		if (mTextureSizes[existingIndex] != ivec2(channelWidth, channelHeight)) return -1;
+		ManagedTexture &tex = mTextures[existingIndex];
+		if (channelFormat != tex.format) return -1;
+		if (tex.size != ivec2(channelWidth, channelHeight)) return -1;
 
 		// If we've asked for more usage types than anyone else, update the resource
-		mTextureFlags[existingIndex] |= usageFlags;
+		tex.flags |= usageFlags;
 
 		// Looks like a match!  Return an index for the exisitng resource
 		return existingIndex;
 	}
 
-	// No existing resource with that name.  Create one.
-	existingIndex = int32_t(mTextures.size());
-	mTextures.push_back(nullptr);    // We'll actually create the resource in initializeResources()
-	mTextureSizes.push_back(ivec2(channelWidth, channelHeight));
-	mTextureNames.push_back(channelName);
-	mTextureFlags.push_back(usageFlags);
-	mTextureFormat.push_back(channelFormat);
+	// No existing resource with that name.  Create one.  We'll actually create the resource in initializeResources()
+	existingIndex = addTexture(channelName, ivec2(channelWidth, channelHeight), usageFlags, channelFormat);
 
 	// While we haven't changed existing resources, it's probably good to notify users that resources available have changed
 	mUpdatedFlag = true;
@@ -250,6 +305,48 @@ void ResourceManager::requestTextureResources(const std::vector<std::string> &ch
 	}
 }
 
+void ResourceManager::requestTextureResources(const std::vector<std::string> &channelNames, ChannelAccess access,
+	ResourceFormat channelFormat, Resource::BindFlags usageFlags, int32_t channelWidth, int32_t channelHeight)
+{
+	for (uint32_t i = 0; i < channelNames.size(); i++)
+	{
+		requestTextureResource(channelNames[i], access, channelFormat, usageFlags, channelWidth, channelHeight);
+	}
+}
+
+void ResourceManager::recordChannelUsage(int32_t channelIdx, ChannelAccess access, bool declared)
+{
+	if (!mpRequestingPass || channelIdx < 0) return;
+
+	// If the pass requests the same channel more than once, merge the accesses.  A declared access overrides an undeclared one.
+	std::vector<ChannelUsage> &usage = mChannelUsage[mpRequestingPass];
+	for (auto &use : usage)
+	{
+		if (use.channel != channelIdx) continue;
+		if (declared && !use.declared)
+			use = { channelIdx, access, true };
+		else if (declared == use.declared)
+			use.access = ChannelAccess(uint32_t(use.access) | uint32_t(access));
+		return;
+	}
+	usage.push_back({ channelIdx, access, declared });
+}
+
+void ResourceManager::withdrawChannelAccess(int32_t channelIdx)
+{
+	if (!mpRequestingPass) return;
+
+	std::vector<ChannelUsage> &usage = mChannelUsage[mpRequestingPass];
+	usage.erase(std::remove_if(usage.begin(), usage.end(), [channelIdx](const ChannelUsage &use) { return use.channel == channelIdx; }), usage.end());
+}
+
+const std::vector<ResourceManager::ChannelUsage> &ResourceManager::getChannelUsage(const ::RenderPass *pPass) const
+{
+	static const std::vector<ChannelUsage> kNoUsage;
+	auto item = mChannelUsage.find(pPass);
+	return (item == mChannelUsage.end()) ? kNoUsage : item->second;
+}
+
 void ResourceManager::setDefaultSceneName(const std::string &sceneFilename) 
 { 
 	mDefaultSceneName = sceneFilename; 
@@ -267,10 +364,10 @@ Fbo::SharedPtr ResourceManager::createManagedFbo(const std::vector<int32_t> &col
 	if (depthStencilBufIdx >= 0 && depthStencilBufIdx < int32_t(mTextures.size()))
 	{
 		// Was that texture set up with a DepthStencil format and binding flag?
-		if (isDepthStencilFormat(mTextureFormat[depthStencilBufIdx]) && 
+		if (isDepthStencilFormat(mTextures[depthStencilBufIdx].format) && 
 			hasBindFlag(depthStencilBufIdx, Resource::BindFlags::DepthStencil))
 		{
-			pFbo->attachDepthStencilTarget(mTextures[depthStencilBufIdx]);
+			pFbo->attachDepthStencilTarget(mTextures[depthStencilBufIdx].texture);
 			hasDepthStencilBuf = true;
 		}
 	}
@@ -280,11 +377,11 @@ Fbo::SharedPtr ResourceManager::createManagedFbo(const std::vector<int32_t> &col
 	{
 		// Ignore and bind no texture at slot i if:
 		if (colorBufIndicies[i] < 0 || colorBufIndicies[i] >= int32_t(mTextures.size())) continue;  // it's an invalid index; no such resource exists
-		if (isDepthStencilFormat(mTextureFormat[colorBufIndicies[i]])) continue;                    // it's a depth/stencil buffer
+		if (isDepthStencilFormat(mTextures[colorBufIndicies[i]].format)) continue;                  // it's a depth/stencil buffer
 		if (!hasBindFlag(colorBufIndicies[i], Resource::BindFlags::RenderTarget)) continue;         // it can't be bound as a render target
 		if (i >= int32_t(Fbo::getMaxColorTargetCount())) continue;                                  // We've exceeded the number of allowable color targets
 
-		pFbo->attachColorTarget(mTextures[colorBufIndicies[i]], i);
+		pFbo->attachColorTarget(mTextures[colorBufIndicies[i]].texture, i);
 		hasColorBuf = true;
 	}
 
@@ -311,7 +408,7 @@ Fbo::SharedPtr ResourceManager::createManagedFbo(const std::vector<std::string>
 
 bool ResourceManager::hasBindFlag(int32_t index, Resource::BindFlags flag)
 {
-	return ((mTextureFlags[index] & flag) == flag);
+	return ((mTextures[index].flags & flag) == flag);
 }
 
 void ResourceManager::updateTextureSize(const std::string &channelName, int32_t newWidth, int32_t newHeight)
@@ -330,11 +427,13 @@ void ResourceManager::updateTextureSize(int32_t channelIdx, int32_t newWidth, in
 		newSize = ivec2(-1, -1);
 
 	// If we haven't changed sizes, there's no reason to deallocate and reallocate the texture
-	if (mTextureSizes[channelIdx] == newSize) return;
+	ManagedTexture &tex = mTextures[channelIdx];
+	if (tex.size == newSize) return;
 
 	// Update the channel
-	mTextures[channelIdx] = Texture::create2D(newSize.x, newSize.y, mTextureFormat[channelIdx], 1u, Texture::kMaxPossible, nullptr, mTextureFlags[channelIdx]);
-	mTextureSizes[channelIdx] = newSize;
+	tex.texture = Texture::create2D(newSize.x, newSize.y, tex.format, 1u, Texture::kMaxPossible, nullptr, tex.flags);
+	tagChannelTexture(tex.texture, tex.name);
+	tex.size = newSize;
 	mUpdatedFlag = true;
 }
 
@@ -369,3 +468,32 @@ Fbo::SharedPtr ResourceManager::createFbo(uint32_t width, uint32_t height, std::
 
 	return FboHelper::create2D(width, height, desc);
 }
+
+void ResourceManager::runLookupBenchmark(uint32_t iterations)
+{
+	if (mTextures.empty() || iterations == 0) return;
+
+	// Resolve everything up front, like a pass would in initialize()
+	std::vector<std::string> names;
+	std::vector<TextureHandle> handles;
+	for (const auto &tex : mTextures)
+	{
+		names.push_back(tex.name);
+		handles.push_back(getTextureHandle(tex.name));
+	}
+
+	// Accumulate something from each lookup so the loops can't be optimized away
+	size_t checksum = 0;
+	CpuTimer::TimePoint start = CpuTimer::getCurrentTimePoint();
+	for (uint32_t i = 0; i < iterations; i++)
+		checksum += size_t(getTexture(names[i % names.size()]).get());
+	CpuTimer::TimePoint nameEnd = CpuTimer::getCurrentTimePoint();
+	for (uint32_t i = 0; i < iterations; i++)
+		checksum += size_t(getTexture(handles[i % handles.size()]).get());
+	CpuTimer::TimePoint handleEnd = CpuTimer::getCurrentTimePoint();
+
+	double nameNs = 1.0e6 * CpuTimer::calcDuration(start, nameEnd) / iterations;
+	double handleNs = 1.0e6 * CpuTimer::calcDuration(nameEnd, handleEnd) / iterations;
+	logInfo("ResourceManager lookups over " + std::to_string(mTextures.size()) + " channels: " + std::to_string(nameNs) + " ns by name, " +
+		std::to_string(handleNs) + " ns by handle (checksum " + std::to_string(checksum & 0xff) + ")");
+}
@@ -20,9 +20,12 @@
 #include "Falcor.h"
 #include <vector>
 #include <map>
+#include <unordered_map>
 
 using namespace Falcor;
 
+class RenderPass;
+
 class ResourceManager : public std::enable_shared_from_this<ResourceManager>
 {
 public:
@@ -32,6 +35,39 @@ public:
 	static const std::string kOutputChannel; 
 	static const std::string kEnvironmentMap;
 
+	// A typed handle to a managed texture channel.  Channels are never removed, and resizing or replacing a channel's texture
+	//    keeps its handle, so passes can resolve their handles once in initialize() and use them every frame instead of names.
+	class TextureHandle
+	{
+	public:
+		TextureHandle() = default;
+		bool    isValid() const  { return mIndex >= 0; }
+		int32_t getIndex() const { return mIndex; }
+		bool operator==(const TextureHandle &other) const { return mIndex == other.mIndex; }
+		bool operator!=(const TextureHandle &other) const { return mIndex != other.mIndex; }
+	private:
+		friend class ResourceManager;
+		explicit TextureHandle(int32_t index) : mIndex(index) {}
+		int32_t mIndex = -1;
+	};
+
+	// How a pass accesses a channel.  Passes that declare this when requesting channels let the RenderingPipeline work out
+	//    which passes depend on each other, which passes can be skipped, and which resource barriers are needed between them.
+	enum class ChannelAccess : uint32_t
+	{
+		Read      = 0x1,    ///< The pass only reads the channel
+		Write     = 0x2,    ///< The pass overwrites the channel without reading its prior contents
+		ReadWrite = 0x3,    ///< The pass reads and writes the channel (e.g., accumulation).  Assumed for requests without an access.
+	};
+
+	// A channel accessed by a pass
+	struct ChannelUsage
+	{
+		int32_t       channel;     ///< Channel index
+		ChannelAccess access;      ///< How the pass accesses the channel
+		bool          declared;    ///< False if the pass didn't say how it accesses the channel (then access is ReadWrite)
+	};
+
 	// Public ctors and dtors
 	static SharedPtr create(uint32_t width, uint32_t height, SampleCallbacks *callbacks);
 	virtual ~ResourceManager() = default;
@@ -50,6 +86,11 @@ public:
 	// The same as above, but requests multiple textures with the same format
 	void requestTextureResources(const std::vector<std::string> &channelNames, ResourceFormat channelFormat = ResourceFormat::RGBA32Float, Resource::BindFlags usageFlags = kDefaultFlags, int32_t channelWidth = -1, int32_t channelHeight = -1);
 
+	// The same as above, but also declares how the requesting pass accesses the channel(s).  Passes should prefer these, since
+	//    the pipeline must assume undeclared channels are both read and written, and can never skip a pass that uses them.
+	int32_t requestTextureResource(const std::string &channelName, ChannelAccess access, ResourceFormat channelFormat = ResourceFormat::RGBA32Float, Resource::BindFlags usageFlags = kDefaultFlags, int32_t channelWidth = -1, int32_t channelHeight = -1);
+	void requestTextureResources(const std::vector<std::string> &channelNames, ChannelAccess access, ResourceFormat channelFormat = ResourceFormat::RGBA32Float, Resource::BindFlags usageFlags = kDefaultFlags, int32_t channelWidth = -1, int32_t channelHeight = -1);
+
 	// If a pass has created a resource other passes may want to share, it can request it to be managed, and pass it to the resource manager
 	int32_t manageTextureResource(const std::string &channelName, Texture::SharedPtr sharedTex);
 
@@ -63,22 +104,47 @@ public:
 	Texture::SharedPtr getTexture(const std::string &channelName);
 	Texture::SharedPtr getTexture(int32_t channelIdx);
 
+	// Get the texture of a channel from its handle.  This is the cheapest lookup, meant for per-frame use.  Returns a nullptr if the handle is invalid
+	const Texture::SharedPtr &getTexture(TextureHandle handle) const;
+
 	// Get a pointer to requested texture, but before returning, clear the channel
 	Texture::SharedPtr getClearedTexture(const std::string &channelName, vec4 &clearColor);
 	Texture::SharedPtr getClearedTexture(int32_t channelIdx, vec4 &clearColor);
+	Texture::SharedPtr getClearedTexture(TextureHandle handle, const vec4 &clearColor);
 
 	// If you have a texture, you can clear it here
 	void clearTexture(Texture::SharedPtr &tex, const vec4 &clearColor);
 
+	// Channel requests are attributed to this pass until it is reset to nullptr.  The RenderingPipeline sets it around each pass' initialize()
+	void setRequestingPass(const ::RenderPass *pPass) { mpRequestingPass = pPass; }
+
+	// Declare or withdraw the requesting pass' access to an existing channel, for passes whose inputs change at runtime.  Call these while
+	//    the pass is the requesting pass (e.g., in pipelineUpdated(); set the rebind flag to have the pipeline call it again).
+	void declareChannelAccess(int32_t channelIdx, ChannelAccess access) { recordChannelUsage(channelIdx, access, true); }
+	void withdrawChannelAccess(int32_t channelIdx);
+
+	// Returns the channels the specified pass requested (while it was the requesting pass), and how it accesses them
+	const std::vector<ChannelUsage> &getChannelUsage(const ::RenderPass *pPass) const;
+
+	// Returns true if the channel's texture was handed to us by manageTextureResource() rather than produced by a pass (e.g., the environment map)
+	bool isExternalTexture(int32_t channelIdx) const { return channelIdx >= 0 && channelIdx < int32_t(mTextures.size()) && mTextures[channelIdx].isExternal; }
+
 	// Returns the name of the texture with the specified index
 	std::string getTextureName(int32_t channelIdx);
 
 	// Returns the channel index of the channel with the specified name (returns -1 if channel name does not exist)
 	int32_t getTextureIndex(const std::string &channelName) const;
 
+	// Returns a handle to the channel with the specified name (the handle is invalid if channel name does not exist).  Call this 
+	//    after requesting the channel; unlike requestTextureResource(), it also succeeds if another pass requested a different format.
+	TextureHandle getTextureHandle(const std::string &channelName) const { return TextureHandle(getTextureIndex(channelName)); }
+
 	// Return the maximum number of channels we might have (some may be invalid)
 	uint32_t getTextureCount(void) const { return uint32_t(mTextures.size()); }
 
+	// Time per-frame style texture lookups by name and by handle over all current channels, and log the average cost of each
+	void runLookupBenchmark(uint32_t iterations = 100000);
+
 	// Will update the stored environment map to the specified file.  Returns <true> if
 	//     the resource manager was able to load the specified file.  If the load fails,
 	//     the prior environment map is still used.
@@ -159,12 +225,31 @@ protected:
 	// Falcor's callbacks structure to access basic resources of the application
 	SampleCallbacks *mpAppCallbacks;
 
-    // The internal texture resources.  These could be combined into an AoS rather than a SoA, but I was lazy.  Does it matter?
-    std::vector<Texture::SharedPtr>   mTextures;         ///< The texture resources managed by this class
-	std::vector<std::string>          mTextureNames;     ///< std::string-based names for the textures
-	std::vector<glm::ivec2>           mTextureSizes;     ///< Stored separately from internal texture data so we can distinguish between fixed & fullscreen textures
-	std::vector<Resource::BindFlags>  mTextureFlags;     ///< Expected usage flags
-	std::vector<ResourceFormat>       mTextureFormat;    ///< Expected texture format
+	// The internal texture resources.  Everything a lookup touches is in one entry, and names are found through a hash map.
+	struct ManagedTexture
+	{
+		Texture::SharedPtr   texture;    ///< The texture resource managed by this class
+		std::string          name;       ///< std::string-based name for the texture
+		glm::ivec2           size;       ///< Stored separately from internal texture data so we can distinguish between fixed & fullscreen textures
+		Resource::BindFlags  flags;      ///< Expected usage flags
+		ResourceFormat       format;     ///< Expected texture format
+		bool                 isExternal; ///< Texture was passed to manageTextureResource()
+	};
+	std::vector<ManagedTexture>               mTextures;         ///< Indexed by channel index / handle
+	std::unordered_map<std::string, int32_t>  mTextureIndices;   ///< Channel name -> index into mTextures
+
+	// Append a new channel and index its name
+	int32_t addTexture(const std::string &channelName, const glm::ivec2 &size, Resource::BindFlags flags, ResourceFormat format);
+
+	// Finds or creates a channel; the common part of the requestTextureResource() overloads
+	int32_t requestChannel(const std::string &channelName, ResourceFormat channelFormat, Resource::BindFlags usageFlags, int32_t channelWidth, int32_t channelHeight);
+
+	// Remember that the current requesting pass accesses a channel
+	void recordChannelUsage(int32_t channelIdx, ChannelAccess access, bool declared);
+
+	// The channels accessed by each pass, recorded as they're requested
+	const ::RenderPass *mpRequestingPass = nullptr;
+	std::unordered_map<const ::RenderPass*, std::vector<ChannelUsage>> mChannelUsage;
 
 private:
 	// These are not meant to be exposed outside the class and may not have suitable error checking non-private use.
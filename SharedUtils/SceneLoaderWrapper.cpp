@@ -55,7 +55,19 @@ Falcor::RtScene::SharedPtr loadScene( uvec2 currentScreenSize, const char *defau
 	// Load a scene
 	if (hasSuffix(filename, ".fscene", false))
 	{
-		pScene = RtScene::loadFromFile(filename, RtBuildFlags::None, Model::LoadFlags::RemoveInstancing);
+		// Identical meshes are loaded once and instanced, rather than flattened into world space.  Static meshes
+		//    also get a chain of simplified LODs, so distant geometry can be rasterized and ray traced more cheaply.
+		Model::LoadFlags modelFlags = Model::LoadFlags::DetectInstancing | Model::LoadFlags::GenerateLods;
+
+		// If texture streaming was enabled, only load the mip-tails now; the rest is streamed in on demand
+		if (TextureStreamer::getGlobalStreamer(false)) modelFlags |= Model::LoadFlags::StreamTextures;
+
+		// Likewise, if geometry streaming was enabled, large meshes are split into clusters which are paged in on demand
+		if (GeometryStreamer::getGlobalStreamer(false)) modelFlags |= Model::LoadFlags::StreamGeometry;
+		{
+			PROFILE(sceneImport);
+			pScene = RtScene::loadFromFile(filename, RtBuildFlags::None, modelFlags);
+		}
 
 		// If we have a valid scene, do some sanity checking; set some defaults
 		if (pScene)
@@ -17,9 +17,15 @@
 **********************************************************************************************************************/
 
 #include "SimpleVars.h"
+#include <atomic>
 
 using namespace Falcor;
 
+namespace {
+	// Ids start at 1 so that a default-constructed handle never matches
+	std::atomic<uint32_t> gNextSimpleVarsId(1);
+};
+
 SimpleVars::SharedPtr SimpleVars::SimpleVars::create(Falcor::Program::SharedPtr pProg)
 {
 	return SharedPtr(new SimpleVars( GraphicsVars::create(pProg->getActiveVersion()->getReflector()).get() ));
@@ -33,6 +39,70 @@ SimpleVars::SharedPtr SimpleVars::SimpleVars::create(Falcor::GraphicsVars *pVars
 SimpleVars::SimpleVars(Falcor::GraphicsVars *pVars)
 {
 	mpVars = pVars;
+	mId = gNextSimpleVarsId++;
+}
+
+bool SimpleVars::resolve(VarHandle& handle)
+{
+	if (handle.mResolvedFor != mId)
+	{
+		handle.mResolvedFor = mId;
+		handle.mpCB = mpVars ? mpVars->getConstantBuffer(handle.mCBName).get() : nullptr;
+		handle.mOffset = handle.mpCB ? handle.mpCB->getVariableOffset(handle.mVarName) : VariablesBuffer::kInvalidOffset;
+	}
+	return handle.mOffset != VariablesBuffer::kInvalidOffset;
+}
+
+Falcor::ConstantBuffer* SimpleVars::resolve(CBufferHandle& handle)
+{
+	if (handle.mResolvedFor != mId)
+	{
+		handle.mResolvedFor = mId;
+		handle.mpCB = mpVars ? mpVars->getConstantBuffer(handle.mCBName).get() : nullptr;
+	}
+	return handle.mpCB;
+}
+
+SimpleVars::VarHandle& SimpleVars::getCachedHandle(const std::string& cbName, const std::string& varName)
+{
+	std::string key = cbName + "." + varName;
+	auto it = mHandleCache.find(key);
+	if (it == mHandleCache.end())
+	{
+		it = mHandleCache.emplace(key, VarHandle(cbName, varName)).first;
+	}
+	return it->second;
+}
+
+void SimpleVars::runBindingBenchmark(const std::string& cbName, const std::string& varName, uint32_t iterations)
+{
+	VarHandle handle(cbName, varName);
+	if (!resolve(handle) || iterations == 0) return;
+
+	// Set the variable as a raw 32-bit blob, so the same value works whatever the variable's declared type
+	SharedPtr self(shared_from_this());
+	uint32_t value = 0;
+
+	// What the string syntax did before it was layered on handles:  a constant buffer and a reflection lookup per assignment
+	CpuTimer::TimePoint start = CpuTimer::getCurrentTimePoint();
+	for (uint32_t i = 0; i < iterations; i++)
+	{
+		ConstantBuffer::SharedPtr pCB = mpVars->getConstantBuffer(cbName);
+		pCB->setBlob(&value, pCB->getVariableOffset(varName), sizeof(value));
+	}
+	CpuTimer::TimePoint falcorEnd = CpuTimer::getCurrentTimePoint();
+	for (uint32_t i = 0; i < iterations; i++)
+		self[cbName][varName].setBlob(value);
+	CpuTimer::TimePoint stringEnd = CpuTimer::getCurrentTimePoint();
+	for (uint32_t i = 0; i < iterations; i++)
+		self[handle].setBlob(value);
+	CpuTimer::TimePoint handleEnd = CpuTimer::getCurrentTimePoint();
+
+	double falcorNs = 1.0e6 * CpuTimer::calcDuration(start, falcorEnd) / iterations;
+	double stringNs = 1.0e6 * CpuTimer::calcDuration(falcorEnd, stringEnd) / iterations;
+	double handleNs = 1.0e6 * CpuTimer::calcDuration(stringEnd, handleEnd) / iterations;
+	logInfo("SimpleVars assignments to " + cbName + "." + varName + ": " + std::to_string(falcorNs) + " ns with lookups, " +
+		std::to_string(stringNs) + " ns by name, " + std::to_string(handleNs) + " ns by handle");
 }
 
 #if 0
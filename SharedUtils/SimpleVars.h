@@ -39,6 +39,14 @@ also use more Falcor-like syntax if you just want this class' beefed up error ch
 	hlslVars->setTexture("myTexture", myTextureResource);
 	hlslVars->setTypedBuffer("myBuffer", myBufferResource);
 
+For variables you set every frame, a handle skips the string lookups.  Declare it once (e.g., as a pass member)
+and assign through it:
+	SimpleVars::VarHandle mFrameCountVar = { "myShaderCB", "gFrameCount" };
+	hlslVars[mFrameCountVar] = frameCount;
+
+	SimpleVars::CBufferHandle mPerFrameCB = { "myShaderCB" };
+	hlslVars->setBlob( mPerFrameCB, myCpuStructMatchingTheWholeCB );
+
 The C++ code for this class, below, is ugly, confusing, and I'm not particularly proud of it.  
 However, this syntactic sugar makes my coding, debugging, and experentation so much easier that
 quite a number of people have decided to use this wrapper (or similar earlier versions I've written)
@@ -48,6 +56,36 @@ class SimpleVars : public std::enable_shared_from_this<SimpleVars>
 {
 public:
 
+	// A constant buffer variable whose location is resolved on first use and remembered afterwards.  If the
+	//     handle is later used with a different SimpleVars object (e.g., because a define changed and the
+	//     wrapper recreated its variables), it transparently resolves again.
+	class VarHandle
+	{
+	public:
+		VarHandle() = default;
+		VarHandle(const std::string& cbName, const std::string& varName) : mCBName(cbName), mVarName(varName) {}
+	protected:
+		friend class SimpleVars;
+		std::string             mCBName;
+		std::string             mVarName;
+		uint32_t                mResolvedFor = 0;         // Id of the SimpleVars this was resolved against (0 == never)
+		Falcor::ConstantBuffer* mpCB = nullptr;
+		size_t                  mOffset = Falcor::VariablesBuffer::kInvalidOffset;
+	};
+
+	// An entire constant buffer, for uploading it in one go from a C++ struct that mirrors its layout
+	class CBufferHandle
+	{
+	public:
+		CBufferHandle() = default;
+		CBufferHandle(const std::string& cbName) : mCBName(cbName) {}
+	protected:
+		friend class SimpleVars;
+		std::string             mCBName;
+		uint32_t                mResolvedFor = 0;
+		Falcor::ConstantBuffer* mpCB = nullptr;
+	};
+
 	// This class uses an overloaded shared_ptr that allows calling array operations.
 	class SharedPtr : public std::shared_ptr<SimpleVars>
 	{
@@ -60,6 +98,9 @@ public:
 			// Constructor gets called when mySharedPtr["myIdx1"]["myVar"] is encountered
 			Var(Falcor::ConstantBuffer *cb, const std::string& var) : mCB(cb), mVar(var) { if (cb) { mOffset = cb->getVariableOffset(var); } }
 
+			// Constructor gets called when mySharedPtr[myHandle] is encountered, with the location already resolved
+			Var(Falcor::ConstantBuffer *cb, size_t offset) : mCB(cb), mOffset(cb ? offset : Falcor::VariablesBuffer::kInvalidOffset) { }
+
 			// Assignment operator gets called when mySharedPtr["myIdx1"]["myVar"] = T(someData); is encountered
 			template<typename T> void operator=(const T& val) { if (mOffset != Falcor::VariablesBuffer::kInvalidOffset) { mCB->setVariable(mOffset, val); } }
 
@@ -83,8 +124,9 @@ public:
 			// Constructor gets called when mySharedPtr["myIdx1"] is encoutered
 			Idx1(SimpleVars* pBuf, const std::string& var) : mpBuf(pBuf), mVar(var) { }
 
-			// When a second array operator is encountered, instatiate a Var object to handle mySharedPtr["myIdx1"]["myVar"]
-			Var operator[](const std::string& var) { return mpBuf->mpVars ? Var(mpBuf->mpVars->getConstantBuffer(mVar).get(), var) : Var(nullptr, var); }
+			// When a second array operator is encountered, instatiate a Var object to handle mySharedPtr["myIdx1"]["myVar"].
+			//     This goes through the same cached handles as mySharedPtr[myHandle], so repeated assignments only pay for the hashing.
+			Var operator[](const std::string& var) { return mpBuf->getVar(mpBuf->getCachedHandle(mVar, var)); }
 
 			// When encountering an assignment operator (i.e., mySharedPtr["myIdx1"] = pSomeResource;)  
 			//   set the appropriate resource for the following types:  texture, sampler, various buffers
@@ -112,6 +154,9 @@ public:
 
 		// Calling [] on the SharedPtr?  Create an intermediate object to process further operators
 		Idx1 operator[](const std::string& var) { return Idx1(get(), var); }
+
+		// Calling [] with a handle?  Skip straight to the resolved variable
+		Var operator[](VarHandle& handle) { return get()->getVar(handle); }
 	};
 
 	// public constructors
@@ -130,6 +175,36 @@ public:
 		}
 	}
 
+	// Set a variable through a handle, without any string lookups once the handle is resolved
+	template<typename T>
+	void setVariable(VarHandle& handle, const T& value)
+	{
+		if (resolve(handle)) handle.mpCB->setVariable(handle.mOffset, value);
+	}
+
+	// Upload an entire constant buffer from a C++ struct with the same layout.  Fails if the struct is larger than the buffer
+	template<typename T>
+	bool setBlob(CBufferHandle& handle, const T& blob)
+	{
+		Falcor::ConstantBuffer* pCB = resolve(handle);
+		if (!pCB) return false;
+		if (sizeof(T) > pCB->getSize())
+		{
+			Falcor::logWarning("SimpleVars::setBlob() - struct is larger than constant buffer '" + handle.mCBName + "'");
+			return false;
+		}
+		pCB->setBlob(&blob, 0, sizeof(T));
+		return true;
+	}
+
+	// Resolve a handle against this object's variables.  Returns false (or nullptr) if the variable does not exist
+	bool resolve(VarHandle& handle);
+	Falcor::ConstantBuffer* resolve(CBufferHandle& handle);
+
+	// Compare the CPU cost of setting a constant buffer variable by name through plain Falcor calls, through
+	//     the string syntax, and through a handle.  Results are logged.
+	void runBindingBenchmark(const std::string& cbName, const std::string& varName, uint32_t iterations = 100000);
+
 	// Set a texture, sampler, or buffer resource.  (Could probably add setParameterBlock, too, if needed)
 	//    -> Note:  These do additional error checks that core Falcor variants do not, which introduces 
 	//       additional overhead in exchange for reduced hard-to-debug hard program crashes when a shader 
@@ -151,6 +226,13 @@ protected:
 
 private:
 	Falcor::GraphicsVars*   mpVars = nullptr;
+	uint32_t                mId;                      // Unique per SimpleVars object; lets handles detect they were resolved elsewhere
+
+	// Handles backing the mySharedPtr["myIdx1"]["myVar"] syntax, keyed by "myIdx1.myVar"
+	std::unordered_map<std::string, VarHandle> mHandleCache;
+
+	VarHandle& getCachedHandle(const std::string& cbName, const std::string& varName);
+	SharedPtr::Var getVar(VarHandle& handle) { return resolve(handle) ? SharedPtr::Var(handle.mpCB, handle.mOffset) : SharedPtr::Var(nullptr, size_t(0)); }
 
 	// Internal utility function that does additional error checking beyond Falcor's built-in checks
 	//    -> returns true if shader variable [varName] exists and has type [varType]